@@ -10,11 +10,12 @@
 //
 
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include "support/BROSCompat.h"
 #include "support/BRBIP39WordsEn.h"
 #include "ethereum/blockchain/BREthereumAccount.h"
-#include "test.h"  // runSyncTest
+#include "test.h"  // runSyncTest, BRRunPerfTests, BRRunSupPerfTests
 
 #if defined (NEVER_EWM)
 extern BREthereumClient
@@ -82,17 +83,76 @@ runSyncMany (BREthereumNetwork newtork,
 }
 #endif
 
+static void
+usage (const char *program) {
+    fprintf (stderr,
+             "Usage: %s [options] [paperKey]\n"
+             "  -btc     Base58/Bech32, Keccak and merkleblock benchmarks\n"
+             "  -alarm   Alarm clock benchmark (runs for about five seconds)\n"
+             "  -les     LES frame coder benchmarks\n"
+             "  -ripple  Ripple payment signing and re-signing benchmark\n"
+             "  -hedera  Hedera transaction pack and ed25519 batch verify benchmarks\n"
+             "  -qry     QRY address discovery time-to-synced against a stub client\n"
+             "  -bundle  XRP transfer bundle decoding and BTC transaction bundle recovery\n"
+             "  -sync    ETH sync test (requires NEVER_EWM)\n"
+             "  -all     All of the above benchmarks, except -sync\n",
+             program);
+}
+
 int main(int argc, const char * argv[]) {
     BRCryptoSyncMode mode = CRYPTO_SYNC_MODE_API_WITH_P2P_SEND;
 
-    const char *paperKey = (argc > 1 ? argv[1] : "0xa9de3dbd7d561e67527bc1ecb025c59d53b9f7ef");
+    const char *paperKey = "0xa9de3dbd7d561e67527bc1ecb025c59d53b9f7ef";
+    int runBTC = 0, runAlarm = 0, runLES = 0, runRipple = 0, runHedera = 0, runQRY = 0, runBundle = 0, runSync = 0;
+
+    for (int index = 1; index < argc; index++) {
+        const char *arg = argv[index];
+        if      (0 == strcmp (arg, "-btc"))    runBTC    = 1;
+        else if (0 == strcmp (arg, "-alarm"))  runAlarm  = 1;
+        else if (0 == strcmp (arg, "-les"))    runLES    = 1;
+        else if (0 == strcmp (arg, "-ripple")) runRipple = 1;
+        else if (0 == strcmp (arg, "-hedera")) runHedera = 1;
+        else if (0 == strcmp (arg, "-qry"))    runQRY    = 1;
+        else if (0 == strcmp (arg, "-bundle")) runBundle = 1;
+        else if (0 == strcmp (arg, "-sync"))   runSync   = 1;
+        else if (0 == strcmp (arg, "-all"))    runBTC = runAlarm = runLES = runRipple = runHedera = runQRY = runBundle = 1;
+        else if ('-' == arg[0]) { usage (argv[0]); return 1; }
+        else paperKey = arg;
+    }
+
+    if (!(runBTC || runAlarm || runLES || runRipple || runHedera || runQRY || runBundle || runSync)) {
+        usage (argv[0]);
+        return 0;
+    }
+
     BREthereumAccount account = ethAccountCreate (paperKey);
     BREthereumTimestamp timestamp = 1539330275; // ETHEREUM_TIMESTAMP_UNKNOWN;
     const char *path = "core";
 
+    if (runBTC)    BRRunPerfTests (1000000);
+    if (runAlarm)  BRRunSupPerfTests (10000);
+    if (runLES) {
+        runPerfTestsFrameCoder (20000, 200);
+        runPerfTestsFrameCoder (2000, 16384);
+    }
+    if (runRipple) runRipplePerfTest (20000);
+    if (runHedera) {
+        runHederaPerfTest (200000);
+        runHederaVerifyPerfTest (200);
+    }
+    if (runQRY)    runCryptoClientQRYPerfTest (2000, 10);
+    if (runBundle) {
+        runCryptoTransferBundleDecodePerfTest (1000000, 5);
+        runCryptoTransactionBundlesBTCPerfTest (2000);
+    }
+
+    if (runSync) {
 #if defined (NEVER_EWM)
-    runSyncTest (ethNetworkMainnet,  account, mode, timestamp,  5 * 60, path);
-//    runSyncMany(ethereumMainnet, mode, 10 * 60, 1000);
+        runSyncTest (ethNetworkMainnet,  account, mode, timestamp,  5 * 60, path);
+//        runSyncMany(ethereumMainnet, mode, 10 * 60, 1000);
+#else
+        fprintf (stderr, "-sync: not built; define NEVER_EWM\n");
 #endif
+    }
     return 0;
 }
@@ -41,6 +41,7 @@
 
 #include "bitcoin/BRBloomFilter.h"
 #include "bitcoin/BRMerkleBlock.h"
+#include "bitcoin/BROrphanPool.h"
 #include "bitcoin/BRWallet.h"
 #include "bitcoin/BRBIP38Key.h"
 #include "bitcoin/BRPeer.h"
@@ -48,6 +49,7 @@
 #include "bitcoin/BRChainParams.h"
 #include "bitcoin/BRPaymentProtocol.h"
 #include "bitcoin/BRTransaction.h"
+#include "bitcoin/BRTxPeerList.h"
 
 #include "test.h"
 
@@ -357,6 +359,41 @@ int BRBase58Tests()
     if (l5 != 21 || memcmp(s, b5, l5) != 0)
         r = 0, fprintf(stderr, "***FAILED*** %s: BRBase58CheckDecode() test 5\n", __func__);
 
+    uint8_t batch[8][21], batchDecoded[8][21];
+    char batchStr[8][36], batchStr1[36];
+    const char *batchStrs[8];
+    size_t batchLens[8];
+    
+    for (size_t i = 0; i < 8; i++) {
+        for (size_t j = 0; j < 21; j++) batch[i][j] = (uint8_t)(i*j*37 + i);
+        batchStrs[i] = batchStr[i];
+    }
+    
+    batch[0][0] = batch[0][1] = 0; // leading zeroes
+
+    if (BRBase58CheckEncodeBatch(&batchStr[0][0], sizeof(*batchStr), &batch[0][0], 21, 8) != 8)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRBase58CheckEncodeBatch() test 1\n", __func__);
+    
+    for (size_t i = 0; i < 8; i++) {
+        BRBase58CheckEncode(batchStr1, sizeof(batchStr1), batch[i], 21);
+        if (strcmp(batchStr1, batchStr[i]) != 0)
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRBase58CheckEncodeBatch() test 2\n", __func__);
+    }
+    
+    batchStr[5][3] = (batchStr[5][3] == 'z') ? 'y' : 'z'; // fails the checksum
+    
+    if (BRBase58CheckDecodeBatch(&batchDecoded[0][0], sizeof(*batchDecoded), batchLens, batchStrs, 8) != 7)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRBase58CheckDecodeBatch() test 1\n", __func__);
+    
+    for (size_t i = 0; i < 8; i++) {
+        if (i == 5 ? batchLens[i] != 0 : (batchLens[i] != 21 || memcmp(batch[i], batchDecoded[i], 21) != 0))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRBase58CheckDecodeBatch() test 2\n", __func__);
+    }
+    
+    // a payload that does not fit in the stride
+    if (BRBase58CheckDecodeBatch(&batchDecoded[0][0], 20, batchLens, batchStrs, 1) != 0 || batchLens[0] != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRBase58CheckDecodeBatch() test 3\n", __func__);
+
     return r;
 }
 
@@ -390,6 +427,32 @@ int BRBech32Tests()
     if (l == 0 || strcmp(addr, "bc1zw508d6qejxtdg4y5r3zarvaryvg6kdaj"))
         r = 0, fprintf(stderr, "\n***FAILED*** %s: BRBech32Encode() test 3", __func__);
 
+    uint8_t programs[3][22], decoded[3][42];
+    char addrs[3][91];
+    const char *addrStrs[3] = { addrs[0], addrs[1], "BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4" };
+    size_t lens[3];
+    
+    for (size_t i = 0; i < 3; i++) memcpy(programs[i], "\x00\x14\x75\x1e\x76\xe8\x19\x91\x96\xd4\x54\x94\x1c\x45"
+                                                "\xd1\xb3\xa3\x23\xf1\x43\x3b\xd6", 22);
+    programs[1][21] ^= 0x01;
+    
+    if (BRBech32EncodeBatch(&addrs[0][0], "bc", &programs[0][0], 22, 3) != 3 ||
+        strcmp(addrs[0], "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4") != 0)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRBech32EncodeBatch() test 1", __func__);
+    
+    l = BRBech32Encode(addr, "bc", programs[1]);
+    if (l == 0 || strcmp(addr, addrs[1]) != 0)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRBech32EncodeBatch() test 2", __func__);
+    
+    if (BRBech32DecodeBatch(&decoded[0][0], lens, "bc", addrStrs, 3) != 3 ||
+        lens[0] != 22 || memcmp(decoded[0], programs[0], 22) != 0 ||
+        lens[1] != 22 || memcmp(decoded[1], programs[1], 22) != 0 ||
+        lens[2] != 22 || memcmp(decoded[2], programs[2], 22) != 0)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRBech32DecodeBatch() test 1", __func__);
+    
+    if (BRBech32DecodeBatch(&decoded[0][0], lens, "tb", addrStrs, 3) != 0 || lens[0] != 0)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRBech32DecodeBatch() test 2", __func__);
+
     if (! r) fprintf(stderr, "\n                                    ");
     return r;
 }
@@ -701,6 +764,32 @@ int BRHashTests()
                     "\x82\x27\x3b\x7b\xfa\xd8\x04\x5d\x85\xa4\x70", *(UInt256 *)md))
         r = 0, fprintf(stderr, "***FAILED*** %s: Keccak-256() test 1\n", __func__);
 
+    // test keccak-512
+    
+    s = "";
+    BRKeccak512(md, s, strlen(s));
+    if (memcmp("\x0e\xab\x42\xde\x4c\x3c\xeb\x92\x35\xfc\x91\xac\xff\xe7\x46\xb2\x9c\x29\xa8\xc3\x66\xb7\xc6\x0e"
+               "\x4e\x67\xc4\x66\xf3\x6a\x43\x04\xc0\x0f\xa9\xca\xf9\xd8\x79\x76\xba\x46\x9b\xcb\xe0\x67\x13\xb4"
+               "\x35\xf0\x91\xef\x27\x69\xfb\x16\x0c\xda\xb3\x3d\x36\x70\x68\x0e", md, 64) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: Keccak-512() test 1\n", __func__);
+
+    // test keccak-256 batch, lengths around the 136 byte block boundary, more messages than the 4-way lanes
+    
+    {
+        uint8_t msg[600], mds[9*32];
+        const size_t lens[] = { 0, 1, 32, 135, 136, 137, 271, 272, 600 };
+        const void *msgs[] = { NULL, msg, msg + 7, msg, msg + 1, msg, msg + 2, msg, msg };
+        
+        for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)(i*31 + 7);
+        BRKeccak256Batch(mds, msgs, lens, 9);
+        
+        for (size_t i = 0; i < 9; i++) {
+            BRKeccak256(md, msgs[i], lens[i]);
+            if (memcmp(&mds[i*32], md, 32) != 0)
+                r = 0, fprintf(stderr, "***FAILED*** %s: BRKeccak256Batch() test %zu\n", __func__, i + 1);
+        }
+    }
+
     // test murmurHash3-x86_32
     
     if (BRMurmur3_32("", 0, 0) != 0)
@@ -2388,6 +2477,24 @@ int BRTransactionTests()
         r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionCopy() test 3", __func__);
     BRTransactionFree(tgt);
     BRTransactionFree(src);
+
+    // parsed and copied transactions share one allocation with their buffers, they must still take mutations
+    src = BRTransactionParse((uint8_t *)buf0, sizeof(buf0) - 1);
+    tgt = BRTransactionCopy(src);
+    BRTxInputSetSignature(&tgt->inputs[0], script, scriptLen);
+    BRTxInputSetWitness(&tgt->inputs[0], NULL, 0);
+    BRTxOutputSetScript(&tgt->outputs[0], script, scriptLen);
+    BRTransactionAddInput(tgt, inHash, 0, 1, script, scriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput(tgt, 1000000, script, scriptLen);
+    BRTransactionAddOutput(src, 1000000, script, scriptLen);
+    if (tgt->inCount != src->inCount + 1 || tgt->outCount != src->outCount ||
+        tgt->inputs[0].sigLen != scriptLen || memcmp(tgt->inputs[0].signature, script, scriptLen) != 0 ||
+        tgt->outputs[0].scriptLen != scriptLen || memcmp(tgt->outputs[0].script, script, scriptLen) != 0 ||
+        tgt->inputs[0].witness != NULL || ! UInt256Eq(tgt->inputs[1].txHash, inHash) ||
+        tgt->outputs[tgt->outCount - 1].amount != 1000000 || ! UInt256Eq(tgt->txHash, src->txHash))
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionCopy() test 4", __func__);
+    BRTransactionFree(tgt);
+    BRTransactionFree(src);
     
     if (! r) fprintf(stderr, "\n                                    ");
     return r;
@@ -2583,7 +2690,100 @@ int BRWalletTests()
 
     BRTransactionFree(tx);
     BRWalletFree(w);
-    
+
+    BRTransaction *batch[2], *txs[2];
+
+    tx = BRTransactionNew();
+    BRTransactionAddInput(tx, inHash, 0, 1, inScript, inScriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput(tx, SATOSHIS, outScript, outScriptLen);
+    BRTransactionSign(tx, 0, &k, 1);
+    batch[1] = BRTransactionCopy(tx);
+    w = BRWalletNew(BRMainNetParams->addrParams, &tx, 1, mpk);
+    batch[0] = BRWalletCreateTransaction(w, SATOSHIS/2, addr.s); // spends batch[1]
+    if (batch[0]) BRWalletSignTransaction(w, batch[0], 0x00, &seed, sizeof(seed));
+    BRWalletFree(w);
+
+    w = BRWalletNew(BRMainNetParams->addrParams, NULL, 0, mpk);
+    if (! batch[0] || BRWalletRegisterTransactions(w, batch, 2) != 2 ||
+        BRWalletBalance(w) + BRWalletFeeForTx(w, batch[0]) != SATOSHIS/2)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransactions() test 1\n", __func__);
+
+    if (BRWalletTransactions(w, txs, 2) != 2 || txs[0] != batch[1] || txs[1] != batch[0]) // parent ordered first
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransactions() test 2\n", __func__);
+
+    if (BRWalletRegisterTransactions(w, batch, 2) != 0 || BRWalletTransactions(w, NULL, 0) != 2)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransactions() test 3\n", __func__);
+
+    BRWalletFree(w);
+
+    BRWalletAddressIndex *index = BRWalletAddressIndexNew(mpk);
+    BRAddress unused[SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED], recvAddr2;
+    BRWallet *w2;
+
+    tx = BRTransactionNew();
+    BRTransactionAddInput(tx, inHash, 0, 1, inScript, inScriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput(tx, SATOSHIS, outScript, outScriptLen);
+    BRTransactionSign(tx, 0, &k, 1);
+    w = BRWalletNewWithAddressIndex(BRMainNetParams->addrParams, &tx, 1, index);
+    w2 = BRWalletNewWithAddressIndex(BRMainNetParams->addrParams, NULL, 0, index);
+    recvAddr2 = BRWalletReceiveAddress(w2);
+
+    // w has used its first receive address and w2 hasn't, so w generated one more address than w2
+    if (BRWalletAllAddrs(w, NULL, 0) != BRWalletAllAddrs(w2, NULL, 0) + 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletNewWithAddressIndex() test 1\n", __func__);
+
+    if (! BRAddressEq(&recvAddr2, &recvAddr) || BRWalletBalance(w) != SATOSHIS || BRWalletBalance(w2) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletNewWithAddressIndex() test 2\n", __func__);
+
+    // the last of these was generated for w only, even though w2 shares the index it was derived in
+    if (BRWalletUnusedAddrs(w, unused, SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED, SEQUENCE_EXTERNAL_CHAIN) !=
+        SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED ||
+        ! BRWalletContainsAddress(w, unused[SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED - 1].s) ||
+        BRWalletContainsAddress(w2, unused[SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED - 1].s))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletNewWithAddressIndex() test 3\n", __func__);
+
+    BRWalletFree(w);
+    BRWalletAddressIndexRelease(index); // w2 still holds a reference
+
+    if (! BRWalletContainsAddress(w2, recvAddr.s) ||
+        BRWalletUnusedAddrs(w2, unused, SEQUENCE_GAP_LIMIT_EXTERNAL, SEQUENCE_EXTERNAL_CHAIN) !=
+        SEQUENCE_GAP_LIMIT_EXTERNAL || ! BRAddressEq(&unused[0], &recvAddr))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletNewWithAddressIndex() test 4\n", __func__);
+
+    BRWalletFree(w2);
+
+    BRAddress ahead[SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED];
+    size_t allCount;
+
+    w = BRWalletNew(BRMainNetParams->addrParams, NULL, 0, mpk);
+    allCount = BRWalletAllAddrs(w, NULL, 0);
+
+    // look-ahead addresses are derived, but not generated for the wallet
+    if (BRWalletAddrsAhead(w, ahead, SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED, SEQUENCE_EXTERNAL_CHAIN) !=
+        SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED || BRWalletAllAddrs(w, NULL, 0) != allCount ||
+        BRWalletContainsAddress(w, ahead[0].s))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletAddrsAhead() test 1\n", __func__);
+
+    uint8_t aheadScript[BRAddressScriptPubKey(NULL, 0, BRMainNetParams->addrParams, ahead[20].s)];
+    size_t aheadScriptLen = BRAddressScriptPubKey(aheadScript, sizeof(aheadScript), BRMainNetParams->addrParams,
+                                                  ahead[20].s);
+
+    tx = BRTransactionNew();
+    BRTransactionAddInput(tx, inHash, 0, 1, inScript, inScriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput(tx, SATOSHIS, aheadScript, aheadScriptLen);
+    BRTransactionSign(tx, 0, &k, 1);
+
+    // generating the used address also generates the 20 that precede it, but none after it
+    if (BRWalletGenerateAddrsUsedBy(w, &tx, 1) != 21 || BRWalletAllAddrs(w, NULL, 0) != allCount + 21 ||
+        ! BRWalletContainsAddress(w, ahead[20].s) || BRWalletContainsAddress(w, ahead[21].s))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletGenerateAddrsUsedBy() test 1\n", __func__);
+
+    if (BRWalletRegisterTransactions(w, &tx, 1) != 1 || BRWalletBalance(w) != SATOSHIS ||
+        BRWalletGenerateAddrsUsedBy(w, &tx, 1) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletGenerateAddrsUsedBy() test 2\n", __func__);
+
+    BRWalletFree(w);
+
     amt = BRBitcoinAmount(50000, 50000);
     if (amt != SATOSHIS) r = 0, fprintf(stderr, "***FAILED*** %s: BRBitcoinAmount() test 1\n", __func__);
 
@@ -2951,8 +3151,67 @@ int BRPaymentProtocolTests()
     if (req->details->expires == 0 || req->details->expires >= time(NULL)) // check that request is expired
         r = 0, fprintf(stderr, "***FAILED*** %s: BRPaymentProtocolRequest->details->expires test 1\n", __func__);
     
+    BRPaymentProtocolRequestView view;
+    uint8_t md1[32], md2[32];
+    const uint8_t *script;
+    size_t off = 0, scriptLen;
+    uint64_t amount;
+
+    if (! BRPaymentProtocolRequestViewParse(&view, buf3, sizeof(buf3)) || ! view.isCanonical ||
+        view.pkiDataLen != req->pkiDataLen || memcmp(view.pkiData, req->pkiData, view.pkiDataLen) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRPaymentProtocolRequestViewParse() test\n", __func__);
+
+    for (i = 0; BRPaymentProtocolDetailsNextOutput(view.details, view.detailsLen, &off, &amount, &script, &scriptLen);
+         i++) {
+        if (i >= req->details->outCount || amount != req->details->outputs[i].amount ||
+            scriptLen != req->details->outputs[i].scriptLen ||
+            memcmp(script, req->details->outputs[i].script, scriptLen) != 0) break;
+    }
+
+    if (i != req->details->outCount)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRPaymentProtocolDetailsNextOutput() test\n", __func__);
+
+    // the digests hashed in place must match the hash of the request reserialized with an empty signature
+    size_t sigLen = req->sigLen;
+    
+    req->sigLen = 0;
+    len = BRPaymentProtocolRequestSerialize(req, buf4, sizeof(buf4));
+    req->sigLen = sigLen;
+    BRSHA256(md2, buf4, len);
+    
+    if (BRPaymentProtocolRequestViewDigest(&view, md1, sizeof(md1)) != sizeof(md1) || memcmp(md1, md2, sizeof(md1)) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRPaymentProtocolRequestViewDigest() test\n", __func__);
+    
+    if (BRPaymentProtocolRequestDigest(req, md1, sizeof(md1)) != sizeof(md1) || memcmp(md1, md2, sizeof(md1)) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRPaymentProtocolRequestDigest() test\n", __func__);
+
     if (req) BRPaymentProtocolRequestFree(req);
 
+    // two unknown fields each in an output, the details and the request, in order, then with the details' swapped
+    uint8_t ubuf1[] = "\x08\x01\x12\x0bx509+sha256\x22\x12"
+    "\x12\x0a\x08\xe8\x07\x12\x01\x51\x18\x00\x20\x00\x18\x01\x40\x00\x48\x00" // details, output in outputs
+    "\x2a\x02\xab\xcd\x30\x00\x38\x00";
+    uint8_t ubuf2[sizeof(ubuf1)];
+
+    for (i = 0; i < 2; i++) {
+        if (i == 1) ubuf1[31] = 0x48, ubuf1[33] = 0x40;
+        req = BRPaymentProtocolRequestParse(ubuf1, sizeof(ubuf1) - 1);
+        len = (req) ? BRPaymentProtocolRequestSerialize(req, ubuf2, sizeof(ubuf2)) : 0;
+
+        // check that unknown fields in order reserialize as parsed
+        if (! BRPaymentProtocolRequestViewParse(&view, ubuf1, sizeof(ubuf1) - 1) || view.isCanonical != (i == 0) ||
+            (i == 0 && (len != sizeof(ubuf1) - 1 || memcmp(ubuf1, ubuf2, len) != 0)))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRPaymentProtocolRequestViewParse() unknown fields test %d\n",
+                           __func__, i + 1);
+
+        if (! req || BRPaymentProtocolRequestViewDigest(&view, md1, sizeof(md1)) != sizeof(md1) ||
+            BRPaymentProtocolRequestDigest(req, md2, sizeof(md2)) != sizeof(md2) || memcmp(md1, md2, sizeof(md1)) != 0)
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRPaymentProtocolRequestViewDigest() unknown fields test %d\n",
+                           __func__, i + 1);
+
+        if (req) BRPaymentProtocolRequestFree(req);
+    }
+
     const char buf5[] = "\x0a\x00\x12\x5f\x54\x72\x61\x6e\x73\x61\x63\x74\x69\x6f\x6e\x20\x72\x65\x63\x65\x69\x76\x65"
     "\x64\x20\x62\x79\x20\x42\x69\x74\x50\x61\x79\x2e\x20\x49\x6e\x76\x6f\x69\x63\x65\x20\x77\x69\x6c\x6c\x20\x62\x65"
     "\x20\x6d\x61\x72\x6b\x65\x64\x20\x61\x73\x20\x70\x61\x69\x64\x20\x69\x66\x20\x74\x68\x65\x20\x74\x72\x61\x6e\x73"
@@ -3206,13 +3465,303 @@ int BRPaymentProtocolEncryptionTests()
 
 void BRPeerAcceptMessageTest(BRPeer *peer, const uint8_t *msg, size_t len, const char *type);
 
+static BRMerkleBlock *_orphanTestBlock(uint32_t hash, uint32_t prevHash)
+{
+    BRMerkleBlock *block = BRMerkleBlockNew();
+
+    block->blockHash.u32[0] = hash, block->blockHash.u32[7] = hash;
+    block->prevBlock.u32[0] = prevHash, block->prevBlock.u32[7] = prevHash;
+    return block;
+}
+
+int BROrphanPoolTests()
+{
+    int r = 1;
+    BROrphanPool pool;
+    BRMerkleBlock *b1, *b2, *b3, *b4, *dup, *b;
+    UInt256 hash = UINT256_ZERO;
+    time_t now = 1000000000;
+
+    BROrphanPoolInit(&pool);
+    b1 = _orphanTestBlock(1, 100);
+    b2 = _orphanTestBlock(2, 100); // a fork of b1
+    b3 = _orphanTestBlock(3, 1);
+    b4 = _orphanTestBlock(4, 100);
+    dup = _orphanTestBlock(1, 100);
+
+    if (! BROrphanPoolAdd(&pool, b1, now) || ! BROrphanPoolAdd(&pool, b2, now) || ! BROrphanPoolAdd(&pool, b3, now) ||
+        ! BROrphanPoolAdd(&pool, b4, now))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolAdd() test 1\n", __func__);
+
+    if (BROrphanPoolAdd(&pool, dup, now) || BRSetCount(pool.byHash) != 4) // a duplicate is not taken
+        r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolAdd() test 2\n", __func__);
+
+    // removal by block, including a fork that isn't the first with its parent
+    if (BROrphanPoolRemove(&pool, dup) || ! BROrphanPoolRemove(&pool, b2) || BROrphanPoolRemove(&pool, b2))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolRemove() test\n", __func__);
+
+    // lookup by parent finds each fork in turn
+    hash.u32[0] = 100, hash.u32[7] = 100;
+    b = BROrphanPoolTakeChild(&pool, hash);
+    if (b != b1 && b != b4) r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolTakeChild() test 1\n", __func__);
+    b = BROrphanPoolTakeChild(&pool, hash);
+    if (b != b1 && b != b4) r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolTakeChild() test 2\n", __func__);
+    if (BROrphanPoolTakeChild(&pool, hash) != NULL)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolTakeChild() test 3\n", __func__);
+
+    hash.u32[0] = 1, hash.u32[7] = 1;
+    if (BROrphanPoolTakeChild(&pool, hash) != b3 || BRSetCount(pool.byHash) != 0 || BRSetCount(pool.byPrevBlock) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolTakeChild() test 4\n", __func__);
+
+    BRMerkleBlockFree(b1), BRMerkleBlockFree(b2), BRMerkleBlockFree(b3), BRMerkleBlockFree(b4);
+
+    // the pool never holds more than ORPHANS_MAX_COUNT blocks; the oldest are evicted first
+    for (uint32_t i = 1; i <= ORPHANS_MAX_COUNT + 10; i++) {
+        BROrphanPoolAdd(&pool, _orphanTestBlock(1000 + i, 1000 + i/2), now);
+        if (BRSetCount(pool.byHash) > ORPHANS_MAX_COUNT)
+            r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolAdd() count test %"PRIu32"\n", __func__, i);
+    }
+
+    hash.u32[0] = 1001, hash.u32[7] = 1001; // the parent of the first two added, both since evicted
+    if (BRSetCount(pool.byHash) != ORPHANS_MAX_COUNT || BROrphanPoolTakeChild(&pool, hash) != NULL)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolAdd() eviction test 1\n", __func__);
+
+    hash.u32[0] = 1000 + (ORPHANS_MAX_COUNT + 10)/2, hash.u32[7] = hash.u32[0];
+    b = BROrphanPoolTakeChild(&pool, hash);
+    if (b == NULL) r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolAdd() eviction test 2\n", __func__);
+    else BRMerkleBlockFree(b);
+
+    // orphans are evicted after ORPHANS_MAX_AGE, as the next one is added
+    BROrphanPoolClear(&pool);
+    BROrphanPoolAdd(&pool, _orphanTestBlock(1, 100), now);
+    BROrphanPoolAdd(&pool, _orphanTestBlock(2, 100), now + ORPHANS_MAX_AGE/2);
+    BROrphanPoolAdd(&pool, _orphanTestBlock(3, 200), now + ORPHANS_MAX_AGE);
+    hash.u32[0] = 100, hash.u32[7] = 100;
+    b = BROrphanPoolTakeChild(&pool, hash);
+
+    if (BRSetCount(pool.byHash) != 1 || b == NULL || b->blockHash.u32[0] != 2)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BROrphanPoolAdd() eviction test 3\n", __func__);
+
+    if (b) BRMerkleBlockFree(b);
+    BRMerkleBlockFree(dup);
+    BROrphanPoolFree(&pool);
+    return r;
+}
+
+int BRTxPeerListTests()
+{
+    int r = 1;
+    UInt512 seed;
+    UInt256 secret = uint256("0000000000000000000000000000000000000000000000000000000000000001"), hash;
+    BRKey k;
+    BRAddress addr, recvAddr;
+    BRTxPeerList list;
+    BRPeer p1 = BR_PEER_NONE, p2 = BR_PEER_NONE;
+    BRTransaction *tx;
+    time_t now = 1000000000;
+
+    BRBIP39DeriveKey(&seed, "a random seed", NULL);
+    BRWallet *w = BRWalletNew(BRMainNetParams->addrParams, NULL, 0, BRBIP32MasterPubKey(&seed, sizeof(seed)));
+
+    // an unconfirmed wallet transaction
+    recvAddr = BRWalletReceiveAddress(w);
+    BRKeySetSecret(&k, &secret, 1);
+    BRKeyAddress(&k, addr.s, sizeof(addr), BRMainNetParams->addrParams);
+    uint8_t inScript[BRAddressScriptPubKey(NULL, 0, BRMainNetParams->addrParams, addr.s)];
+    size_t inScriptLen = BRAddressScriptPubKey(inScript, sizeof(inScript), BRMainNetParams->addrParams, addr.s);
+    uint8_t outScript[BRAddressScriptPubKey(NULL, 0, BRMainNetParams->addrParams, recvAddr.s)];
+    size_t outScriptLen = BRAddressScriptPubKey(outScript, sizeof(outScript), BRMainNetParams->addrParams, recvAddr.s);
+
+    tx = BRTransactionNew();
+    BRTransactionAddInput(tx, secret, 0, 1, inScript, inScriptLen, NULL, 0, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput(tx, SATOSHIS, outScript, outScriptLen);
+    BRTransactionSign(tx, 0, &k, 1);
+    BRWalletRegisterTransaction(w, tx);
+    if (BRWalletTransactionForHash(w, tx->txHash) != tx)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRWalletRegisterTransaction() test\n", __func__);
+
+    p1.port = 8333;
+    p2.port = 8334;
+    BRTxPeerListInit(&list);
+
+    // lookup by txHash
+    if (BRTxPeerListAddPeer(&list, w, tx->txHash, &p1, now) != 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() test 1\n", __func__);
+
+    if (BRTxPeerListAddPeer(&list, w, tx->txHash, &p2, now) != 2)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() test 2\n", __func__);
+
+    if (BRTxPeerListAddPeer(&list, w, tx->txHash, &p1, now) != 2) // adding the same peer twice
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() test 3\n", __func__);
+
+    for (uint32_t i = 1; i <= 1000; i++) {
+        hash = UINT256_ZERO, hash.u32[0] = i, hash.u32[7] = i;
+        BRTxPeerListAddPeer(&list, w, hash, (i % 2) ? &p1 : &p2, now);
+    }
+
+    for (uint32_t i = 1; i <= 1000; i++) {
+        hash = UINT256_ZERO, hash.u32[0] = i, hash.u32[7] = i;
+
+        if (BRTxPeerListCount(&list, hash) != 1 || ! BRTxPeerListHasPeer(&list, hash, (i % 2) ? &p1 : &p2) ||
+            BRTxPeerListHasPeer(&list, hash, (i % 2) ? &p2 : &p1))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListHasPeer() test %"PRIu32"\n", __func__, i);
+    }
+
+    hash = UINT256_ZERO, hash.u32[0] = 1; // same bucket as txHash 1, different hash
+    if (BRTxPeerListCount(&list, hash) != 0 || BRTxPeerListHasPeer(&list, hash, &p1))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListCount() test\n", __func__);
+
+    if (! BRTxPeerListRemovePeer(&list, tx->txHash, &p1) || BRTxPeerListRemovePeer(&list, tx->txHash, &p1) ||
+        BRTxPeerListCount(&list, tx->txHash) != 1 || ! BRTxPeerListHasPeer(&list, tx->txHash, &p2))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListRemovePeer() test\n", __func__);
+
+    // age-based eviction happens as a new txHash is added; an entry added to since is kept
+    hash = UINT256_ZERO, hash.u32[0] = 500, hash.u32[7] = 500;
+    BRTxPeerListAddPeer(&list, w, hash, &p1, now + TX_PEER_LIST_MAX_AGE/2);
+
+    hash = UINT256_ZERO, hash.u32[0] = 2000;
+    BRTxPeerListAddPeer(&list, w, hash, &p1, now + TX_PEER_LIST_MAX_AGE - 1);
+    if (BRSetCount(list.entries) != 1002)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() eviction test 1\n", __func__);
+
+    hash = UINT256_ZERO, hash.u32[0] = 2001;
+    BRTxPeerListAddPeer(&list, w, hash, &p1, now + TX_PEER_LIST_MAX_AGE);
+    if (BRSetCount(list.entries) != 4)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() eviction test 2\n", __func__);
+
+    hash = UINT256_ZERO, hash.u32[0] = 1, hash.u32[7] = 1;
+    if (BRTxPeerListCount(&list, hash) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() eviction test 3\n", __func__);
+
+    hash = UINT256_ZERO, hash.u32[0] = 500, hash.u32[7] = 500;
+    if (BRTxPeerListCount(&list, hash) != 2)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() eviction test 4\n", __func__);
+
+    // the unconfirmed wallet transaction is never evicted
+    if (BRTxPeerListCount(&list, tx->txHash) != 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() eviction test 5\n", __func__);
+
+    // count-based eviction keeps at most TX_PEER_LIST_MAX_COUNT txHashes before adding one more
+    for (uint32_t i = 1; i <= TX_PEER_LIST_MAX_COUNT + 100; i++) {
+        hash = UINT256_ZERO, hash.u32[0] = i, hash.u32[6] = 1;
+        BRTxPeerListAddPeer(&list, w, hash, &p1, now + TX_PEER_LIST_MAX_AGE);
+    }
+
+    if (BRSetCount(list.entries) != TX_PEER_LIST_MAX_COUNT + 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() eviction test 6\n", __func__);
+
+    hash = UINT256_ZERO, hash.u32[0] = 100, hash.u32[6] = 1;
+    if (BRTxPeerListCount(&list, hash) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() eviction test 7\n", __func__);
+
+    hash = UINT256_ZERO, hash.u32[0] = TX_PEER_LIST_MAX_COUNT + 100, hash.u32[6] = 1;
+    if (BRTxPeerListCount(&list, hash) != 1 || BRTxPeerListCount(&list, tx->txHash) != 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRTxPeerListAddPeer() eviction test 8\n", __func__);
+
+    BRTxPeerListFree(&list);
+    BRWalletFree(w);
+    return r;
+}
+
+// block 10001 filtered to include only transactions 0, 1, 2, and 6, as in BRMerkleBlockTests()
+static const char _peerTestBlock[] =
+    "\x01\x00\x00\x00\x06\xe5\x33\xfd\x1a\xda\x86\x39\x1f\x3f\x6c\x34\x32\x04\xb0\xd2\x78\xd4\xaa\xec\x1c"
+    "\x0b\x20\xaa\x27\xba\x03\x00\x00\x00\x00\x00\x6a\xbb\xb3\xeb\x3d\x73\x3a\x9f\xe1\x89\x67\xfd\x7d\x4c\x11\x7e\x4c"
+    "\xcb\xba\xc5\xbe\xc4\xd9\x10\xd9\x00\xb3\xae\x07\x93\xe7\x7f\x54\x24\x1b\x4d\x4c\x86\x04\x1b\x40\x89\xcc\x9b\x0c"
+    "\x00\x00\x00\x08\x4c\x30\xb6\x3c\xfc\xdc\x2d\x35\xe3\x32\x94\x21\xb9\x80\x5e\xf0\xc6\x56\x5d\x35\x38\x1c\xa8\x57"
+    "\x76\x2e\xa0\xb3\xa5\xa1\x28\xbb\xca\x50\x65\xff\x96\x17\xcb\xcb\xa4\x5e\xb2\x37\x26\xdf\x64\x98\xa9\xb9\xca\xfe"
+    "\xd4\xf5\x4c\xba\xb9\xd2\x27\xb0\x03\x5d\xde\xfb\xbb\x15\xac\x1d\x57\xd0\x18\x2a\xae\xe6\x1c\x74\x74\x3a\x9c\x4f"
+    "\x78\x58\x95\xe5\x63\x90\x9b\xaf\xec\x45\xc9\xa2\xb0\xff\x31\x81\xd7\x77\x06\xbe\x8b\x1d\xcc\x91\x11\x2e\xad\xa8"
+    "\x6d\x42\x4e\x2d\x0a\x89\x07\xc3\x48\x8b\x6e\x44\xfd\xa5\xa7\x4a\x25\xcb\xc7\xd6\xbb\x4f\xa0\x42\x45\xf4\xac\x8a"
+    "\x1a\x57\x1d\x55\x37\xea\xc2\x4a\xdc\xa1\x45\x4d\x65\xed\xa4\x46\x05\x54\x79\xaf\x6c\x6d\x4d\xd3\xc9\xab\x65\x84"
+    "\x48\xc1\x0b\x69\x21\xb7\xa4\xce\x30\x21\xeb\x22\xed\x6b\xb6\xa7\xfd\xe1\xe5\xbc\xc4\xb1\xdb\x66\x15\xc6\xab\xc5"
+    "\xca\x04\x21\x27\xbf\xaf\x9f\x44\xeb\xce\x29\xcb\x29\xc6\xdf\x9d\x05\xb4\x7f\x35\xb2\xed\xff\x4f\x00\x64\xb5\x78"
+    "\xab\x74\x1f\xa7\x82\x76\x22\x26\x51\x20\x9f\xe1\xa2\xc4\xc0\xfa\x1c\x58\x51\x0a\xec\x8b\x09\x0d\xd1\xeb\x1f\x82"
+    "\xf9\xd2\x61\xb8\x27\x3b\x52\x5b\x02\xff\x1a";
+
+typedef struct {
+    size_t count, hashesCount[256];
+} BRPeerTestInfo;
+
+static void _peerTestRelayedBlock(void *info, BRMerkleBlock *block)
+{
+    BRPeerTestInfo *testInfo = info;
+    
+    if (testInfo->count < sizeof(testInfo->hashesCount)/sizeof(*testInfo->hashesCount)) {
+        testInfo->hashesCount[testInfo->count] = block->hashesCount;
+    }
+    
+    testInfo->count++;
+    BRMerkleBlockFree(block);
+}
+
+// returns a peer that will accept _peerTestBlock merkleblocks without waiting for its matched tx
+static BRPeer *_peerTestNew(BRPeerTestInfo *info)
+{
+    BRPeer *p = BRPeerNew(BRMainNetParams->magicNumber);
+    BRMerkleBlock *b = BRMerkleBlockParse((const uint8_t *)_peerTestBlock, sizeof(_peerTestBlock) - 1);
+    UInt256 txHashes[BRMerkleBlockTxHashes(b, NULL, 0)];
+    
+    BRPeerSetCallbacks(p, info, NULL, NULL, NULL, NULL, NULL, NULL, _peerTestRelayedBlock, NULL, NULL, NULL, NULL,
+                       NULL);
+    BRPeerSendGetdata(p, NULL, 0, &b->blockHash, 1); // peer isn't connected, but it now expects merkleblocks
+    BRPeerSendInv(p, txHashes, BRMerkleBlockTxHashes(b, txHashes, sizeof(txHashes)/sizeof(*txHashes)));
+    BRMerkleBlockFree(b);
+    return p;
+}
+
+// serializes _peerTestBlock with only its merkle root in the partial merkle tree, as sent when no tx match the filter
+static size_t _peerTestRootOnlyBlock(uint8_t *buf, size_t bufLen, int valid)
+{
+    BRMerkleBlock *b = BRMerkleBlockParse((const uint8_t *)_peerTestBlock, sizeof(_peerTestBlock) - 1);
+    UInt256 root = b->merkleRoot;
+    uint8_t flags = 0;
+    size_t len;
+    
+    if (! valid) root.u8[0] ^= 1;
+    BRMerkleBlockSetTxHashes(b, &root, 1, &flags, 1);
+    b->hashesCount = 1, b->flagsLen = 1;
+    len = BRMerkleBlockSerialize(b, buf, bufLen);
+    BRMerkleBlockFree(b);
+    return len;
+}
+
 int BRPeerTests()
 {
     int r = 1;
     BRPeer *p = BRPeerNew(BRMainNetParams->magicNumber);
     const char msg[] = "my message";
+    const uint8_t emptyNotfound[] = { 0 };
+    uint8_t rootOnly[128], invalid[128];
+    size_t rootOnlyLen, invalidLen, i;
+    BRPeerTestInfo info;
     
     BRPeerAcceptMessageTest(p, (const uint8_t *)msg, sizeof(msg) - 1, "inv");
+    BRPeerFree(p);
+    
+    // merkleblocks are verified off the peer thread, but must still be relayed in the order received
+    memset(&info, 0, sizeof(info));
+    p = _peerTestNew(&info);
+    rootOnlyLen = _peerTestRootOnlyBlock(rootOnly, sizeof(rootOnly), 1);
+    invalidLen = _peerTestRootOnlyBlock(invalid, sizeof(invalid), 0);
+    
+    for (i = 0; i < 200; i++) {
+        if (i % 3 == 0) BRPeerAcceptMessageTest(p, rootOnly, rootOnlyLen, "merkleblock");
+        else BRPeerAcceptMessageTest(p, (const uint8_t *)_peerTestBlock, sizeof(_peerTestBlock) - 1, "merkleblock");
+    }
+    
+    BRPeerAcceptMessageTest(p, invalid, invalidLen, "merkleblock");
+    BRPeerAcceptMessageTest(p, emptyNotfound, sizeof(emptyNotfound), "notfound"); // relays all verified blocks
+    
+    if (info.count != 200)
+        r = 0, fprintf(stderr, "***FAILED*** %s: relayedBlock count test, got %zu\n", __func__, info.count);
+    
+    for (i = 0; i < info.count && i < 200; i++) {
+        if ((i % 3 == 0) != (info.hashesCount[i] == 1))
+            r = 0, fprintf(stderr, "***FAILED*** %s: relayedBlock order test %zu\n", __func__, i);
+    }
+    
+    BRPeerFree(p);
     return r;
 }
 
@@ -3268,6 +3817,10 @@ int BRRunTests()
     printf("%s\n", (BRBloomFilterTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRMerkleBlockTests...               ");
     printf("%s\n", (BRMerkleBlockTests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BROrphanPoolTests...                ");
+    printf("%s\n", (BROrphanPoolTests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BRTxPeerListTests...                ");
+    printf("%s\n", (BRTxPeerListTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRPaymentProtocolTests...           ");
     printf("%s\n", (BRPaymentProtocolTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRPaymentProtocolEncryptionTests... ");
@@ -3280,6 +3833,199 @@ int BRRunTests()
     return (fail == 0);
 }
 
+//
+// Perf Tests
+//
+static void BRBase58Bech32PerfTests(size_t count)
+{
+    uint8_t *payloads = calloc(count, 21), *programs = calloc(count, 22), *decoded = calloc(count, 42);
+    char *strs = calloc(count, 36), *addrs = calloc(count, 91);
+    const char **strPtrs = calloc(count, sizeof(char *)), **addrPtrs = calloc(count, sizeof(char *));
+    size_t *lens = calloc(count, sizeof(size_t));
+    double start;
+
+    for (size_t i = 0; i < count; i++) {
+        payloads[i*21] = BITCOIN_PUBKEY_PREFIX;
+        arc4random_buf_brd(&payloads[i*21 + 1], 20);
+        programs[i*22] = OP_0;
+        programs[i*22 + 1] = 20;
+        memcpy(&programs[i*22 + 2], &payloads[i*21 + 1], 20);
+        strPtrs[i] = &strs[i*36];
+        addrPtrs[i] = &addrs[i*91];
+    }
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++) BRBase58CheckEncode(&strs[i*36], 36, &payloads[i*21], 21);
+    printf("BRBase58CheckEncode:      %10.0f/s\n", count/(supPerfTimeNow() - start));
+
+    start = supPerfTimeNow();
+    BRBase58CheckEncodeBatch(strs, 36, payloads, 21, count);
+    printf("BRBase58CheckEncodeBatch: %10.0f/s\n", count/(supPerfTimeNow() - start));
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++) BRBase58CheckDecode(&decoded[i*42], 42, strPtrs[i]);
+    printf("BRBase58CheckDecode:      %10.0f/s\n", count/(supPerfTimeNow() - start));
+
+    start = supPerfTimeNow();
+    BRBase58CheckDecodeBatch(decoded, 42, lens, strPtrs, count);
+    printf("BRBase58CheckDecodeBatch: %10.0f/s\n", count/(supPerfTimeNow() - start));
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++) BRBech32Encode(&addrs[i*91], "bc", &programs[i*22]);
+    printf("BRBech32Encode:           %10.0f/s\n", count/(supPerfTimeNow() - start));
+
+    start = supPerfTimeNow();
+    BRBech32EncodeBatch(addrs, "bc", programs, 22, count);
+    printf("BRBech32EncodeBatch:      %10.0f/s\n", count/(supPerfTimeNow() - start));
+
+    start = supPerfTimeNow();
+    BRBech32DecodeBatch(decoded, lens, "bc", addrPtrs, count);
+    printf("BRBech32DecodeBatch:      %10.0f/s\n", count/(supPerfTimeNow() - start));
+
+    free(lens);
+    free(addrPtrs);
+    free(strPtrs);
+    free(addrs);
+    free(strs);
+    free(decoded);
+    free(programs);
+    free(payloads);
+}
+
+static void BRKeccakPerfTests(size_t count)
+{
+    const size_t lens[] = { 32, 64, 1024 };
+    uint8_t *data = calloc(count + 1024, 1), *mds = calloc(count, 32);
+    const void **ptrs = calloc(count, sizeof(void *));
+    size_t *dataLens = calloc(count, sizeof(size_t));
+    double start;
+
+    arc4random_buf_brd(data, count + 1024);
+
+    for (size_t l = 0; l < sizeof(lens)/sizeof(*lens); l++) {
+        size_t n = (lens[l] > 64) ? count/16 : count; // keep long inputs to a comparable run time
+
+        for (size_t i = 0; i < n; i++) ptrs[i] = &data[i], dataLens[i] = lens[l];
+
+        start = supPerfTimeNow();
+        for (size_t i = 0; i < n; i++) BRKeccak256(&mds[i*32], ptrs[i], lens[l]);
+        printf("BRKeccak256(%4zu):         %10.0f/s\n", lens[l], n/(supPerfTimeNow() - start));
+
+        start = supPerfTimeNow();
+        BRKeccak256Batch(mds, ptrs, dataLens, n);
+        printf("BRKeccak256Batch(%4zu):    %10.0f/s\n", lens[l], n/(supPerfTimeNow() - start));
+    }
+
+    free(dataLens);
+    free(ptrs);
+    free(mds);
+    free(data);
+}
+
+// filtered rescan throughput: merkleblock messages accepted by a peer and relayed, in order, to relayedBlock
+static void BRPeerMerkleblockPerfTests(size_t count)
+{
+    BRPeerTestInfo info;
+    BRPeer *p;
+    BRMerkleBlock *b;
+    const uint8_t emptyNotfound[] = { 0 };
+    uint8_t rootOnly[128];
+    size_t rootOnlyLen = _peerTestRootOnlyBlock(rootOnly, sizeof(rootOnly), 1), i;
+    double start;
+    
+    memset(&info, 0, sizeof(info));
+    start = supPerfTimeNow();
+    
+    for (i = 0; i < count; i++) {
+        b = BRMerkleBlockParse((const uint8_t *)_peerTestBlock, sizeof(_peerTestBlock) - 1);
+        if (BRMerkleBlockIsValid(b, (uint32_t)time(NULL))) _peerTestRelayedBlock(&info, b);
+        else BRMerkleBlockFree(b);
+    }
+    
+    printf("BRMerkleBlockParse/IsValid:          %10.0f blocks/s\n", count/(supPerfTimeNow() - start));
+    
+    for (int matched = 1; matched >= 0; matched--) {
+        memset(&info, 0, sizeof(info));
+        p = _peerTestNew(&info);
+        start = supPerfTimeNow();
+        
+        for (i = 0; i < count; i++) {
+            if (matched) BRPeerAcceptMessageTest(p, (const uint8_t *)_peerTestBlock, sizeof(_peerTestBlock) - 1,
+                                                 "merkleblock");
+            else BRPeerAcceptMessageTest(p, rootOnly, rootOnlyLen, "merkleblock");
+        }
+        
+        BRPeerAcceptMessageTest(p, emptyNotfound, sizeof(emptyNotfound), "notfound");
+        printf("BRPeer merkleblock (%s): %10.0f blocks/s, %zu relayed\n", (matched) ? "4 matched tx" : "no match    ",
+               count/(supPerfTimeNow() - start), info.count);
+        BRPeerFree(p);
+    }
+}
+
+// a 5000 output x509 payment request: parsed and hashed for verification, with and without the view, and serialized
+static void BRPaymentProtocolPerfTests(size_t count)
+{
+    const size_t outCount = 5000;
+    BRTxOutput *outputs = calloc(outCount, sizeof(*outputs));
+    uint8_t script[25] = { OP_DUP, OP_HASH160, 20 }, pkiData[36*1024], sig[256], md[32], *buf;
+    BRPaymentProtocolDetails *details;
+    BRPaymentProtocolRequest *req;
+    BRPaymentProtocolRequestView view;
+    size_t bufLen, i;
+    double start;
+
+    script[23] = OP_EQUALVERIFY, script[24] = OP_CHECKSIG;
+    arc4random_buf_brd(&script[3], 20);
+    arc4random_buf_brd(pkiData, sizeof(pkiData));
+    arc4random_buf_brd(sig, sizeof(sig));
+
+    for (i = 0; i < outCount; i++) {
+        outputs[i].amount = 100000 + i;
+        outputs[i].script = script;
+        outputs[i].scriptLen = sizeof(script);
+    }
+
+    details = BRPaymentProtocolDetailsNew("main", outputs, outCount, (uint64_t)time(NULL), 0, "perf", NULL, NULL, 0);
+    req = BRPaymentProtocolRequestNew(1, "x509+sha256", pkiData, sizeof(pkiData), details, sig, sizeof(sig));
+    bufLen = BRPaymentProtocolRequestSerialize(req, NULL, 0);
+    buf = malloc(bufLen);
+    bufLen = BRPaymentProtocolRequestSerialize(req, buf, bufLen);
+
+    start = supPerfTimeNow();
+
+    for (i = 0; i < count; i++) {
+        BRPaymentProtocolRequest *r = BRPaymentProtocolRequestParse(buf, bufLen);
+
+        BRPaymentProtocolRequestDigest(r, md, sizeof(md));
+        BRPaymentProtocolRequestFree(r);
+    }
+
+    printf("BRPaymentProtocolRequestParse/Digest (%zuKB, %zu outputs): %8.3fms\n", bufLen/1024, outCount,
+           1000*(supPerfTimeNow() - start)/count);
+    start = supPerfTimeNow();
+
+    for (i = 0; i < count; i++) {
+        if (BRPaymentProtocolRequestViewParse(&view, buf, bufLen)) BRPaymentProtocolRequestViewDigest(&view, md, sizeof(md));
+    }
+
+    printf("BRPaymentProtocolRequestViewParse/Digest:                 %8.3fms\n", 1000*(supPerfTimeNow() - start)/count);
+    start = supPerfTimeNow();
+    for (i = 0; i < count; i++) BRPaymentProtocolRequestSerialize(req, buf, bufLen);
+    printf("BRPaymentProtocolRequestSerialize:                        %8.3fms\n", 1000*(supPerfTimeNow() - start)/count);
+
+    free(buf);
+    BRPaymentProtocolRequestFree(req);
+    free(outputs);
+}
+
+void BRRunPerfTests(size_t count)
+{
+    BRBase58Bech32PerfTests(count);
+    BRKeccakPerfTests(count);
+    BRPeerMerkleblockPerfTests(count/10);
+    BRPaymentProtocolPerfTests(count/1000);
+}
+
 //
 // Rescan // Sync Test
 //
@@ -14,6 +14,7 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "BRCryptoAmount.h"
@@ -22,15 +23,22 @@
 #include "crypto/BRCryptoTransferP.h"
 #include "crypto/BRCryptoWalletManagerP.h"
 #include "crypto/BRCryptoSystemP.h"
+#include "crypto/BRCryptoKeyP.h"
+#include "crypto/BRCryptoClientP.h"
+#include "crypto/BRCryptoAccountP.h"
+#include "crypto/BRCryptoListenerP.h"
 
 #include "support/BRBIP32Sequence.h"
 #include "support/BRBIP39Mnemonic.h"
 #include "support/util/BRHex.h"
 #include "bitcoin/BRChainParams.h"
 #include "bitcoin/BRWallet.h"
+#include "ripple/BRRippleAddress.h"
 
 #include "crypto/handlers/btc/BRCryptoBTC.h"
 
+#include "test.h"
+
 #ifdef __ANDROID__
 #include <android/log.h>
 #define fprintf(...) __android_log_print(ANDROID_LOG_ERROR, "testCrypto", _va_rest(__VA_ARGS__, NULL))
@@ -308,6 +316,784 @@ runCryptoTransferTests (void) {
     transferTestsAddress();
 }
 
+///
+/// Mark: BRCryptoWalletSweeper Tests
+///
+
+static BRCryptoClientTransactionBundle
+sweeperTestsBundle (BRTransaction *tid) {
+    uint8_t serialization[BRTransactionSerialize (tid, NULL, 0)];
+    size_t  serializationCount = BRTransactionSerialize (tid, serialization, sizeof (serialization));
+
+    // The sweeper parses its own copy; the serialization's txHash is the one it will record.
+    BRTransaction *parsed = BRTransactionParse (serialization, serializationCount);
+    tid->txHash = parsed->txHash;
+    BRTransactionFree (parsed);
+
+    return cryptoClientTransactionBundleCreate (CRYPTO_TRANSFER_STATE_INCLUDED,
+                                                serialization,
+                                                serializationCount,
+                                                0,
+                                                0);
+}
+
+static uint64_t
+sweeperTestsBalance (BRCryptoWalletSweeper sweeper) {
+    BRCryptoBoolean overflow;
+    BRCryptoAmount  amount  = cryptoWalletSweeperGetBalance (sweeper);
+    uint64_t        balance = cryptoAmountGetIntegerRaw (amount, &overflow);
+
+    assert (CRYPTO_FALSE == overflow);
+    cryptoAmountGive (amount);
+    return balance;
+}
+
+static void
+runCryptoWalletSweeperTests (void) {
+    BRCryptoCurrency btc = cryptoCurrencyCreate ("BitcoinUIDS", "Bitcoin", "BTC", "native", NULL);
+    BRCryptoUnit     sat = cryptoUnitCreateAsBase (btc, "SatoshiUIDS", "Satoshi", "SAT");
+    BRAddressParams  addrParams = BRTestNetParams->addrParams;
+
+    BRCryptoSecret secret = { .data = { [31] = 1 } }, otherSecret = { .data = { [31] = 2 } };
+    BRCryptoKey key      = cryptoKeyCreateFromSecret (secret);
+    BRCryptoKey otherKey = cryptoKeyCreateFromSecret (otherSecret);
+
+    // The scriptPubKey paying to each key's legacy address
+    BRKey *keyCore = cryptoKeyGetCore (key), *otherKeyCore = cryptoKeyGetCore (otherKey);
+    char sourceAddr[75], otherAddr[75];
+    BRKeyLegacyAddr (keyCore,      sourceAddr, sizeof (sourceAddr), addrParams);
+    BRKeyLegacyAddr (otherKeyCore, otherAddr,  sizeof (otherAddr),  addrParams);
+
+    uint8_t sourceScript[25], otherScript[25];
+    size_t  sourceScriptLen = BRAddressScriptPubKey (sourceScript, sizeof (sourceScript), addrParams, sourceAddr);
+    size_t  otherScriptLen  = BRAddressScriptPubKey (otherScript,  sizeof (otherScript),  addrParams, otherAddr);
+
+    // A pay-to-pubkey-hash scriptSig, `<sig> <pubKey>`, for each key; the signature's value is
+    // irrelevant to the sweeper, only that the source's pubKey is pushed last.
+    uint8_t sourceSig[1 + 71 + 1 + 65], otherSig[1 + 71 + 1 + 65];
+    size_t  sourceSigLen, otherSigLen;
+
+    sourceSig[0] = 71; memset (&sourceSig[1], 0x30, 71);
+    sourceSig[72] = (uint8_t) BRKeyPubKey (keyCore, &sourceSig[73], 65);
+    sourceSigLen  = 73 + sourceSig[72];
+
+    otherSig[0] = 71; memset (&otherSig[1], 0x30, 71);
+    otherSig[72] = (uint8_t) BRKeyPubKey (otherKeyCore, &otherSig[73], 65);
+    otherSigLen  = 73 + otherSig[72];
+
+    // tx1: funds the source with 10000 (output 0); 5000 goes elsewhere (output 1)
+    BRTransaction *tx1 = BRTransactionNew ();
+    BRTransactionAddInput  (tx1, UINT256_ZERO, 0, 0, NULL, 0, otherSig, otherSigLen, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput (tx1, 10000, sourceScript, sourceScriptLen);
+    BRTransactionAddOutput (tx1,  5000, otherScript,  otherScriptLen);
+    BRCryptoClientTransactionBundle bundle1 = sweeperTestsBundle (tx1);
+
+    // tx2: the source spends tx1:0, returning 3000 to itself; the other key spends tx1:1
+    BRTransaction *tx2 = BRTransactionNew ();
+    BRTransactionAddInput  (tx2, tx1->txHash, 0, 0, NULL, 0, sourceSig, sourceSigLen, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddInput  (tx2, tx1->txHash, 1, 0, NULL, 0, otherSig,  otherSigLen,  NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput (tx2, 3000, sourceScript, sourceScriptLen);
+    BRTransactionAddOutput (tx2, 6000, otherScript,  otherScriptLen);
+    BRCryptoClientTransactionBundle bundle2 = sweeperTestsBundle (tx2);
+
+    // tx3: the other key spends tx2:0 with its own pubKey, which must not match the source
+    BRTransaction *tx3 = BRTransactionNew ();
+    BRTransactionAddInput  (tx3, tx2->txHash, 0, 0, NULL, 0, otherSig, otherSigLen, NULL, 0, TXIN_SEQUENCE);
+    BRTransactionAddOutput (tx3, 2000, otherScript, otherScriptLen);
+    BRCryptoClientTransactionBundle bundle3 = sweeperTestsBundle (tx3);
+
+    // In order: the UTXO set is maintained as each transaction is added
+    BRCryptoWalletSweeper sweeper = cryptoWalletSweeperCreateAsBTC (CRYPTO_NETWORK_TYPE_BTC, key, sat, addrParams, CRYPTO_FALSE);
+    assert (CRYPTO_WALLET_SWEEPER_NO_TRANSFERS_FOUND == cryptoWalletSweeperValidate (sweeper));
+
+    assert (CRYPTO_WALLET_SWEEPER_SUCCESS == cryptoWalletSweeperAddTransactionFromBundle (sweeper, bundle1));
+    assert (10000 == sweeperTestsBalance (sweeper));
+    assert (CRYPTO_WALLET_SWEEPER_SUCCESS == cryptoWalletSweeperValidate (sweeper));
+
+    assert (CRYPTO_WALLET_SWEEPER_SUCCESS == cryptoWalletSweeperAddTransactionFromBundle (sweeper, bundle2));
+    assert (3000 == sweeperTestsBalance (sweeper));
+
+    assert (CRYPTO_WALLET_SWEEPER_SUCCESS == cryptoWalletSweeperAddTransactionFromBundle (sweeper, bundle3));
+    assert (3000 == sweeperTestsBalance (sweeper));
+
+    // A duplicate neither adds a UTXO nor resurrects a spent one
+    assert (CRYPTO_WALLET_SWEEPER_SUCCESS == cryptoWalletSweeperAddTransactionFromBundle (sweeper, bundle1));
+    assert (3000 == sweeperTestsBalance (sweeper));
+    cryptoWalletSweeperRelease (sweeper);
+
+    // Out of order: the spend arrives before the output it spends
+    sweeper = cryptoWalletSweeperCreateAsBTC (CRYPTO_NETWORK_TYPE_BTC, key, sat, addrParams, CRYPTO_FALSE);
+    assert (CRYPTO_WALLET_SWEEPER_SUCCESS == cryptoWalletSweeperAddTransactionFromBundle (sweeper, bundle2));
+    assert (3000 == sweeperTestsBalance (sweeper));
+    assert (CRYPTO_WALLET_SWEEPER_SUCCESS == cryptoWalletSweeperAddTransactionFromBundle (sweeper, bundle1));
+    assert (3000 == sweeperTestsBalance (sweeper));
+    cryptoWalletSweeperRelease (sweeper);
+
+    // Only spent: nothing remains to sweep
+    sweeper = cryptoWalletSweeperCreateAsBTC (CRYPTO_NETWORK_TYPE_BTC, key, sat, addrParams, CRYPTO_FALSE);
+    assert (CRYPTO_WALLET_SWEEPER_SUCCESS == cryptoWalletSweeperAddTransactionFromBundle (sweeper, bundle3));
+    assert (0 == sweeperTestsBalance (sweeper));
+    assert (CRYPTO_WALLET_SWEEPER_INSUFFICIENT_FUNDS == cryptoWalletSweeperValidate (sweeper));
+    cryptoWalletSweeperRelease (sweeper);
+
+    cryptoClientTransactionBundleRelease (bundle3);
+    cryptoClientTransactionBundleRelease (bundle2);
+    cryptoClientTransactionBundleRelease (bundle1);
+    BRTransactionFree (tx3);
+    BRTransactionFree (tx2);
+    BRTransactionFree (tx1);
+    cryptoKeyGive (otherKey);
+    cryptoKeyGive (key);
+    cryptoUnitGive (sat);
+    cryptoCurrencyGive (btc);
+}
+
+///
+/// Mark: BRCryptoClient Tests
+///
+
+static void
+clientTestsTransactionBundlesSort (void) {
+    // Heights out of order with ties; the tag (the one-byte serialization) records the given order
+    uint64_t heights[] = { 5, 3, 5, 1, 3, 5, 0, 1 };
+    size_t   count     = sizeof (heights) / sizeof (heights[0]);
+
+    BRCryptoClientTransactionBundle bundles[count];
+    for (uint8_t tag = 0; tag < count; tag++)
+        bundles[tag] = cryptoClientTransactionBundleCreate (CRYPTO_TRANSFER_STATE_INCLUDED, &tag, 1, 0, heights[tag]);
+
+    cryptoClientTransactionBundlesSort (bundles, count);
+
+    // Lowest block first and, within a block, in the given order
+    for (size_t index = 1; index < count; index++) {
+        assert (bundles[index - 1]->blockHeight <= bundles[index]->blockHeight);
+        if (bundles[index - 1]->blockHeight == bundles[index]->blockHeight)
+            assert (bundles[index - 1]->serialization[0] < bundles[index]->serialization[0]);
+    }
+    assert (0 == bundles[0]->blockHeight && 5 == bundles[count - 1]->blockHeight);
+
+    for (size_t index = 0; index < count; index++)
+        cryptoClientTransactionBundleRelease (bundles[index]);
+}
+
+static void
+clientTestsTransferBundlesSort (void) {
+    // Block number, then the index in the block; the uids record the given order
+    uint64_t numbers[] = { 9, 7, 9, 7, 9, 8 };
+    uint64_t indices[] = { 2, 0, 1, 0, 1, 4 };
+    size_t   count     = sizeof (numbers) / sizeof (numbers[0]);
+
+    BRCryptoClientTransferBundle bundles[count];
+    for (size_t tag = 0; tag < count; tag++) {
+        char uids[2] = { (char) ('a' + tag), '\0' };
+        bundles[tag] = cryptoClientTransferBundleCreate (CRYPTO_TRANSFER_STATE_INCLUDED,
+                                                         "0x00", uids, "0x01", "0x02",
+                                                         "1", "eth", "0",
+                                                         0, numbers[tag], 1, indices[tag], "0x03",
+                                                         0, NULL, NULL);
+    }
+
+    cryptoClientTransferBundlesSort (bundles, count);
+
+    const char *expected[] = { "b", "d", "f", "c", "e", "a" };
+    for (size_t index = 0; index < count; index++)
+        assert (0 == strcmp (expected[index], bundles[index]->uids));
+
+    for (size_t index = 0; index < count; index++)
+        cryptoClientTransferBundleRelease (bundles[index]);
+}
+
+static void
+clientTestsParseBundlesBTC (void) {
+    // Enough bundles for every parse thread to get a slice; one is unparsable
+    size_t count = 2048, junk = 1000;
+
+    uint8_t sig[72], script[25] = { 0x76, 0xa9, 20, [23] = 0x88, [24] = 0xac };
+    memset (sig, 0x30, sizeof (sig));
+
+    BRCryptoClientTransactionBundle bundles[count];
+    for (size_t index = 0; index < count; index++) {
+        if (junk == index) {
+            uint8_t bytes[3] = { 1, 2, 3 };
+            bundles[index] = cryptoClientTransactionBundleCreate (CRYPTO_TRANSFER_STATE_INCLUDED, bytes, sizeof (bytes), 0, index);
+            continue;
+        }
+
+        UInt256 prevHash = UINT256_ZERO;
+        UInt32SetLE (prevHash.u8, (uint32_t) index + 1);
+
+        BRTransaction *tid = BRTransactionNew ();
+        BRTransactionAddInput  (tid, prevHash, 0, 0, NULL, 0, sig, sizeof (sig), NULL, 0, TXIN_SEQUENCE);
+        BRTransactionAddOutput (tid, 1000 + index, script, sizeof (script));
+
+        uint8_t serialization[BRTransactionSerialize (tid, NULL, 0)];
+        size_t  serializationCount = BRTransactionSerialize (tid, serialization, sizeof (serialization));
+        bundles[index] = cryptoClientTransactionBundleCreate (CRYPTO_TRANSFER_STATE_INCLUDED, serialization, serializationCount, 0, index);
+        BRTransactionFree (tid);
+    }
+
+    BRTransaction *parallel[count];
+    cryptoWalletManagerParseBundlesBTC (bundles, count, parallel);
+
+    // Parallel parsing gives, per index, exactly what serial parsing does
+    for (size_t index = 0; index < count; index++) {
+        BRTransaction *serial = BRTransactionParse (bundles[index]->serialization, bundles[index]->serializationCount);
+
+        assert ((NULL == serial) == (junk == index));
+        assert ((NULL == serial) == (NULL == parallel[index]));
+
+        if (NULL != serial) {
+            assert (UInt256Eq (serial->txHash, parallel[index]->txHash));
+            assert (serial->outputs[0].amount == parallel[index]->outputs[0].amount);
+            BRTransactionFree (serial);
+            BRTransactionFree (parallel[index]);
+        }
+    }
+
+    for (size_t index = 0; index < count; index++)
+        cryptoClientTransactionBundleRelease (bundles[index]);
+}
+
+static void
+clientTestsParseIntegers (void) {
+    // Digit strings, parsed directly
+    assert (0                    == cryptoClientTransferBundleParseUInt64 ("0"));
+    assert (1234567890           == cryptoClientTransferBundleParseUInt64 ("1234567890"));
+    assert (9999999999999999999u == cryptoClientTransferBundleParseUInt64 ("9999999999999999999"));
+    assert (999999999999999999   == cryptoClientTransferBundleParseInt64  ("999999999999999999"));
+
+    // Empty, missing and garbage fields are zero
+    assert (0 == cryptoClientTransferBundleParseUInt64 (NULL));
+    assert (0 == cryptoClientTransferBundleParseUInt64 (""));
+    assert (0 == cryptoClientTransferBundleParseUInt64 ("abc"));
+    assert (0 == cryptoClientTransferBundleParseInt64  (NULL));
+    assert (0 == cryptoClientTransferBundleParseInt64  (""));
+    assert (0 == cryptoClientTransferBundleParseInt64  ("abc"));
+
+    // Trailing garbage stops the parse, as sscanf() does
+    assert (12 == cryptoClientTransferBundleParseUInt64 ("12abc"));
+    assert (12 == cryptoClientTransferBundleParseInt64  ("12 "));
+
+    // Signs
+    assert (-42 == cryptoClientTransferBundleParseInt64  ("-42"));
+    assert ( 42 == cryptoClientTransferBundleParseInt64  ("+42"));
+    assert ( 42 == cryptoClientTransferBundleParseUInt64 ("+42"));
+    assert (INT64_MIN == cryptoClientTransferBundleParseInt64 ("-9223372036854775808"));
+
+    // The largest values; one more overflows and saturates
+    assert (UINT64_MAX == cryptoClientTransferBundleParseUInt64 ("18446744073709551615"));
+    assert (INT64_MAX  == cryptoClientTransferBundleParseInt64  ("9223372036854775807"));
+    assert (UINT64_MAX == cryptoClientTransferBundleParseUInt64 ("18446744073709551616"));
+    assert (INT64_MAX  == cryptoClientTransferBundleParseInt64  ("9223372036854775808"));
+    assert (INT64_MIN  == cryptoClientTransferBundleParseInt64  ("-9223372036854775809"));
+
+    // "%i" reads a leading '0' as octal and "0x" as hex; "%u" does neither
+    assert (8  == cryptoClientTransferBundleParseInt64  ("010"));
+    assert (16 == cryptoClientTransferBundleParseInt64  ("0x10"));
+    assert (10 == cryptoClientTransferBundleParseUInt64 ("010"));
+
+    // Whatever the field, the same value as the sscanf() the handlers used before
+    const char *fields[] = {
+        "0", "7", "00", "0009", "123456789012345678", "1234567890123456789", "12345678901234567890",
+        "99999999999999999999999", "-1", "-0", "+", "-", " 5", "5 ", "1e3", "0x", "08", "0b1", ""
+    };
+    for (size_t index = 0; index < sizeof (fields) / sizeof (fields[0]); index++) {
+        uint64_t u = 0;
+        int64_t  i = 0;
+        sscanf (fields[index], "%" PRIu64, &u);
+        sscanf (fields[index], "%" PRIi64, &i);
+        assert (u == cryptoClientTransferBundleParseUInt64 (fields[index]));
+        assert (i == cryptoClientTransferBundleParseInt64  (fields[index]));
+    }
+}
+
+static void
+runCryptoClientTests (void) {
+    clientTestsTransactionBundlesSort ();
+    clientTestsTransferBundlesSort ();
+    clientTestsParseBundlesBTC ();
+    clientTestsParseIntegers ();
+}
+
+///
+/// Mark: BRCryptoWalletManager Address Intern Tests
+///
+
+static size_t addressInternTestsDecodeCount = 0;
+
+static void *
+addressInternTestsDecode (const char *string) {
+    addressInternTestsDecodeCount++;
+    return rippleAddressCreateFromString (string, false);
+}
+
+static void *
+addressInternTestsClone (const void *address) {
+    return rippleAddressClone ((BRRippleAddress) address);
+}
+
+static void
+addressInternTestsRelease (void *address) {
+    rippleAddressFree ((BRRippleAddress) address);
+}
+
+static const BRCryptoAddressInternHandlers addressInternTestsHandlers = {
+    addressInternTestsDecode,
+    addressInternTestsClone,
+    addressInternTestsRelease
+};
+
+// A distinct, valid address string for each `tag`
+static char *
+addressInternTestsString (size_t tag) {
+    uint8_t bytes[20];
+    memset (bytes, 0x5a, sizeof (bytes));
+    bytes[0] = (uint8_t) tag;
+    bytes[1] = (uint8_t) (tag >> 8);
+
+    BRRippleAddress address = rippleAddressCreateFromBytes (bytes, sizeof (bytes));
+    char *string = rippleAddressAsString (address);
+    rippleAddressFree (address);
+    return string;
+}
+
+// Decode `string` through `intern`; check that the result equals a direct decode and whether the
+// intern had to decode it itself.
+static void
+addressInternTestsCheck (BRCryptoAddressIntern *intern, const char *string, bool expectHit) {
+    size_t decodeCount = addressInternTestsDecodeCount;
+
+    BRRippleAddress address = cryptoAddressInternDecode (intern, string, &addressInternTestsHandlers);
+    assert (expectHit == (decodeCount == addressInternTestsDecodeCount));
+
+    BRRippleAddress expected = rippleAddressCreateFromString (string, false);
+    assert (NULL != address && 1 == rippleAddressEqual (expected, address));
+
+    // The caller owns a clone; freeing it leaves the interned address alone
+    rippleAddressFree (address);
+    rippleAddressFree (expected);
+}
+
+static void
+runCryptoAddressInternTests (void) {
+    const size_t capacity = CRYPTO_WALLET_MANAGER_ADDRESS_INTERN_CAPACITY;
+
+    BRCryptoAddressIntern intern;
+    cryptoAddressInternInit (&intern);
+
+    char *strings[capacity + 1];
+    for (size_t index = 0; index <= capacity; index++)
+        strings[index] = addressInternTestsString (index);
+
+    // Decoded once, then hits that return an equal address
+    addressInternTestsCheck (&intern, strings[0], false);
+    addressInternTestsCheck (&intern, strings[0], true);
+    addressInternTestsCheck (&intern, strings[0], true);
+
+    // A string that does not decode returns NULL and is not interned
+    size_t decodeCount = addressInternTestsDecodeCount;
+    assert (NULL == cryptoAddressInternDecode (&intern, "rNotAnAddress", &addressInternTestsHandlers));
+    assert (NULL == cryptoAddressInternDecode (&intern, "rNotAnAddress", &addressInternTestsHandlers));
+    assert (decodeCount + 2 == addressInternTestsDecodeCount);
+
+    // Fill the ring; everything is still a hit
+    for (size_t index = 1; index < capacity; index++)
+        addressInternTestsCheck (&intern, strings[index], false);
+    for (size_t index = 0; index < capacity; index++)
+        addressInternTestsCheck (&intern, strings[index], true);
+
+    // One more replaces the oldest entry, strings[0], and only that one
+    addressInternTestsCheck (&intern, strings[capacity], false);
+    for (size_t index = 1; index <= capacity; index++)
+        addressInternTestsCheck (&intern, strings[index], true);
+
+    // The evicted string decodes again, replacing strings[1]; the address is still equal
+    addressInternTestsCheck (&intern, strings[0], false);
+    addressInternTestsCheck (&intern, strings[0], true);
+    addressInternTestsCheck (&intern, strings[1], false);
+
+    cryptoAddressInternRelease (&intern);
+
+    for (size_t index = 0; index <= capacity; index++)
+        free (strings[index]);
+}
+
+///
+/// Mark: BRCryptoListener Tests
+///
+
+typedef struct {
+    char kind;      // 'B'egin and 'E'nd of a batch, 'W'allet or 'T'ransfer event
+    int type;
+    int64_t value;  // batch count; balance; transfer `old` state
+    int64_t value2; // transfer `new` state
+} ListenerTestRecord;
+
+typedef struct {
+    pthread_mutex_t lock;
+    BRArrayOf(ListenerTestRecord) records;
+} ListenerTestState;
+
+static void
+listenerTestsRecord (ListenerTestState *state, ListenerTestRecord record) {
+    pthread_mutex_lock (&state->lock);
+    array_add (state->records, record);
+    pthread_mutex_unlock (&state->lock);
+}
+
+static void
+listenerTestsBatchCallback (BRCryptoListenerContext context,
+                            BRCryptoBoolean begin,
+                            size_t eventsCount) {
+    listenerTestsRecord (context, (ListenerTestRecord) { (begin ? 'B' : 'E'), 0, (int64_t) eventsCount, 0 });
+}
+
+static void
+listenerTestsSystemCallback (BRCryptoListenerContext context,
+                             BRCryptoSystem system,
+                             BRCryptoSystemEvent event) {
+    cryptoSystemGive (system);
+}
+
+static void
+listenerTestsNetworkCallback (BRCryptoListenerContext context,
+                              BRCryptoNetwork network,
+                              BRCryptoNetworkEvent event) {
+    cryptoNetworkGive (network);
+}
+
+static void
+listenerTestsManagerCallback (BRCryptoListenerContext context,
+                              BRCryptoWalletManager manager,
+                              BRCryptoWalletManagerEvent event) {
+    cryptoWalletManagerGive (manager);
+}
+
+static void
+listenerTestsWalletCallback (BRCryptoListenerContext context,
+                             BRCryptoWalletManager manager,
+                             BRCryptoWallet wallet,
+                             BRCryptoWalletEvent event) {
+    BRCryptoBoolean overflow;
+    int64_t value = 0;
+
+    if (CRYPTO_WALLET_EVENT_BALANCE_UPDATED == event.type) {
+        value = (int64_t) cryptoAmountGetIntegerRaw (event.u.balanceUpdated.amount, &overflow);
+        cryptoAmountGive (event.u.balanceUpdated.amount);
+    }
+
+    if (CRYPTO_WALLET_EVENT_TRANSFER_ADDED   == event.type ||
+        CRYPTO_WALLET_EVENT_TRANSFER_DELETED == event.type)
+        cryptoTransferGive (event.u.transfer);
+
+    listenerTestsRecord (context, (ListenerTestRecord) { 'W', event.type, value, 0 });
+    cryptoWalletGive (wallet);
+    cryptoWalletManagerGive (manager);
+}
+
+static void
+listenerTestsTransferCallback (BRCryptoListenerContext context,
+                               BRCryptoWalletManager manager,
+                               BRCryptoWallet wallet,
+                               BRCryptoTransfer transfer,
+                               BRCryptoTransferEvent event) {
+    int64_t oldType = 0, newType = 0;
+
+    if (CRYPTO_TRANSFER_EVENT_CHANGED == event.type) {
+        oldType = event.u.state.old.type;
+        newType = event.u.state.new.type;
+        cryptoTransferStateRelease (&event.u.state.old);
+        cryptoTransferStateRelease (&event.u.state.new);
+    }
+
+    listenerTestsRecord (context, (ListenerTestRecord) { 'T', event.type, oldType, newType });
+    cryptoTransferGive (transfer);
+    cryptoWalletGive (wallet);
+    cryptoWalletManagerGive (manager);
+}
+
+static void
+listenerTestsGenerateChanged (BRCryptoTransfer transfer,
+                              BRCryptoTransferStateType oldType,
+                              BRCryptoTransferStateType newType) {
+    cryptoTransferGenerateEvent (transfer, (BRCryptoTransferEvent) {
+        CRYPTO_TRANSFER_EVENT_CHANGED,
+        { .state = { cryptoTransferStateInit (oldType), cryptoTransferStateInit (newType) }}
+    });
+}
+
+static void
+listenerTestsGenerateBalance (BRCryptoWallet wallet,
+                              BRCryptoUnit unit,
+                              int64_t balance) {
+    cryptoWalletGenerateEvent (wallet, (BRCryptoWalletEvent) {
+        CRYPTO_WALLET_EVENT_BALANCE_UPDATED,
+        { .balanceUpdated = { cryptoAmountCreateInteger (balance, unit) }}
+    });
+}
+
+static void
+listenerTestsGenerateWalletTransfer (BRCryptoWallet wallet,
+                                     BRCryptoTransfer transfer,
+                                     BRCryptoWalletEventType type) {
+    cryptoWalletGenerateEvent (wallet, (BRCryptoWalletEvent) {
+        type,
+        { .transfer = cryptoTransferTake (transfer) }
+    });
+}
+
+static void
+listenerTestsWait (ListenerTestState *state,
+                   ListenerTestRecord *expected,
+                   size_t expectedCount) {
+    for (size_t tries = 0; tries < 500; tries++) {
+        pthread_mutex_lock (&state->lock);
+        size_t count = array_count (state->records);
+        pthread_mutex_unlock (&state->lock);
+        if (count >= expectedCount) break;
+        usleep (10 * 1000);
+    }
+
+    pthread_mutex_lock (&state->lock);
+    assert (expectedCount == array_count (state->records));
+    for (size_t index = 0; index < expectedCount; index++) {
+        assert (expected[index].kind   == state->records[index].kind);
+        assert (expected[index].type   == state->records[index].type);
+        assert (expected[index].value  == state->records[index].value);
+        assert (expected[index].value2 == state->records[index].value2);
+    }
+    array_clear (state->records);
+    pthread_mutex_unlock (&state->lock);
+}
+
+static void
+listenerTestsCoalesce (void) {
+    ListenerTestState state;
+    pthread_mutex_init (&state.lock, NULL);
+    array_new (state.records, 10);
+
+    BRCryptoListener listener = cryptoListenerCreate (&state,
+                                                      listenerTestsSystemCallback,
+                                                      listenerTestsNetworkCallback,
+                                                      listenerTestsManagerCallback,
+                                                      listenerTestsWalletCallback,
+                                                      listenerTestsTransferCallback);
+
+    // Flush once six events are pending; the window is never reached.
+    cryptoListenerSetCoalescing (listener, 60 * 1000, 6, listenerTestsBatchCallback);
+
+    BRCryptoCurrency btc = cryptoCurrencyCreate ("BitcoinUIDS", "Bitcoin", "BTC", "native", NULL);
+    BRCryptoUnit     sat = cryptoUnitCreateAsBase (btc, "SatoshiUIDS", "Satoshi", "SAT");
+
+    BRWallet *wid = BRWalletNew (BRTestNetParams->addrParams, NULL, 0, transferTestsGetMPK());
+    BRWalletSetCallbacks (wid, NULL, NULL, NULL, NULL, NULL);
+
+    size_t   rawSize;
+    uint8_t *rawBytes = hexDecodeCreate (&rawSize, transferTests[0].rawChars, strlen (transferTests[0].rawChars));
+    BRTransaction *tid = BRTransactionParse (rawBytes, rawSize);
+    free (rawBytes);
+
+    // The listener isn't started; every event is held until it is.
+    BRCryptoWalletListener walletListener = { listener, NULL, NULL, NULL };
+    BRCryptoWallet   wallet   = cryptoWalletCreateAsBTC (CRYPTO_NETWORK_TYPE_BTC, walletListener, sat, sat, wid);
+    BRCryptoTransfer transfer = cryptoTransferCreateAsBTC (cryptoListenerCreateTransferListener (&walletListener, wallet, NULL),
+                                                           sat, sat, wid, tid, CRYPTO_NETWORK_TYPE_BTC);
+
+    listenerTestsGenerateChanged (transfer, CRYPTO_TRANSFER_STATE_CREATED,   CRYPTO_TRANSFER_STATE_SIGNED);
+    listenerTestsGenerateBalance (wallet, sat, 1);
+    listenerTestsGenerateChanged (transfer, CRYPTO_TRANSFER_STATE_SIGNED,    CRYPTO_TRANSFER_STATE_SUBMITTED);
+    listenerTestsGenerateBalance (wallet, sat, 2);
+    cryptoTransferGenerateEvent  (transfer, (BRCryptoTransferEvent) { CRYPTO_TRANSFER_EVENT_DELETED });
+    listenerTestsGenerateChanged (transfer, CRYPTO_TRANSFER_STATE_SUBMITTED, CRYPTO_TRANSFER_STATE_DELETED);
+
+    ListenerTestRecord expected[] = {
+        { 'B', 0, 6, 0 },
+        { 'W', CRYPTO_WALLET_EVENT_CREATED,         0, 0 },
+        { 'T', CRYPTO_TRANSFER_EVENT_CREATED,       0, 0 },
+        // Both CHANGED events merged, in the place of the last: first `old` and last `new`.
+        { 'T', CRYPTO_TRANSFER_EVENT_CHANGED,       CRYPTO_TRANSFER_STATE_CREATED, CRYPTO_TRANSFER_STATE_SUBMITTED },
+        // The latest balance wins, in the place of the last
+        { 'W', CRYPTO_WALLET_EVENT_BALANCE_UPDATED, 2, 0 },
+        { 'T', CRYPTO_TRANSFER_EVENT_DELETED,       0, 0 },
+        // No merge across DELETED
+        { 'T', CRYPTO_TRANSFER_EVENT_CHANGED,       CRYPTO_TRANSFER_STATE_SUBMITTED, CRYPTO_TRANSFER_STATE_DELETED },
+        { 'E', 0, 6, 0 }
+    };
+    size_t expectedCount = sizeof (expected) / sizeof (expected[0]);
+
+    cryptoListenerStart (listener);
+    listenerTestsWait (&state, expected, expectedCount);
+
+    // Stopped, a full batch signals a flush that the stopped handler can't run.  Stopping again
+    // discards the held events, giving their references, along with the flush.
+    cryptoListenerStop (listener);
+    for (size_t index = 0; index < 6; index++)
+        listenerTestsGenerateWalletTransfer (wallet, transfer, CRYPTO_WALLET_EVENT_TRANSFER_ADDED);
+    assert (6 == array_count (listener->pending) && listener->coalesceFlushSignaled);
+
+    cryptoListenerStop (listener);
+    assert (0 == array_count (listener->pending) && !listener->coalesceFlushSignaled);
+
+    // Restarted, a batch is flushed again.  The latest balance follows the transfer added after
+    // the first balance.
+    cryptoListenerSetCoalescing (listener, 60 * 1000, 3, listenerTestsBatchCallback);
+    cryptoListenerStart (listener);
+
+    listenerTestsGenerateBalance        (wallet, sat, 3);
+    listenerTestsGenerateWalletTransfer (wallet, transfer, CRYPTO_WALLET_EVENT_TRANSFER_ADDED);
+    listenerTestsGenerateBalance        (wallet, sat, 4);
+    listenerTestsGenerateWalletTransfer (wallet, transfer, CRYPTO_WALLET_EVENT_TRANSFER_DELETED);
+
+    ListenerTestRecord expectedRestarted[] = {
+        { 'B', 0, 3, 0 },
+        { 'W', CRYPTO_WALLET_EVENT_TRANSFER_ADDED,   0, 0 },
+        { 'W', CRYPTO_WALLET_EVENT_BALANCE_UPDATED,  4, 0 },
+        { 'W', CRYPTO_WALLET_EVENT_TRANSFER_DELETED, 0, 0 },
+        { 'E', 0, 3, 0 }
+    };
+    listenerTestsWait (&state, expectedRestarted, sizeof (expectedRestarted) / sizeof (expectedRestarted[0]));
+
+    // Left pending at stop, these events give their references then.
+    listenerTestsGenerateChanged (transfer, CRYPTO_TRANSFER_STATE_DELETED, CRYPTO_TRANSFER_STATE_DELETED);
+    listenerTestsGenerateBalance (wallet, sat, 3);
+
+    cryptoTransferGive (transfer);
+    cryptoWalletGive (wallet);
+    cryptoListenerStop (listener);
+    cryptoListenerGive (listener);
+
+    BRWalletFree (wid);
+    cryptoUnitGive (sat);
+    cryptoCurrencyGive (btc);
+    array_free (state.records);
+    pthread_mutex_destroy (&state.lock);
+}
+
+static void
+runCryptoListenerTests (void) {
+    listenerTestsCoalesce ();
+}
+
+///
+/// Mark: BRCryptoNetwork Tests
+///
+
+static void
+networkTestsAddCurrency (BRCryptoNetwork network,
+                         BRCryptoCurrency currency,
+                         const char *baseCode) {
+    BRCryptoUnit base = cryptoUnitCreateAsBase (currency, baseCode, baseCode, baseCode);
+    cryptoNetworkAddCurrency (network, currency, base, base);
+    cryptoUnitGive (base);
+}
+
+// The currency `network` returns for `code`, `uids` or `issuer` - the first not NULL - is `expected`
+static void
+networkTestsCheckLookup (BRCryptoNetwork network,
+                         const char *code,
+                         const char *uids,
+                         const char *issuer,
+                         BRCryptoCurrency expected) {
+    BRCryptoCurrency currency = (NULL != code ? cryptoNetworkGetCurrencyForCode   (network, code)
+                                 : (NULL != uids ? cryptoNetworkGetCurrencyForUids   (network, uids)
+                                    : cryptoNetworkGetCurrencyForIssuer (network, issuer)));
+    assert (expected == currency);
+    if (NULL != currency) cryptoCurrencyGive (currency);
+}
+
+static void
+networkTestsCurrencyLookup (void) {
+    ListenerTestState state;
+    pthread_mutex_init (&state.lock, NULL);
+    array_new (state.records, 1);
+
+    BRCryptoListener listener = cryptoListenerCreate (&state,
+                                                      listenerTestsSystemCallback,
+                                                      listenerTestsNetworkCallback,
+                                                      listenerTestsManagerCallback,
+                                                      listenerTestsWalletCallback,
+                                                      listenerTestsTransferCallback);
+    cryptoListenerStart (listener);
+
+    size_t networksCount = 0;
+    BRCryptoNetwork *networks = cryptoNetworkInstallBuiltins (&networksCount,
+                                                              cryptoListenerCreateNetworkListener (listener, NULL),
+                                                              true);
+    BRCryptoNetwork network = NULL;
+    for (size_t index = 0; index < networksCount; index++) {
+        if (NULL == network && 0 == strcmp ("ethereum-mainnet", networks[index]->uids))
+            network = cryptoNetworkTake (networks[index]);
+        cryptoNetworkGive (networks[index]);
+    }
+    free (networks);
+    assert (NULL != network);
+
+    size_t currencyCount = cryptoNetworkGetCurrencyCount (network);
+
+    // The builtin currencies are indexed; uids lookups ignore case
+    BRCryptoCurrency eth = cryptoNetworkGetCurrency (network);
+    networkTestsCheckLookup (network, NULL, "ethereum-mainnet:__native__", NULL, eth);
+    networkTestsCheckLookup (network, NULL, "Ethereum-Mainnet:__NATIVE__", NULL, eth);
+    networkTestsCheckLookup (network, "eth", NULL, NULL, eth);
+    networkTestsCheckLookup (network, "ETH", NULL, NULL, NULL);   // codes are case-sensitive
+    networkTestsCheckLookup (network, NULL, "ethereum-mainnet:0xnone", NULL, NULL);
+
+    // An issuer, unknown until its association is added; issuer lookups ignore case
+    const char *issuer = "0x00000000000000000000000000000000000a11ce";
+    networkTestsCheckLookup (network, NULL, NULL, issuer, NULL);
+
+    BRCryptoCurrency alice = cryptoCurrencyCreate ("ethereum-mainnet:0x00000000000000000000000000000000000a11ce",
+                                                   "Alice", "tst", "erc20", issuer);
+    networkTestsAddCurrency (network, alice, "tst-base");
+
+    networkTestsCheckLookup (network, NULL, NULL, issuer, alice);
+    networkTestsCheckLookup (network, NULL, NULL, "0x00000000000000000000000000000000000A11CE", alice);
+    networkTestsCheckLookup (network, NULL, "ETHEREUM-MAINNET:0x00000000000000000000000000000000000A11CE", NULL, alice);
+    networkTestsCheckLookup (network, "tst", NULL, NULL, alice);
+
+    // A repeated code, and a uids differing only in case: the first association keeps the key
+    BRCryptoCurrency bob = cryptoCurrencyCreate ("ethereum-mainnet:0x00000000000000000000000000000000000A11CE",
+                                                 "Bob", "tst", "erc20", NULL);
+    networkTestsAddCurrency (network, bob, "bob-base");
+
+    networkTestsCheckLookup (network, "tst", NULL, NULL, alice);
+    networkTestsCheckLookup (network, NULL, "ethereum-mainnet:0x00000000000000000000000000000000000A11CE", NULL, alice);
+    assert (currencyCount + 2 == cryptoNetworkGetCurrencyCount (network));
+
+    // Yet each still finds its own association
+    assert (CRYPTO_TRUE == cryptoNetworkHasCurrency (network, alice));
+    assert (CRYPTO_TRUE == cryptoNetworkHasCurrency (network, bob));
+
+    BRCryptoUnit unit = cryptoNetworkGetUnitAsBase (network, bob);
+    assert (0 == strcmp ("bob-base", cryptoUnitGetName (unit)));
+    cryptoUnitGive (unit);
+
+    unit = cryptoNetworkGetUnitAsDefault (network, alice);
+    assert (0 == strcmp ("tst-base", cryptoUnitGetName (unit)));
+    cryptoUnitGive (unit);
+
+    // A currency never added is not found, even with a known code
+    BRCryptoCurrency carol = cryptoCurrencyCreate ("ethereum-mainnet:0xca401", "Carol", "tst", "erc20", NULL);
+    assert (CRYPTO_FALSE == cryptoNetworkHasCurrency (network, carol));
+    assert (NULL == cryptoNetworkGetUnitAsBase (network, carol));
+
+    cryptoCurrencyGive (carol);
+    cryptoCurrencyGive (bob);
+    cryptoCurrencyGive (alice);
+    cryptoCurrencyGive (eth);
+    cryptoNetworkGive (network);
+
+    cryptoListenerStop (listener);
+    cryptoListenerGive (listener);
+    array_free (state.records);
+    pthread_mutex_destroy (&state.lock);
+}
+
+static void
+runCryptoNetworkTests (void) {
+    networkTestsCurrencyLookup ();
+}
+
 ///
 /// Mark: BRCryptoWalletManager Tests
 ///
@@ -1532,6 +2318,574 @@ runCryptoWalletManagerLifecycleWithSetModeTest (BRCryptoAccount account,
     return success;
 }
 
+///
+/// Mark: BRCryptoClient QRY Performance
+///
+
+// A recorded transaction, served for the one address it pays.
+typedef struct {
+    BRAddress address; // must be first, for BRAddressHash()/BRAddressEq()
+    uint8_t *serialization;
+    size_t serializationCount;
+    uint64_t blockHeight;
+} QRYPerfEntry;
+
+// A stub client that answers each GET transactions request, after `latency`, on its own thread.
+typedef struct {
+    BRSetOf(QRYPerfEntry *) entries;
+    useconds_t latency;
+    size_t requests;
+    size_t outstanding;
+    pthread_mutex_t lock;
+} QRYPerfClientState;
+
+typedef struct {
+    QRYPerfClientState *state;
+    BRCryptoWalletManager manager;
+    BRCryptoClientCallbackState callbackState;
+    BRArrayOf(BRCryptoClientTransactionBundle) bundles;
+} QRYPerfResponse;
+
+static void *
+_QRYPerfRespondThread (void *context) {
+    QRYPerfResponse *response = context;
+    QRYPerfClientState *state = response->state;
+
+    usleep (state->latency);
+
+    cwmAnnounceTransactions (response->manager,
+                             response->callbackState,
+                             CRYPTO_TRUE,
+                             response->bundles,
+                             array_count (response->bundles));
+
+    cryptoWalletManagerGive (response->manager);
+    array_free (response->bundles);
+    free (response);
+
+    pthread_mutex_lock (&state->lock);
+    state->outstanding -= 1;
+    pthread_mutex_unlock (&state->lock);
+
+    return NULL;
+}
+
+static void
+_QRYPerfGetBlockNumberCallback (BRCryptoClientContext context,
+                                OwnershipGiven BRCryptoWalletManager manager,
+                                OwnershipGiven BRCryptoClientCallbackState callbackState) {
+    cwmAnnounceBlockNumber (manager, callbackState, CRYPTO_TRUE, cryptoNetworkGetHeight (manager->network), NULL);
+    cryptoWalletManagerGive (manager);
+}
+
+static void
+_QRYPerfGetTransactionsCallback (BRCryptoClientContext context,
+                                 OwnershipGiven BRCryptoWalletManager manager,
+                                 OwnershipGiven BRCryptoClientCallbackState callbackState,
+                                 OwnershipKept const char **addresses,
+                                 size_t addressCount,
+                                 uint64_t begBlockNumber,
+                                 uint64_t endBlockNumber) {
+    QRYPerfClientState *state = (QRYPerfClientState *) context;
+
+    QRYPerfResponse *response = calloc (1, sizeof (QRYPerfResponse));
+    response->state         = state;
+    response->manager       = manager;
+    response->callbackState = callbackState;
+    array_new (response->bundles, 10);
+
+    for (size_t index = 0; index < addressCount; index++) {
+        BRAddress address = BR_ADDRESS_NONE;
+        strncpy (address.s, addresses[index], sizeof (address.s) - 1);
+
+        QRYPerfEntry *entry = BRSetGet (state->entries, &address);
+        if (NULL != entry)
+            array_add (response->bundles, cryptoClientTransactionBundleCreate (CRYPTO_TRANSFER_STATE_INCLUDED,
+                                                                               entry->serialization,
+                                                                               entry->serializationCount,
+                                                                               0,
+                                                                               entry->blockHeight));
+    }
+
+    pthread_mutex_lock (&state->lock);
+    state->requests    += 1;
+    state->outstanding += 1;
+    pthread_mutex_unlock (&state->lock);
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init (&attr);
+    pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+    if (0 != pthread_create (&thread, &attr, _QRYPerfRespondThread, response))
+        _QRYPerfRespondThread (response);
+    pthread_attr_destroy (&attr);
+}
+
+// The listener callbacks give everything the events hold.
+
+static void
+_QRYPerfSystemCallback (BRCryptoListenerContext context,
+                        BRCryptoSystem system,
+                        BRCryptoSystemEvent event) {
+}
+
+static void
+_QRYPerfNetworkCallback (BRCryptoListenerContext context,
+                         BRCryptoNetwork network,
+                         BRCryptoNetworkEvent event) {
+    if (NULL != network) cryptoNetworkGive (network);
+}
+
+static void
+_QRYPerfManagerCallback (BRCryptoListenerContext context,
+                         BRCryptoWalletManager manager,
+                         BRCryptoWalletManagerEvent event) {
+    switch (event.type) {
+        case CRYPTO_WALLET_MANAGER_EVENT_WALLET_ADDED:
+        case CRYPTO_WALLET_MANAGER_EVENT_WALLET_CHANGED:
+        case CRYPTO_WALLET_MANAGER_EVENT_WALLET_DELETED:
+            if (NULL != event.u.wallet) cryptoWalletGive (event.u.wallet);
+            break;
+        default:
+            break;
+    }
+    if (NULL != manager) cryptoWalletManagerGive (manager);
+}
+
+static void
+_QRYPerfWalletCallback (BRCryptoListenerContext context,
+                        BRCryptoWalletManager manager,
+                        BRCryptoWallet wallet,
+                        BRCryptoWalletEvent event) {
+    switch (event.type) {
+        case CRYPTO_WALLET_EVENT_TRANSFER_ADDED:
+        case CRYPTO_WALLET_EVENT_TRANSFER_CHANGED:
+        case CRYPTO_WALLET_EVENT_TRANSFER_SUBMITTED:
+        case CRYPTO_WALLET_EVENT_TRANSFER_DELETED:
+            if (NULL != event.u.transfer) cryptoTransferGive (event.u.transfer);
+            break;
+        case CRYPTO_WALLET_EVENT_BALANCE_UPDATED:
+            cryptoAmountGive (event.u.balanceUpdated.amount);
+            break;
+        case CRYPTO_WALLET_EVENT_FEE_BASIS_UPDATED:
+            cryptoFeeBasisGive (event.u.feeBasisUpdated.basis);
+            break;
+        case CRYPTO_WALLET_EVENT_FEE_BASIS_ESTIMATED:
+            if (NULL != event.u.feeBasisEstimated.basis) cryptoFeeBasisGive (event.u.feeBasisEstimated.basis);
+            break;
+        default:
+            break;
+    }
+    if (NULL != wallet)  cryptoWalletGive (wallet);
+    if (NULL != manager) cryptoWalletManagerGive (manager);
+}
+
+static void
+_QRYPerfTransferCallback (BRCryptoListenerContext context,
+                          BRCryptoWalletManager manager,
+                          BRCryptoWallet wallet,
+                          BRCryptoTransfer transfer,
+                          BRCryptoTransferEvent event) {
+    if (CRYPTO_TRANSFER_EVENT_CHANGED == event.type) {
+        cryptoTransferStateRelease (&event.u.state.old);
+        cryptoTransferStateRelease (&event.u.state.new);
+    }
+    if (NULL != transfer) cryptoTransferGive (transfer);
+    if (NULL != wallet)   cryptoWalletGive (wallet);
+    if (NULL != manager)  cryptoWalletManagerGive (manager);
+}
+
+static int
+_QRYPerfIsSynced (BRCryptoClientQRYManager qry, int *success) {
+    pthread_mutex_lock (&qry->lock);
+    int completed = qry->sync.completed;
+    *success = qry->sync.success;
+    pthread_mutex_unlock (&qry->lock);
+    return completed;
+}
+
+/// Sync a new BTC wallet manager, API only, from `state`; the QRY manager requests addresses with
+/// `depth` gap windows of look-ahead.  Returns the seconds until the sync completed.
+static double
+_QRYPerfRun (BRCryptoListener listener,
+             BRCryptoNetwork network,
+             const char *paperKey,
+             QRYPerfClientState *state,
+             size_t depth,
+             size_t *transactionsCount,
+             int *success) {
+    char storagePath[] = "/tmp/qryPerfXXXXXX";
+    if (NULL == mkdtemp (storagePath)) return -1;
+
+    // A new account for each run, so that no address is already derived.
+    BRCryptoAccount account = cryptoAccountCreate (paperKey, 0, "qry-perf");
+
+    BRCryptoClient client = (BRCryptoClient) {
+        state,
+        _QRYPerfGetBlockNumberCallback,
+        _QRYPerfGetTransactionsCallback,
+        _CWMNopGetTransfersCallback,
+        _CWMNopSubmitTransactionCallback,
+        _CWMNopEstimateTransactionFeeCallback
+    };
+
+    BRCryptoWalletManager manager = cryptoWalletManagerCreate (cryptoListenerCreateWalletManagerListener (listener, NULL),
+                                                               client,
+                                                               account,
+                                                               network,
+                                                               CRYPTO_SYNC_MODE_API_ONLY,
+                                                               CRYPTO_ADDRESS_SCHEME_BTC_LEGACY,
+                                                               storagePath);
+    cryptoClientQRYManagerSetLookAheadDepth (manager->qryManager, depth);
+
+    state->requests = 0;
+
+    double start = supPerfTimeNow ();
+    cryptoClientQRYManagerTickTock (manager->qryManager);
+    while (!_QRYPerfIsSynced (manager->qryManager, success)) usleep (1000);
+    double elapsed = supPerfTimeNow () - start;
+
+    // Every batch has been announced; wait for the responses to finish with the manager.
+    for (int outstanding = 1; outstanding; usleep (1000)) {
+        pthread_mutex_lock (&state->lock);
+        outstanding = (0 != state->outstanding);
+        pthread_mutex_unlock (&state->lock);
+    }
+
+    *transactionsCount = BRWalletTransactions (cryptoWalletAsBTC (manager->wallet), NULL, 0);
+
+    cryptoWalletManagerStop (manager);
+    cryptoWalletManagerGive (manager);
+    cryptoAccountGive (account);
+
+    cryptoWalletManagerWipe (network, storagePath);
+    rmdir (storagePath);
+
+    return elapsed;
+}
+
+///
+/// Time-to-synced for a BTC wallet with one received transaction on each of its first `usedCount`
+/// external addresses.  The real QRY manager syncs against a stub client that answers every
+/// request after `latencyInMilliseconds`; look-ahead depth 0 is plain, window by window, recovery.
+///
+extern void
+runCryptoClientQRYPerfTest (size_t usedCount,
+                            unsigned int latencyInMilliseconds) {
+    const char *paperKey = "ginger settle marine tissue robot crane night number ramp coast roast critic";
+    size_t depths[] = { 0, 1, 2, 4 };
+
+    BRCryptoListener listener = cryptoListenerCreate (NULL,
+                                                     _QRYPerfSystemCallback,
+                                                     _QRYPerfNetworkCallback,
+                                                     _QRYPerfManagerCallback,
+                                                     _QRYPerfWalletCallback,
+                                                     _QRYPerfTransferCallback);
+    cryptoListenerStart (listener);
+
+    size_t networksCount = 0;
+    BRCryptoNetwork *networks = cryptoNetworkInstallBuiltins (&networksCount,
+                                                              cryptoListenerCreateNetworkListener (listener, NULL),
+                                                              true);
+    BRCryptoNetwork network = NULL;
+    for (size_t index = 0; index < networksCount; index++) {
+        if (NULL == network && 0 == strcmp ("bitcoin-mainnet", networks[index]->uids))
+            network = cryptoNetworkTake (networks[index]);
+        cryptoNetworkGive (networks[index]);
+    }
+    free (networks);
+
+    BRAddressParams addrParams = cryptoNetworkAsBTC (network)->addrParams;
+
+    // Record one transaction paying each used address.
+    BRCryptoAccount account = cryptoAccountCreate (paperKey, 0, "qry-perf");
+    BRWallet *wallet = BRWalletNew (addrParams, NULL, 0, cryptoAccountAsBTC (account));
+    BRAddress *addresses = calloc (usedCount, sizeof (BRAddress));
+    BRWalletUnusedAddrs (wallet, addresses, (uint32_t) usedCount, SEQUENCE_EXTERNAL_CHAIN);
+    BRWalletFree (wallet);
+    cryptoAccountGive (account);
+
+    QRYPerfClientState state;
+    state.entries     = BRSetNew (BRAddressHash, BRAddressEq, usedCount);
+    state.latency     = 1000 * latencyInMilliseconds;
+    state.requests    = 0;
+    state.outstanding = 0;
+    pthread_mutex_init (&state.lock, NULL);
+
+    QRYPerfEntry *entries = calloc (usedCount, sizeof (QRYPerfEntry));
+    uint8_t sig[72], script[64];
+    memset (sig, 0x30, sizeof (sig));
+
+    for (size_t index = 0; index < usedCount; index++) {
+        UInt256 prevHash = UINT256_ZERO;
+        UInt32SetLE (prevHash.u8, (uint32_t) index + 1);
+
+        BRTransaction *tid = BRTransactionNew ();
+        BRTransactionAddInput  (tid, prevHash, 0, 0, NULL, 0, sig, sizeof (sig), NULL, 0, TXIN_SEQUENCE);
+        BRTransactionAddOutput (tid, 100000, script, BRAddressScriptPubKey (script, sizeof (script), addrParams, addresses[index].s));
+
+        entries[index].address            = addresses[index];
+        entries[index].serializationCount = BRTransactionSerialize (tid, NULL, 0);
+        entries[index].serialization      = malloc (entries[index].serializationCount);
+        entries[index].blockHeight        = 600000 + index;
+        BRTransactionSerialize (tid, entries[index].serialization, entries[index].serializationCount);
+        BRTransactionFree (tid);
+
+        BRSetAdd (state.entries, &entries[index]);
+    }
+
+    for (size_t index = 0; index < sizeof (depths) / sizeof (depths[0]); index++) {
+        size_t transactionsCount = 0;
+        int success = 0;
+        double elapsed = _QRYPerfRun (listener, network, paperKey, &state, depths[index], &transactionsCount, &success);
+
+        printf ("QRY sync (%zu used, %ums latency), depth %zu: %6.3fs, %4zu requests, %zu transactions%s\n",
+                usedCount, latencyInMilliseconds, depths[index], elapsed, state.requests, transactionsCount,
+                (success ? "" : " (failed)"));
+    }
+
+    for (size_t index = 0; index < usedCount; index++)
+        free (entries[index].serialization);
+    free (entries);
+    free (addresses);
+    BRSetFree (state.entries);
+    pthread_mutex_destroy (&state.lock);
+    cryptoNetworkGive (network);
+    cryptoListenerStop (listener);
+    cryptoListenerGive (listener);
+}
+
+///
+/// Mark: BTC Transaction Bundles Recovery Performance
+///
+
+/// Recover `bundles` into a new BTC wallet manager, API only, either bundle by bundle or, as
+/// `cwmAnnounceTransactions()` does, all at once; then announce them again.  Returns the seconds
+/// for each announcement in `elapsed`, and the wallet's balance.
+static uint64_t
+_BundlesBTCPerfRun (BRCryptoListener listener,
+                    BRCryptoNetwork network,
+                    BRCryptoAccount account,
+                    BRCryptoClientTransactionBundle *bundles,
+                    size_t bundlesCount,
+                    BRAddress *addresses,
+                    bool batch,
+                    double elapsed[2]) {
+    char storagePath[] = "/tmp/bundlesPerfXXXXXX";
+    if (NULL == mkdtemp (storagePath)) return 0;
+
+    BRCryptoClient client = (BRCryptoClient) {
+        NULL,
+        _CWMNopGetBlockNumberCallback,
+        _CWMNopGetTransactionsCallback,
+        _CWMNopGetTransfersCallback,
+        _CWMNopSubmitTransactionCallback,
+        _CWMNopEstimateTransactionFeeCallback
+    };
+
+    BRCryptoWalletManager manager = cryptoWalletManagerCreate (cryptoListenerCreateWalletManagerListener (listener, NULL),
+                                                               client,
+                                                               account,
+                                                               network,
+                                                               CRYPTO_SYNC_MODE_API_ONLY,
+                                                               CRYPTO_ADDRESS_SCHEME_BTC_LEGACY,
+                                                               storagePath);
+
+    // Every address paid, as the QRY manager would have found them.
+    BRWalletUnusedAddrs (cryptoWalletAsBTC (manager->wallet), NULL, (uint32_t) bundlesCount, SEQUENCE_EXTERNAL_CHAIN);
+    assert (BRWalletContainsAddress (cryptoWalletAsBTC (manager->wallet), addresses[bundlesCount - 1].s));
+
+    for (size_t pass = 0; pass < 2; pass++) {
+        double start = supPerfTimeNow ();
+        if (batch)
+            cryptoWalletManagerRecoverTransfersFromTransactionBundles (manager, bundles, bundlesCount);
+        else
+            for (size_t index = 0; index < bundlesCount; index++)
+                cryptoWalletManagerRecoverTransfersFromTransactionBundle (manager, bundles[index]);
+        elapsed[pass] = supPerfTimeNow () - start;
+    }
+
+    uint64_t balance = BRWalletBalance (cryptoWalletAsBTC (manager->wallet));
+
+    // Every transfer is included, at its bundle's block
+    size_t transfersCount = 0;
+    BRCryptoTransfer *transfers = cryptoWalletGetTransfers (manager->wallet, &transfersCount);
+    assert (bundlesCount == transfersCount);
+
+    for (size_t index = 0; index < transfersCount; index++) {
+        BRCryptoTransferState state = cryptoTransferGetState (transfers[index]);
+        assert (CRYPTO_TRANSFER_STATE_INCLUDED == state.type);
+        assert (600000 <= state.u.included.blockNumber && state.u.included.blockNumber < 600000 + bundlesCount);
+        cryptoTransferStateRelease (&state);
+        cryptoTransferGive (transfers[index]);
+    }
+    free (transfers);
+
+    cryptoWalletManagerStop (manager);
+    cryptoWalletManagerGive (manager);
+
+    cryptoWalletManagerWipe (network, storagePath);
+    rmdir (storagePath);
+
+    return balance;
+}
+
+/// Time to recover `bundlesCount` BTC transaction bundles, one paying each of a wallet's first
+/// external addresses, four to a block, through the BTC handler bundle by bundle and through its
+/// batch handler.  Half of the transactions signal replace-by-fee, which the wallet holds as pending
+/// until they are included.  A second announcement of the same bundles finds them all held.
+///
+extern void
+runCryptoTransactionBundlesBTCPerfTest (size_t bundlesCount) {
+    const char *paperKey = "ginger settle marine tissue robot crane night number ramp coast roast critic";
+
+    BRCryptoListener listener = cryptoListenerCreate (NULL,
+                                                     _QRYPerfSystemCallback,
+                                                     _QRYPerfNetworkCallback,
+                                                     _QRYPerfManagerCallback,
+                                                     _QRYPerfWalletCallback,
+                                                     _QRYPerfTransferCallback);
+    cryptoListenerStart (listener);
+
+    size_t networksCount = 0;
+    BRCryptoNetwork *networks = cryptoNetworkInstallBuiltins (&networksCount,
+                                                              cryptoListenerCreateNetworkListener (listener, NULL),
+                                                              true);
+    BRCryptoNetwork network = NULL;
+    for (size_t index = 0; index < networksCount; index++) {
+        if (NULL == network && 0 == strcmp ("bitcoin-mainnet", networks[index]->uids))
+            network = cryptoNetworkTake (networks[index]);
+        cryptoNetworkGive (networks[index]);
+    }
+    free (networks);
+
+    BRAddressParams addrParams = cryptoNetworkAsBTC (network)->addrParams;
+    BRCryptoAccount account    = cryptoAccountCreate (paperKey, 0, "bundles-perf");
+
+    BRWallet *wallet = BRWalletNew (addrParams, NULL, 0, cryptoAccountAsBTC (account));
+    BRAddress *addresses = calloc (bundlesCount, sizeof (BRAddress));
+    BRWalletUnusedAddrs (wallet, addresses, (uint32_t) bundlesCount, SEQUENCE_EXTERNAL_CHAIN);
+    BRWalletFree (wallet);
+
+    BRCryptoClientTransactionBundle *bundles = calloc (bundlesCount, sizeof (BRCryptoClientTransactionBundle));
+    uint8_t sig[72], script[64];
+    memset (sig, 0x30, sizeof (sig));
+
+    uint64_t amount = 0;
+    for (size_t index = 0; index < bundlesCount; index++) {
+        UInt256 prevHash = UINT256_ZERO;
+        UInt32SetLE (prevHash.u8, (uint32_t) index + 1);
+
+        BRTransaction *tid = BRTransactionNew ();
+        BRTransactionAddInput  (tid, prevHash, 0, 0, NULL, 0, sig, sizeof (sig), NULL, 0,
+                                (index % 2 ? TXIN_SEQUENCE - 2 : TXIN_SEQUENCE));
+        BRTransactionAddOutput (tid, 100000 + index, script, BRAddressScriptPubKey (script, sizeof (script), addrParams, addresses[index].s));
+        amount += 100000 + index;
+
+        uint8_t serialization[BRTransactionSerialize (tid, NULL, 0)];
+        size_t  serializationCount = BRTransactionSerialize (tid, serialization, sizeof (serialization));
+        bundles[index] = cryptoClientTransactionBundleCreate (CRYPTO_TRANSFER_STATE_INCLUDED,
+                                                              serialization,
+                                                              serializationCount,
+                                                              1600000000 + 600 * (index / 4),
+                                                              600000 + index / 4);
+        BRTransactionFree (tid);
+    }
+
+    double serial[2], batch[2];
+    uint64_t serialBalance = _BundlesBTCPerfRun (listener, network, account, bundles, bundlesCount, addresses, false, serial);
+    uint64_t batchBalance  = _BundlesBTCPerfRun (listener, network, account, bundles, bundlesCount, addresses, true,  batch);
+
+    // Both ways hold every transaction as included
+    assert (amount == serialBalance && amount == batchBalance);
+
+    printf ("BTC transaction bundles (%zu): %7.3fs by bundle, %7.3fs batched; again: %7.3fs by bundle, %7.3fs batched\n",
+            bundlesCount, serial[0], batch[0], serial[1], batch[1]);
+
+    for (size_t index = 0; index < bundlesCount; index++)
+        cryptoClientTransactionBundleRelease (bundles[index]);
+    free (bundles);
+    free (addresses);
+    cryptoAccountGive (account);
+    cryptoNetworkGive (network);
+    cryptoListenerStop (listener);
+    cryptoListenerGive (listener);
+}
+
+///
+/// Mark: BRCryptoClient Transfer Bundle Decode Performance
+///
+
+/// Time per XRP transfer bundle to decode its `to` and `from` addresses and its amount and fee,
+/// as the XRP handler did before (a full decode and sscanf() every time) and through an address
+/// intern and the bundle integer parsers.  One side of each bundle is the account; the other is
+/// one of `counterpartiesCount` addresses.
+///
+extern void
+runCryptoTransferBundleDecodePerfTest (size_t bundlesCount,
+                                       size_t counterpartiesCount) {
+    char *account = addressInternTestsString (0xffff);
+    char *counterparties[counterpartiesCount];
+    for (size_t index = 0; index < counterpartiesCount; index++)
+        counterparties[index] = addressInternTestsString (index);
+
+    char (*amounts)[24] = malloc (bundlesCount * sizeof (*amounts));
+    for (size_t index = 0; index < bundlesCount; index++)
+        sprintf (amounts[index], "%" PRIu64, (uint64_t) 1000000 + 7919 * index);
+    const char *fee = "12";
+
+    uint64_t check = 0;
+
+    double start = supPerfTimeNow();
+    for (size_t index = 0; index < bundlesCount; index++) {
+        const char *to   = (index % 2 ? account : counterparties[index % counterpartiesCount]);
+        const char *from = (index % 2 ? counterparties[index % counterpartiesCount] : account);
+
+        uint64_t amountDrops = 0, feeDrops = 0;
+        sscanf (amounts[index], "%" PRIu64, &amountDrops);
+        sscanf (fee, "%" PRIu64, &feeDrops);
+
+        BRRippleAddress toAddress   = rippleAddressCreateFromString (to,   false);
+        BRRippleAddress fromAddress = rippleAddressCreateFromString (from, false);
+        check += amountDrops + feeDrops + rippleAddressHashValue (toAddress) + rippleAddressHashValue (fromAddress);
+        rippleAddressFree (toAddress);
+        rippleAddressFree (fromAddress);
+    }
+    double before = supPerfTimeNow() - start;
+
+    BRCryptoAddressIntern intern;
+    cryptoAddressInternInit (&intern);
+
+    start = supPerfTimeNow();
+    for (size_t index = 0; index < bundlesCount; index++) {
+        const char *to   = (index % 2 ? account : counterparties[index % counterpartiesCount]);
+        const char *from = (index % 2 ? counterparties[index % counterpartiesCount] : account);
+
+        uint64_t amountDrops = cryptoClientTransferBundleParseUInt64 (amounts[index]);
+        uint64_t feeDrops    = cryptoClientTransferBundleParseUInt64 (fee);
+
+        BRRippleAddress toAddress   = cryptoAddressInternDecode (&intern, to,   &addressInternTestsHandlers);
+        BRRippleAddress fromAddress = cryptoAddressInternDecode (&intern, from, &addressInternTestsHandlers);
+        check -= amountDrops + feeDrops + rippleAddressHashValue (toAddress) + rippleAddressHashValue (fromAddress);
+        rippleAddressFree (toAddress);
+        rippleAddressFree (fromAddress);
+    }
+    double after = supPerfTimeNow() - start;
+
+    cryptoAddressInternRelease (&intern);
+
+    // Both ways decode the same values
+    assert (0 == check);
+
+    printf ("XRP transfer bundle decode (%zu counterparties): %6.0f ns/bundle before, %6.0f ns/bundle interned\n",
+            counterpartiesCount, 1e9 * before / bundlesCount, 1e9 * after / bundlesCount);
+
+    for (size_t index = 0; index < counterpartiesCount; index++)
+        free (counterparties[index]);
+    free (account);
+    free (amounts);
+}
+
 ///
 /// Mark: Entrypoints
 ///
@@ -1648,5 +3002,10 @@ extern void
 runCryptoTests (void) {
     runCryptoAmountTests ();
     runCryptoTransferTests();
+    runCryptoWalletSweeperTests();
+    runCryptoClientTests();
+    runCryptoAddressInternTests();
+    runCryptoListenerTests();
+    runCryptoNetworkTests();
     return;
 }
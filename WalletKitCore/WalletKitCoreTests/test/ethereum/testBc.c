@@ -41,6 +41,7 @@ runBloomTests (void) {
 
 #define BLOCK_HEADER_0_RLP "f9020ca00000000000000000000000000000000000000000000000000000000000000000a01dcc4de8dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d49347940000000000000000000000000000000000000000a0d7f8974fb5ac78d9ac099b9ad5018bedc2ce0a72dad1827a1709da30580f0544a056e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421a056e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421b9010000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000850400000000008213880000a011bbe8db4e347b4e8c937c1c8370e4b5ed33adb3db69cbdb7a38e1e50b1b82faa0000000000000000000000000000000000000000000000000000000000000000042"
 #define BLOCK_HEADER_1_RLP "f90211a0d4e56740f876aef8c010b86a40d5f56745a118d0906a34e69aec8c0db1cb8fa3a01dcc4de8dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d493479405a56e2d52c817161883f50c441c3228cfe54d9fa0d67e4d450343046425ae4271474353857ab860dbc0a1dde64b41b5cd3a532bf3a056e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421a056e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421b90100000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000008503ff80000001821388008455ba422499476574682f76312e302e302f6c696e75782f676f312e342e32a0969b900de27b6ac6a67742365dd65f55a0526c41fd18e1b16f1a1215c2e66f5988539bd4979fef1ec4"
+#define BLOCK_HEADER_1_POW_RLP "f90211a0d4e56740f876aef8c010b86a40d5f56745a118d0906a34e69aec8c0db1cb8fa3a01dcc4de8dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d493479405a56e2d52c817161883f50c441c3228cfe54d9fa0d67e4d450343046425ae4271474353857ab860dbc0a1dde64b41b5cd3a532bf3a056e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421a056e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421b90100000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000008503ff80000001821388808455ba422499476574682f76312e302e302f6c696e75782f676f312e342e32a0969b900de27b6ac6a67742365dd65f55a0526c41fd18e1b16f1a1215c2e66f5988539bd4979fef1ec4"
 #define BLOCK_HEADER_2_RLP "f90218a088e96d4537bea4d9c05d12549907b32561d3bf31f45aae734cdc119f13406cb6a01dcc4de8dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d4934794dd2f1e6e498202e86d8f5442af596580a4f03c2ca04943d941637411107494da9ec8bc04359d731bfd08b72b4d0edcbd4cd2ecb341a056e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421a056e81f171bcc55a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421b90100000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000008503ff00100002821388008455ba4241a0476574682f76312e302e302d30636463373634372f6c696e75782f676f312e34a02f0790c5aa31ab94195e1f6443d645af5b75c46c04fbf9911711198a0ce8fdda88b853fa261a86aa9e"
 
 #define BLOCK_HEADER_4000000_RLP "f90218a09b3c1d182975fdaa5797879cbc45d6b00a84fb3b13980a107645b2491bcca899a01dcc4de8dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d49347941e9939daaad6924ad004c2560e90804164900341a0c191817e387e5405867535fb7f97991346e5f95c9dd040fb21503762ee22f5f8a0e3957fe2e24a0699872fe045ea7d1af2da0ea331fe782c802902b1a0e80560a8a0cd98e056d619b4047ff1ec598e61fd42edb3b48e6748bac41e164e1671d02623b90100408000002040080200010150010000022800000010030000001225000021010840000010000000020080400800000001000000000020040000004000000001000020000000000000c000048c802010080000000000230080000180004000000020088038420800000200104204000800124000204800404000002910021080622020820180000080c00000080401980001008000028a000080400000001081004040000020002000120008100004240100140c03000080200200804000000000010000024004000000024000008000400000000400000001201000080100210100000002010000100000002400000204400800200800020003000020000000818703e5151f3eae1c833d090083666c4883437928845962979f97706f6f6c2e65746866616e732e6f726720284d4e313529a081277f51ee22c1022b848064b1c5af001e3ba06d808a1ef3fd52aad07279e0f088f285952002120e7f"
@@ -130,7 +131,25 @@ runBlockHeaderTests (void) {
                                                               header_0,
                                                               NULL)));
 
+    // Ethash - epoch 133 and, with zero gasUsed in the seal, epoch 0
+    BREthereumProofOfWork pow = proofOfWorkCreate ();
 
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (blockHeaderIsValid (header_4000001,
+                                                              header_4000000,
+                                                              0,
+                                                              header_0,
+                                                              pow)));
+
+    BREthereumBlockHeader header_1 = testGetBlockHeader(BLOCK_HEADER_1_POW_RLP);
+    UInt256 n;
+    BREthereumHash m;
+
+    proofOfWorkCompute (pow, header_1, &n, &m);
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (ethHashEqual (m, blockHeaderGetMixHash (header_1))));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (ethHashEqual (blockHeaderGetHash (header_1),
+                                                    ethHashCreate ("0x88e96d4537bea4d9c05d12549907b32561d3bf31f45aae734cdc119f13406cb6"))));
+
+    proofOfWorkRelease (pow);
 }
 
 //
@@ -249,6 +268,14 @@ runBlockTest1 () {
         // It does not contain transaction address info.
         assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterMatch(filter, bloomFilterCreateAddress(addressSource))));
         assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterMatch(filter, bloomFilterCreateAddress(addressTarget))));
+
+        // ... and the same with a query
+        BREthereumBloomQuery query = bloomQueryCreate();
+        bloomQueryAddAddress (query, addressSource);
+        assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomQueryMatch (query, &filter)));
+        logTopicAddToBloomQueryAddress (addressTarget, query);
+        assert (ETHEREUM_BOOLEAN_IS_TRUE (bloomQueryMatch (query, &filter)));
+        bloomQueryRelease (query);
     }
 
     // BLOCK_2
@@ -267,6 +294,22 @@ runBlockTest1 () {
         // It does not contain transaction address info.
         assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterMatch(filter, bloomFilterCreateAddress(addressSource))));
         assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterMatch(filter, bloomFilterCreateAddress(addressTarget))));
+
+        assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomFilterMatchHash (&filter, ethAddressGetHash (addressTokenC))));
+        assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterMatchHash (&filter, ethAddressGetHash (addressSource))));
+
+        // ... and with a query large enough to use the 'union' pre-check
+        BREthereumBloomQuery query = bloomQueryCreate();
+        for (uint8_t i = 1; i <= 16; i++) {
+            BREthereumAddress address = addressSource;
+            address.bytes[0] ^= i;
+            bloomQueryAddAddress (query, address);
+        }
+        assert (16 == bloomQueryGetCount (query));
+        assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomQueryMatch (query, &filter)));
+        logTopicAddToBloomQueryAddress (addressSource, query);
+        assert (ETHEREUM_BOOLEAN_IS_TRUE (bloomQueryMatch (query, &filter)));
+        bloomQueryRelease (query);
     }
 }
 
@@ -9,8 +9,10 @@
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
 #include <stdio.h>
+#include <stdint.h>
 #include <assert.h>
 #include <pthread.h>
+#include <sys/time.h>
 #include "support/event/BREvent.h"
 #include "support/event/BREventAlarm.h"
 
@@ -26,8 +28,10 @@ testEventAlarmCallback (BREventAlarmContext context,
                         BREventAlarmClock clock) {
     assert (clock == alarmClock);
     assert (context == testEventAlarmContext);
+    pthread_mutex_lock(&testEventAlarmMutex);
     testEventAlarmCount++;
     pthread_cond_signal(&testEventAlarmConditional);
+    pthread_mutex_unlock(&testEventAlarmMutex);
 }
 
 static void
@@ -42,14 +46,67 @@ runEventTest (void) {
 
     pthread_mutex_lock(&testEventAlarmMutex);
     alarm = alarmClockAddAlarmPeriodic(alarmClock, testEventAlarmContext, testEventAlarmCallback, testEventAlarmPeriod);
-    pthread_cond_wait(&testEventAlarmConditional, &testEventAlarmMutex);
+    while (0 == testEventAlarmCount)
+        pthread_cond_wait(&testEventAlarmConditional, &testEventAlarmMutex);
+    pthread_mutex_unlock(&testEventAlarmMutex);
     alarmClockRemAlarm(alarmClock, alarm);
     assert (0 < testEventAlarmCount);
     alarmClockStop(alarmClock);
     alarmClockDestroy(alarmClock);
 }
 
+static int testEventAlarmOrder[3];
+static int testEventAlarmOrderCount = 0;
+
+static void
+testEventAlarmOrderCallback (BREventAlarmContext context,
+                             struct timespec expiration,
+                             BREventAlarmClock clock) {
+    pthread_mutex_lock(&testEventAlarmMutex);
+    assert (testEventAlarmOrderCount < 3);
+    testEventAlarmOrder[testEventAlarmOrderCount++] = (int) (intptr_t) context;
+    pthread_cond_signal(&testEventAlarmConditional);
+    pthread_mutex_unlock(&testEventAlarmMutex);
+}
+
+static struct timespec
+testEventAlarmTimeFromNow (long milliseconds) {
+    struct timeval now;
+    gettimeofday (&now, NULL);
+
+    long nsec = 1000 * now.tv_usec + 1000000 * milliseconds;
+    return (struct timespec) { .tv_sec = now.tv_sec + nsec / 1000000000, .tv_nsec = nsec % 1000000000 };
+}
+
+static void
+runEventAlarmOrderTest (void) {
+    BREventAlarmClock clock = alarmClockCreate();
+
+    // Added out of order; expire in order (of context)
+    alarmClockAddAlarm (clock, (void*) 3, testEventAlarmOrderCallback, testEventAlarmTimeFromNow (300));
+    alarmClockAddAlarm (clock, (void*) 1, testEventAlarmOrderCallback, testEventAlarmTimeFromNow (100));
+    BREventAlarmId alarm =
+    alarmClockAddAlarm (clock, (void*) 4, testEventAlarmOrderCallback, testEventAlarmTimeFromNow (150));
+    alarmClockAddAlarm (clock, (void*) 2, testEventAlarmOrderCallback, testEventAlarmTimeFromNow (200));
+
+    assert (alarmClockHasAlarm (clock, alarm));
+    alarmClockRemAlarm (clock, alarm);
+    assert (!alarmClockHasAlarm (clock, alarm));
+
+    pthread_mutex_lock(&testEventAlarmMutex);
+    alarmClockStart (clock);
+    while (testEventAlarmOrderCount < 3)
+        pthread_cond_wait(&testEventAlarmConditional, &testEventAlarmMutex);
+    pthread_mutex_unlock(&testEventAlarmMutex);
+
+    assert (1 == testEventAlarmOrder[0] && 2 == testEventAlarmOrder[1] && 3 == testEventAlarmOrder[2]);
+
+    alarmClockStop (clock);
+    alarmClockDestroy (clock);
+}
+
 extern void
 runEventTests (void) {
     runEventTest();
+    runEventAlarmOrderTest();
 }
@@ -157,6 +157,103 @@ runMathMulTests () {
 
 }
 
+//
+// Reference arithmetic, with 32-bit digits, to check the 64-bit limb implementations against.
+//
+static UInt512
+uint256MulReference (UInt256 x, UInt256 y) {
+    UInt512 z = UINT512_ZERO;
+    for (size_t xi = 0; xi < 8; xi++) {
+        uint64_t carry = 0;
+        for (size_t yi = 0; yi < 8; yi++) {
+            uint64_t total = z.u32[yi + xi] + carry + ((uint64_t) y.u32[yi]) * ((uint64_t) x.u32[xi]);
+            carry = total >> 32;
+            z.u32[yi + xi] = (uint32_t) total;
+        }
+        z.u32[xi + 8] = (uint32_t) carry;
+    }
+    return z;
+}
+
+static UInt512
+uint256AddReference (UInt256 x, UInt256 y) {
+    UInt512 z = UINT512_ZERO;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < 8; i++) {
+        uint64_t sum = ((uint64_t) x.u32[i]) + ((uint64_t) y.u32[i]) + carry;
+        carry = sum >> 32;
+        z.u32[i] = (uint32_t) sum;
+    }
+    z.u32[8] = (uint32_t) carry;
+    return z;
+}
+
+static int
+uint512EQL (UInt512 x, UInt512 y) {
+    return 0 == memcmp (x.u8, y.u8, sizeof (x.u8));
+}
+
+static void
+runMathReferenceTests () {
+    // Limb values that exercise the carries: 0, 1, 2^31, 2^32 - 1, 2^32, 2^63, 2^64 - 1, ...
+    uint64_t limbs[] = {
+        0, 1, 2, UINT32_MAX, ((uint64_t) 1) << 32, ((uint64_t) 1) << 63,
+        UINT64_MAX - 1, UINT64_MAX, 0x0123456789abcdefu, 0xfedcba9876543210u
+    };
+    size_t limbsCount = sizeof (limbs) / sizeof (uint64_t);
+
+    // Operands with every width, from zero to four limbs; the high limb takes each value.
+    UInt256 values[1 + 4 * 10];
+    size_t valuesCount = 0;
+
+    values[valuesCount++] = UINT256_ZERO;
+    for (size_t width = 1; width <= 4; width++)
+        for (size_t index = 0; index < limbsCount; index++) {
+            UInt256 v = UINT256_ZERO;
+            for (size_t limb = 0; limb < width; limb++)
+                v.u64[limb] = limbs[(index + 3 * limb) % limbsCount];
+            v.u64[width - 1] = limbs[index];
+            values[valuesCount++] = v;
+        }
+
+    for (size_t xi = 0; xi < valuesCount; xi++)
+        for (size_t yi = 0; yi < valuesCount; yi++) {
+            UInt256 x = values[xi], y = values[yi];
+            int overflow, negative;
+
+            UInt512 product = uint256MulReference (x, y);
+            assert (uint512EQL (product, uint256Mul (x, y)));
+
+            UInt256 productCoerced = uint256Coerce (product, &overflow);
+            int productOverflow = overflow;
+            assert (uint256EQL (productCoerced, uint256Mul_Overflow (x, y, &overflow)) && productOverflow == overflow);
+
+            UInt512 sum = uint256AddReference (x, y);
+            assert (uint512EQL (sum, uint256Add (x, y)));
+
+            UInt256 sumCoerced = uint256Coerce (sum, &overflow);
+            int sumOverflow = overflow;
+            assert (uint256EQL (sumCoerced, uint256Add_Overflow (x, y, &overflow)) && sumOverflow == overflow);
+
+            // (- (+ x y) y) => x, when (+ x y) doesn't overflow
+            if (!sumOverflow) {
+                assert (uint256EQL (x, uint256Sub_Negative (sumCoerced, y, &negative)) && 0 == negative);
+                assert (uint256EQL (x, uint256Sub_Negative (y, sumCoerced, &negative))
+                        && (uint256EQL (x, UINT256_ZERO) ? 0 : 1) == negative);
+            }
+
+            // Small multiplies and integral doubles match the full multiply.
+            uint32_t small = y.u32[0];
+            UInt256 smallCoerced = uint256Coerce (uint256MulReference (x, uint256Create (small)), &overflow);
+            int smallOverflow = overflow;
+            assert (uint256EQL (smallCoerced, uint256Mul_Small (x, small, &overflow)) && smallOverflow == overflow);
+
+            double rem = -1.0;
+            assert (uint256EQL (smallCoerced, uint256Mul_Double (x, (double) small, &overflow, &negative, &rem))
+                    && smallOverflow == overflow && 0 == negative && 0.0 == rem);
+        }
+}
+
 static void
 runMathMulDoubleTests () {
     BRCoreParseStatus status;
@@ -294,6 +391,26 @@ runMathCoerceTests () {
     gs = uint256CoerceStringPrefaced (g, 16, "0x");
     assert (0 == strcmp (gs, "0xa"));
     free ((char *) gs);
+
+    // Into a caller's buffer; too small leaves the buffer empty
+    char buffer[32];
+    assert (22 == uint256CoerceStringInto (b, 10, buffer, sizeof (buffer)));
+    assert (0 == strcmp (buffer, "1000000000000000000000"));
+
+    assert (22 == uint256CoerceStringInto (b, 10, buffer, 22));
+    assert (0 == strcmp (buffer, ""));
+
+    assert (8 == uint256CoerceStringInto (c, 2, buffer, sizeof (buffer)));
+    assert (0 == strcmp (buffer, "00001111"));
+
+    assert (23 == uint256CoerceStringDecimalInto (b, 18, buffer, sizeof (buffer)));
+    assert (0 == strcmp (buffer, "1000.000000000000000000"));
+
+    assert (20 == uint256CoerceStringDecimalInto (g, 18, buffer, sizeof (buffer)));
+    assert (0 == strcmp (buffer, "0.000000000000000010"));
+
+    assert (1 == uint256CoerceStringDecimalInto (f, 0, buffer, sizeof (buffer)));
+    assert (0 == strcmp (buffer, "0"));
 }
 
 static void
@@ -484,4 +601,5 @@ runUtilTests (void) {
     runMathMulTests();
     runMathMulDoubleTests();
     runMathDivTests();
+    runMathReferenceTests();
 }
@@ -20,9 +20,15 @@
 #include "support/BRBIP39Mnemonic.h"
 #include "support/BRBIP39WordsEn.h"
 #include "support/BRKey.h"
+#include "support/BROSCompat.h"
 
 #include "hedera/BRHederaTransaction.h"
 #include "hedera/BRHederaAccount.h"
+#include "hedera/BRHederaCrypto.h"
+#include "hedera/BRHederaSerialize.h"
+#include "hedera/proto/Transaction.pb-c.h"
+#include "ed25519/ed25519.h"
+#include "test.h"
 
 static int debug_log = 0;
 
@@ -335,6 +341,53 @@ static void hederaAccountCheckSerialize(const char * userName)
     hederaAccountFree(account2);
 }
 
+static void verifySignaturesTest()
+{
+#define VERIFY_COUNT (8)
+    const char * names[] = { "patient", "choose", "inmate" };
+    uint8_t publicKeyBytes[VERIFY_COUNT][32];
+    uint8_t signatureBytes[VERIFY_COUNT][64];
+    uint8_t bodyBytes[VERIFY_COUNT][64];
+    const uint8_t * bodies[VERIFY_COUNT];
+    const uint8_t * signatures[VERIFY_COUNT];
+    const uint8_t * publicKeys[VERIFY_COUNT];
+    size_t bodySizes[VERIFY_COUNT];
+    int valid[VERIFY_COUNT];
+
+    for (size_t i = 0; i < VERIFY_COUNT; i++) {
+        struct account_info accountInfo = find_account (names[i % 3]);
+        UInt512 seed = UINT512_ZERO;
+        BRBIP39DeriveKey(seed.u8, accountInfo.paper_key, NULL); // no passphrase
+        BRKey key = hederaKeyCreate (seed);
+
+        uint8_t privateKey[64];
+        ed25519_create_keypair (publicKeyBytes[i], privateKey, key.secret.u8);
+
+        memset (bodyBytes[i], (int) (0xa0 + i), sizeof (bodyBytes[i]));
+        bodySizes[i] = 8 + 7 * i;
+        ed25519_sign (signatureBytes[i], bodyBytes[i], bodySizes[i], publicKeyBytes[i], privateKey);
+        memset (privateKey, 0x00, sizeof (privateKey));
+
+        bodies[i] = bodyBytes[i];
+        signatures[i] = signatureBytes[i];
+        publicKeys[i] = publicKeyBytes[i];
+    }
+
+    assert (1 == hederaVerifySignatures (bodies, bodySizes, signatures, publicKeys, VERIFY_COUNT, valid));
+    for (size_t i = 0; i < VERIFY_COUNT; i++) assert (1 == valid[i]);
+
+    // Only the signature with the wrong key is reported
+    publicKeys[2] = publicKeyBytes[3];
+    assert (0 == hederaVerifySignatures (bodies, bodySizes, signatures, publicKeys, VERIFY_COUNT, valid));
+    for (size_t i = 0; i < VERIFY_COUNT; i++) assert ((2 != i) == valid[i]);
+    publicKeys[2] = publicKeyBytes[2];
+
+    signatureBytes[5][40] ^= 0x80;
+    assert (0 == hederaVerifySignatures (bodies, bodySizes, signatures, publicKeys, VERIFY_COUNT, valid));
+    for (size_t i = 0; i < VERIFY_COUNT; i++) assert ((5 != i) == valid[i]);
+#undef VERIFY_COUNT
+}
+
 static void accountStringTest(const char * userName) {
     struct account_info accountInfo = find_account (userName);
     UInt512 seed = UINT512_ZERO;
@@ -520,6 +573,8 @@ static void account_tests() {
     hederaAccountCheckSerialize("none");
 
     accountStringTest("patient");
+
+    verifySignaturesTest();
 }
 
 static void nodeAddressTest()
@@ -569,3 +624,245 @@ runHederaTest (void /* ... */) {
     transaction_tests();
     txIDTests();
 }
+
+// The packer as it was before the protobuf graph moved onto the stack: every node is calloc'd
+// and the memo, public key, signature and body are copied so free_unpacked() can release them.
+// Kept as the benchmark baseline and as a reference for the packed bytes.
+
+static Proto__AccountID *
+baselineCreateAccountID (BRHederaAddress address) {
+    Proto__AccountID *protoAccountID = calloc (1, sizeof (Proto__AccountID));
+    proto__account_id__init (protoAccountID);
+    protoAccountID->shardnum   = hederaAddressGetShard (address);
+    protoAccountID->realmnum   = hederaAddressGetRealm (address);
+    protoAccountID->accountnum = hederaAddressGetAccount (address);
+    return protoAccountID;
+}
+
+static Proto__AccountAmount *
+baselineCreateAccountAmount (BRHederaAddress address, int64_t amount) {
+    Proto__AccountAmount *accountAmount = calloc (1, sizeof (Proto__AccountAmount));
+    proto__account_amount__init (accountAmount);
+    accountAmount->accountid = baselineCreateAccountID (address);
+    accountAmount->amount = amount;
+    return accountAmount;
+}
+
+static uint8_t *
+baselineTransactionBodyPack (BRHederaAddress source,
+                             BRHederaAddress target,
+                             BRHederaAddress nodeAddress,
+                             BRHederaUnitTinyBar amount,
+                             BRHederaTimeStamp timeStamp,
+                             BRHederaUnitTinyBar fee,
+                             const char * memo,
+                             size_t *size) {
+    Proto__TransactionBody *body = calloc (1, sizeof (Proto__TransactionBody));
+    proto__transaction_body__init (body);
+
+    body->transactionid = calloc (1, sizeof (Proto__TransactionID));
+    proto__transaction_id__init (body->transactionid);
+    body->transactionid->transactionvalidstart = calloc (1, sizeof (Proto__Timestamp));
+    proto__timestamp__init (body->transactionid->transactionvalidstart);
+    body->transactionid->transactionvalidstart->seconds = timeStamp.seconds;
+    body->transactionid->transactionvalidstart->nanos   = timeStamp.nano;
+    body->transactionid->accountid = baselineCreateAccountID (source);
+
+    body->nodeaccountid  = baselineCreateAccountID (nodeAddress);
+    body->transactionfee = (uint64_t) fee;
+    if (memo) body->memo = strndup (memo, 100);
+
+    body->transactionvalidduration = calloc (1, sizeof (Proto__Duration));
+    proto__duration__init (body->transactionvalidduration);
+    body->transactionvalidduration->seconds = 180;
+
+    body->data_case = PROTO__TRANSACTION_BODY__DATA_CRYPTO_TRANSFER;
+    body->cryptotransfer = calloc (1, sizeof (Proto__CryptoTransferTransactionBody));
+    proto__crypto_transfer_transaction_body__init (body->cryptotransfer);
+    body->cryptotransfer->transfers = calloc (1, sizeof (Proto__TransferList));
+    proto__transfer_list__init (body->cryptotransfer->transfers);
+
+    body->cryptotransfer->transfers->n_accountamounts = 2;
+    body->cryptotransfer->transfers->accountamounts = calloc (2, sizeof (Proto__AccountAmount*));
+    body->cryptotransfer->transfers->accountamounts[0] = baselineCreateAccountAmount (source, -(amount));
+    body->cryptotransfer->transfers->accountamounts[1] = baselineCreateAccountAmount (target, amount);
+
+    *size = proto__transaction_body__get_packed_size (body);
+    uint8_t *buffer = calloc (1, *size);
+    proto__transaction_body__pack (body, buffer);
+
+    proto__transaction_body__free_unpacked (body, NULL);
+    return buffer;
+}
+
+static uint8_t *
+baselineTransactionPack (uint8_t * signature, size_t signatureSize,
+                         uint8_t * publicKey, size_t publicKeySize,
+                         uint8_t * body, size_t bodySize,
+                         size_t * serializedSize) {
+    Proto__Transaction *transaction = calloc (1, sizeof (Proto__Transaction));
+    proto__transaction__init (transaction);
+
+    Proto__SignatureMap *sigMap = calloc (1, sizeof (Proto__SignatureMap));
+    proto__signature_map__init (sigMap);
+    sigMap->sigpair = calloc (1, sizeof (Proto__SignaturePair*));
+    sigMap->sigpair[0] = calloc (1, sizeof (Proto__SignaturePair));
+    proto__signature_pair__init (sigMap->sigpair[0]);
+    sigMap->sigpair[0]->signature_case = PROTO__SIGNATURE_PAIR__SIGNATURE_ED25519;
+    sigMap->sigpair[0]->pubkeyprefix.data = malloc (publicKeySize);
+    memcpy (sigMap->sigpair[0]->pubkeyprefix.data, publicKey, publicKeySize);
+    sigMap->sigpair[0]->pubkeyprefix.len = publicKeySize;
+    sigMap->sigpair[0]->ed25519.data = malloc (signatureSize);
+    memcpy (sigMap->sigpair[0]->ed25519.data, signature, signatureSize);
+    sigMap->sigpair[0]->ed25519.len = signatureSize;
+    sigMap->n_sigpair = 1;
+    transaction->sigmap = sigMap;
+
+    transaction->bodybytes.data = malloc (bodySize);
+    memcpy (transaction->bodybytes.data, body, bodySize);
+    transaction->bodybytes.len = bodySize;
+    transaction->body_data_case = PROTO__TRANSACTION__BODY_DATA_BODY_BYTES;
+
+    *serializedSize = proto__transaction__get_packed_size (transaction);
+    uint8_t *serializeBytes = calloc (1, *serializedSize);
+    proto__transaction__pack (transaction, serializeBytes);
+
+    proto__transaction__free_unpacked (transaction, NULL);
+    return serializeBytes;
+}
+
+// Time per body + transaction pack: the baseline packer above, the allocating wrappers, and the
+// *PackInto() functions writing to caller buffers.
+extern void
+runHederaPerfTest (size_t count) {
+    BRHederaAddress source = hederaAddressCreateFromString ("0.0.114008", true);
+    BRHederaAddress target = hederaAddressCreateFromString ("0.0.114009", true);
+    BRHederaAddress node   = hederaAddressCreateFromString ("0.0.3", true);
+    BRHederaTimeStamp timeStamp = { 1571928073, 12345 };
+    uint8_t signature[64], publicKey[32], body[256], tx[512];
+    memset (signature, 7, sizeof (signature));
+    memset (publicKey, 9, sizeof (publicKey));
+
+    double start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++) {
+        size_t bodySize, txSize;
+        uint8_t *packedBody = baselineTransactionBodyPack (source, target, node, (BRHederaUnitTinyBar) i, timeStamp,
+                                                           500000, "memo", &bodySize);
+        uint8_t *packedTx   = baselineTransactionPack (signature, sizeof (signature), publicKey, sizeof (publicKey),
+                                                       packedBody, bodySize, &txSize);
+        free (packedTx);
+        free (packedBody);
+    }
+    double baseline = supPerfTimeNow() - start;
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++) {
+        size_t bodySize, txSize;
+        uint8_t *packedBody = hederaTransactionBodyPack (source, target, node, (BRHederaUnitTinyBar) i, timeStamp,
+                                                         500000, "memo", &bodySize);
+        uint8_t *packedTx   = hederaTransactionPack (signature, sizeof (signature), publicKey, sizeof (publicKey),
+                                                     packedBody, bodySize, &txSize);
+        free (packedTx);
+        free (packedBody);
+    }
+    double allocating = supPerfTimeNow() - start;
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++) {
+        size_t bodySize = hederaTransactionBodyPackInto (source, target, node, (BRHederaUnitTinyBar) i, timeStamp,
+                                                         500000, "memo", body, sizeof (body));
+        assert (bodySize <= sizeof (body));
+        assert (hederaTransactionPackInto (signature, sizeof (signature), publicKey, sizeof (publicKey),
+                                           body, bodySize, tx, sizeof (tx)) <= sizeof (tx));
+    }
+    double into = supPerfTimeNow() - start;
+
+    // All three produce the same bytes, with and without a memo
+    const char *memos[] = { "memo", NULL };
+    for (size_t m = 0; m < sizeof (memos) / sizeof (memos[0]); m++) {
+        size_t baselineBodySize, baselineTxSize, bodySize, txSize;
+        uint8_t *baselineBody = baselineTransactionBodyPack (source, target, node, (BRHederaUnitTinyBar) (count - 1),
+                                                             timeStamp, 500000, memos[m], &baselineBodySize);
+        uint8_t *baselineTx   = baselineTransactionPack (signature, sizeof (signature), publicKey, sizeof (publicKey),
+                                                         baselineBody, baselineBodySize, &baselineTxSize);
+        uint8_t *packedBody   = hederaTransactionBodyPack (source, target, node, (BRHederaUnitTinyBar) (count - 1),
+                                                           timeStamp, 500000, memos[m], &bodySize);
+        uint8_t *packedTx     = hederaTransactionPack (signature, sizeof (signature), publicKey, sizeof (publicKey),
+                                                       packedBody, bodySize, &txSize);
+
+        assert (bodySize == baselineBodySize && 0 == memcmp (packedBody, baselineBody, bodySize));
+        assert (txSize   == baselineTxSize   && 0 == memcmp (packedTx,   baselineTx,   txSize));
+
+        assert (bodySize == hederaTransactionBodyPackInto (source, target, node, (BRHederaUnitTinyBar) (count - 1),
+                                                           timeStamp, 500000, memos[m], body, sizeof (body)));
+        assert (0 == memcmp (packedBody, body, bodySize));
+        assert (txSize == hederaTransactionPackInto (signature, sizeof (signature), publicKey, sizeof (publicKey),
+                                                     body, bodySize, tx, sizeof (tx)));
+        assert (0 == memcmp (packedTx, tx, txSize));
+
+        free (packedTx);
+        free (packedBody);
+        free (baselineTx);
+        free (baselineBody);
+    }
+
+    printf ("hederaTransaction{Body}Pack, baseline: %6.0f ns/pack\n", 1e9 * baseline   / count);
+    printf ("hederaTransaction{Body}Pack:           %6.0f ns/pack\n", 1e9 * allocating / count);
+    printf ("hederaTransaction{Body}PackInto:       %6.0f ns/pack\n", 1e9 * into       / count);
+
+    hederaAddressFree (source);
+    hederaAddressFree (target);
+    hederaAddressFree (node);
+}
+
+// Time per signature to verify `count` batches of up to 64 signed bodies, one ed25519_verify()
+// at a time and as one hederaVerifySignatures() batch.
+extern void
+runHederaVerifyPerfTest (size_t count) {
+#define VERIFY_PERF_COUNT (64)
+    uint8_t publicKeyBytes[VERIFY_PERF_COUNT][32];
+    uint8_t signatureBytes[VERIFY_PERF_COUNT][64];
+    uint8_t bodyBytes[VERIFY_PERF_COUNT][128];
+    const uint8_t * bodies[VERIFY_PERF_COUNT];
+    const uint8_t * signatures[VERIFY_PERF_COUNT];
+    const uint8_t * publicKeys[VERIFY_PERF_COUNT];
+    size_t bodySizes[VERIFY_PERF_COUNT];
+    int valid[VERIFY_PERF_COUNT];
+
+    for (size_t i = 0; i < VERIFY_PERF_COUNT; i++) {
+        uint8_t seed[32], privateKey[64];
+        arc4random_buf_brd (seed, sizeof (seed));
+        ed25519_create_keypair (publicKeyBytes[i], privateKey, seed);
+
+        arc4random_buf_brd (bodyBytes[i], sizeof (bodyBytes[i]));
+        bodySizes[i] = sizeof (bodyBytes[i]);
+        ed25519_sign (signatureBytes[i], bodyBytes[i], bodySizes[i], publicKeyBytes[i], privateKey);
+
+        bodies[i] = bodyBytes[i];
+        signatures[i] = signatureBytes[i];
+        publicKeys[i] = publicKeyBytes[i];
+    }
+
+    for (size_t batchSize = 8; batchSize <= VERIFY_PERF_COUNT; batchSize *= 2) {
+        int allValid = 1;
+
+        double start = supPerfTimeNow();
+        for (size_t n = 0; n < count; n++)
+            for (size_t i = 0; i < batchSize; i++)
+                allValid &= ed25519_verify (signatures[i], bodies[i], bodySizes[i], publicKeys[i]);
+        double sequential = supPerfTimeNow() - start;
+
+        start = supPerfTimeNow();
+        for (size_t n = 0; n < count; n++)
+            allValid &= hederaVerifySignatures (bodies, bodySizes, signatures, publicKeys, batchSize, valid);
+        double batched = supPerfTimeNow() - start;
+        assert (allValid);
+
+        printf ("ed25519 verify, %2zu signatures: %6.1f us/sig sequential, %6.1f us/sig batched (%.2fx)\n",
+                batchSize,
+                1e6 * sequential / (count * batchSize),
+                1e6 * batched    / (count * batchSize),
+                sequential / batched);
+    }
+#undef VERIFY_PERF_COUNT
+}
@@ -70,6 +70,9 @@ runTests (int reallySend);
 extern void
 runPerfTestsCoder (int repeat, int many);
 
+extern void
+runPerfTestsFrameCoder (size_t frameCount, size_t payloadSize);
+
 // Bitcoin
 typedef enum {
     BITCOIN_CHAIN_BTC,
@@ -85,6 +88,12 @@ getChainName (BRBitcoinChain chain);
 
 extern int BRRunSupTests (void);
 
+extern double supPerfTimeNow (void);
+
+extern void BRRunSupPerfTests (size_t alarms);
+
+extern void BRRunPerfTests (size_t count);
+
 extern int BRRunTests();
 
 extern int BRRunTestsSync (const char *paperKey,
@@ -120,14 +129,34 @@ runCryptoTestsWithAccountAndNetwork (BRCryptoAccount account,
                                      BRCryptoNetwork network,
                                      const char *storagePath);
 
+extern void
+runCryptoClientQRYPerfTest (size_t usedCount,
+                            unsigned int latencyInMilliseconds);
+
+extern void
+runCryptoTransactionBundlesBTCPerfTest (size_t bundlesCount);
+
+extern void
+runCryptoTransferBundleDecodePerfTest (size_t bundlesCount,
+                                       size_t counterpartiesCount);
+
 // Ripple
 extern void
 runRippleTest (void /* ... */);
 
+extern void
+runRipplePerfTest (size_t count);
+
 // Hedera
 extern void
 runHederaTest (void);
 
+extern void
+runHederaPerfTest (size_t count);
+
+extern void
+runHederaVerifyPerfTest (size_t count);
+
 // Tezos
 extern void
 runTezosTest (void);
@@ -18,6 +18,9 @@
 #include "support/BRBIP39WordsEn.h"
 #include "support/BRKey.h"
 #include "ripple/BRRipple.h"
+#include "ripple/BRRipplePrivateStructs.h"
+#include "ripple/BRRippleSerialize.h"
+#include "test.h"
 
 #include "testRippleTxList1.h"
 #include "testRippleTxList2.h"
@@ -776,6 +779,86 @@ void testRippleAddressFee() {
     rippleAddressFree(address);
 }
 
+static void
+testResignTransaction () {
+    const char * paper_key = "F603971FCF8366465537B6AD793B37BED5FF730D3764A9DC0F7F4AD911E7372C";
+    BRRippleAccount account = createTestRippleAccount(paper_key, NULL);
+    BRRippleAddress address = rippleAccountGetAddress(account);
+
+    uint8_t destBytes[] = { 0xAF, 0x65, 0x53, 0xEE, 0x2C, 0xDC, 0xA1, 0x65, 0xAB, 0x03,
+        0x75, 0xA3, 0xEF, 0xB0, 0xC7, 0x65, 0x0E, 0xA5, 0x53, 0x50 };
+    BRRippleAddress targetAddress = rippleAddressCreateFromBytes(destBytes, 20);
+
+    BRRippleFeeBasis feeBasis;
+    feeBasis.pricePerCostFactor = 10;
+    feeBasis.costFactor = 1;
+    BRRippleTransaction transaction = rippleTransactionCreate(address, targetAddress, 1000000, feeBasis);
+    rippleTransactionSetDestinationTag(transaction, 42);
+
+    UInt512 seed = UINT512_ZERO;
+    BRBIP39DeriveKey(seed.u8, paper_key, NULL);
+
+    rippleAccountSetSequence(account, 25);
+    size_t size1 = rippleAccountSignTransaction(account, transaction, seed);
+    size_t signed_size1;
+    uint8_t *signed_bytes1 = rippleTransactionSerialize(transaction, &signed_size1);
+    BRRippleTransactionHash hash1 = rippleTransactionGetHash(transaction);
+    assert(size1 == signed_size1);
+
+    // Signing again with the same sequence gives the same bytes
+    rippleAccountSetSequence(account, 25);
+    size_t size2 = rippleAccountSignTransaction(account, transaction, seed);
+    size_t signed_size2;
+    uint8_t *signed_bytes2 = rippleTransactionSerialize(transaction, &signed_size2);
+    BRRippleTransactionHash hash2 = rippleTransactionGetHash(transaction);
+    assert(size1 == size2 && signed_size1 == signed_size2);
+    assert(0 == memcmp(signed_bytes1, signed_bytes2, signed_size1));
+    assert(0 == memcmp(hash1.bytes, hash2.bytes, 32));
+
+    // ... and the bytes parse back to the same transaction
+    BRRippleTransaction parsed = rippleTransactionCreateFromBytes(signed_bytes2, (uint32_t) signed_size2);
+    BRRippleTransactionHash hash3 = rippleTransactionGetHash(parsed);
+    assert(0 == memcmp(hash1.bytes, hash3.bytes, 32));
+    assert(26 == rippleTransactionGetSequence(parsed));
+    assert(42 == rippleTransactionGetDestinationTag(parsed));
+    assert(1000000 == rippleTransactionGetAmount(parsed));
+    assert(rippleTransactionHasTarget(parsed, targetAddress));
+    rippleTransactionFree(parsed);
+
+    // Signing with the wrong seed gives other bytes, and signing again with the right seed
+    // does not keep them
+    UInt512 wrongSeed = UINT512_ZERO;
+    BRBIP39DeriveKey(wrongSeed.u8, "patient doctor olympic frog force glimpse endless antenna online dragon bargain someone", NULL);
+
+    rippleAccountSetSequence(account, 25);
+    rippleAccountSignTransaction(account, transaction, wrongSeed);
+    size_t wrong_size;
+    uint8_t *wrong_bytes = rippleTransactionSerialize(transaction, &wrong_size);
+    assert(wrong_size != signed_size1 || 0 != memcmp(signed_bytes1, wrong_bytes, signed_size1));
+    free(wrong_bytes);
+
+    rippleAccountSetSequence(account, 25);
+    rippleAccountSignTransaction(account, transaction, seed);
+    free(signed_bytes2);
+    signed_bytes2 = rippleTransactionSerialize(transaction, &signed_size2);
+    assert(signed_size1 == signed_size2);
+    assert(0 == memcmp(signed_bytes1, signed_bytes2, signed_size1));
+
+    // A new sequence is a new transaction
+    size_t size3 = rippleAccountSignTransaction(account, transaction, seed);
+    BRRippleTransactionHash hash4 = rippleTransactionGetHash(transaction);
+    assert(size3 > 0);
+    assert(0 != memcmp(hash1.bytes, hash4.bytes, 32));
+    assert(27 == rippleTransactionGetSequence(transaction));
+
+    free(signed_bytes1);
+    free(signed_bytes2);
+    rippleTransactionFree(transaction);
+    rippleAddressFree(targetAddress);
+    rippleAddressFree(address);
+    rippleAccountFree(account);
+}
+
 void rippleAccountTests()
 {
     testCreateRippleAccountWithPaperKey();
@@ -797,6 +880,7 @@ void rippleTransactionTests()
     testRippleTransaction();
     testRippleTransactionGetters();
     testSerializeWithSignature();
+    testResignTransaction();
     testTransactionId();
     testTransactionDeserialize();
     testTransactionDeserializeUnknownFields();
@@ -1118,6 +1202,84 @@ static void testStartingSequence()
 #pragma GCC diagnostic pop
 #endif // No BRRippleWallet; No BRRippleTransfer
 
+extern size_t
+rippleTransactionSerializeAndSign(BRRippleTransaction transaction, BRKey *privateKey,
+                                  BRKey *publicKey, uint32_t sequence, uint32_t lastLedgerSequence);
+
+extern int
+setFieldInfo(BRRippleField *fields, BRRippleTransaction transaction,
+             uint8_t * signature, int sig_length);
+
+// Time per payment, over `count` payments, to serialize the unsigned fields as signing does, to
+// sign new payments, to re-sign them unchanged and, for scale, to ECDSA sign alone.
+extern void
+runRipplePerfTest (size_t count) {
+    UInt256 secret;
+    for (size_t i = 0; i < sizeof(secret.u8); i++) secret.u8[i] = (uint8_t) (i + 1);
+
+    BRKey key;
+    BRKeySetSecret(&key, &secret, 1);
+    BRKeyPubKey(&key, NULL, 0);
+    BRKey publicKey = key;
+
+    uint8_t destBytes[20];
+    memset(destBytes, 0x5a, sizeof(destBytes));
+    BRRippleAddress source = rippleAddressCreateFromKey(&publicKey);
+    BRRippleAddress target = rippleAddressCreateFromBytes(destBytes, sizeof(destBytes));
+    BRRippleFeeBasis feeBasis = { 10, 1 };
+
+    BRRippleTransaction *transactions = calloc(count, sizeof(BRRippleTransaction));
+    for (size_t i = 0; i < count; i++) {
+        transactions[i] = rippleTransactionCreate(source, target, 1000000 + i, feeBasis);
+        rippleTransactionSetDestinationTag(transactions[i], (BRRippleDestinationTag) i);
+    }
+
+    size_t serializedSize = 0, signedSize = 0, resignedSize = 0;
+    uint8_t buffer[512];
+
+    double start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++) {
+        BRRippleField fields[11];
+        uint32_t num_fields = (uint32_t) setFieldInfo(fields, transactions[i], NULL, 0);
+        uint32_t size = rippleSerialize(fields, num_fields, NULL, 0);
+        assert(size <= sizeof(buffer));
+        serializedSize += rippleSerialize(fields, num_fields, buffer, size);
+    }
+    double serialize = supPerfTimeNow() - start;
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++)
+        signedSize += rippleTransactionSerializeAndSign(transactions[i], &key, &publicKey, 100 + (uint32_t) i, 0);
+    double signNew = supPerfTimeNow() - start;
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++)
+        resignedSize += rippleTransactionSerializeAndSign(transactions[i], &key, &publicKey, 100 + (uint32_t) i, 0);
+    double signAgain = supPerfTimeNow() - start;
+
+    assert(serializedSize > 0 && signedSize == resignedSize);
+
+    uint8_t sig[72];
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < count; i++) {
+        UInt256 md = UINT256_ZERO;
+        UInt64SetLE(md.u8, i + 1);
+        BRKeySign(&key, sig, sizeof(sig), md);
+    }
+    double ecdsa = supPerfTimeNow() - start;
+
+    printf("rippleSerialize, unsigned payment:           %7.2f us/payment\n", 1e6 * serialize / count);
+    printf("rippleTransactionSerializeAndSign, new:      %7.2f us/payment\n", 1e6 * signNew   / count);
+    printf("rippleTransactionSerializeAndSign, re-sign:  %7.2f us/payment\n", 1e6 * signAgain / count);
+    printf("BRKeySign:                                   %7.2f us/payment\n", 1e6 * ecdsa     / count);
+
+    for (size_t i = 0; i < count; i++)
+        rippleTransactionFree(transactions[i]);
+    free(transactions);
+    rippleAddressFree(target);
+    rippleAddressFree(source);
+}
+
 extern void
 runRippleTest (void /* ... */) {
 
@@ -16,10 +16,12 @@
 #include <unistd.h>
 #include <assert.h>
 #include <string.h>
+#include <time.h>
 
 #include "support/BRFileService.h"
 #include "support/BRAssert.h"
 #include "support/BROSCompat.h"
+#include "support/event/BREventAlarm.h"
 
 /// MARK: - File Service Tests
 
@@ -517,6 +519,75 @@ runSupAssertTests (void) {
     return success;
 }
 
+/// MARK: - Perf Support
+
+/// Return a monotonic time, in seconds, for measuring elapsed times in perf tests
+extern double
+supPerfTimeNow (void) {
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+}
+
+/// MARK: - Alarm Clock Perf
+
+static struct {
+    size_t expirations;
+    double latenessTotal;
+    double latenessMax;
+} supAlarmPerf;
+
+static void
+supAlarmPerfCallback (BREventAlarmContext context,
+                      struct timespec expiration,
+                      BREventAlarmClock clock) {
+    // Alarm expirations are in `gettimeofday()` time
+    struct timeval now;
+    gettimeofday (&now, NULL);
+
+    double lateness = ((double) (now.tv_sec - expiration.tv_sec) +
+                       1e-6 * (double) now.tv_usec - 1e-9 * (double) expiration.tv_nsec);
+
+    supAlarmPerf.expirations   += 1;
+    supAlarmPerf.latenessTotal += lateness;
+    if (lateness > supAlarmPerf.latenessMax) supAlarmPerf.latenessMax = lateness;
+}
+
+/// Run `alarms` periodic alarms, each with a one second period, for a few seconds; report the
+/// add/remove rates, the expiration rate and how late, on average and at worst, alarms expire.
+extern void
+BRRunSupPerfTests (size_t alarms) {
+    BREventAlarmClock clock = alarmClockCreate();
+    BREventAlarmId *identifiers = calloc (alarms, sizeof (BREventAlarmId));
+    struct timespec period = { 1, 0 };
+    unsigned int duration = 5;
+    double start;
+
+    memset (&supAlarmPerf, 0, sizeof (supAlarmPerf));
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < alarms; i++)
+        identifiers[i] = alarmClockAddAlarmPeriodic (clock, NULL, supAlarmPerfCallback, period);
+    printf("alarmClockAddAlarmPeriodic: %10.0f/s\n", alarms/(supPerfTimeNow() - start));
+
+    alarmClockStart (clock);
+    sleep (duration);
+    alarmClockStop (clock);
+
+    printf("alarmClock Expirations:     %10.0f/s, late: %.3f ms avg, %.3f ms max\n",
+           supAlarmPerf.expirations / (double) duration,
+           1e3 * supAlarmPerf.latenessTotal / (double) (supAlarmPerf.expirations > 0 ? supAlarmPerf.expirations : 1),
+           1e3 * supAlarmPerf.latenessMax);
+
+    start = supPerfTimeNow();
+    for (size_t i = 0; i < alarms; i++)
+        alarmClockRemAlarm (clock, identifiers[i]);
+    printf("alarmClockRemAlarm:         %10.0f/s\n", alarms/(supPerfTimeNow() - start));
+
+    alarmClockDestroy (clock);
+    free (identifiers);
+}
+
 ///
 /// Support Tests
 ///
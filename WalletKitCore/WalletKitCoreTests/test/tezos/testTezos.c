@@ -157,6 +157,50 @@ testCreateTezosAccountWithSerializedAccount() {
     free(serializedAccount);
 }
 
+static void
+testVerifySignatures() {
+    BRTezosAccount account = makeAccount(testAccount1);
+    UInt512 seed = getSeed(testAccount1);
+    BRKey publicKey = tezosAccountGetPublicKey(account);
+
+#define VERIFY_COUNT (10)
+    uint8_t messageBytes[VERIFY_COUNT][40];
+    BRCryptoData data[VERIFY_COUNT];
+    BRCryptoData signatures[VERIFY_COUNT];
+    const uint8_t *publicKeys[VERIFY_COUNT];
+    int valid[VERIFY_COUNT];
+
+    for (size_t i = 0; i < VERIFY_COUNT; i++) {
+        memset (messageBytes[i], (int) i, sizeof (messageBytes[i]));
+        data[i] = (BRCryptoData) { messageBytes[i], 1 + 3 * i };
+        signatures[i] = tezosAccountSignData (account, data[i], seed);
+        publicKeys[i] = publicKey.pubKey;
+    }
+
+    assert (1 == tezosAccountVerifySignatures (data, signatures, publicKeys, VERIFY_COUNT, valid));
+    for (size_t i = 0; i < VERIFY_COUNT; i++) assert (1 == valid[i]);
+
+    // a single bad signature fails the batch and is the only one reported
+    signatures[4].bytes[10] ^= 0x01;
+    assert (0 == tezosAccountVerifySignatures (data, signatures, publicKeys, VERIFY_COUNT, valid));
+    for (size_t i = 0; i < VERIFY_COUNT; i++) assert ((4 != i) == valid[i]);
+    signatures[4].bytes[10] ^= 0x01;
+
+    // as does a signature over different data
+    messageBytes[7][0] ^= 0x01;
+    assert (0 == tezosAccountVerifySignatures (data, signatures, publicKeys, VERIFY_COUNT, valid));
+    for (size_t i = 0; i < VERIFY_COUNT; i++) assert ((7 != i) == valid[i]);
+    messageBytes[7][0] ^= 0x01;
+
+    assert (1 == tezosAccountVerifySignatures (data, signatures, publicKeys, 1, valid));
+    assert (1 == valid[0]);
+
+    for (size_t i = 0; i < VERIFY_COUNT; i++) cryptoDataFree (signatures[i]);
+#undef VERIFY_COUNT
+
+    tezosAccountFree(account);
+}
+
 // MARK: - Address Tests
 
 static void testAddressCreate() {
@@ -475,6 +519,20 @@ testBatchOperationSerialize() {
     bin2HexString(unsignedBytes.bytes, unsignedBytes.size, serializedHex);
     assert (0 == strcasecmp("f3b761a633b2b0cc9d2edbb09cda4800818f893b3d6567b09a818f1a5f685fb86b004cdee21a9180f80956ab8d27fb6abdbd89934052949a0303d84f0000efc82a1445744a87fec55fce35e1b7ec80f9bbed9df2a03bcdde1a346f3d42946c004cdee21a9180f80956ab8d27fb6abdbd89934052949a0303d84f0080c2d72f0000d2e495a7ab40156d0a7c35b73d2530a3470fc87000", serializedHex));
     
+    // caller-provided buffer: size query, too small, exact fit
+    uint8_t serializedBytes[256];
+    size_t serializedSize = tezosSerializeOperationListInto(opList, opCount, lastBlockHash, NULL, 0);
+    assert (serializedSize == unsignedBytes.size);
+    memset (serializedBytes, 0xaa, sizeof(serializedBytes));
+    assert (serializedSize == tezosSerializeOperationListInto(opList, opCount, lastBlockHash, serializedBytes, serializedSize - 1));
+    assert (0xaa == serializedBytes[0]);
+    assert (serializedSize == tezosSerializeOperationListInto(opList, opCount, lastBlockHash, serializedBytes, serializedSize));
+    assert (0 == memcmp (serializedBytes, unsignedBytes.bytes, serializedSize));
+    
+    // the operation list tail is the transaction op
+    size_t txSize = tezosSerializeTransactionInto(tx, serializedBytes, sizeof(serializedBytes));
+    assert (0 == memcmp (serializedBytes, &unsignedBytes.bytes[unsignedBytes.size - txSize], txSize));
+    
     tezosTransferFree(transfer);
     tezosTransactionFree(reveal);
     cryptoDataFree(unsignedBytes);
@@ -530,6 +588,29 @@ testTransactionSign() {
     BRBase58CheckEncode(hashString, sizeof(hashString), hash.bytes, sizeof(hash.bytes));
     assert (0 == strcmp ("ooRC21UA17amABZekMapQJkn1cZEiqcffGNtZXtBeUW5rMiJBGR", hashString));
     
+    // the signed size feeds back into the fee, changing the forged bytes; once the size is stable,
+    // re-serializing reuses the forged bytes and gives the same bytes and hash
+    size_t resignedSize = 0;
+    for (size_t i = 0; i < 4 && resignedSize != signedSize; i++) {
+        resignedSize = signedSize;
+        signedSize = tezosTransactionSerializeAndSign(tx, account, seed, lastBlockHash, 0);
+    }
+    assert (resignedSize == signedSize);
+    
+    BRTezosHash hash2 = tezosTransactionGetHash(tx);
+    assert (0 != memcmp (hash.bytes, hash2.bytes, sizeof(hash.bytes)));
+    tezosTransactionSerializeAndSign(tx, account, seed, lastBlockHash, 0);
+    BRTezosHash hash3 = tezosTransactionGetHash(tx);
+    assert (0 == memcmp (hash2.bytes, hash3.bytes, sizeof(hash.bytes)));
+    
+    // the empty signature changes the hash; signing again restores it
+    tezosTransactionSerializeForFeeEstimation(tx, account, lastBlockHash, 0);
+    BRTezosHash hash4 = tezosTransactionGetHash(tx);
+    assert (0 != memcmp (hash3.bytes, hash4.bytes, sizeof(hash.bytes)));
+    tezosTransactionSerializeAndSign(tx, account, seed, lastBlockHash, 0);
+    BRTezosHash hash5 = tezosTransactionGetHash(tx);
+    assert (0 == memcmp (hash3.bytes, hash5.bytes, sizeof(hash.bytes)));
+    
     tezosAddressFree(targetAddress);
     tezosAddressFree(sourceAddress);
     tezosTransferFree(transfer);
@@ -596,6 +677,7 @@ static void
 tezosAccountTests() {
     testCreateTezosAccountWithSeed();
     testCreateTezosAccountWithSerializedAccount();
+    testVerifySignatures();
 }
 
 static void
@@ -57,6 +57,37 @@ cryptoListenerCreate (BRCryptoListenerContext context,
                       BRCryptoListenerWalletCallback walletCallback,
                       BRCryptoListenerTransferCallback transferCallback);
 
+/**
+ * Signal the boundaries of a batch of coalesced events.  With `begin` as CRYPTO_TRUE, the next
+ * `eventsCount` events delivered to the listener's callbacks form one batch; with `begin` as
+ * CRYPTO_FALSE, that batch has been delivered.
+ */
+typedef void (*BRCryptoListenerBatchCallback) (BRCryptoListenerContext context,
+                                               BRCryptoBoolean begin,
+                                               size_t eventsCount);
+
+/**
+ * Optionally coalesce events before they are delivered to the listener's callbacks.  Events are
+ * held for up to `windowInMilliseconds`, or until `batchLimit` are held, and then delivered in
+ * order as a batch, between a `batchCallback` begin and end.  While held, an event that is
+ * superseded by a later event for the same object is merged into the later event, which keeps
+ * its place in the batch, after every event held before it:
+ *   - wallet BALANCE_UPDATED and FEE_BASIS_UPDATED keep only the latest, per wallet;
+ *   - transfer CHANGED is merged into one, from the first `old` to the last `new` state;
+ *   - manager SYNC_CONTINUES and BLOCK_HEIGHT_UPDATED keep only the latest, per manager.
+ * Events are never merged across a CREATED or DELETED event for the same object.  Stopping the
+ * listener discards the events held, as it does the events queued for delivery.
+ *
+ * This must be called before the listener is started, that is, before `cryptoSystemStart()`.
+ * A `windowInMilliseconds` of 0, the default, delivers every event individually, without any
+ * batch signals.  The `batchCallback` may be NULL.
+ */
+extern void
+cryptoListenerSetCoalescing (BRCryptoListener listener,
+                             unsigned int windowInMilliseconds,
+                             size_t batchLimit,
+                             BRCryptoListenerBatchCallback batchCallback);
+
 
 DECLARE_CRYPTO_GIVE_TAKE (BRCryptoListener, cryptoListener);
 
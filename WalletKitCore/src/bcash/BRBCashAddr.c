@@ -39,6 +39,18 @@
     (-(((x) >> 36) & 1) & 0x79b76d99e2) ^ (-(((x) >> 37) & 1) & 0xf33e5fb3c4) ^\
     (-(((x) >> 38) & 1) & 0xae2eabe2a8) ^ (-(((x) >> 39) & 1) & 0x1e4f43e470))
 
+// the cashaddr digit values of either case, or -1 for an invalid character
+static const int8_t cashAddrDigits[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    15, -1, 10, 17, 21, 20, 26, 30,  7,  5, -1, -1, -1, -1, -1, -1,
+    -1, 29, -1, 24, 13, 25,  9,  8, 23, -1, 18, 22, 31, 27, 19, -1,
+     1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1,
+    -1, 29, -1, 24, 13, 25,  9,  8, 23, -1, 18, 22, 31, 27, 19, -1,
+     1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1
+};
+
 // returns the number of bytes written to data21 (maximum of 21)
 static size_t _BRBCashAddrDecode(char *hrp12, uint8_t *data21, const char *addr)
 {
@@ -63,17 +75,8 @@ static size_t _BRBCashAddrDecode(char *hrp12, uint8_t *data21, const char *addr)
     memset(buf, 0, sizeof(buf));
     
     for (i = sep + 1, j = 0; i < addrLen; i++, j++) {
-        switch (tolower(addr[i])) {
-            case 'q': c = 0;  break; case 'p': c = 1;  break; case 'z': c = 2;  break; case 'r': c = 3;  break;
-            case 'y': c = 4;  break; case '9': c = 5;  break; case 'x': c = 6;  break; case '8': c = 7;  break;
-            case 'g': c = 8;  break; case 'f': c = 9;  break; case '2': c = 10; break; case 't': c = 11; break;
-            case 'v': c = 12; break; case 'd': c = 13; break; case 'w': c = 14; break; case '0': c = 15; break;
-            case 's': c = 16; break; case '3': c = 17; break; case 'j': c = 18; break; case 'n': c = 19; break;
-            case '5': c = 20; break; case '4': c = 21; break; case 'k': c = 22; break; case 'h': c = 23; break;
-            case 'c': c = 24; break; case 'e': c = 25; break; case '6': c = 26; break; case 'm': c = 27; break;
-            case 'u': c = 28; break; case 'a': c = 29; break; case '7': c = 30; break; case 'l': c = 31; break;
-            default: return 0; // invalid bech32 digit
-        }
+        if (cashAddrDigits[(uint8_t)addr[i]] < 0) return 0; // invalid bech32 digit
+        c = (uint8_t)cashAddrDigits[(uint8_t)addr[i]];
         
         chk = polymod(chk) ^ c;
         if (j >= 35 || i + 8 >= addrLen) continue;
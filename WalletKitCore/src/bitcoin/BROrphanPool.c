@@ -0,0 +1,143 @@
+//
+//  BROrphanPool.c
+//
+//  Split out of BRPeerManager.c.
+//  Copyright (c) 2015-2026 breadwallet LLC.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#include "BROrphanPool.h"
+#include <stdlib.h>
+#include <assert.h>
+
+inline static size_t _BROrphanHash(const void *orphan)
+{
+    return BRMerkleBlockHash(((const BROrphan *)orphan)->block);
+}
+
+inline static int _BROrphanEq(const void *orphan, const void *otherOrphan)
+{
+    return BRMerkleBlockEq(((const BROrphan *)orphan)->block, ((const BROrphan *)otherOrphan)->block);
+}
+
+inline static size_t _BROrphanPrevBlockHash(const void *orphan)
+{
+    return (size_t)((const BROrphan *)orphan)->block->prevBlock.u32[0];
+}
+
+inline static int _BROrphanPrevBlockEq(const void *orphan, const void *otherOrphan)
+{
+    return UInt256Eq(((const BROrphan *)orphan)->block->prevBlock, ((const BROrphan *)otherOrphan)->block->prevBlock);
+}
+
+void BROrphanPoolInit(BROrphanPool *pool)
+{
+    pool->byHash = BRSetNew(_BROrphanHash, _BROrphanEq, 100);
+    pool->byPrevBlock = BRSetNew(_BROrphanPrevBlockHash, _BROrphanPrevBlockEq, 100);
+    pool->oldest = pool->newest = NULL;
+}
+
+// removes orphan from the pool, leaving its block to the caller
+static BRMerkleBlock *_BROrphanPoolUnlink(BROrphanPool *pool, BROrphan *orphan)
+{
+    BRMerkleBlock *block = orphan->block;
+    BROrphan *o = BRSetGet(pool->byPrevBlock, orphan);
+
+    if (o == orphan) { // replace the head of the prevBlock's siblings with the next one, if any
+        BRSetRemove(pool->byPrevBlock, orphan);
+        if (orphan->sibling) BRSetAdd(pool->byPrevBlock, orphan->sibling);
+    }
+    else {
+        while (o && o->sibling != orphan) o = o->sibling;
+        if (o) o->sibling = orphan->sibling;
+    }
+
+    BRSetRemove(pool->byHash, orphan);
+    if (orphan->older) orphan->older->newer = orphan->newer;
+    else pool->oldest = orphan->newer;
+    if (orphan->newer) orphan->newer->older = orphan->older;
+    else pool->newest = orphan->older;
+    free(orphan);
+    return block;
+}
+
+// adds block to the pool, first evicting orphans older than ORPHANS_MAX_AGE and the oldest beyond ORPHANS_MAX_COUNT;
+// returns false, without taking block, if the pool already has it
+int BROrphanPoolAdd(BROrphanPool *pool, BRMerkleBlock *block, time_t now)
+{
+    BROrphan *orphan = &(BROrphan) { block }, *o;
+
+    if (BRSetContains(pool->byHash, orphan)) return 0;
+
+    while (pool->oldest && (BRSetCount(pool->byHash) >= ORPHANS_MAX_COUNT ||
+                            pool->oldest->timestamp + ORPHANS_MAX_AGE <= now)) {
+        BRMerkleBlockFree(_BROrphanPoolUnlink(pool, pool->oldest));
+    }
+
+    orphan = calloc(1, sizeof(*orphan));
+    assert(orphan != NULL);
+    orphan->block = block;
+    orphan->timestamp = now;
+    orphan->older = pool->newest;
+    if (pool->newest) pool->newest->newer = orphan;
+    else pool->oldest = orphan;
+    pool->newest = orphan;
+    BRSetAdd(pool->byHash, orphan);
+
+    o = BRSetGet(pool->byPrevBlock, orphan);
+    if (o) orphan->sibling = o->sibling, o->sibling = orphan; // another block with the same parent, i.e. a fork
+    else BRSetAdd(pool->byPrevBlock, orphan);
+    return 1;
+}
+
+// removes block from the pool, returns true if it was there
+int BROrphanPoolRemove(BROrphanPool *pool, const BRMerkleBlock *block)
+{
+    BROrphan *orphan = BRSetGet(pool->byHash, &(BROrphan) { (BRMerkleBlock *)block });
+
+    if (! orphan || orphan->block != block) return 0;
+    _BROrphanPoolUnlink(pool, orphan);
+    return 1;
+}
+
+// removes and returns an orphan whose parent is blockHash, or NULL if there is none
+BRMerkleBlock *BROrphanPoolTakeChild(BROrphanPool *pool, UInt256 blockHash)
+{
+    BRMerkleBlock key;
+    BROrphan *orphan;
+
+    key.prevBlock = blockHash;
+    orphan = BRSetGet(pool->byPrevBlock, &(BROrphan) { &key });
+    return (orphan) ? _BROrphanPoolUnlink(pool, orphan) : NULL;
+}
+
+// frees all orphan blocks in the pool
+void BROrphanPoolClear(BROrphanPool *pool)
+{
+    while (pool->oldest) BRMerkleBlockFree(_BROrphanPoolUnlink(pool, pool->oldest));
+}
+
+// frees all orphan blocks and memory allocated for the pool
+void BROrphanPoolFree(BROrphanPool *pool)
+{
+    BROrphanPoolClear(pool);
+    BRSetFree(pool->byHash);
+    BRSetFree(pool->byPrevBlock);
+    pool->byHash = pool->byPrevBlock = NULL;
+}
@@ -0,0 +1,75 @@
+//
+//  BROrphanPool.h
+//
+//  Split out of BRPeerManager.c.
+//  Copyright (c) 2015-2026 breadwallet LLC.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#ifndef BROrphanPool_h
+#define BROrphanPool_h
+
+#include "BRMerkleBlock.h"
+#include "support/BRSet.h"
+#include "support/BRInt.h"
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ORPHANS_MAX_COUNT 1000    // orphan blocks kept before the oldest are evicted
+#define ORPHANS_MAX_AGE   (60*60) // seconds an orphan block is kept waiting for its parent
+
+typedef struct _BROrphan {
+    BRMerkleBlock *block; // must be first, orphans are indexed through their block
+    time_t timestamp; // time the orphan was received
+    struct _BROrphan *sibling; // next orphan with the same prevBlock
+    struct _BROrphan *older, *newer;
+} BROrphan;
+
+// orphan blocks indexed by blockHash and by prevBlock, linked oldest to newest for eviction
+typedef struct {
+    BRSet *byHash, *byPrevBlock;
+    BROrphan *oldest, *newest;
+} BROrphanPool;
+
+void BROrphanPoolInit(BROrphanPool *pool);
+
+// adds block to the pool, first evicting orphans older than ORPHANS_MAX_AGE and the oldest beyond ORPHANS_MAX_COUNT;
+// returns false, without taking block, if the pool already has it
+int BROrphanPoolAdd(BROrphanPool *pool, BRMerkleBlock *block, time_t now);
+
+// removes block from the pool, returns true if it was there
+int BROrphanPoolRemove(BROrphanPool *pool, const BRMerkleBlock *block);
+
+// removes and returns an orphan whose parent is blockHash, or NULL if there is none
+BRMerkleBlock *BROrphanPoolTakeChild(BROrphanPool *pool, UInt256 blockHash);
+
+// frees all orphan blocks in the pool
+void BROrphanPoolClear(BROrphanPool *pool);
+
+// frees all orphan blocks and memory allocated for the pool
+void BROrphanPoolFree(BROrphanPool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BROrphanPool_h
@@ -38,7 +38,7 @@
 #define PROTOBUF_32BIT    5 // fixed32, sfixed32, float
 
 typedef struct {
-    uint8_t *defaults;
+    uint8_t defaults[16]; // indexed by field key, set for fields that were not present and are not serialized
     uint8_t *unknown;
 } ProtoBufContext;
 
@@ -74,8 +74,8 @@ static const uint8_t *_ProtoBufLenDelim(const uint8_t *buf, size_t *len, size_t
     const uint8_t *data = NULL;
     size_t dataLen = (size_t)_ProtoBufVarInt(buf, *len, off);
     
-    if (buf && *off + dataLen <= *len) data = &buf[*off];
-    *off += dataLen;
+    if (buf && *off <= *len && dataLen <= *len - *off) data = &buf[*off];
+    *off = (dataLen <= SIZE_MAX - *off) ? *off + dataLen : SIZE_MAX;
     *len = dataLen;
     return data;
 }
@@ -89,6 +89,13 @@ static void _ProtoBufSetLenDelim(uint8_t *buf, size_t bufLen, const void *data,
     }
 }
 
+// writes the key and length of a length delimited field, the caller then writes len bytes of field data at *off
+static void _ProtoBufSetLenDelimKey(uint8_t *buf, size_t bufLen, uint64_t key, size_t len, size_t *off)
+{
+    _ProtoBufSetVarInt(buf, bufLen, (key << 3) | PROTOBUF_LENDELIM, off);
+    _ProtoBufSetVarInt(buf, bufLen, len, off);
+}
+
 // the following fixed int functions are not used by payment protocol, and only work for parsing/serializing unknown
 // fields - the values returned or set are unconverted raw byte values
 static uint64_t _ProtoBufFixed(const uint8_t *buf, size_t bufLen, size_t *off, size_t size)
@@ -123,6 +130,28 @@ static uint64_t _ProtoBufField(uint64_t *i, const uint8_t **data, const uint8_t
     return key;
 }
 
+// true if the field read from buf[start..off) is encoded exactly as it would be serialized: with minimal varints, a
+// known wire type, and nothing truncated
+static int _ProtoBufFieldIsCanonical(const uint8_t *buf, size_t bufLen, size_t start, size_t off, uint64_t key,
+                                     uint64_t i, const uint8_t *data, size_t dataLen)
+{
+    uint8_t hdr[20];
+    size_t hdrLen = 0;
+    
+    if ((key >> 3) == 0 || off > bufLen) return 0;
+    _ProtoBufSetVarInt(hdr, sizeof(hdr), key, &hdrLen);
+    
+    switch (key & 0x07) {
+        case PROTOBUF_VARINT: _ProtoBufSetVarInt(hdr, sizeof(hdr), i, &hdrLen), dataLen = 0; break;
+        case PROTOBUF_64BIT: dataLen = sizeof(uint64_t); break;
+        case PROTOBUF_LENDELIM: if (! data) return 0; _ProtoBufSetVarInt(hdr, sizeof(hdr), dataLen, &hdrLen); break;
+        case PROTOBUF_32BIT: dataLen = sizeof(uint32_t); break;
+        default: return 0;
+    }
+    
+    return (start + hdrLen + dataLen == off && memcmp(&buf[start], hdr, hdrLen) == 0);
+}
+
 static void _ProtoBufString(char **str, const void *data, size_t dataLen)
 {
     if (data || dataLen == 0) {
@@ -165,9 +194,10 @@ static void _ProtoBufSetInt(uint8_t *buf, size_t bufLen, uint64_t i, uint64_t ke
     _ProtoBufSetVarInt(buf, bufLen, i, off);
 }
 
+// adds a field to the unknown fields, which are kept in ascending key order, replacing any field with the same key
 static void _ProtoBufUnknown(uint8_t **unknown, uint64_t key, uint64_t i, const void *data, size_t dataLen)
 {
-    size_t bufLen = 10 + ((key & 0x07) == PROTOBUF_LENDELIM ? dataLen : 0);
+    size_t bufLen = 20 + ((key & 0x07) == PROTOBUF_LENDELIM && data ? dataLen : 0); // key and value varints
     uint8_t _buf[(bufLen <= 0x1000) ? bufLen : 0], *buf = (bufLen <= 0x1000) ? _buf : malloc(bufLen);
     size_t off = 0, o = 0, l;
     uint64_t k;
@@ -193,6 +223,7 @@ static void _ProtoBufUnknown(uint8_t **unknown, uint64_t key, uint64_t i, const
         k = _ProtoBufField(NULL, NULL, *unknown, &l, &off);
         if (k == key) array_rm_range(*unknown, o, off - o);
         if (k >= key) break;
+        o = off; // after every field with a lower key
     }
     
     array_insert_array(*unknown, o, buf, bufLen);
@@ -268,51 +299,55 @@ typedef enum {
     encrypted_msg_status_msg = 9
 } encrypted_msg_key;
 
+// copies script to out with context stored at end of script data, in a single allocation
+static void _BRPaymentProtocolOutputSetScript(BRTxOutput *out, const uint8_t *script, size_t scriptLen,
+                                              const ProtoBufContext *ctx)
+{
+    array_new(out->script, scriptLen + sizeof(*ctx));
+    if (scriptLen > 0) array_add_array(out->script, script, scriptLen);
+    array_add_array(out->script, (const uint8_t *)ctx, sizeof(*ctx));
+    out->scriptLen = scriptLen;
+}
+
 static BRTxOutput _BRPaymentProtocolOutput(uint64_t amount, uint8_t *script, size_t scriptLen)
 {
     BRTxOutput out = BR_TX_OUTPUT_NONE;
-    ProtoBufContext ctx = { NULL, NULL };
+    ProtoBufContext ctx = { { 0 }, NULL };
     
     assert(script != NULL || scriptLen == 0);
     
-    array_new(ctx.defaults, output_script + 1);
-    array_set_count(ctx.defaults, output_script + 1);
     out.amount = amount;
-    BRTxOutputSetScript(&out, script, scriptLen);
-    if (! out.script) array_new(out.script, sizeof(ctx));
-    array_add_array(out.script, (uint8_t *)&ctx, sizeof(ctx)); // store context at end of script data
+    _BRPaymentProtocolOutputSetScript(&out, script, scriptLen, &ctx);
     return out;
 }
 
 static BRTxOutput _BRPaymentProtocolOutputParse(const uint8_t *buf, size_t bufLen)
 {
     BRTxOutput out = BR_TX_OUTPUT_NONE;
-    ProtoBufContext ctx = { NULL, NULL };
-    size_t off = 0;
+    ProtoBufContext ctx = { { 0 }, NULL };
+    const uint8_t *script = NULL;
+    size_t off = 0, scriptLen = 0;
 
-    array_new(ctx.defaults, output_script + 1);
-    array_set_count(ctx.defaults, output_script + 1);
     out.amount = 0;
     ctx.defaults[output_amount] = 1;
     
-    while (off < bufLen) {
+    while (buf && off < bufLen) {
         const uint8_t *data = NULL;
         size_t dataLen = bufLen;
         uint64_t i = 0, key = _ProtoBufField(&i, &data, buf, &dataLen, &off);
         
         switch (key >> 3) {
             case output_amount: out.amount = i, ctx.defaults[output_amount] = 0; break;
-            case output_script: BRTxOutputSetScript(&out, data, dataLen); break;
+            case output_script: script = data, scriptLen = dataLen; break; // copied once all fields are read
             default: _ProtoBufUnknown(&ctx.unknown, key, i, data, dataLen); break;
         }
     }
 
-    if (! out.script) { // required
+    if (! script) { // required
         out = BR_TX_OUTPUT_NONE;
-        if (ctx.defaults) array_free(ctx.defaults);
         if (ctx.unknown) array_free(ctx.unknown);
     }
-    else array_add_array(out.script, (uint8_t *)&ctx, sizeof(ctx)); // store context at end of script data
+    else _BRPaymentProtocolOutputSetScript(&out, script, scriptLen, &ctx);
 
     return out;
 }
@@ -342,12 +377,80 @@ static void _BRPaymentProtocolOutputFree(BRTxOutput out)
 
     if (out.script) {
         memcpy(&ctx, &out.script[out.scriptLen], sizeof(ctx));
-        if (ctx.defaults) array_free(ctx.defaults);
         if (ctx.unknown) array_free(ctx.unknown);
         BRTxOutputSetScript(&out, NULL, 0);
     }
 }
 
+// reads a serialized output in place, returns true if it has the required script
+// isCanonical is set to true if _BRPaymentProtocolOutputParse() followed by serializing would reproduce buf exactly
+static int _BRPaymentProtocolOutputView(const uint8_t *buf, size_t bufLen, uint64_t *amount, const uint8_t **script,
+                                        size_t *scriptLen, int *isCanonical)
+{
+    size_t start, off = 0;
+    uint64_t last = 0;
+    
+    *amount = 0, *script = NULL, *scriptLen = 0, *isCanonical = 1;
+    
+    while (buf && off < bufLen) {
+        const uint8_t *data = NULL;
+        size_t dataLen = bufLen;
+        uint64_t i = 0, key;
+        
+        start = off;
+        key = _ProtoBufField(&i, &data, buf, &dataLen, &off);
+        if (! _ProtoBufFieldIsCanonical(buf, bufLen, start, off, key, i, data, dataLen)) *isCanonical = 0;
+        if ((key >> 3) <= last) *isCanonical = 0; // fields must be in order, without repeats
+        last = key >> 3;
+        
+        switch (key >> 3) {
+            case output_amount: *amount = i; if ((key & 0x07) != PROTOBUF_VARINT) *isCanonical = 0; break;
+            case output_script: *script = data, *scriptLen = dataLen; break;
+            default: break;
+        }
+    }
+    
+    if (! *script) *isCanonical = 0, *scriptLen = 0;
+    return (*script != NULL);
+}
+
+// true if BRPaymentProtocolDetailsParse() followed by BRPaymentProtocolDetailsSerialize() would reproduce buf exactly
+static int _BRPaymentProtocolDetailsIsCanonical(const uint8_t *buf, size_t bufLen)
+{
+    static const uint8_t wireTypes[] = { 0, PROTOBUF_LENDELIM, PROTOBUF_LENDELIM, PROTOBUF_VARINT, PROTOBUF_VARINT,
+                                         PROTOBUF_LENDELIM, PROTOBUF_LENDELIM, PROTOBUF_LENDELIM };
+    const uint8_t *script;
+    size_t start, off = 0, scriptLen;
+    uint64_t last = 0, amount;
+    int isCanonical;
+    
+    while (buf && off < bufLen) {
+        const uint8_t *data = NULL;
+        size_t dLen = bufLen;
+        uint64_t i = 0, key;
+        
+        start = off;
+        key = _ProtoBufField(&i, &data, buf, &dLen, &off);
+        if (! _ProtoBufFieldIsCanonical(buf, bufLen, start, off, key, i, data, dLen)) return 0;
+        if ((key >> 3) < last || ((key >> 3) == last && last != details_outputs)) return 0;
+        if ((key >> 3) < sizeof(wireTypes) && (key & 0x07) != wireTypes[key >> 3]) return 0;
+        last = key >> 3;
+        
+        switch (key >> 3) {
+            case details_network: // fall through
+            case details_memo: // fall through
+            case details_payment_url: if (memchr(data, '\0', dLen)) return 0; break;
+            case details_outputs:
+                if (! _BRPaymentProtocolOutputView(data, dLen, &amount, &script, &scriptLen, &isCanonical)) return 0;
+                if (! isCanonical) return 0;
+                break;
+            default: break;
+        }
+    }
+    
+    return 1;
+}
+
 // returns a newly allocated details struct that must be freed by calling BRPaymentProtocolDetailsFree()
 BRPaymentProtocolDetails *BRPaymentProtocolDetailsNew(const char *network, const BRTxOutput outputs[], size_t outCount,
                                                       uint64_t time, uint64_t expires, const char *memo,
@@ -360,9 +463,6 @@ BRPaymentProtocolDetails *BRPaymentProtocolDetailsNew(const char *network, const
     assert(details != NULL);
     assert(outputs != NULL || outCount == 0);
     
-    array_new(ctx->defaults, details_merch_data + 1);
-    array_set_count(ctx->defaults, details_merch_data + 1);
-
     if (! network) {
         _ProtoBufString(&details->network, "main", strlen("main"));
         ctx->defaults[details_network] = 1;
@@ -396,8 +496,6 @@ BRPaymentProtocolDetails *BRPaymentProtocolDetailsParse(const uint8_t *buf, size
     assert(details != NULL);
     assert(buf != NULL || bufLen == 0);
 
-    array_new(ctx->defaults, details_merch_data + 1);
-    array_set_count(ctx->defaults, details_merch_data + 1);
     ctx->defaults[details_time] = 1;
     ctx->defaults[details_expires] = 1;
     array_new(details->outputs, 1);
@@ -436,23 +534,19 @@ BRPaymentProtocolDetails *BRPaymentProtocolDetailsParse(const uint8_t *buf, size
 size_t BRPaymentProtocolDetailsSerialize(const BRPaymentProtocolDetails *details, uint8_t *buf, size_t bufLen)
 {
     const ProtoBufContext *ctx = (const ProtoBufContext *)&details[1];
-    size_t i, off = 0, outLen = 0x100, l;
-    uint8_t *outBuf = malloc(outLen);
+    size_t i, off = 0, l;
 
-    assert(outBuf != NULL);
     assert(details != NULL);
     
     if (! ctx->defaults[details_network]) _ProtoBufSetString(buf, bufLen, details->network, details_network, &off);
     
-    for (i = 0; i < details->outCount; i++) {
+    for (i = 0; i < details->outCount; i++) { // outputs are serialized directly into buf
         l = _BRPaymentProtocolOutputSerialize(details->outputs[i], NULL, 0);
-        if (l > outLen) outBuf = realloc(outBuf, (outLen = l));
-        assert(outBuf != NULL);
-        l = _BRPaymentProtocolOutputSerialize(details->outputs[i], outBuf, outLen);
-        _ProtoBufSetBytes(buf, bufLen, outBuf, l, details_outputs, &off);
+        _ProtoBufSetLenDelimKey(buf, bufLen, details_outputs, l, &off);
+        if (buf && off + l <= bufLen) _BRPaymentProtocolOutputSerialize(details->outputs[i], &buf[off], l);
+        off += l;
     }
 
-    free(outBuf);
     if (! ctx->defaults[details_time]) _ProtoBufSetInt(buf, bufLen, details->time, details_time, &off);
     if (! ctx->defaults[details_expires]) _ProtoBufSetInt(buf, bufLen, details->expires, details_expires, &off);
     if (details->memo) _ProtoBufSetString(buf, bufLen, details->memo, details_memo, &off);
@@ -481,7 +575,6 @@ void BRPaymentProtocolDetailsFree(BRPaymentProtocolDetails *details)
     if (details->memo) array_free(details->memo);
     if (details->paymentURL) array_free(details->paymentURL);
     if (details->merchantData) array_free(details->merchantData);
-    if (ctx->defaults) array_free(ctx->defaults);
     if (ctx->unknown) array_free(ctx->unknown);
     free(details);
 }
@@ -497,9 +590,6 @@ BRPaymentProtocolRequest *BRPaymentProtocolRequestNew(uint32_t version, const ch
     assert(req != NULL);
     assert(details != NULL);
     
-    array_new(ctx->defaults, request_signature + 1);
-    array_set_count(ctx->defaults, request_signature + 1);
-
     if (! version) {
         req->version = 1;
         ctx->defaults[request_version] = 1;
@@ -535,8 +625,6 @@ BRPaymentProtocolRequest *BRPaymentProtocolRequestParse(const uint8_t *buf, size
     assert(req != NULL);
     assert(buf != NULL || bufLen == 0);
 
-    array_new(ctx->defaults, request_signature + 1);
-    array_set_count(ctx->defaults, request_signature + 1);
     req->version = 1;
     ctx->defaults[request_version] = 1;
     
@@ -549,7 +637,10 @@ BRPaymentProtocolRequest *BRPaymentProtocolRequestParse(const uint8_t *buf, size
             case request_version: req->version = (uint32_t)i, ctx->defaults[request_version] = 0; break;
             case request_pki_type: _ProtoBufString(&req->pkiType, data, dataLen); break;
             case request_pki_data: req->pkiDataLen = _ProtoBufBytes(&req->pkiData, data, dataLen); break;
-            case request_details: req->details = (data) ? BRPaymentProtocolDetailsParse(data, dataLen) : NULL; break;
+            case request_details:
+                if (req->details) BRPaymentProtocolDetailsFree(req->details);
+                req->details = (data) ? BRPaymentProtocolDetailsParse(data, dataLen) : NULL;
+                break;
             case request_signature: req->sigLen = _ProtoBufBytes(&req->signature, data, dataLen); break;
             default: _ProtoBufUnknown(&ctx->unknown, key, i, data, dataLen); break;
         }
@@ -581,14 +672,12 @@ size_t BRPaymentProtocolRequestSerialize(const BRPaymentProtocolRequest *req, ui
     if (! ctx->defaults[request_pki_type]) _ProtoBufSetString(buf, bufLen, req->pkiType, request_pki_type, &off);
     if (req->pkiData) _ProtoBufSetBytes(buf, bufLen, req->pkiData, req->pkiDataLen, request_pki_data, &off);
 
-    if (req->details) {
+    if (req->details) { // details are serialized directly into buf
         size_t detailsLen = BRPaymentProtocolDetailsSerialize(req->details, NULL, 0);
-        uint8_t *detailsBuf = malloc(detailsLen);
 
-        assert(detailsBuf != NULL);
-        detailsLen = BRPaymentProtocolDetailsSerialize(req->details, detailsBuf, detailsLen);
-        _ProtoBufSetBytes(buf, bufLen, detailsBuf, detailsLen, request_details, &off);
-        free(detailsBuf);
+        _ProtoBufSetLenDelimKey(buf, bufLen, request_details, detailsLen, &off);
+        if (buf && off + detailsLen <= bufLen) BRPaymentProtocolDetailsSerialize(req->details, &buf[off], detailsLen);
+        off += detailsLen;
     }
     
     if (req->signature) _ProtoBufSetBytes(buf, bufLen, req->signature, req->sigLen, request_signature, &off);
@@ -669,11 +758,136 @@ void BRPaymentProtocolRequestFree(BRPaymentProtocolRequest *req)
     if (req->pkiData) array_free(req->pkiData);
     if (req->details) BRPaymentProtocolDetailsFree(req->details);
     if (req->signature) array_free(req->signature);
-    if (ctx->defaults) array_free(ctx->defaults);
     if (ctx->unknown) array_free(ctx->unknown);
     free(req);
 }
 
+// buf must contain a serialized request struct, and must not be modified or freed while the view is in use
+// returns true on success
+int BRPaymentProtocolRequestViewParse(BRPaymentProtocolRequestView *view, const uint8_t *buf, size_t bufLen)
+{
+    static const uint8_t wireTypes[] = { 0, PROTOBUF_VARINT, PROTOBUF_LENDELIM, PROTOBUF_LENDELIM, PROTOBUF_LENDELIM,
+                                         PROTOBUF_LENDELIM };
+    size_t start, off = 0;
+    uint64_t last = 0;
+    
+    assert(view != NULL);
+    assert(buf != NULL || bufLen == 0);
+    
+    memset(view, 0, sizeof(*view));
+    view->version = 1;
+    view->pkiType = "none", view->pkiTypeLen = strlen("none");
+    view->buf = buf, view->bufLen = bufLen;
+    view->isCanonical = 1;
+    
+    while (buf && off < bufLen) {
+        const uint8_t *data = NULL;
+        size_t dataLen = bufLen;
+        uint64_t i = 0, key;
+        
+        start = off;
+        key = _ProtoBufField(&i, &data, buf, &dataLen, &off);
+        if (! _ProtoBufFieldIsCanonical(buf, bufLen, start, off, key, i, data, dataLen)) view->isCanonical = 0;
+        if ((key >> 3) <= last) view->isCanonical = 0; // fields must be in order, without repeats
+        if ((key >> 3) < sizeof(wireTypes) && (key & 0x07) != wireTypes[key >> 3]) view->isCanonical = 0;
+        last = key >> 3;
+        
+        switch (key >> 3) {
+            case request_version: view->version = (uint32_t)i; if (i > UINT32_MAX) view->isCanonical = 0; break;
+            case request_pki_type:
+                if (data) view->pkiType = (const char *)data, view->pkiTypeLen = dataLen;
+                if (! data || memchr(data, '\0', dataLen)) view->isCanonical = 0;
+                break;
+            case request_pki_data: if (data) view->pkiData = data, view->pkiDataLen = dataLen; break;
+            case request_details: view->details = data, view->detailsLen = (data) ? dataLen : 0; break;
+            case request_signature:
+                if (data) view->signature = data, view->sigLen = dataLen, view->sigLenOff = start + 1;
+                break;
+            default: break;
+        }
+    }
+    
+    if (view->isCanonical && view->details) {
+        view->isCanonical = _BRPaymentProtocolDetailsIsCanonical(view->details, view->detailsLen);
+    }
+    
+    return (view->details != NULL); // required
+}
+
+// iterates over the outputs of a serialized details struct, such as view->details, without copying them
+// *off must be 0 for the first output, and script is set to point into details
+// returns true if an output was read, or false after the last output
+int BRPaymentProtocolDetailsNextOutput(const uint8_t *details, size_t detailsLen, size_t *off, uint64_t *amount,
+                                       const uint8_t **script, size_t *scriptLen)
+{
+    int isCanonical;
+    
+    assert(off != NULL);
+    assert(amount != NULL);
+    assert(script != NULL);
+    assert(scriptLen != NULL);
+    
+    while (details && *off < detailsLen) {
+        const uint8_t *data = NULL;
+        size_t dLen = detailsLen;
+        uint64_t key = _ProtoBufField(NULL, &data, details, &dLen, off);
+        
+        // outputs without a script are skipped, as they are by BRPaymentProtocolDetailsParse()
+        if ((key >> 3) == details_outputs && data &&
+            _BRPaymentProtocolOutputView(data, dLen, amount, script, scriptLen, &isCanonical)) return 1;
+    }
+    
+    return 0;
+}
+
+// writes the hash of the request to md needed to verify the request, hashing the serialized request in place
+// returns the number of bytes written, or the total mdLen needed if md is NULL
+size_t BRPaymentProtocolRequestViewDigest(const BRPaymentProtocolRequestView *view, uint8_t *md, size_t mdLen)
+{
+    static const uint8_t zero = 0;
+    const void *data[3];
+    size_t dataLens[3], count = 0, len = 0;
+    
+    assert(view != NULL);
+    
+    if (! view->isCanonical) { // hash the request as it would be reserialized
+        BRPaymentProtocolRequest *req = BRPaymentProtocolRequestParse(view->buf, view->bufLen);
+        
+        if (req) len = BRPaymentProtocolRequestDigest(req, md, mdLen), BRPaymentProtocolRequestFree(req);
+        return len;
+    }
+    
+    if (view->pkiTypeLen == strlen("x509+sha256") && memcmp(view->pkiType, "x509+sha256", view->pkiTypeLen) == 0) {
+        len = 256/8;
+    }
+    else if (view->pkiTypeLen == strlen("x509+sha1") && memcmp(view->pkiType, "x509+sha1", view->pkiTypeLen) == 0) {
+        len = 160/8;
+    }
+    
+    if (md && len > 0 && len <= mdLen) { // signature is hashed as 0 bytes, a signature can't sign itself
+        if (view->signature) {
+            data[count] = view->buf, dataLens[count++] = view->sigLenOff;
+            data[count] = &zero, dataLens[count++] = 1;
+            data[count] = view->signature + view->sigLen;
+            dataLens[count++] = view->bufLen - (size_t)(view->signature + view->sigLen - view->buf);
+        }
+        else data[count] = view->buf, dataLens[count++] = view->bufLen;
+        
+        if (len == 256/8) BRSHA256Vec(md, data, dataLens, count);
+        else {
+            uint8_t *buf = malloc(view->bufLen);
+            size_t i, off = 0;
+            
+            assert(buf != NULL);
+            for (i = 0; i < count; i++) memcpy(&buf[off], data[i], dataLens[i]), off += dataLens[i];
+            BRSHA1(md, buf, off);
+            free(buf);
+        }
+    }
+    
+    return (! md || len <= mdLen) ? len : 0;
+}
+
 // returns a newly allocated payment struct that must be freed by calling BRPaymentProtocolPaymentFree()
 BRPaymentProtocolPayment *BRPaymentProtocolPaymentNew(const uint8_t *merchantData, size_t merchDataLen,
                                                       BRTransaction *transactions[], size_t txCount,
@@ -683,16 +897,12 @@ BRPaymentProtocolPayment *BRPaymentProtocolPaymentNew(const uint8_t *merchantDat
                                                       size_t refundToCount, const char *memo)
 {
     BRPaymentProtocolPayment *payment = calloc(1, sizeof(*payment) + sizeof(ProtoBufContext));
-    ProtoBufContext *ctx = (ProtoBufContext *)&payment[1];
     
     assert(payment != NULL);
     assert(transactions != NULL || txCount == 0);
     assert(refundToAmounts != NULL || refundToCount == 0);
     assert(refundToAddresses != NULL || refundToCount == 0);
     
-    array_new(ctx->defaults, payment_merch_data + 1);
-    array_set_count(ctx->defaults, payment_merch_data + 1);
-
     if (merchantData) payment->merchDataLen = _ProtoBufBytes(&payment->merchantData, merchantData, merchDataLen);
     
     if (transactions) {
@@ -726,8 +936,6 @@ BRPaymentProtocolPayment *BRPaymentProtocolPaymentParse(const uint8_t *buf, size
     assert(payment != NULL);
     assert(buf != NULL || bufLen == 0);
     
-    array_new(ctx->defaults, payment_merch_data + 1);
-    array_set_count(ctx->defaults, payment_merch_data + 1);
     array_new(payment->transactions, 1);
     array_new(payment->refundTo, 1);
     
@@ -759,33 +967,28 @@ BRPaymentProtocolPayment *BRPaymentProtocolPaymentParse(const uint8_t *buf, size
 size_t BRPaymentProtocolPaymentSerialize(const BRPaymentProtocolPayment *payment, uint8_t *buf, size_t bufLen)
 {
     const ProtoBufContext *ctx = (const ProtoBufContext *)&payment[1];
-    size_t off = 0, sLen = 0x100, l;
-    uint8_t *sBuf = malloc(sLen);
+    size_t off = 0, l;
 
-    assert(sBuf != NULL);
     assert(payment != NULL);
     
     if (payment->merchantData) {
         _ProtoBufSetBytes(buf, bufLen, payment->merchantData, payment->merchDataLen, payment_merch_data, &off);
     }
 
-    for (size_t i = 0; i < payment->txCount; i++) {
+    for (size_t i = 0; i < payment->txCount; i++) { // transactions are serialized directly into buf
         l = BRTransactionSerialize(payment->transactions[i], NULL, 0);
-        if (l > sLen) sBuf = realloc(sBuf, (sLen = l));
-        assert(sBuf != NULL);
-        l = BRTransactionSerialize(payment->transactions[i], sBuf, sLen);
-        _ProtoBufSetBytes(buf, bufLen, sBuf, l, payment_transactions, &off);
+        _ProtoBufSetLenDelimKey(buf, bufLen, payment_transactions, l, &off);
+        if (buf && off + l <= bufLen) BRTransactionSerialize(payment->transactions[i], &buf[off], l);
+        off += l;
     }
 
     for (size_t i = 0; i < payment->refundToCount; i++) {
         l = _BRPaymentProtocolOutputSerialize(payment->refundTo[i], NULL, 0);
-        if (l > sLen) sBuf = realloc(sBuf, (sLen = l));
-        assert(sBuf != NULL);
-        l = _BRPaymentProtocolOutputSerialize(payment->refundTo[i], sBuf, l);
-        _ProtoBufSetBytes(buf, bufLen, sBuf, l, payment_refund_to, &off);
+        _ProtoBufSetLenDelimKey(buf, bufLen, payment_refund_to, l, &off);
+        if (buf && off + l <= bufLen) _BRPaymentProtocolOutputSerialize(payment->refundTo[i], &buf[off], l);
+        off += l;
     }
 
-    free(sBuf);
     if (payment->memo) _ProtoBufSetString(buf, bufLen, payment->memo, payment_memo, &off);
 
     if (ctx->unknown) {
@@ -808,21 +1011,18 @@ void BRPaymentProtocolPaymentFree(BRPaymentProtocolPayment *payment)
     for (size_t i = 0; i < payment->refundToCount; i++) _BRPaymentProtocolOutputFree(payment->refundTo[i]);
     if (payment->refundTo) array_free(payment->refundTo);
     if (payment->memo) array_free(payment->memo);
-    if (ctx->defaults) array_free(ctx->defaults);
     if (ctx->unknown) array_free(ctx->unknown);
+    free(payment);
 }
 
 // returns a newly allocated ACK struct that must be freed by calling BRPaymentProtocolACKFree()
 BRPaymentProtocolACK *BRPaymentProtocolACKNew(BRPaymentProtocolPayment *payment, const char *memo)
 {
     BRPaymentProtocolACK *ack = calloc(1, sizeof(*ack) + sizeof(ProtoBufContext));
-    ProtoBufContext *ctx = (ProtoBufContext *)&ack[1];
     
     assert(ack != NULL);
     assert(payment != NULL);
     
-    array_new(ctx->defaults, ack_memo + 1);
-    array_set_count(ctx->defaults, ack_memo + 1);
     ack->payment = payment;
     if (memo) _ProtoBufString(&ack->memo, memo, strlen(memo));
     
@@ -845,16 +1045,16 @@ BRPaymentProtocolACK *BRPaymentProtocolACKParse(const uint8_t *buf, size_t bufLe
     assert(ack != NULL);
     assert(buf != NULL || bufLen == 0);
     
-    array_new(ctx->defaults, ack_memo + 1);
-    array_set_count(ctx->defaults, ack_memo + 1);
-    
     while (buf && off < bufLen) {
         const uint8_t *data = NULL;
         size_t dataLen = bufLen;
         uint64_t i = 0, key = _ProtoBufField(&i, &data, buf, &dataLen, &off);
         
         switch (key >> 3) {
-            case ack_payment: ack->payment = (data) ? BRPaymentProtocolPaymentParse(data, dataLen) : NULL; break;
+            case ack_payment:
+                if (ack->payment) BRPaymentProtocolPaymentFree(ack->payment);
+                ack->payment = (data) ? BRPaymentProtocolPaymentParse(data, dataLen) : NULL;
+                break;
             case ack_memo: _ProtoBufString(&ack->memo, data, dataLen); break;
             default: _ProtoBufUnknown(&ctx->unknown, key, i, data, dataLen); break;
         }
@@ -877,14 +1077,12 @@ size_t BRPaymentProtocolACKSerialize(const BRPaymentProtocolACK *ack, uint8_t *b
     assert(ack != NULL);
     assert(ack->payment != NULL);
     
-    if (ack->payment) {
+    if (ack->payment) { // payment is serialized directly into buf
         size_t paymentLen = BRPaymentProtocolPaymentSerialize(ack->payment, NULL, 0);
-        uint8_t *paymentBuf = malloc(paymentLen);
         
-        assert(paymentBuf != NULL);
-        paymentLen = BRPaymentProtocolPaymentSerialize(ack->payment, paymentBuf, paymentLen);
-        _ProtoBufSetBytes(buf, bufLen, paymentBuf, paymentLen, ack_payment, &off);
-        free(paymentBuf);
+        _ProtoBufSetLenDelimKey(buf, bufLen, ack_payment, paymentLen, &off);
+        if (buf && off + paymentLen <= bufLen) BRPaymentProtocolPaymentSerialize(ack->payment, &buf[off], paymentLen);
+        off += paymentLen;
     }
     
     if (ack->memo) _ProtoBufSetString(buf, bufLen, ack->memo, ack_memo, &off);
@@ -906,7 +1104,6 @@ void BRPaymentProtocolACKFree(BRPaymentProtocolACK *ack)
     
     if (ack->payment) BRPaymentProtocolPaymentFree(ack->payment);
     if (ack->memo) array_free(ack->memo);
-    if (ctx->defaults) array_free(ctx->defaults);
     if (ctx->unknown) array_free(ctx->unknown);
     free(ack);
 }
@@ -926,8 +1123,6 @@ BRPaymentProtocolInvoiceRequest *BRPaymentProtocolInvoiceRequestNew(BRKey *sende
     assert(req != NULL);
     assert(senderPubKey != NULL);
     
-    array_new(ctx->defaults, invoice_req_signature + 1);
-    array_set_count(ctx->defaults, invoice_req_signature + 1);
     pkLen = BRKeyPubKey(senderPubKey, pk, sizeof(pk));
     BRKeySetPubKey(&req->senderPubKey, pk, pkLen);
     req->amount = amount;
@@ -957,8 +1152,6 @@ BRPaymentProtocolInvoiceRequest *BRPaymentProtocolInvoiceRequestParse(const uint
     assert(req != NULL);
     assert(buf != NULL || bufLen == 0);
     
-    array_new(ctx->defaults, invoice_req_signature + 1);
-    array_set_count(ctx->defaults, invoice_req_signature + 1);
     ctx->defaults[invoice_req_amount] = 1;
     
     while (buf && off < bufLen) {
@@ -1053,7 +1246,7 @@ size_t BRPaymentProtocolInvoiceRequestDigest(BRPaymentProtocolInvoiceRequest *re
     size_t bufLen;
     
     assert(req != NULL);
-    
+
     req->sigLen = 0; // set signature to 0 bytes, a signature can't sign itself
     bufLen = BRPaymentProtocolInvoiceRequestSerialize(req, NULL, 0);
     buf = malloc(bufLen);
@@ -1083,7 +1276,6 @@ void BRPaymentProtocolInvoiceRequestFree(BRPaymentProtocolInvoiceRequest *req)
     if (req->memo) array_free(req->memo);
     if (req->notifyUrl) array_free(req->notifyUrl);
     if (req->signature) array_free(req->signature);
-    if (ctx->defaults) array_free(ctx->defaults);
     if (ctx->unknown) array_free(ctx->unknown);
     free(req);
 }
@@ -1094,13 +1286,10 @@ BRPaymentProtocolMessage *BRPaymentProtocolMessageNew(BRPaymentProtocolMessageTy
                                                       const uint8_t *identifier, size_t identLen)
 {
     BRPaymentProtocolMessage *msg = calloc(1, sizeof(*msg) + sizeof(ProtoBufContext));
-    ProtoBufContext *ctx = (ProtoBufContext *)&msg[1];
     
     assert(msg != NULL);
     assert(message != NULL || msgLen == 0);
     
-    array_new(ctx->defaults, message_identifier + 1);
-    array_set_count(ctx->defaults, message_identifier + 1);
     msg->msgType = msgType;
     if (message) msg->msgLen = _ProtoBufBytes(&msg->message, message, msgLen);
     msg->statusCode = statusCode;
@@ -1127,8 +1316,6 @@ BRPaymentProtocolMessage *BRPaymentProtocolMessageParse(const uint8_t *buf, size
     assert(msg != NULL);
     assert(buf != NULL || bufLen == 0);
     
-    array_new(ctx->defaults, message_identifier + 1);
-    array_set_count(ctx->defaults, message_identifier + 1);
     ctx->defaults[message_status_code] = 1;
     
     while (buf && off < bufLen) {
@@ -1187,7 +1374,6 @@ void BRPaymentProtocolMessageFree(BRPaymentProtocolMessage *msg)
     if (msg->message) array_free(msg->message);
     if (msg->statusMsg) array_free(msg->statusMsg);
     if (msg->identifier) array_free(msg->identifier);
-    if (ctx->defaults) array_free(ctx->defaults);
     if (ctx->unknown) array_free(ctx->unknown);
     free(msg);
 }
@@ -1223,7 +1409,6 @@ BRPaymentProtocolEncryptedMessage *BRPaymentProtocolEncryptedMessageNew(BRPaymen
                                                                         uint64_t statusCode, const char *statusMsg)
 {
     BRPaymentProtocolEncryptedMessage *msg = calloc(1, sizeof(*msg) + sizeof(ProtoBufContext));
-    ProtoBufContext *ctx = (ProtoBufContext *)&msg[1];
     BRKey *privKey;
     size_t pkLen, sigLen, bufLen = msgLen + 16, adLen = (statusMsg) ? 20 + strlen(statusMsg) + 1 : 20 + 1;
     char *ad = calloc(adLen, sizeof(*ad));
@@ -1237,8 +1422,6 @@ BRPaymentProtocolEncryptedMessage *BRPaymentProtocolEncryptedMessageNew(BRPaymen
     assert(senderKey != NULL);
     assert(BRKeyIsPrivKey(receiverKey) || BRKeyIsPrivKey(senderKey));
     
-    array_new(ctx->defaults, encrypted_msg_status_msg + 1);
-    array_set_count(ctx->defaults, encrypted_msg_status_msg + 1);
     msg->msgType = msgType;
     pkLen = BRKeyPubKey(receiverKey, pk, sizeof(pk));
     BRKeySetPubKey(&msg->receiverPubKey, pk, pkLen);
@@ -1290,8 +1473,6 @@ BRPaymentProtocolEncryptedMessage *BRPaymentProtocolEncryptedMessageParse(const
     assert(msg != NULL);
     assert(buf != NULL || bufLen == 0);
     
-    array_new(ctx->defaults, encrypted_msg_status_msg + 1);
-    array_set_count(ctx->defaults, encrypted_msg_status_msg + 1);
     ctx->defaults[encrypted_msg_status_code] = 1;
     
     while (buf && off < bufLen) {
@@ -1414,7 +1595,6 @@ void BRPaymentProtocolEncryptedMessageFree(BRPaymentProtocolEncryptedMessage *ms
     if (msg->signature) array_free(msg->signature);
     if (msg->identifier) array_free(msg->identifier);
     if (msg->statusMsg) array_free(msg->statusMsg);
-    if (ctx->defaults) array_free(ctx->defaults);
     if (ctx->unknown) array_free(ctx->unknown);
     free(msg);
 }
@@ -99,6 +99,37 @@ size_t BRPaymentProtocolRequestDigest(BRPaymentProtocolRequest *req, uint8_t *md
 // frees memory allocated for request struct
 void BRPaymentProtocolRequestFree(BRPaymentProtocolRequest *req);
 
+// a request parsed in place, with fields pointing into the serialized request instead of copies of them
+typedef struct {
+    uint32_t version; // default is 1
+    const char *pkiType; // none / x509+sha256 / x509+sha1, default is "none", not NULL terminated
+    size_t pkiTypeLen;
+    const uint8_t *pkiData; // depends on pkiType, optional
+    size_t pkiDataLen;
+    const uint8_t *details; // serialized details struct, required
+    size_t detailsLen;
+    const uint8_t *signature; // pki-dependent signature, optional
+    size_t sigLen;
+    const uint8_t *buf; // the serialized request
+    size_t bufLen;
+    size_t sigLenOff; // offset in buf of the signature length, the span replaced when hashing the request
+    int isCanonical; // true if reserializing the parsed request would reproduce buf exactly
+} BRPaymentProtocolRequestView;
+
+// buf must contain a serialized request struct, and must not be modified or freed while the view is in use
+// returns true on success
+int BRPaymentProtocolRequestViewParse(BRPaymentProtocolRequestView *view, const uint8_t *buf, size_t bufLen);
+
+// iterates over the outputs of a serialized details struct, such as view->details, without copying them
+// *off must be 0 for the first output, and script is set to point into details
+// returns true if an output was read, or false after the last output
+int BRPaymentProtocolDetailsNextOutput(const uint8_t *details, size_t detailsLen, size_t *off, uint64_t *amount,
+                                       const uint8_t **script, size_t *scriptLen);
+
+// writes the hash of the request to md needed to verify the request, hashing the serialized request in place
+// returns the number of bytes written, or the total mdLen needed if md is NULL
+size_t BRPaymentProtocolRequestViewDigest(const BRPaymentProtocolRequestView *view, uint8_t *md, size_t mdLen);
+
 typedef struct {
     uint8_t *merchantData; // from request->details->merchantData, optional
     size_t merchDataLen;
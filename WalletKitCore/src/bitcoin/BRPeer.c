@@ -95,6 +95,11 @@ typedef enum {
     inv_filtered_witness_block = inv_filtered_block | WITNESS_FLAG
 } inv_type;
 
+typedef struct {
+    BRMerkleBlock *block;
+    int valid; // -1 until verified, guarded by the verify pool lock
+} BRPendingBlock;
+
 typedef struct {
     BRPeer peer; // superstruct on top of BRPeer
     uint32_t magicNumber;
@@ -111,6 +116,8 @@ typedef struct {
     UInt256 lastBlockHash;
     BRMerkleBlock *currentBlock;
     UInt256 *currentBlockTxHashes, *knownBlockHashes, *knownTxHashes;
+    BRPendingBlock **pendingBlocks; // merkleblocks not yet relayed, in the order received
+    size_t verifyPending; // verify pool jobs queued or running for this peer, guarded by the verify pool lock
     BRSet *knownTxHashSet;
     volatile int socket;
     void *info;
@@ -412,6 +419,172 @@ static int _BRPeerAcceptInvMessage(BRPeer *peer, const uint8_t *msg, size_t msgL
     return r;
 }
 
+// Checking proof-of-work and merkle roots is independent for each block, so it's done on a small pool of long-lived
+// worker threads shared by all peers. Merkleblocks are queued on the peer in the order received and handed to
+// relayedBlock strictly in that order once verified, so chain linking in the peer manager is unchanged.
+#define VERIFY_THREADS_MAXIMUM  4
+#define HEADERS_PER_VERIFY_JOB  250
+#define PENDING_BLOCKS_MAXIMUM  1000
+
+typedef struct {
+    BRPeerContext *owner;
+    const uint8_t *headers; // if not NULL, 81 byte serialized headers to parse into blocks[] before verifying
+    BRMerkleBlock **blocks; // NULL if malformed
+    int *valid; // -1 until verified, then true if the corresponding block passed BRMerkleBlockIsValid()
+    size_t count;
+    uint32_t currentTime;
+} BRVerifyJob;
+
+static pthread_once_t _verifyOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t _verifyLock = PTHREAD_MUTEX_INITIALIZER; // guards job queue, verifyPending and valid results
+static pthread_cond_t _verifyCond = PTHREAD_COND_INITIALIZER; // signaled when a job is queued
+static pthread_cond_t _verifyDoneCond = PTHREAD_COND_INITIALIZER; // broadcast when a job is finished
+static BRVerifyJob *_verifyJobs = NULL;
+static size_t _verifyThreadCount = 0;
+
+static void _BRVerifyJobRun(BRVerifyJob *job)
+{
+    int valid;
+    
+    for (size_t i = 0; i < job->count; i++) {
+        if (job->headers) job->blocks[i] = BRMerkleBlockParse(&job->headers[81*i], 81);
+        valid = (job->blocks[i] && BRMerkleBlockIsValid(job->blocks[i], job->currentTime));
+        pthread_mutex_lock(&_verifyLock);
+        job->valid[i] = valid;
+        pthread_mutex_unlock(&_verifyLock);
+    }
+}
+
+static void *_BRVerifyThreadRoutine(void *arg)
+{
+    BRVerifyJob job;
+    
+    pthread_setname_brd(pthread_self(), "Core BTC Verify");
+    pthread_mutex_lock(&_verifyLock);
+    
+    while (1) {
+        while (array_count(_verifyJobs) == 0) pthread_cond_wait(&_verifyCond, &_verifyLock);
+        job = _verifyJobs[0];
+        array_rm(_verifyJobs, 0);
+        pthread_mutex_unlock(&_verifyLock);
+        _BRVerifyJobRun(&job);
+        pthread_mutex_lock(&_verifyLock);
+        job.owner->verifyPending--;
+        pthread_cond_broadcast(&_verifyDoneCond);
+    }
+    
+    return NULL;
+}
+
+static void _BRVerifyPoolStart(void)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threadCount = (processors > 0) ? (size_t)processors : 1;
+    pthread_attr_t attr;
+    pthread_t thread;
+    
+    if (threadCount > VERIFY_THREADS_MAXIMUM) threadCount = VERIFY_THREADS_MAXIMUM;
+    array_new(_verifyJobs, 100);
+    
+    if (pthread_attr_init(&attr) == 0) {
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        pthread_attr_setstacksize(&attr, PTHREAD_STACK_SIZE);
+        
+        while (_verifyThreadCount < threadCount &&
+               pthread_create(&thread, &attr, _BRVerifyThreadRoutine, NULL) == 0) _verifyThreadCount++;
+        
+        pthread_attr_destroy(&attr);
+    }
+}
+
+// queues job on the verify pool, or runs it on the calling thread if the pool couldn't be started
+static void _BRPeerSubmitVerifyJob(BRPeerContext *ctx, BRVerifyJob job)
+{
+    pthread_once(&_verifyOnce, _BRVerifyPoolStart);
+    
+    if (_verifyThreadCount == 0) {
+        _BRVerifyJobRun(&job);
+    }
+    else {
+        pthread_mutex_lock(&_verifyLock);
+        array_add(_verifyJobs, job);
+        ctx->verifyPending++;
+        pthread_cond_signal(&_verifyCond);
+        pthread_mutex_unlock(&_verifyLock);
+    }
+}
+
+// waits until every job submitted for this peer is finished
+static void _BRPeerWaitForVerify(BRPeerContext *ctx)
+{
+    pthread_mutex_lock(&_verifyLock);
+    while (ctx->verifyPending > 0) pthread_cond_wait(&_verifyDoneCond, &_verifyLock);
+    pthread_mutex_unlock(&_verifyLock);
+}
+
+// frees queued merkleblocks without relaying them, including one still collecting tx messages, once the verify pool is
+// done with them
+static void _BRPeerClearPendingBlocks(BRPeerContext *ctx)
+{
+    _BRPeerWaitForVerify(ctx);
+    array_clear(ctx->currentBlockTxHashes);
+    ctx->currentBlock = NULL;
+    
+    for (size_t i = 0; i < array_count(ctx->pendingBlocks); i++) {
+        BRMerkleBlockFree(ctx->pendingBlocks[i]->block);
+        free(ctx->pendingBlocks[i]);
+    }
+    
+    array_clear(ctx->pendingBlocks);
+}
+
+// relays queued merkleblocks in the order received, stopping at the block still collecting tx messages, or at the first
+// block not yet verified unless wait is true, returns false if an invalid block was found, which drops the whole queue
+static int _BRPeerRelayPendingBlocks(BRPeer *peer, int wait)
+{
+    BRPeerContext *ctx = (BRPeerContext *)peer;
+    BRPendingBlock *pending;
+    int valid, r = 1;
+    
+    while (r && array_count(ctx->pendingBlocks) > 0 && ctx->pendingBlocks[0]->block != ctx->currentBlock) {
+        pending = ctx->pendingBlocks[0];
+        pthread_mutex_lock(&_verifyLock);
+        while (wait && pending->valid < 0) pthread_cond_wait(&_verifyDoneCond, &_verifyLock);
+        valid = pending->valid;
+        pthread_mutex_unlock(&_verifyLock);
+        if (valid < 0) break;
+        array_rm(ctx->pendingBlocks, 0);
+        
+        if (! valid) {
+            peer_log(peer, "invalid merkleblock: %s", u256hex(pending->block->blockHash));
+            BRMerkleBlockFree(pending->block);
+            _BRPeerClearPendingBlocks(ctx);
+            r = 0;
+        }
+        else if (ctx->relayedBlock) {
+            ctx->relayedBlock(ctx->info, pending->block);
+        }
+        else BRMerkleBlockFree(pending->block);
+        
+        free(pending);
+    }
+    
+    return r;
+}
+
+// parses and validates count headers into blocks[] and valid[] on the verify pool
+static void _BRPeerVerifyHeaders(BRPeerContext *ctx, const uint8_t *headers, size_t count, uint32_t currentTime,
+                                 BRMerkleBlock *blocks[], int valid[])
+{
+    for (size_t i = 0; i < count; i += HEADERS_PER_VERIFY_JOB) {
+        size_t n = (count - i < HEADERS_PER_VERIFY_JOB) ? count - i : HEADERS_PER_VERIFY_JOB;
+        
+        _BRPeerSubmitVerifyJob(ctx, (BRVerifyJob) { ctx, &headers[81*i], &blocks[i], &valid[i], n, currentTime });
+    }
+    
+    _BRPeerWaitForVerify(ctx);
+}
+
 static int _BRPeerAcceptTxMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen)
 {
     BRPeerContext *ctx = (BRPeerContext *)peer;
@@ -445,10 +618,8 @@ static int _BRPeerAcceptTxMessage(BRPeer *peer, const uint8_t *msg, size_t msgLe
             }
         
             if (array_count(ctx->currentBlockTxHashes) == 0) { // we received the entire block including all matched tx
-                BRMerkleBlock *block = ctx->currentBlock;
-            
                 ctx->currentBlock = NULL;
-                if (ctx->relayedBlock) ctx->relayedBlock(ctx->info, block);
+                r = _BRPeerRelayPendingBlocks(peer, 0);
             }
         }
     }
@@ -495,14 +666,22 @@ static int _BRPeerAcceptHeadersMessage(BRPeer *peer, const uint8_t *msg, size_t
             }
             else BRPeerSendGetheaders(peer, locators, 2, UINT256_ZERO);
 
-            for (size_t i = 0; r && i < count; i++) {
-                BRMerkleBlock *block = BRMerkleBlockParse(&msg[off + 81*i], 81);
+            BRMerkleBlock **blocks = malloc(count*sizeof(*blocks));
+            int *valid = malloc(count*sizeof(*valid));
+            size_t i;
+            
+            assert(blocks != NULL);
+            assert(valid != NULL);
+            _BRPeerVerifyHeaders(ctx, &msg[off], count, (uint32_t)now, blocks, valid);
+            
+            for (i = 0; r && i < count; i++) {
+                BRMerkleBlock *block = blocks[i];
                 
                 if (! block) {
                     peer_log(peer, "malformed headers message with length: %zu", msgLen);
                     r = 0;
                 }
-                else if (! BRMerkleBlockIsValid(block, (uint32_t)now)) {
+                else if (! valid[i]) {
                     peer_log(peer, "invalid block header: %s", u256hex(block->blockHash));
                     BRMerkleBlockFree(block);
                     r = 0;
@@ -512,6 +691,13 @@ static int _BRPeerAcceptHeadersMessage(BRPeer *peer, const uint8_t *msg, size_t
                 }
                 else BRMerkleBlockFree(block);
             }
+            
+            for (; i < count; i++) { // free any headers left after an invalid one
+                if (blocks[i]) BRMerkleBlockFree(blocks[i]);
+            }
+            
+            free(valid);
+            free(blocks);
         }
         else {
             peer_log(peer, "non-standard headers message, %zu is fewer header(s) than expected", count);
@@ -722,12 +908,6 @@ static int _BRPeerAcceptMerkleblockMessage(BRPeer *peer, const uint8_t *msg, siz
         peer_log(peer, "malformed merkleblock message with length: %zu", msgLen);
         r = 0;
     }
-    else if (! BRMerkleBlockIsValid(block, (uint32_t)time(NULL))) {
-        peer_log(peer, "invalid merkleblock: %s", u256hex(block->blockHash));
-        BRMerkleBlockFree(block);
-        block = NULL;
-        r = 0;
-    }
     else if (! ctx->sentFilter && ! ctx->sentGetdata) {
         peer_log(peer, "got merkleblock message before loading a filter");
         BRMerkleBlockFree(block);
@@ -749,14 +929,17 @@ static int _BRPeerAcceptMerkleblockMessage(BRPeer *peer, const uint8_t *msg, siz
         if (hashes != _hashes) free(hashes);
     }
 
-    if (block) {
-        if (array_count(ctx->currentBlockTxHashes) > 0) { // wait til we get all tx messages before processing the block
-            ctx->currentBlock = block;
-        }
-        else if (ctx->relayedBlock) {
-            ctx->relayedBlock(ctx->info, block);
-        }
-        else BRMerkleBlockFree(block);
+    if (block) { // the block is verified on the verify pool, and relayed once verified and all tx messages arrive
+        BRPendingBlock *pending = calloc(1, sizeof(*pending));
+        
+        assert(pending != NULL);
+        pending->block = block;
+        pending->valid = -1;
+        array_add(ctx->pendingBlocks, pending);
+        if (array_count(ctx->currentBlockTxHashes) > 0) ctx->currentBlock = block;
+        _BRPeerSubmitVerifyJob(ctx, (BRVerifyJob) { ctx, NULL, &pending->block, &pending->valid, 1,
+                                                    (uint32_t)time(NULL) });
+        r = _BRPeerRelayPendingBlocks(peer, array_count(ctx->pendingBlocks) > PENDING_BLOCKS_MAXIMUM);
     }
 
     return r;
@@ -842,8 +1025,12 @@ static int _BRPeerAcceptMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen,
     if (ctx->currentBlock && strncmp(MSG_TX, type, 12) != 0) { // if we receive a non-tx message, merkleblock is done
         peer_log(peer, "incomplete merkleblock %s, expected %zu more tx, got %s", u256hex(ctx->currentBlock->blockHash),
                  array_count(ctx->currentBlockTxHashes), type);
-        array_clear(ctx->currentBlockTxHashes);
-        ctx->currentBlock = NULL;
+        _BRPeerRelayPendingBlocks(peer, 1);
+        _BRPeerClearPendingBlocks(ctx);
+        r = 0;
+    }
+    else if (strncmp(MSG_TX, type, 12) != 0 && strncmp(MSG_MERKLEBLOCK, type, 12) != 0 &&
+             ! _BRPeerRelayPendingBlocks(peer, 1)) { // any other message may depend on previous blocks being relayed
         r = 0;
     }
     else if (strncmp(MSG_VERSION, type, 12) == 0) r = _BRPeerAcceptVersionMessage(peer, msg, msgLen);
@@ -986,6 +1173,17 @@ static double _peerGetMempoolTime (BRPeerContext *ctx) {
 }
 
 
+static int _BRPeerSocketHasData(int socket)
+{
+    struct timeval tv = { 0, 0 };
+    fd_set fds;
+    
+    if (socket < 0) return 0;
+    FD_ZERO(&fds);
+    FD_SET(socket, &fds);
+    return (select(socket + 1, &fds, NULL, NULL, &tv) > 0);
+}
+
 static void *_peerThreadRoutine(void *arg)
 {
     BRPeer *peer = arg;
@@ -1012,6 +1210,10 @@ static void *_peerThreadRoutine(void *arg)
 
         while (_peerCheckAndGetSocket(ctx, &socket) && ! error) {
             len = 0;
+            
+            // if the remote peer has gone quiet, relay the merkleblocks still being verified rather than hold them
+            if (array_count(ctx->pendingBlocks) > 0 && ! _BRPeerSocketHasData(socket) &&
+                ! _BRPeerRelayPendingBlocks(peer, 1)) error = EPROTO;
 
             while (socket >= 0 && ! error && len < HEADER_LENGTH) {
                 n = read(socket, &header[len], sizeof(header) - len);
@@ -1102,6 +1304,8 @@ static void *_peerThreadRoutine(void *arg)
 
     if (socket >= 0) close(socket);
     peer_log(peer, "disconnected");
+    _BRPeerRelayPendingBlocks(peer, 1); // blocks verified before the disconnect are still relayed, in order
+    _BRPeerClearPendingBlocks(ctx);
     
     while (array_count(ctx->pongCallback) > 0) {
         void (*pongCallback)(void *, int) = ctx->pongCallback[0];
@@ -1133,6 +1337,7 @@ BRPeer *BRPeerNew(uint32_t magicNumber)
     array_new(ctx->useragent, 40);
     array_new(ctx->knownBlockHashes, 10);
     array_new(ctx->currentBlockTxHashes, 10);
+    array_new(ctx->pendingBlocks, 10);
     array_new(ctx->knownTxHashes, 10);
     ctx->knownTxHashSet = BRSetNew(BRTransactionHash, BRTransactionEq, 10);
     array_new(ctx->pongInfo, 10);
@@ -1636,6 +1841,11 @@ void BRPeerRerequestBlocks(BRPeer *peer, UInt256 fromBlock)
 void BRPeerFree(BRPeer *peer)
 {
     BRPeerContext *ctx = (BRPeerContext *)peer;
+
+    if (ctx->pendingBlocks) { // waits for the verify pool to finish with any queued blocks
+        _BRPeerClearPendingBlocks(ctx);
+        array_free(ctx->pendingBlocks);
+    }
     
     if (ctx->useragent) array_free(ctx->useragent);
     if (ctx->currentBlockTxHashes) array_free(ctx->currentBlockTxHashes);
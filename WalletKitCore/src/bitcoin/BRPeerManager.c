@@ -24,6 +24,8 @@
 
 #include "BRPeerManager.h"
 #include "BRBloomFilter.h"
+#include "BRTxPeerList.h"
+#include "BROrphanPool.h"
 #include "support/BRSet.h"
 #include "support/BRArray.h"
 #include "support/BRInt.h"
@@ -64,75 +66,6 @@ typedef struct {
     void (*callback)(void *info, int error);
 } BRPublishedTx;
 
-typedef struct {
-    UInt256 txHash;
-    BRPeer *peers;
-} BRTxPeerList;
-
-// true if peer is contained in the list of peers associated with txHash
-static int _BRTxPeerListHasPeer(const BRTxPeerList *list, UInt256 txHash, const BRPeer *peer)
-{
-    for (size_t i = array_count(list); i > 0; i--) {
-        if (! UInt256Eq(list[i - 1].txHash, txHash)) continue;
-
-        for (size_t j = array_count(list[i - 1].peers); j > 0; j--) {
-            if (BRPeerEq(&list[i - 1].peers[j - 1], peer)) return 1;
-        }
-        
-        break;
-    }
-    
-    return 0;
-}
-
-// number of peers associated with txHash
-static size_t _BRTxPeerListCount(const BRTxPeerList *list, UInt256 txHash)
-{
-    for (size_t i = array_count(list); i > 0; i--) {
-        if (UInt256Eq(list[i - 1].txHash, txHash)) return array_count(list[i - 1].peers);
-    }
-    
-    return 0;
-}
-
-// adds peer to the list of peers associated with txHash and returns the new total number of peers
-static size_t _BRTxPeerListAddPeer(BRTxPeerList **list, UInt256 txHash, const BRPeer *peer)
-{
-    for (size_t i = array_count(*list); i > 0; i--) {
-        if (! UInt256Eq((*list)[i - 1].txHash, txHash)) continue;
-        
-        for (size_t j = array_count((*list)[i - 1].peers); j > 0; j--) {
-            if (BRPeerEq(&(*list)[i - 1].peers[j - 1], peer)) return array_count((*list)[i - 1].peers);
-        }
-        
-        array_add((*list)[i - 1].peers, *peer);
-        return array_count((*list)[i - 1].peers);
-    }
-
-    array_add(*list, ((const BRTxPeerList) { txHash, NULL }));
-    array_new((*list)[array_count(*list) - 1].peers, PEER_MAX_CONNECTIONS);
-    array_add((*list)[array_count(*list) - 1].peers, *peer);
-    return 1;
-}
-
-// removes peer from the list of peers associated with txHash, returns true if peer was found
-static int _BRTxPeerListRemovePeer(BRTxPeerList *list, UInt256 txHash, const BRPeer *peer)
-{
-    for (size_t i = array_count(list); i > 0; i--) {
-        if (! UInt256Eq(list[i - 1].txHash, txHash)) continue;
-        
-        for (size_t j = array_count(list[i - 1].peers); j > 0; j--) {
-            if (! BRPeerEq(&list[i - 1].peers[j - 1], peer)) continue;
-            array_rm(list[i - 1].peers, j - 1);
-            return 1;
-        }
-        
-        break;
-    }
-    
-    return 0;
-}
-
 // comparator for sorting peers by timestamp, most recent first
 inline static int _peerTimestampCompare(const void *peer, const void *otherPeer)
 {
@@ -175,9 +108,11 @@ struct BRPeerManagerStruct {
     uint32_t earliestKeyTime, syncStartHeight, filterUpdateHeight, estimatedHeight;
     BRBloomFilter *bloomFilter;
     double fpRate, averageTxPerBlock;
-    BRSet *blocks, *orphans, *checkpoints;
-    BRMerkleBlock *lastBlock, *lastOrphan;
-    BRTxPeerList *txRelays, *txRequests;
+    BRSet *blocks, *checkpoints;
+    BROrphanPool orphans;
+    BRMerkleBlock *lastBlock;
+    UInt256 lastOrphanHash;
+    BRTxPeerList txRelays, txRequests;
     BRPublishedTx *publishedTx;
     UInt256 *publishedTxHashes;
     void *info;
@@ -271,9 +206,8 @@ static void _BRPeerManagerLoadBloomFilter(BRPeerManager *manager, BRPeer *peer)
     BRWalletUnusedAddrs(manager->wallet, NULL, SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED, SEQUENCE_EXTERNAL_CHAIN);
     BRWalletUnusedAddrs(manager->wallet, NULL, SEQUENCE_GAP_LIMIT_INTERNAL_EXTENDED, SEQUENCE_INTERNAL_CHAIN);
 
-    BRSetApply(manager->orphans, NULL, _setApplyFreeBlock);
-    BRSetClear(manager->orphans); // clear out orphans that may have been received on an old filter
-    manager->lastOrphan = NULL;
+    BROrphanPoolClear(&manager->orphans); // clear out orphans that may have been received on an old filter
+    manager->lastOrphanHash = UINT256_ZERO;
     manager->filterUpdateHeight = manager->lastBlock->height;
     manager->fpRate = BLOOM_REDUCED_FALSEPOSITIVE_RATE;
     
@@ -478,13 +412,13 @@ static void _requestUnrelayedTxGetdataDone(void *info, int success)
                     manager->publishedTx[j - 1].callback != NULL) isPublishing = 1;
             }
             
-            if (! isPublishing && _BRTxPeerListCount(manager->txRelays, hash) == 0 &&
-                _BRTxPeerListCount(manager->txRequests, hash) == 0) {
+            if (! isPublishing && BRTxPeerListCount(&manager->txRelays, hash) == 0 &&
+                BRTxPeerListCount(&manager->txRequests, hash) == 0) {
                 peer_log(peer, "removing tx unconfirmed at: %d, txHash: %s", manager->lastBlock->height, u256hex(hash));
                 assert(tx[i - 1]->blockHeight == TX_UNCONFIRMED);
                 BRWalletRemoveTransaction(manager->wallet, hash);
             }
-            else if (! isPublishing && _BRTxPeerListCount(manager->txRelays, hash) < manager->maxConnectCount) {
+            else if (! isPublishing && BRTxPeerListCount(&manager->txRelays, hash) < manager->maxConnectCount) {
                 // set timestamp 0 to mark as unverified
                 BRWalletUpdateTransactions(manager->wallet, &hash, 1, TX_UNCONFIRMED, 0);
             }
@@ -504,10 +438,10 @@ static void _BRPeerManagerRequestUnrelayedTx(BRPeerManager *manager, BRPeer *pee
     txCount = BRWalletTxUnconfirmedBefore(manager->wallet, tx, txCount, TX_UNCONFIRMED);
     
     for (size_t i = 0; i < txCount; i++) {
-        if (! _BRTxPeerListHasPeer(manager->txRelays, tx[i]->txHash, peer) &&
-            ! _BRTxPeerListHasPeer(manager->txRequests, tx[i]->txHash, peer)) {
+        if (! BRTxPeerListHasPeer(&manager->txRelays, tx[i]->txHash, peer) &&
+            ! BRTxPeerListHasPeer(&manager->txRequests, tx[i]->txHash, peer)) {
             txHashes[hashCount++] = tx[i]->txHash;
-            _BRTxPeerListAddPeer(&manager->txRequests, tx[i]->txHash, peer);
+            BRTxPeerListAddPeer(&manager->txRequests, manager->wallet, tx[i]->txHash, peer, time(NULL));
         }
     }
 
@@ -800,7 +734,7 @@ static void _peerDisconnected(void *info, int error)
 {
     BRPeer *peer = ((BRPeerCallbackInfo *)info)->peer;
     BRPeerManager *manager = ((BRPeerCallbackInfo *)info)->manager;
-    BRTxPeerList *peerList;
+    BRTxPeerEntry *peerEntry;
     int willSave = 0, willReconnect = 0, txError = 0;
     size_t txCount = 0;
     
@@ -825,11 +759,9 @@ static void _peerDisconnected(void *info, int error)
                                    array_count(manager->connectedPeers) == 1)) txError = ETIMEDOUT;
     }
     
-    for (size_t i = array_count(manager->txRelays); i > 0; i--) {
-        peerList = &manager->txRelays[i - 1];
-
-        for (size_t j = array_count(peerList->peers); j > 0; j--) {
-            if (BRPeerEq(&peerList->peers[j - 1], peer)) array_rm(peerList->peers, j - 1);
+    for (peerEntry = manager->txRelays.oldest; peerEntry; peerEntry = peerEntry->newer) {
+        for (size_t j = array_count(peerEntry->peers); j > 0; j--) {
+            if (BRPeerEq(&peerEntry->peers[j - 1], peer)) array_rm(peerEntry->peers, j - 1);
         }
     }
 
@@ -927,7 +859,7 @@ static void _peerRelayedTx(void *info, BRTransaction *tx)
             txCallback = manager->publishedTx[i - 1].callback;
             manager->publishedTx[i - 1].info = NULL;
             manager->publishedTx[i - 1].callback = NULL;
-            relayCount = _BRTxPeerListAddPeer(&manager->txRelays, tx->txHash, peer);
+            relayCount = BRTxPeerListAddPeer(&manager->txRelays, manager->wallet, tx->txHash, peer, time(NULL));
         }
         else if (manager->publishedTx[i - 1].callback != NULL) hasPendingCallbacks = 1;
     }
@@ -958,9 +890,9 @@ static void _peerRelayedTx(void *info, BRTransaction *tx)
 
         // keep track of how many peers have or relay a tx, this indicates how likely the tx is to confirm
         // (we only need to track this after syncing is complete)
-        if (manager->syncStartHeight == 0) relayCount = _BRTxPeerListAddPeer(&manager->txRelays, tx->txHash, peer);
+        if (manager->syncStartHeight == 0) relayCount = BRTxPeerListAddPeer(&manager->txRelays, manager->wallet, tx->txHash, peer, time(NULL));
         
-        _BRTxPeerListRemovePeer(manager->txRequests, tx->txHash, peer);
+        BRTxPeerListRemovePeer(&manager->txRequests, tx->txHash, peer);
         
         if (manager->bloomFilter != NULL) { // check if bloom filter is already being updated
             BRAddress addrs[SEQUENCE_GAP_LIMIT_EXTERNAL + SEQUENCE_GAP_LIMIT_INTERNAL];
@@ -1010,7 +942,7 @@ static void _peerHasTx(void *info, UInt256 txHash)
             if (! tx) tx = pubTx.tx;
             manager->publishedTx[i - 1].callback = NULL;
             manager->publishedTx[i - 1].info = NULL;
-            relayCount = _BRTxPeerListAddPeer(&manager->txRelays, txHash, peer);
+            relayCount = BRTxPeerListAddPeer(&manager->txRelays, manager->wallet, txHash, peer, time(NULL));
         }
         else if (manager->publishedTx[i - 1].callback != NULL) hasPendingCallbacks = 1;
     }
@@ -1031,14 +963,14 @@ static void _peerHasTx(void *info, UInt256 txHash)
         
         // keep track of how many peers have or relay a tx, this indicates how likely the tx is to confirm
         // (we only need to track this after syncing is complete)
-        if (manager->syncStartHeight == 0) relayCount = _BRTxPeerListAddPeer(&manager->txRelays, txHash, peer);
+        if (manager->syncStartHeight == 0) relayCount = BRTxPeerListAddPeer(&manager->txRelays, manager->wallet, txHash, peer, time(NULL));
 
         // set timestamp when tx is verified
         if (relayCount >= manager->maxConnectCount && tx && tx->blockHeight == TX_UNCONFIRMED && tx->timestamp == 0) {
             BRWalletUpdateTransactions(manager->wallet, &txHash, 1, TX_UNCONFIRMED, (uint32_t)time(NULL));
         }
 
-        _BRTxPeerListRemovePeer(manager->txRequests, txHash, peer);
+        BRTxPeerListRemovePeer(&manager->txRequests, txHash, peer);
     }
     
     pthread_mutex_unlock(&manager->lock);
@@ -1054,10 +986,10 @@ static void _peerRejectedTx(void *info, UInt256 txHash, uint8_t code)
     pthread_mutex_lock(&manager->lock);
     peer_log(peer, "rejected tx: %s", u256hex(txHash));
     tx = BRWalletTransactionForHash(manager->wallet, txHash);
-    _BRTxPeerListRemovePeer(manager->txRequests, txHash, peer);
+    BRTxPeerListRemovePeer(&manager->txRequests, txHash, peer);
 
     if (tx) {
-        if (_BRTxPeerListRemovePeer(manager->txRelays, txHash, peer) && tx->blockHeight == TX_UNCONFIRMED) {
+        if (BRTxPeerListRemovePeer(&manager->txRelays, txHash, peer) && tx->blockHeight == TX_UNCONFIRMED) {
             // set timestamp 0 to mark tx as unverified
             BRWalletUpdateTransactions(manager->wallet, &txHash, 1, TX_UNCONFIRMED, 0);
         }
@@ -1141,22 +1073,23 @@ static void _peerRelayedBlockFailed (BRMerkleBlock *blockToFree, BRPeer *peer, c
     assert (0);
 }
 
-static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
+// connects or stores block, returning the next orphan in the chain that block is the parent of, if any
+static BRMerkleBlock *_peerRelayedBlockConnect(void *info, BRMerkleBlock *block)
 {
     if (NULL == info || NULL == block) {
         _peerRelayedBlockFailed (block, NULL, "missed 'info' or 'block'");
-        return;
+        return NULL;
     }
 
     BRPeer *peer = ((BRPeerCallbackInfo *)info)->peer;
     BRPeerManager *manager = ((BRPeerCallbackInfo *)info)->manager;
     size_t i, j, fpCount = 0, saveCount = 0;
-    BRMerkleBlock orphan, *b, *b2, *prev, *next = NULL;
+    BRMerkleBlock *b, *b2, *prev, *next = NULL;
     uint32_t txTime = 0;
 
     if (NULL == peer || NULL == manager) {
         _peerRelayedBlockFailed (block, peer, "missed 'peer' or 'manager'");
-        return;
+        return NULL;
     }
 
     // Check manager - ensure anything dereferenced subsequently is valid
@@ -1165,7 +1098,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         NULL == manager->lastBlock ||
         NULL == manager->downloadPeer) {
         _peerRelayedBlockFailed (block, peer, "missed 'manager' fields");
-        return;
+        return NULL;
     }
 
     // Check block - ensure anything dereferenced subsequently is valid.  The only pointers in
@@ -1173,7 +1106,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
     if ((NULL == block->hashes && 0 != block->hashesCount) ||
         (NULL == block->flags  && 0 != block->flagsLen)) {
         _peerRelayedBlockFailed (block, peer, "missed 'block' fields");
-        return;
+        return NULL;
     }
 
     size_t txCount = BRMerkleBlockTxHashes(block, NULL, 0);
@@ -1241,7 +1174,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         else {
             // call getblocks, unless we already did with the previous block, or we're still syncing
             if (manager->lastBlock->height >= BRPeerLastBlock(peer) &&
-                (! manager->lastOrphan || ! UInt256Eq(manager->lastOrphan->blockHash, block->prevBlock))) {
+                ! UInt256Eq(manager->lastOrphanHash, block->prevBlock)) {
                 UInt256 locators[_BRPeerManagerBlockLocators(manager, NULL, 0)];
                 size_t locatorsCount = _BRPeerManagerBlockLocators(manager, locators,
                                                                    sizeof(locators)/sizeof(*locators));
@@ -1250,8 +1183,12 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
                 BRPeerSendGetblocks(peer, locators, locatorsCount, UINT256_ZERO);
             }
             
-            BRSetAdd(manager->orphans, block); // BUG: limit total orphans to avoid memory exhaustion attack
-            manager->lastOrphan = block;
+            manager->lastOrphanHash = block->blockHash;
+
+            if (! BROrphanPoolAdd(&manager->orphans, block, time(NULL))) { // already have it from another peer
+                BRMerkleBlockFree(block);
+                block = NULL;
+            }
         }
     }
     else if (! _BRPeerManagerVerifyBlock(manager, block, prev, peer)) { // block is invalid
@@ -1294,7 +1231,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
 
         if (NULL == b) {
             _peerRelayedBlockFailed (block, peer, "In 'already have a block' missed 'b'");
-            return;
+            return NULL;
         }
 
         if (BRMerkleBlockEq(b, block)) { // if it's not on a fork, set block heights for its transactions
@@ -1305,16 +1242,19 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         b = BRSetAdd(manager->blocks, block);
 
         if (b != block) {
-            if (BRSetGet(manager->orphans, b) == b) BRSetRemove(manager->orphans, b);
-            if (manager->lastOrphan == b) manager->lastOrphan = NULL;
+            BROrphanPoolRemove(&manager->orphans, b);
             BRMerkleBlockFree(b);
         }
     }
     else if (manager->lastBlock->height < BRPeerLastBlock(peer) &&
              block->height > manager->lastBlock->height + 1) { // special case, new block mined durring rescan
         peer_log(peer, "marking new block #%"PRIu32" as orphan until rescan completes", block->height);
-        BRSetAdd(manager->orphans, block); // mark as orphan til we're caught up
-        manager->lastOrphan = block;
+        manager->lastOrphanHash = block->blockHash;
+
+        if (! BROrphanPoolAdd(&manager->orphans, block, time(NULL))) { // mark as orphan til we're caught up
+            BRMerkleBlockFree(block);
+            block = NULL;
+        }
     }
     else if (block->height <= manager->params->checkpoints[manager->params->checkpointsCount - 1].height) { // old fork
         peer_log(peer, "ignoring block on fork older than most recent checkpoint, block #%"PRIu32", hash: %s",
@@ -1339,7 +1279,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
 
             if (NULL == b) {
                 _peerRelayedBlockFailed (NULL, peer, "In 'on a fork' missed 'b'");
-                return;
+                return NULL;
             }
             peer_log(peer, "reorganizing chain from height %"PRIu32", new height is %"PRIu32, b->height, block->height);
         
@@ -1356,7 +1296,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
                                malloc(count*sizeof(*txHashes));
                     if (NULL == txHashes) {
                         _peerRelayedBlockFailed (NULL, peer, "In 'on a fork' missed 'txHashes'");
-                        return;
+                        return NULL;
                     }
                     txCount = count;
                 }
@@ -1382,8 +1322,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         if (block->height > manager->estimatedHeight) manager->estimatedHeight = block->height;
         
         // check if the next block was received as an orphan
-        orphan.prevBlock = block->blockHash;
-        next = BRSetRemove(manager->orphans, &orphan);
+        next = BROrphanPoolTakeChild(&manager->orphans, block->blockHash);
     }
     
     BRMerkleBlock *saveBlocks[saveCount];
@@ -1391,7 +1330,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
     for (i = 0, b = block; b && i < saveCount; i++) {
         if (b->height == BLOCK_UNKNOWN_HEIGHT) {
             _peerRelayedBlockFailed (NULL, peer, "In 'save' missed 'height'");
-            return;
+            return NULL;
         }
         saveBlocks[i] = b;
         b = BRSetGet(manager->blocks, &b->prevBlock);
@@ -1402,7 +1341,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
     if (j > 0) i -= (i > BLOCK_DIFFICULTY_INTERVAL - j) ? BLOCK_DIFFICULTY_INTERVAL - j : i;
     if (i != 0 && (saveBlocks[i - 1]->height % BLOCK_DIFFICULTY_INTERVAL) != 0) {
         _peerRelayedBlockFailed (NULL, peer, "In 'save' missed 'difficulty'");
-        return;
+        return NULL;
     }
     if (i > 0 && manager->saveBlocks) manager->saveBlocks(manager->info, (i > 1 ? 1 : 0), saveBlocks, i);
     pthread_mutex_unlock(&manager->lock);
@@ -1412,7 +1351,13 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         manager->txStatusUpdate(manager->info); // notify that transaction confirmations may have changed
     }
     
-    if (next) _peerRelayedBlock(info, next);
+    return next;
+}
+
+static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
+{
+    // connect a whole run of orphans once their parent arrives, without recursing once per block
+    while (block) block = _peerRelayedBlockConnect(info, block);
 }
 
 static void _peerDataNotfound(void *info, const UInt256 txHashes[], size_t txCount,
@@ -1424,8 +1369,8 @@ static void _peerDataNotfound(void *info, const UInt256 txHashes[], size_t txCou
     pthread_mutex_lock(&manager->lock);
 
     for (size_t i = 0; i < txCount; i++) {
-        _BRTxPeerListRemovePeer(manager->txRelays, txHashes[i], peer);
-        _BRTxPeerListRemovePeer(manager->txRequests, txHashes[i], peer);
+        BRTxPeerListRemovePeer(&manager->txRelays, txHashes[i], peer);
+        BRTxPeerListRemovePeer(&manager->txRequests, txHashes[i], peer);
     }
 
     pthread_mutex_unlock(&manager->lock);
@@ -1477,7 +1422,7 @@ static BRTransaction *_peerRequestedTx(void *info, UInt256 txHash)
         BRPeerScheduleDisconnect(peer, -1); // cancel publish tx timeout
     }
 
-    _BRTxPeerListAddPeer(&manager->txRelays, txHash, peer);
+    BRTxPeerListAddPeer(&manager->txRelays, manager->wallet, txHash, peer, time(NULL));
     if (pubTx.tx) BRWalletRegisterTransaction(manager->wallet, pubTx.tx);
     if (pubTx.tx && ! BRWalletTransactionIsValid(manager->wallet, pubTx.tx)) error = EINVAL;
     pthread_mutex_unlock(&manager->lock);
@@ -1513,6 +1458,7 @@ BRPeerManager *BRPeerManagerNew(const BRChainParams *params, BRWallet *wallet, u
 {
     BRPeerManager *manager = calloc(1, sizeof(*manager));
     BRMerkleBlock orphan, *block = NULL;
+    BRSet *saved;
     
     assert(manager != NULL);
     assert(params != NULL);
@@ -1530,7 +1476,7 @@ BRPeerManager *BRPeerManagerNew(const BRChainParams *params, BRWallet *wallet, u
     qsort(manager->peers, array_count(manager->peers), sizeof(*manager->peers), _peerTimestampCompare);
     array_new(manager->connectedPeers, PEER_MAX_CONNECTIONS);
     manager->blocks = BRSetNew(BRMerkleBlockHash, BRMerkleBlockEq, blocksCount);
-    manager->orphans = BRSetNew(_BRPrevBlockHash, _BRPrevBlockEq, blocksCount); // orphans are indexed by prevBlock
+    BROrphanPoolInit(&manager->orphans);
     manager->checkpoints = BRSetNew(_BRBlockHeightHash, _BRBlockHeightEq, 100); // checkpoints are indexed by height
 
     for (size_t i = 0; i < manager->params->checkpointsCount; i++) {
@@ -1548,10 +1494,11 @@ BRPeerManager *BRPeerManagerNew(const BRChainParams *params, BRWallet *wallet, u
               (manager->lastBlock ? manager->lastBlock->height : (uint32_t) -1));
 
     block = NULL;
+    saved = BRSetNew(_BRPrevBlockHash, _BRPrevBlockEq, blocksCount); // saved blocks are indexed by prevBlock
     
     for (size_t i = 0; blocks && i < blocksCount; i++) {
         assert(blocks[i]->height != BLOCK_UNKNOWN_HEIGHT); // height must be saved/restored along with serialized block
-        BRSetAdd(manager->orphans, blocks[i]);
+        BRSetAdd(saved, blocks[i]);
 
         if ((blocks[i]->height % BLOCK_DIFFICULTY_INTERVAL) == 0 &&
             (! block || blocks[i]->height > block->height)) block = blocks[i]; // find last transition block
@@ -1561,15 +1508,23 @@ BRPeerManager *BRPeerManagerNew(const BRChainParams *params, BRWallet *wallet, u
         BRSetAdd(manager->blocks, block);
         manager->lastBlock = block;
         orphan.prevBlock = block->prevBlock;
-        BRSetRemove(manager->orphans, &orphan);
+        BRSetRemove(saved, &orphan);
         orphan.prevBlock = block->blockHash;
-        block = BRSetGet(manager->orphans, &orphan);
+        block = BRSetGet(saved, &orphan);
     }
 
+    // saved blocks not on the main chain are kept as orphans
+    for (block = BRSetIterate(saved, NULL); block; block = BRSetIterate(saved, block)) {
+        if (! BROrphanPoolAdd(&manager->orphans, block, time(NULL))) BRMerkleBlockFree(block);
+    }
+
+    BRSetFree(saved);
+    block = NULL;
+
     _peer_log("BPM: initialized with %u last block height", manager->lastBlock->height);
 
-    array_new(manager->txRelays, 10);
-    array_new(manager->txRequests, 10);
+    BRTxPeerListInit(&manager->txRelays);
+    BRTxPeerListInit(&manager->txRequests);
     array_new(manager->publishedTx, 10);
     array_new(manager->publishedTxHashes, 10);
     pthread_mutex_init(&manager->lock, NULL);
@@ -2049,12 +2004,7 @@ size_t BRPeerManagerRelayCount(BRPeerManager *manager, UInt256 txHash)
     assert(! UInt256IsZero(txHash));
     pthread_mutex_lock(&manager->lock);
     
-    for (size_t i = array_count(manager->txRelays); i > 0; i--) {
-        if (! UInt256Eq(manager->txRelays[i - 1].txHash, txHash)) continue;
-        count = array_count(manager->txRelays[i - 1].peers);
-        break;
-    }
-    
+    count = BRTxPeerListCount(&manager->txRelays, txHash);
     pthread_mutex_unlock(&manager->lock);
     return count;
 }
@@ -2075,13 +2025,10 @@ void BRPeerManagerFree(BRPeerManager *manager)
     array_free(manager->connectedPeers);
     BRSetApply(manager->blocks, NULL, _setApplyFreeBlock);
     BRSetFree(manager->blocks);
-    BRSetApply(manager->orphans, NULL, _setApplyFreeBlock);
-    BRSetFree(manager->orphans);
+    BROrphanPoolFree(&manager->orphans);
     BRSetFree(manager->checkpoints);
-    for (size_t i = array_count(manager->txRelays); i > 0; i--) array_free(manager->txRelays[i - 1].peers);
-    array_free(manager->txRelays);
-    for (size_t i = array_count(manager->txRequests); i > 0; i--) array_free(manager->txRequests[i - 1].peers);
-    array_free(manager->txRequests);
+    BRTxPeerListFree(&manager->txRelays);
+    BRTxPeerListFree(&manager->txRequests);
 
     for (size_t i = array_count(manager->publishedTx); i > 0; i--) {
         tx = manager->publishedTx[i - 1].tx;
@@ -36,6 +36,75 @@
 #define SIGHASH_ANYONECANPAY 0x80 // let other people add inputs, I don't care where the rest of the bitcoins come from
 #define SIGHASH_FORKID       0x40 // use BIP143 digest method (for b-cash/b-gold signatures)
 
+// transactions returned by BRTransactionParse() and BRTransactionCopy() live in a single allocation holding the struct,
+// the inputs and outputs arrays, and every script, signature and witness; those arrays carry a BRArray header with a
+// capacity of TX_ARENA_CAPACITY so that they are never resized or freed on their own
+#define TX_ARENA_CAPACITY SIZE_MAX
+#define TX_ARENA_HDR      (sizeof(size_t)*2)
+
+#define _tx_arena_align(len)         (((len) + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1))
+#define _tx_arena_len(array, len)    ((array) ? TX_ARENA_HDR + _tx_arena_align(len) : 0)
+#define _tx_array_owned(array)       ((array) != NULL && array_capacity(array) != TX_ARENA_CAPACITY)
+
+// places an arena array of count elements totalling len bytes at *next, and advances *next past it
+static void *_BRTxArenaArray(uint8_t **next, size_t count, size_t len)
+{
+    size_t *hdr = (size_t *)*next;
+
+    hdr[0] = TX_ARENA_CAPACITY;
+    hdr[1] = count;
+    *next += TX_ARENA_HDR + _tx_arena_align(len);
+    return &hdr[2];
+}
+
+static uint8_t *_BRTxArenaBytes(uint8_t **next, const uint8_t *bytes, size_t len)
+{
+    uint8_t *array = _BRTxArenaArray(next, len, len);
+
+    if (len > 0) memcpy(array, bytes, len);
+    return array;
+}
+
+// returns a zeroed transaction with inCount inputs and outCount outputs, followed by bufLen bytes for _BRTxArenaBytes()
+static BRTransaction *_BRTransactionArenaNew(size_t inCount, size_t outCount, size_t bufLen, uint8_t **next)
+{
+    size_t off = _tx_arena_align(sizeof(BRTransaction));
+    uint8_t *arena = calloc(1, off + TX_ARENA_HDR + inCount*sizeof(BRTxInput) + TX_ARENA_HDR +
+                            outCount*sizeof(BRTxOutput) + bufLen);
+    BRTransaction *tx = (BRTransaction *)arena;
+
+    assert(arena != NULL);
+    *next = &arena[off];
+    tx->inputs = _BRTxArenaArray(next, inCount, inCount*sizeof(BRTxInput));
+    tx->inCount = inCount;
+    tx->outputs = _BRTxArenaArray(next, outCount, outCount*sizeof(BRTxOutput));
+    tx->outCount = outCount;
+    return tx;
+}
+
+// moves arena inputs and outputs arrays onto the heap so they can grow; their elements are left where they are. the
+// elements are copied straight into the new array's reserved capacity, since array_add_array() would carry a resize
+// path that the compiler can't rule out
+static void _BRTransactionOwnArrays(BRTransaction *tx)
+{
+    BRTxInput *inputs;
+    BRTxOutput *outputs;
+
+    if (! _tx_array_owned(tx->inputs)) {
+        array_new(inputs, tx->inCount + 1);
+        if (tx->inCount > 0) memcpy(inputs, tx->inputs, tx->inCount*sizeof(*inputs));
+        array_count(inputs) = tx->inCount;
+        tx->inputs = inputs;
+    }
+
+    if (! _tx_array_owned(tx->outputs)) {
+        array_new(outputs, tx->outCount + 1);
+        if (tx->outCount > 0) memcpy(outputs, tx->outputs, tx->outCount*sizeof(*outputs));
+        array_count(outputs) = tx->outCount;
+        tx->outputs = outputs;
+    }
+}
+
 size_t BRTxInputAddress(const BRTxInput *input, char *address, size_t addrLen, BRAddressParams params)
 {
     size_t r = BRAddressFromScriptPubKey(address, addrLen, params, input->script, input->scriptLen);
@@ -49,7 +118,7 @@ void BRTxInputSetAddress(BRTxInput *input, BRAddressParams params, const char *a
 {
     assert(input != NULL);
     assert(address == NULL || BRAddressIsValid(params, address));
-    if (input->script) array_free(input->script);
+    if (_tx_array_owned(input->script)) array_free(input->script);
     input->script = NULL;
     input->scriptLen = 0;
 
@@ -65,7 +134,7 @@ void BRTxInputSetScript(BRTxInput *input, const uint8_t *script, size_t scriptLe
 {
     assert(input != NULL);
     assert(script != NULL || scriptLen == 0);
-    if (input->script) array_free(input->script);
+    if (_tx_array_owned(input->script)) array_free(input->script);
     input->script = NULL;
     input->scriptLen = 0;
     
@@ -80,7 +149,7 @@ void BRTxInputSetSignature(BRTxInput *input, const uint8_t *signature, size_t si
 {
     assert(input != NULL);
     assert(signature != NULL || sigLen == 0);
-    if (input->signature) array_free(input->signature);
+    if (_tx_array_owned(input->signature)) array_free(input->signature);
     input->signature = NULL;
     input->sigLen = 0;
     
@@ -95,7 +164,7 @@ void BRTxInputSetWitness(BRTxInput *input, const uint8_t *witness, size_t witLen
 {
     assert(input != NULL);
     assert(witness != NULL || witLen == 0);
-    if (input->witness) array_free(input->witness);
+    if (_tx_array_owned(input->witness)) array_free(input->witness);
     input->witness = NULL;
     input->witLen = 0;
     
@@ -139,7 +208,7 @@ void BRTxOutputSetAddress(BRTxOutput *output, BRAddressParams params, const char
 {
     assert(output != NULL);
     assert(address == NULL || BRAddressIsValid(params, address));
-    if (output->script) array_free(output->script);
+    if (_tx_array_owned(output->script)) array_free(output->script);
     output->script = NULL;
     output->scriptLen = 0;
 
@@ -154,7 +223,7 @@ void BRTxOutputSetAddress(BRTxOutput *output, BRAddressParams params, const char
 void BRTxOutputSetScript(BRTxOutput *output, const uint8_t *script, size_t scriptLen)
 {
     assert(output != NULL);
-    if (output->script) array_free(output->script);
+    if (_tx_array_owned(output->script)) array_free(output->script);
     output->script = NULL;
     output->scriptLen = 0;
 
@@ -368,123 +437,203 @@ BRTransaction *BRTransactionNew(void)
 // returns a deep copy of tx and that must be freed by calling BRTransactionFree()
 BRTransaction *BRTransactionCopy(const BRTransaction *tx)
 {
-    BRTransaction *cpy = BRTransactionNew();
-    BRTxInput *inputs = cpy->inputs;
-    BRTxOutput *outputs = cpy->outputs;
-    
+    BRTransaction *cpy;
+    BRTxInput *inputs, *input;
+    BRTxOutput *outputs, *output;
+    uint8_t *next;
+    size_t i, bufLen = 0;
+
     assert(tx != NULL);
+
+    for (i = 0; i < tx->inCount; i++) {
+        input = &tx->inputs[i];
+        bufLen += _tx_arena_len(input->script, input->scriptLen) + _tx_arena_len(input->signature, input->sigLen) +
+                  _tx_arena_len(input->witness, input->witLen);
+    }
+
+    for (i = 0; i < tx->outCount; i++) bufLen += _tx_arena_len(tx->outputs[i].script, tx->outputs[i].scriptLen);
+
+    cpy = _BRTransactionArenaNew(tx->inCount, tx->outCount, bufLen, &next);
+    inputs = cpy->inputs;
+    outputs = cpy->outputs;
     *cpy = *tx;
     cpy->inputs = inputs;
     cpy->outputs = outputs;
-    cpy->inCount = cpy->outCount = 0;
 
-    for (size_t i = 0; i < tx->inCount; i++) {
-        BRTransactionAddInput(cpy, tx->inputs[i].txHash, tx->inputs[i].index, tx->inputs[i].amount,
-                              tx->inputs[i].script, tx->inputs[i].scriptLen,
-                              tx->inputs[i].signature, tx->inputs[i].sigLen,
-                              tx->inputs[i].witness, tx->inputs[i].witLen, tx->inputs[i].sequence);
+    for (i = 0; i < tx->inCount; i++) {
+        input = &cpy->inputs[i];
+        *input = tx->inputs[i];
+        if (input->script) input->script = _BRTxArenaBytes(&next, input->script, input->scriptLen);
+        if (input->signature) input->signature = _BRTxArenaBytes(&next, input->signature, input->sigLen);
+        if (input->witness) input->witness = _BRTxArenaBytes(&next, input->witness, input->witLen);
     }
-    
-    for (size_t i = 0; i < tx->outCount; i++) {
-        BRTransactionAddOutput(cpy, tx->outputs[i].amount, tx->outputs[i].script, tx->outputs[i].scriptLen);
+
+    for (i = 0; i < tx->outCount; i++) {
+        output = &cpy->outputs[i];
+        *output = tx->outputs[i];
+        if (output->script) output->script = _BRTxArenaBytes(&next, output->script, output->scriptLen);
     }
 
     return cpy;
 }
 
+// walks a serialized tx and returns the number of inputs, outputs and arena bytes needed to hold its scripts,
+// signatures and witnesses, or 0 if buf does not hold a complete tx
+static size_t _BRTransactionParseSize(const uint8_t *buf, size_t bufLen, size_t *inCount, size_t *outCount,
+                                      size_t *arenaLen)
+{
+    int witnessFlag = 0;
+    size_t i, j, off = 0, sLen = 0, len = 0, count;
+
+    *arenaLen = 0;
+    off += sizeof(uint32_t);
+    *inCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+    off += len;
+    if (*inCount == 0 && off + 1 <= bufLen) witnessFlag = buf[off++];
+
+    if (witnessFlag) {
+        *inCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        off += len;
+    }
+
+    for (i = 0; off <= bufLen && i < *inCount; i++) {
+        off += sizeof(UInt256) + sizeof(uint32_t);
+        sLen = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        off += len;
+        if (off + sLen <= bufLen && BRScriptPubKeyIsValid(&buf[off], sLen)) off += sizeof(uint64_t);
+        *arenaLen += TX_ARENA_HDR + _tx_arena_align(sLen);
+        if (! witnessFlag) *arenaLen += TX_ARENA_HDR; // empty witness
+        off += sLen + sizeof(uint32_t);
+    }
+
+    *outCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+    off += len;
+
+    for (i = 0; off <= bufLen && i < *outCount; i++) {
+        off += sizeof(uint64_t);
+        sLen = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        off += len;
+        *arenaLen += TX_ARENA_HDR + _tx_arena_align(sLen);
+        off += sLen;
+    }
+
+    for (i = 0; witnessFlag && off <= bufLen && i < *inCount; i++) {
+        count = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        off += len;
+
+        for (j = 0, sLen = 0; j < count && off + sLen <= bufLen; j++) {
+            sLen += (size_t)BRVarInt(&buf[off + sLen], (off + sLen <= bufLen ? bufLen - (off + sLen) : 0), &len);
+            sLen += len;
+        }
+
+        *arenaLen += TX_ARENA_HDR + _tx_arena_align(sLen);
+        off += sLen;
+    }
+
+    off += sizeof(uint32_t);
+    return (*inCount == 0 || off > bufLen) ? 0 : off;
+}
+
 // buf must contain a serialized tx
 // retruns a transaction that must be freed by calling BRTransactionFree()
+// the tx is sized up front and parsed into a single allocation, see _BRTransactionArenaNew()
 BRTransaction *BRTransactionParse(const uint8_t *buf, size_t bufLen)
 {
     assert(buf != NULL || bufLen == 0);
     if (! buf) return NULL;
     
     int isSigned = 1, witnessFlag = 0;
-    uint8_t *sBuf;
-    size_t i, j, off = 0, witnessOff = 0, sLen = 0, len = 0, count;
-    BRTransaction *tx = BRTransactionNew();
+    uint8_t *next, ver[sizeof(uint32_t)], lock[sizeof(uint32_t)], t[32];
+    size_t i, j, off = 0, witnessOff = 0, sLen = 0, len = 0, count, inCount, outCount, arenaLen;
+    BRTransaction *tx;
     BRTxInput *input;
     BRTxOutput *output;
-    
-    tx->version = (off + sizeof(uint32_t) <= bufLen) ? UInt32GetLE(&buf[off]) : 0;
+
+    if (_BRTransactionParseSize(buf, bufLen, &inCount, &outCount, &arenaLen) == 0) return NULL;
+    tx = _BRTransactionArenaNew(inCount, outCount, arenaLen, &next);
+    tx->blockHeight = TX_UNCONFIRMED;
+
+    // the size pass above has bounds checked every read below
+    tx->version = UInt32GetLE(&buf[off]);
     off += sizeof(uint32_t);
-    tx->inCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+    count = (size_t)BRVarInt(&buf[off], bufLen - off, &len);
     off += len;
-    if (tx->inCount == 0 && off + 1 <= bufLen) witnessFlag = buf[off++];
-    
+    if (count == 0) witnessFlag = buf[off++];
+
     if (witnessFlag) {
-        tx->inCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        BRVarInt(&buf[off], bufLen - off, &len);
         off += len;
     }
 
-    array_set_count(tx->inputs, tx->inCount);
-    
-    for (i = 0; off <= bufLen && i < tx->inCount; i++) {
+    for (i = 0; i < tx->inCount; i++) {
         input = &tx->inputs[i];
-        input->txHash = (off + sizeof(UInt256) <= bufLen) ? UInt256Get(&buf[off]) : UINT256_ZERO;
+        input->txHash = UInt256Get(&buf[off]);
         off += sizeof(UInt256);
-        input->index = (off + sizeof(uint32_t) <= bufLen) ? UInt32GetLE(&buf[off]) : 0;
+        input->index = UInt32GetLE(&buf[off]);
         off += sizeof(uint32_t);
-        sLen = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        sLen = (size_t)BRVarInt(&buf[off], bufLen - off, &len);
         off += len;
         
-        if (off + sLen <= bufLen && BRScriptPubKeyIsValid(&buf[off], sLen)) {
-            BRTxInputSetScript(input, &buf[off], sLen);
-            input->amount = (off + sLen + sizeof(uint64_t) <= bufLen) ? UInt64GetLE(&buf[off + sLen]) : 0;
+        if (BRScriptPubKeyIsValid(&buf[off], sLen)) {
+            input->script = _BRTxArenaBytes(&next, &buf[off], sLen);
+            input->scriptLen = sLen;
+            input->amount = UInt64GetLE(&buf[off + sLen]);
             off += sizeof(uint64_t);
             isSigned = 0;
         }
-        else if (off + sLen <= bufLen) BRTxInputSetSignature(input, &buf[off], sLen);
+        else {
+            input->signature = _BRTxArenaBytes(&next, &buf[off], sLen);
+            input->sigLen = sLen;
+        }
         
         off += sLen;
-        if (! witnessFlag) BRTxInputSetWitness(input, &buf[off], 0); // set witness to empty byte array
-        input->sequence = (off + sizeof(uint32_t) <= bufLen) ? UInt32GetLE(&buf[off]) : 0;
+        if (! witnessFlag) input->witness = _BRTxArenaBytes(&next, NULL, 0); // set witness to empty byte array
+        input->sequence = UInt32GetLE(&buf[off]);
         off += sizeof(uint32_t);
     }
     
-    tx->outCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+    BRVarInt(&buf[off], bufLen - off, &len);
     off += len;
-    array_set_count(tx->outputs, tx->outCount);
     
-    for (i = 0; off <= bufLen && i < tx->outCount; i++) {
+    for (i = 0; i < tx->outCount; i++) {
         output = &tx->outputs[i];
-        output->amount = (off + sizeof(uint64_t) <= bufLen) ? UInt64GetLE(&buf[off]) : 0;
+        output->amount = UInt64GetLE(&buf[off]);
         off += sizeof(uint64_t);
-        sLen = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        sLen = (size_t)BRVarInt(&buf[off], bufLen - off, &len);
         off += len;
-        if (off + sLen <= bufLen) BRTxOutputSetScript(output, &buf[off], sLen);
+        output->script = _BRTxArenaBytes(&next, &buf[off], sLen);
+        output->scriptLen = sLen;
         off += sLen;
     }
     
-    for (i = 0, witnessOff = off; witnessFlag && off <= bufLen && i < tx->inCount; i++) {
+    for (i = 0, witnessOff = off; witnessFlag && i < tx->inCount; i++) {
         input = &tx->inputs[i];
-        count = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        count = (size_t)BRVarInt(&buf[off], bufLen - off, &len);
         off += len;
         
         for (j = 0, sLen = 0; j < count; j++) {
-            sLen += (size_t)BRVarInt(&buf[off + sLen], (off + sLen <= bufLen ? bufLen - (off + sLen) : 0), &len);
+            sLen += (size_t)BRVarInt(&buf[off + sLen], bufLen - (off + sLen), &len);
             sLen += len;
         }
         
-        if (off + sLen <= bufLen) BRTxInputSetWitness(input, &buf[off], sLen);
+        input->witness = _BRTxArenaBytes(&next, &buf[off], sLen);
+        input->witLen = sLen;
         off += sLen;
     }
     
-    tx->lockTime = (off + sizeof(uint32_t) <= bufLen) ? UInt32GetLE(&buf[off]) : 0;
+    tx->lockTime = UInt32GetLE(&buf[off]);
     off += sizeof(uint32_t);
     
-    if (tx->inCount == 0 || off > bufLen) {
-        BRTransactionFree(tx);
-        tx = NULL;
-    }
-    else if (isSigned && witnessFlag) {
+    if (isSigned && witnessFlag) {
+        // txHash skips the marker, flag and witnesses; hash the pieces in place rather than copying them together
+        const void *parts[] = { ver, &buf[sizeof(uint32_t) + 2], lock };
+        const size_t partLens[] = { sizeof(ver), witnessOff - (sizeof(uint32_t) + 2), sizeof(lock) };
+
         BRSHA256_2(&tx->wtxHash, buf, off);
-        sBuf = malloc((witnessOff - 2) + sizeof(uint32_t));
-        UInt32SetLE(sBuf, tx->version);
-        memcpy(&sBuf[sizeof(uint32_t)], &buf[sizeof(uint32_t) + 2], witnessOff - (sizeof(uint32_t) + 2));
-        UInt32SetLE(&sBuf[witnessOff - 2], tx->lockTime);
-        BRSHA256_2(&tx->txHash, sBuf, (witnessOff - 2) + sizeof(uint32_t));
-        free(sBuf);
+        UInt32SetLE(ver, tx->version);
+        UInt32SetLE(lock, tx->lockTime);
+        BRSHA256Vec(t, parts, partLens, 3);
+        BRSHA256(&tx->txHash, t, sizeof(t));
     }
     else if (isSigned) {
         BRSHA256_2(&tx->txHash, buf, off);
@@ -516,6 +665,7 @@ void BRTransactionAddInput(BRTransaction *tx, UInt256 txHash, uint32_t index, ui
     assert(witness != NULL || witLen == 0);
     
     if (tx) {
+        _BRTransactionOwnArrays(tx);
         if (script) BRTxInputSetScript(&input, script, scriptLen);
         if (signature) BRTxInputSetSignature(&input, signature, sigLen);
         if (witness) BRTxInputSetWitness(&input, witness, witLen);
@@ -533,6 +683,7 @@ void BRTransactionAddOutput(BRTransaction *tx, uint64_t amount, const uint8_t *s
     assert(script != NULL || scriptLen == 0);
     
     if (tx) {
+        _BRTransactionOwnArrays(tx);
         BRTxOutputSetScript(&output, script, scriptLen);
         array_add(tx->outputs, output);
         tx->outCount = array_count(tx->outputs);
@@ -743,8 +894,8 @@ void BRTransactionFree(BRTransaction *tx)
             BRTxOutputSetScript(&tx->outputs[i], NULL, 0);
         }
 
-        array_free(tx->outputs);
-        array_free(tx->inputs);
-        free(tx);
+        if (_tx_array_owned(tx->outputs)) array_free(tx->outputs);
+        if (_tx_array_owned(tx->inputs)) array_free(tx->inputs);
+        free(tx); // for an arena tx this also releases its inputs, outputs and their buffers
     }
 }
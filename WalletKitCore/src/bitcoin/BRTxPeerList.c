@@ -0,0 +1,168 @@
+//
+//  BRTxPeerList.c
+//
+//  Split out of BRPeerManager.c.
+//  Copyright (c) 2015-2026 breadwallet LLC.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#include "BRTxPeerList.h"
+#include "BRPeerManager.h" // PEER_MAX_CONNECTIONS
+#include "support/BRArray.h"
+#include <stdlib.h>
+#include <assert.h>
+
+inline static size_t _BRTxPeerEntryHash(const void *entry)
+{
+    return (size_t)((const BRTxPeerEntry *)entry)->txHash.u32[0];
+}
+
+inline static int _BRTxPeerEntryEq(const void *entry, const void *otherEntry)
+{
+    return (entry == otherEntry ||
+            UInt256Eq(((const BRTxPeerEntry *)entry)->txHash, ((const BRTxPeerEntry *)otherEntry)->txHash));
+}
+
+void BRTxPeerListInit(BRTxPeerList *list)
+{
+    list->entries = BRSetNew(_BRTxPeerEntryHash, _BRTxPeerEntryEq, 100);
+    list->oldest = list->newest = NULL;
+}
+
+static void _BRTxPeerEntryFree(void *info, void *entry)
+{
+    array_free(((BRTxPeerEntry *)entry)->peers);
+    free(entry);
+}
+
+// frees memory allocated for the list's entries
+void BRTxPeerListFree(BRTxPeerList *list)
+{
+    BRSetApply(list->entries, NULL, _BRTxPeerEntryFree);
+    BRSetFree(list->entries);
+    list->entries = NULL;
+    list->oldest = list->newest = NULL;
+}
+
+inline static BRTxPeerEntry *_BRTxPeerListGet(const BRTxPeerList *list, UInt256 txHash)
+{
+    return BRSetGet(list->entries, &txHash);
+}
+
+static void _BRTxPeerListUnlink(BRTxPeerList *list, BRTxPeerEntry *entry)
+{
+    if (entry->older) entry->older->newer = entry->newer;
+    else list->oldest = entry->newer;
+    if (entry->newer) entry->newer->older = entry->older;
+    else list->newest = entry->older;
+    entry->older = entry->newer = NULL;
+}
+
+static void _BRTxPeerListLinkNewest(BRTxPeerList *list, BRTxPeerEntry *entry, time_t now)
+{
+    entry->timestamp = now;
+    entry->older = list->newest;
+    entry->newer = NULL;
+    if (list->newest) list->newest->newer = entry;
+    else list->oldest = entry;
+    list->newest = entry;
+}
+
+// evicts txHashes not added to for TX_PEER_LIST_MAX_AGE, or the oldest beyond TX_PEER_LIST_MAX_COUNT, except those
+// of unconfirmed wallet transactions, whose peer counts decide whether the transactions are kept or verified
+static void _BRTxPeerListEvict(BRTxPeerList *list, BRWallet *wallet, time_t now)
+{
+    BRTxPeerEntry *entry;
+    BRTransaction *tx;
+
+    for (size_t i = BRSetCount(list->entries); i > 0 && list->oldest; i--) {
+        entry = list->oldest;
+        if (BRSetCount(list->entries) <= TX_PEER_LIST_MAX_COUNT && entry->timestamp + TX_PEER_LIST_MAX_AGE > now) break;
+        tx = BRWalletTransactionForHash(wallet, entry->txHash);
+        _BRTxPeerListUnlink(list, entry);
+
+        if (tx && tx->blockHeight == TX_UNCONFIRMED) _BRTxPeerListLinkNewest(list, entry, now);
+        else {
+            BRSetRemove(list->entries, entry);
+            _BRTxPeerEntryFree(NULL, entry);
+        }
+    }
+}
+
+// true if peer is contained in the list of peers associated with txHash
+int BRTxPeerListHasPeer(const BRTxPeerList *list, UInt256 txHash, const BRPeer *peer)
+{
+    BRTxPeerEntry *entry = _BRTxPeerListGet(list, txHash);
+
+    for (size_t i = (entry) ? array_count(entry->peers) : 0; i > 0; i--) {
+        if (BRPeerEq(&entry->peers[i - 1], peer)) return 1;
+    }
+
+    return 0;
+}
+
+// number of peers associated with txHash
+size_t BRTxPeerListCount(const BRTxPeerList *list, UInt256 txHash)
+{
+    BRTxPeerEntry *entry = _BRTxPeerListGet(list, txHash);
+
+    return (entry) ? array_count(entry->peers) : 0;
+}
+
+// adds peer to the list of peers associated with txHash and returns the new total number of peers
+size_t BRTxPeerListAddPeer(BRTxPeerList *list, BRWallet *wallet, UInt256 txHash, const BRPeer *peer, time_t now)
+{
+    BRTxPeerEntry *entry = _BRTxPeerListGet(list, txHash);
+
+    if (entry) {
+        _BRTxPeerListUnlink(list, entry);
+        _BRTxPeerListLinkNewest(list, entry, now);
+
+        for (size_t i = array_count(entry->peers); i > 0; i--) {
+            if (BRPeerEq(&entry->peers[i - 1], peer)) return array_count(entry->peers);
+        }
+
+        array_add(entry->peers, *peer);
+        return array_count(entry->peers);
+    }
+
+    _BRTxPeerListEvict(list, wallet, now);
+    entry = calloc(1, sizeof(*entry));
+    assert(entry != NULL);
+    entry->txHash = txHash;
+    array_new(entry->peers, PEER_MAX_CONNECTIONS);
+    array_add(entry->peers, *peer);
+    BRSetAdd(list->entries, entry);
+    _BRTxPeerListLinkNewest(list, entry, now);
+    return 1;
+}
+
+// removes peer from the list of peers associated with txHash, returns true if peer was found
+int BRTxPeerListRemovePeer(BRTxPeerList *list, UInt256 txHash, const BRPeer *peer)
+{
+    BRTxPeerEntry *entry = _BRTxPeerListGet(list, txHash);
+
+    for (size_t i = (entry) ? array_count(entry->peers) : 0; i > 0; i--) {
+        if (! BRPeerEq(&entry->peers[i - 1], peer)) continue;
+        array_rm(entry->peers, i - 1);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+//
+//  BRTxPeerList.h
+//
+//  Split out of BRPeerManager.c.
+//  Copyright (c) 2015-2026 breadwallet LLC.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#ifndef BRTxPeerList_h
+#define BRTxPeerList_h
+
+#include "BRPeer.h"
+#include "BRWallet.h"
+#include "support/BRSet.h"
+#include "support/BRInt.h"
+#include <stddef.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TX_PEER_LIST_MAX_AGE   (3*60*60) // seconds a txHash is tracked after a peer was last added to it
+#define TX_PEER_LIST_MAX_COUNT 10000     // txHashes tracked before the oldest are evicted regardless of age
+
+typedef struct _BRTxPeerEntry {
+    UInt256 txHash; // must be first, entries are indexed by txHash
+    BRPeer *peers;
+    time_t timestamp; // time a peer was last added
+    struct _BRTxPeerEntry *older, *newer;
+} BRTxPeerEntry;
+
+// peers associated with each txHash, indexed by txHash and linked oldest to newest for eviction
+typedef struct {
+    BRSet *entries;
+    BRTxPeerEntry *oldest, *newest;
+} BRTxPeerList;
+
+void BRTxPeerListInit(BRTxPeerList *list);
+
+// frees memory allocated for the list's entries
+void BRTxPeerListFree(BRTxPeerList *list);
+
+// true if peer is contained in the list of peers associated with txHash
+int BRTxPeerListHasPeer(const BRTxPeerList *list, UInt256 txHash, const BRPeer *peer);
+
+// number of peers associated with txHash
+size_t BRTxPeerListCount(const BRTxPeerList *list, UInt256 txHash);
+
+// adds peer to the list of peers associated with txHash and returns the new total number of peers; before tracking a
+// new txHash, evicts txHashes not added to for TX_PEER_LIST_MAX_AGE, or the oldest beyond TX_PEER_LIST_MAX_COUNT, except
+// those of unconfirmed wallet transactions, whose peer counts decide whether the transactions are kept or verified
+size_t BRTxPeerListAddPeer(BRTxPeerList *list, BRWallet *wallet, UInt256 txHash, const BRPeer *peer, time_t now);
+
+// removes peer from the list of peers associated with txHash, returns true if peer was found
+int BRTxPeerListRemovePeer(BRTxPeerList *list, UInt256 txHash, const BRPeer *peer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BRTxPeerList_h
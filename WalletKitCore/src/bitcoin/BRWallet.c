@@ -51,19 +51,94 @@ inline static uint64_t _txFee(uint64_t feePerKb, size_t size)
     return (fee > standardFee) ? fee : standardFee;
 }
 
-// chain position of first tx output address that appears in chain
-inline static size_t _txChainIndex(const BRTransaction *tx, const UInt160 *chain)
+struct BRWalletAddressIndexStruct {
+    BRMasterPubKey masterPubKey;
+    UInt160 *internalChain, *externalChain; // the longest chains derived by any wallet using the index
+    BRSet *allPKH; // every hash160 in both chains
+    size_t refCount;
+    pthread_mutex_t lock;
+};
+
+inline static UInt160 *_BRWalletAddressIndexChain(const BRWalletAddressIndex *index, uint32_t internal)
 {
-    const uint8_t *pkh;
-    
-    for (size_t i = array_count(chain); i > 0; i--) {
-        for (size_t j = 0; j < tx->outCount; j++) {
-            pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
-            if (pkh && _pkhEq(pkh, &chain[i - 1])) return i - 1;
+    return (internal == SEQUENCE_INTERNAL_CHAIN) ? index->internalChain : index->externalChain;
+}
+
+// derives the next address in the given chain, must be called with index->lock held
+// returns false if the derived pubKey is invalid
+static int _BRWalletAddressIndexExtend(BRWalletAddressIndex *index, uint32_t internal)
+{
+    UInt160 *chain = _BRWalletAddressIndexChain(index, internal), *origChain = chain;
+    uint32_t n = (uint32_t)array_count(chain);
+    BRKey key;
+    uint8_t pubKey[BRBIP32PubKey(NULL, 0, index->masterPubKey, internal, n)];
+    size_t i, len = BRBIP32PubKey(pubKey, sizeof(pubKey), index->masterPubKey, internal, n);
+
+    if (! BRKeySetPubKey(&key, pubKey, len)) return 0;
+    array_add(chain, BRKeyHash160(&key));
+
+    // was chain moved to a new memory location?
+    if (chain == origChain) BRSetAdd(index->allPKH, &chain[n]);
+    else {
+        if (internal == SEQUENCE_EXTERNAL_CHAIN) index->externalChain = chain;
+        if (internal == SEQUENCE_INTERNAL_CHAIN) index->internalChain = chain;
+
+        BRSetClear(index->allPKH); // clear and rebuild allPKH
+
+        for (i = array_count(index->internalChain); i > 0; i--) {
+            BRSetAdd(index->allPKH, &index->internalChain[i - 1]);
+        }
+
+        for (i = array_count(index->externalChain); i > 0; i--) {
+            BRSetAdd(index->allPKH, &index->externalChain[i - 1]);
         }
     }
-    
-    return -1;
+
+    return 1;
+}
+
+// returns a reference counted address index for mpk that must be released by calling BRWalletAddressIndexRelease()
+BRWalletAddressIndex *BRWalletAddressIndexNew(BRMasterPubKey mpk)
+{
+    BRWalletAddressIndex *index = calloc(1, sizeof(*index));
+
+    assert(index != NULL);
+    index->masterPubKey = mpk;
+    array_new(index->internalChain, 100);
+    array_new(index->externalChain, 100);
+    index->allPKH = BRSetNew(_pkhHash, _pkhEq, 200);
+    index->refCount = 1;
+    pthread_mutex_init(&index->lock, NULL);
+    return index;
+}
+
+// adds a reference to index and returns it, thread-safe
+BRWalletAddressIndex *BRWalletAddressIndexRetain(BRWalletAddressIndex *index)
+{
+    assert(index != NULL);
+    pthread_mutex_lock(&index->lock);
+    index->refCount++;
+    pthread_mutex_unlock(&index->lock);
+    return index;
+}
+
+// removes a reference to index, freeing it once no references remain, thread-safe
+void BRWalletAddressIndexRelease(BRWalletAddressIndex *index)
+{
+    size_t refCount;
+
+    assert(index != NULL);
+    pthread_mutex_lock(&index->lock);
+    assert(index->refCount > 0);
+    refCount = --index->refCount;
+    pthread_mutex_unlock(&index->lock);
+    if (refCount > 0) return;
+
+    BRSetFree(index->allPKH);
+    array_free(index->internalChain);
+    array_free(index->externalChain);
+    pthread_mutex_destroy(&index->lock);
+    free(index);
 }
 
 struct BRWalletStruct {
@@ -71,10 +146,10 @@ struct BRWalletStruct {
     uint32_t blockHeight;
     BRUTXO *utxos;
     BRTransaction **transactions;
-    BRMasterPubKey masterPubKey;
     BRAddressParams addrParams;
-    UInt160 *internalChain, *externalChain;
-    BRSet *allTx, *invalidTx, *pendingTx, *spentOutputs, *usedPKH, *allPKH;
+    BRWalletAddressIndex *addrIndex;
+    size_t internalCount, externalCount; // number of addrIndex chain addresses generated for this wallet
+    BRSet *allTx, *invalidTx, *pendingTx, *spentOutputs, *usedPKH;
     void *callbackInfo;
     void (*balanceChanged)(void *info, uint64_t balance);
     void (*txAdded)(void *info, BRTransaction *tx);
@@ -83,6 +158,59 @@ struct BRWalletStruct {
     pthread_mutex_t lock;
 };
 
+// chain position of pkh if it's an address derived into the index, otherwise -1, and sets *internal to its chain
+// must be called with index->lock held
+inline static size_t _BRWalletAddressIndexPosition(const BRWalletAddressIndex *index, const void *pkh,
+                                                   uint32_t *internal)
+{
+    const UInt160 *p = BRSetGet(index->allPKH, pkh);
+
+    if (! p) return -1;
+
+    if (p >= index->internalChain && p < index->internalChain + array_count(index->internalChain)) {
+        *internal = SEQUENCE_INTERNAL_CHAIN;
+        return (size_t)(p - index->internalChain);
+    }
+
+    *internal = SEQUENCE_EXTERNAL_CHAIN;
+    return (size_t)(p - index->externalChain);
+}
+
+// chain position of pkh if it's an address generated for the wallet, otherwise -1, and sets *internal to its chain
+// must be called with wallet->addrIndex->lock held
+inline static size_t _BRWalletPKHIndex(const BRWallet *wallet, const void *pkh, uint32_t *internal)
+{
+    uint32_t chain;
+    size_t i = _BRWalletAddressIndexPosition(wallet->addrIndex, pkh, &chain);
+
+    if (i == -1) return -1;
+    if (internal) *internal = chain;
+    return (i < ((chain == SEQUENCE_INTERNAL_CHAIN) ? wallet->internalCount : wallet->externalCount)) ? i : -1;
+}
+
+// true if pkh is an address generated for the wallet, must be called with wallet->addrIndex->lock held
+inline static int _BRWalletContainsPKH(const BRWallet *wallet, const void *pkh)
+{
+    return (_BRWalletPKHIndex(wallet, pkh, NULL) != -1);
+}
+
+// chain position of the last tx output address that appears in the given chain
+// must be called with wallet->addrIndex->lock held
+inline static size_t _txChainIndex(const BRWallet *wallet, const BRTransaction *tx, uint32_t internal)
+{
+    const uint8_t *pkh;
+    size_t i, r = -1;
+    uint32_t chain;
+
+    for (size_t j = 0; j < tx->outCount; j++) {
+        pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+        if (! pkh || (i = _BRWalletPKHIndex(wallet, pkh, &chain)) == -1 || chain != internal) continue;
+        if (r == -1 || i > r) r = i;
+    }
+
+    return r;
+}
+
 inline static int _BRWalletTxIsAscending(BRWallet *wallet, const BRTransaction *tx1, const BRTransaction *tx2)
 {
     if (! tx1 || ! tx2) return 0;
@@ -110,8 +238,17 @@ inline static int _BRWalletTxCompare(BRWallet *wallet, const BRTransaction *tx1,
 
     if (_BRWalletTxIsAscending(wallet, tx1, tx2)) return 1;
     if (_BRWalletTxIsAscending(wallet, tx2, tx1)) return -1;
-    if ((i = _txChainIndex(tx1, wallet->internalChain)) != -1) j = _txChainIndex(tx2, wallet->internalChain);
-    if (j == -1 && (i = _txChainIndex(tx1, wallet->externalChain)) != -1) j = _txChainIndex(tx2, wallet->externalChain);
+    pthread_mutex_lock(&wallet->addrIndex->lock);
+
+    if ((i = _txChainIndex(wallet, tx1, SEQUENCE_INTERNAL_CHAIN)) != -1) {
+        j = _txChainIndex(wallet, tx2, SEQUENCE_INTERNAL_CHAIN);
+    }
+
+    if (j == -1 && (i = _txChainIndex(wallet, tx1, SEQUENCE_EXTERNAL_CHAIN)) != -1) {
+        j = _txChainIndex(wallet, tx2, SEQUENCE_EXTERNAL_CHAIN);
+    }
+
+    pthread_mutex_unlock(&wallet->addrIndex->lock);
     if (i != -1 && j != -1 && i != j) return (i > j) ? 1 : -1;
     return 0;
 }
@@ -131,6 +268,73 @@ inline static void _BRWalletInsertTx(BRWallet *wallet, BRTransaction *tx)
     wallet->transactions[i] = tx;
 }
 
+typedef struct {
+    BRTransaction *tx;
+    size_t index;
+} BRWalletTxOrder;
+
+inline static int _BRWalletTxOrderCompare(const void *o1, const void *o2)
+{
+    const BRWalletTxOrder *e1 = o1, *e2 = o2;
+
+    if (e1->tx->blockHeight != e2->tx->blockHeight) return (e1->tx->blockHeight < e2->tx->blockHeight) ? -1 : 1;
+    if (e1->tx->timestamp != e2->tx->timestamp) return (e1->tx->timestamp < e2->tx->timestamp) ? -1 : 1;
+    return (e1->index < e2->index) ? -1 : (e1->index > e2->index);
+}
+
+// reorders txs by block height and timestamp, oldest first, with each tx following any tx in the set that it spends from, so that
+// _BRWalletInsertTx() places each one after only a comparison or two, and _BRWalletContainsTx() sees parents first
+static void _BRWalletSortTxs(BRTransaction *txs[], size_t txCount)
+{
+    BRWalletTxOrder *order = calloc(txCount, sizeof(*order));
+    BRSet *byHash = BRSetNew(BRTransactionHash, BRTransactionEq, txCount), *seen = BRSetNew(BRTransactionHash,
+                                                                                            BRTransactionEq, txCount);
+    BRTransaction *tx, *parent, **stack;
+    size_t i, j, count = 0;
+
+    assert(order != NULL);
+    array_new(stack, 10);
+
+    for (i = 0; i < txCount; i++) {
+        order[i] = (BRWalletTxOrder) { txs[i], i };
+        if (! BRSetContains(byHash, txs[i])) BRSetAdd(byHash, txs[i]);
+    }
+
+    qsort(order, txCount, sizeof(*order), _BRWalletTxOrderCompare);
+
+    for (i = 0; i < txCount; i++) {
+        tx = order[i].tx;
+        if (BRSetGet(seen, tx) == tx) continue; // already placed as a parent of an earlier tx
+        if (BRSetContains(seen, tx)) { txs[count++] = tx; continue; } // duplicate hash, leave it where it falls
+        BRSetAdd(seen, tx);
+        array_add(stack, tx);
+
+        while (array_count(stack) > 0) { // depth first, without recursion, so long chains of spends can't overflow
+            tx = stack[array_count(stack) - 1];
+
+            for (j = 0, parent = NULL; ! parent && j < tx->inCount; j++) {
+                parent = BRSetGet(byHash, &tx->inputs[j].txHash);
+                if (parent && BRSetContains(seen, parent)) parent = NULL; // already placed, or a cycle
+            }
+
+            if (parent) {
+                BRSetAdd(seen, parent);
+                array_add(stack, parent);
+            }
+            else {
+                txs[count++] = tx;
+                array_rm_last(stack);
+            }
+        }
+    }
+
+    assert(count == txCount);
+    array_free(stack);
+    BRSetFree(seen);
+    BRSetFree(byHash);
+    free(order);
+}
+
 // non-threadsafe version of BRWalletContainsTransaction()
 static int _BRWalletContainsTx(BRWallet *wallet, const BRTransaction *tx)
 {
@@ -138,9 +342,11 @@ static int _BRWalletContainsTx(BRWallet *wallet, const BRTransaction *tx)
     const uint8_t *pkh;
     UInt160 hash;
     
+    pthread_mutex_lock(&wallet->addrIndex->lock);
+
     for (size_t i = 0; ! r && i < tx->outCount; i++) {
         pkh = BRScriptPKH(tx->outputs[i].script, tx->outputs[i].scriptLen);
-        if (pkh && BRSetContains(wallet->allPKH, pkh)) r = 1;
+        if (pkh && _BRWalletContainsPKH(wallet, pkh)) r = 1;
     }
     
     for (size_t i = 0; ! r && i < tx->inCount; i++) {
@@ -148,27 +354,31 @@ static int _BRWalletContainsTx(BRWallet *wallet, const BRTransaction *tx)
         uint32_t n = tx->inputs[i].index;
         
         pkh = (t && n < t->outCount) ? BRScriptPKH(t->outputs[n].script, t->outputs[n].scriptLen) : NULL;
-        if (pkh && BRSetContains(wallet->allPKH, pkh)) r = 1;
+        if (pkh && _BRWalletContainsPKH(wallet, pkh)) r = 1;
     }
     
     for (size_t i = 0; ! r && i < tx->inCount; i++) {
         size_t l = (tx->inputs[i].witLen > 0) ? BRWitnessPKH(hash.u8, tx->inputs[i].witness, tx->inputs[i].witLen)
                                               : BRSignaturePKH(hash.u8, tx->inputs[i].signature, tx->inputs[i].sigLen);
 
-        if (l > 0 && BRSetContains(wallet->allPKH, &hash)) r = 1;
+        if (l > 0 && _BRWalletContainsPKH(wallet, &hash)) r = 1;
     }
 
+    pthread_mutex_unlock(&wallet->addrIndex->lock);
     return r;
 }
 
 static void _BRWalletUpdateBalance(BRWallet *wallet)
 {
-    int isInvalid, isPending;
+    int isInvalid, isPending, isOwned;
     uint64_t balance = 0, prevBalance = 0;
     time_t now = time(NULL);
-    size_t i, j;
+    size_t i, j, outCount = 0;
     BRTransaction *tx, *t;
+    BRUTXO *utxo;
     const uint8_t *pkh;
+    BRSet *unspent;
+    const BRTxInput **spends;
     
     array_clear(wallet->utxos);
     array_clear(wallet->balanceHist);
@@ -179,6 +389,12 @@ static void _BRWalletUpdateBalance(BRWallet *wallet)
     wallet->totalSent = 0;
     wallet->totalReceived = 0;
 
+    // unspent holds pointers into wallet->utxos, so reserve room for every output up front to keep them stable
+    for (i = 0; i < array_count(wallet->transactions); i++) outCount += wallet->transactions[i]->outCount;
+    if (array_capacity(wallet->utxos) < outCount) array_set_capacity(wallet->utxos, outCount);
+    unspent = BRSetNew(BRUTXOHash, BRUTXOEq, outCount/2 + 10);
+    array_new(spends, 10);
+
     for (i = 0; i < array_count(wallet->transactions); i++) {
         tx = wallet->transactions[i];
 
@@ -199,6 +415,7 @@ static void _BRWalletUpdateBalance(BRWallet *wallet)
         // add inputs to spent output set
         for (j = 0; j < tx->inCount; j++) {
             BRSetAdd(wallet->spentOutputs, &tx->inputs[j]);
+            array_add(spends, &tx->inputs[j]);
         }
 
         // check if tx is pending
@@ -231,21 +448,33 @@ static void _BRWalletUpdateBalance(BRWallet *wallet)
         // NOTE: balance/UTXOs will then need to be recalculated when last block changes
         for (j = 0; j < tx->outCount; j++) {
             pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+            if (! pkh) continue;
+
+            // addrIndex is shared with wallets on other chains for the same mpk, so only hold its lock per lookup
+            pthread_mutex_lock(&wallet->addrIndex->lock);
+            isOwned = _BRWalletContainsPKH(wallet, pkh);
+            pthread_mutex_unlock(&wallet->addrIndex->lock);
 
-            if (pkh && BRSetContains(wallet->allPKH, pkh)) {
+            if (isOwned) {
                 BRSetAdd(wallet->usedPKH, (void *)pkh);
                 array_add(wallet->utxos, ((const BRUTXO) { tx->txHash, (uint32_t)j }));
-                balance += tx->outputs[j].amount;
+                utxo = &wallet->utxos[array_count(wallet->utxos) - 1];
+
+                // transaction ordering is not guaranteed, so the output may already be spent by an earlier tx
+                if (BRSetContains(wallet->spentOutputs, utxo)) utxo->hash = UINT256_ZERO;
+                else BRSetAdd(unspent, utxo), balance += tx->outputs[j].amount;
             }
         }
 
-        // transaction ordering is not guaranteed, so check the entire UTXO set against the entire spent output set
-        for (j = array_count(wallet->utxos); j > 0; j--) {
-            if (! BRSetContains(wallet->spentOutputs, &wallet->utxos[j - 1])) continue;
-            t = BRSetGet(wallet->allTx, &wallet->utxos[j - 1].hash);
-            balance -= t->outputs[wallet->utxos[j - 1].n].amount;
-            array_rm(wallet->utxos, j - 1);
+        // remove the UTXOs spent by this tx, and by any pending tx since the last one that reached here
+        for (j = 0; j < array_count(spends); j++) {
+            if (! (utxo = BRSetRemove(unspent, spends[j]))) continue;
+            t = BRSetGet(wallet->allTx, &utxo->hash);
+            balance -= t->outputs[utxo->n].amount;
+            utxo->hash = UINT256_ZERO;
         }
+
+        array_clear(spends);
         
         if (prevBalance < balance) wallet->totalReceived += balance - prevBalance;
         if (balance < prevBalance) wallet->totalSent += prevBalance - balance;
@@ -253,38 +482,59 @@ static void _BRWalletUpdateBalance(BRWallet *wallet)
         prevBalance = balance;
     }
 
+    for (i = 0, j = 0; i < array_count(wallet->utxos); i++) { // drop spent UTXOs, keeping the rest in order
+        if (! UInt256IsZero(wallet->utxos[i].hash)) wallet->utxos[j++] = wallet->utxos[i];
+    }
+
+    array_set_count(wallet->utxos, j);
+    array_free(spends);
+    BRSetFree(unspent);
     assert(array_count(wallet->balanceHist) == array_count(wallet->transactions));
     wallet->balance = balance;
 }
 
 // allocates and populates a BRWallet struct which must be freed by calling BRWalletFree()
 BRWallet *BRWalletNew(BRAddressParams addrParams, BRTransaction *transactions[], size_t txCount, BRMasterPubKey mpk)
+{
+    BRWalletAddressIndex *index = BRWalletAddressIndexNew(mpk);
+    BRWallet *wallet = BRWalletNewWithAddressIndex(addrParams, transactions, txCount, index);
+
+    BRWalletAddressIndexRelease(index);
+    return wallet;
+}
+
+// same as BRWalletNew(), but addresses are derived through index, which may be shared with other wallets
+// the wallet holds its own reference to index until it's freed by calling BRWalletFree()
+BRWallet *BRWalletNewWithAddressIndex(BRAddressParams addrParams, BRTransaction *transactions[], size_t txCount,
+                                      BRWalletAddressIndex *index)
 {
     BRWallet *wallet = NULL;
-    BRTransaction *tx;
+    BRTransaction *tx, **txs;
     const uint8_t *pkh;
 
     assert(transactions != NULL || txCount == 0);
+    assert(index != NULL);
     wallet = calloc(1, sizeof(*wallet));
     assert(wallet != NULL);
     array_new(wallet->utxos, 100);
     array_new(wallet->transactions, txCount + 100);
     wallet->feePerKb = DEFAULT_FEE_PER_KB;
-    wallet->masterPubKey = mpk;
     wallet->addrParams = addrParams;
-    array_new(wallet->internalChain, 100);
-    array_new(wallet->externalChain, 100);
+    wallet->addrIndex = BRWalletAddressIndexRetain(index);
     array_new(wallet->balanceHist, txCount + 100);
     wallet->allTx = BRSetNew(BRTransactionHash, BRTransactionEq, txCount + 100);
     wallet->invalidTx = BRSetNew(BRTransactionHash, BRTransactionEq, 10);
     wallet->pendingTx = BRSetNew(BRTransactionHash, BRTransactionEq, 10);
     wallet->spentOutputs = BRSetNew(BRUTXOHash, BRUTXOEq, txCount + 100);
     wallet->usedPKH = BRSetNew(_pkhHash, _pkhEq, txCount + 100);
-    wallet->allPKH = BRSetNew(_pkhHash, _pkhEq, txCount + 100);
     pthread_mutex_init(&wallet->lock, NULL);
 
-    for (size_t i = 0; transactions && i < txCount; i++) {
-        tx = transactions[i];
+    array_new(txs, txCount);
+    if (transactions) array_add_array(txs, transactions, txCount);
+    _BRWalletSortTxs(txs, array_count(txs));
+
+    for (size_t i = 0; i < array_count(txs); i++) {
+        tx = txs[i];
         if (! BRTransactionIsSigned(tx) || BRSetContains(wallet->allTx, tx)) continue;
         BRSetAdd(wallet->allTx, tx);
         _BRWalletInsertTx(wallet, tx);
@@ -295,6 +545,7 @@ BRWallet *BRWalletNew(BRAddressParams addrParams, BRTransaction *transactions[],
         }
     }
     
+    array_free(txs);
     BRWalletUnusedAddrs(wallet, NULL, SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED, SEQUENCE_EXTERNAL_CHAIN);
     BRWalletUnusedAddrs(wallet, NULL, SEQUENCE_GAP_LIMIT_INTERNAL_EXTENDED, SEQUENCE_INTERNAL_CHAIN);
 
@@ -331,38 +582,31 @@ void BRWalletSetCallbacks(BRWallet *wallet, void *info,
     wallet->txDeleted = txDeleted;
 }
 
-// wallets are composed of chains of addresses
-// each chain is traversed until a gap of a number of addresses is found that haven't been used in any transactions
-// this function writes to addrs an array of <gapLimit> unused addresses following the last used address in the chain
-// the internal chain is used for change addresses and the external chain for receive addresses
-// addrs may be NULL to only generate addresses for BRWalletContainsAddress()
-// returns the number addresses written to addrs
-size_t BRWalletUnusedAddrs(BRWallet *wallet, BRAddress addrs[], uint32_t gapLimit, uint32_t internal)
+// non-threadsafe version of BRWalletUnusedAddrs()
+static size_t _BRWalletUnusedAddrs(BRWallet *wallet, BRAddress addrs[], uint32_t gapLimit, uint32_t internal)
 {
-    UInt160 *chain = NULL, *origChain;
-    size_t i, j = 0, count, startCount;
+    BRWalletAddressIndex *index = wallet->addrIndex;
+    UInt160 *chain;
+    size_t i, j = 0, count, *walletCount = NULL;
 
-    assert(wallet != NULL);
-    assert(gapLimit > 0);
-    pthread_mutex_lock(&wallet->lock);
-    if (internal == SEQUENCE_EXTERNAL_CHAIN) chain = wallet->externalChain;
-    if (internal == SEQUENCE_INTERNAL_CHAIN) chain = wallet->internalChain;
-    assert(chain != NULL);
-    origChain = chain;
-    i = count = startCount = array_count(chain);
+    if (internal == SEQUENCE_EXTERNAL_CHAIN) walletCount = &wallet->externalCount;
+    if (internal == SEQUENCE_INTERNAL_CHAIN) walletCount = &wallet->internalCount;
+    assert(walletCount != NULL);
+    pthread_mutex_lock(&index->lock);
+    chain = _BRWalletAddressIndexChain(index, internal);
+    i = count = *walletCount;
     
     // keep only the trailing contiguous block of addresses with no transactions
     while (i > 0 && ! BRSetContains(wallet->usedPKH, &chain[i - 1])) i--;
     
-    while (i + gapLimit > count) { // generate new addresses up to gapLimit
-        BRKey key;
-        uint8_t pubKey[BRBIP32PubKey(NULL, 0, wallet->masterPubKey, internal, count)];
-        size_t len = BRBIP32PubKey(pubKey, sizeof(pubKey), wallet->masterPubKey, internal, (uint32_t)count);
-        
-        if (! BRKeySetPubKey(&key, pubKey, len)) break;
-        array_add(chain, BRKeyHash160(&key));
+    while (i + gapLimit > count) { // generate new addresses up to gapLimit, deriving any not already in the index
+        if (count == array_count(chain)) {
+            if (! _BRWalletAddressIndexExtend(index, internal)) break;
+            chain = _BRWalletAddressIndexChain(index, internal);
+        }
+
         count++;
-        if (BRSetContains(wallet->usedPKH, &chain[array_count(chain) - 1])) i = count;
+        if (BRSetContains(wallet->usedPKH, &chain[count - 1])) i = count;
     }
 
     if (addrs && i + gapLimit <= count) {
@@ -371,29 +615,106 @@ size_t BRWalletUnusedAddrs(BRWallet *wallet, BRAddress addrs[], uint32_t gapLimi
         }
     }
     
-    // was chain moved to a new memory location?
-    if (chain == origChain) {
-        for (i = startCount; i < count; i++) {
-            BRSetAdd(wallet->allPKH, &chain[i]);
-        }
+    *walletCount = count;
+    pthread_mutex_unlock(&index->lock);
+    return j;
+}
+
+// wallets are composed of chains of addresses
+// each chain is traversed until a gap of a number of addresses is found that haven't been used in any transactions
+// this function writes to addrs an array of <gapLimit> unused addresses following the last used address in the chain
+// the internal chain is used for change addresses and the external chain for receive addresses
+// addrs may be NULL to only generate addresses for BRWalletContainsAddress()
+// returns the number addresses written to addrs
+size_t BRWalletUnusedAddrs(BRWallet *wallet, BRAddress addrs[], uint32_t gapLimit, uint32_t internal)
+{
+    size_t r;
+
+    assert(wallet != NULL);
+    assert(gapLimit > 0);
+    pthread_mutex_lock(&wallet->lock);
+    r = _BRWalletUnusedAddrs(wallet, addrs, gapLimit, internal);
+    pthread_mutex_unlock(&wallet->lock);
+    return r;
+}
+
+// writes to addrs the <count> chain addresses that follow those generated for the wallet, without generating them
+// they aren't included in BRWalletAllAddrs() and transactions using them aren't recognized until generated, either by
+// BRWalletUnusedAddrs() or BRWalletGenerateAddrsUsedBy()
+// returns the number addresses written to addrs
+size_t BRWalletAddrsAhead(BRWallet *wallet, BRAddress addrs[], uint32_t count, uint32_t internal)
+{
+    BRWalletAddressIndex *index;
+    UInt160 *chain;
+    size_t i, start;
+
+    assert(wallet != NULL);
+    assert(addrs != NULL || count == 0);
+    assert(internal == SEQUENCE_EXTERNAL_CHAIN || internal == SEQUENCE_INTERNAL_CHAIN);
+    index = wallet->addrIndex;
+    pthread_mutex_lock(&wallet->lock);
+    pthread_mutex_lock(&index->lock);
+    start = (internal == SEQUENCE_INTERNAL_CHAIN) ? wallet->internalCount : wallet->externalCount;
+    chain = _BRWalletAddressIndexChain(index, internal);
+
+    // the addresses are derived into the index only, the wallet's own chain counts are unchanged
+    while (array_count(chain) < start + count && _BRWalletAddressIndexExtend(index, internal)) {
+        chain = _BRWalletAddressIndexChain(index, internal);
     }
-    else {
-        if (internal == SEQUENCE_EXTERNAL_CHAIN) wallet->externalChain = chain;
-        if (internal == SEQUENCE_INTERNAL_CHAIN) wallet->internalChain = chain;
 
-        BRSetClear(wallet->allPKH); // clear and rebuild allAddrs
+    for (i = start; i < start + count && i < array_count(chain); i++) {
+        BRAddressFromHash160(addrs[i - start].s, sizeof(*addrs), wallet->addrParams, &chain[i]);
+    }
 
-        for (i = array_count(wallet->internalChain); i > 0; i--) {
-            BRSetAdd(wallet->allPKH, &wallet->internalChain[i - 1]);
-        }
-        
-        for (i = array_count(wallet->externalChain); i > 0; i--) {
-            BRSetAdd(wallet->allPKH, &wallet->externalChain[i - 1]);
+    pthread_mutex_unlock(&index->lock);
+    pthread_mutex_unlock(&wallet->lock);
+    return i - start;
+}
+
+// generates for the wallet each address already derived from its master public key, but not yet generated for the
+// wallet, that the given transactions pay to or spend from, along with every address that precedes it in its chain
+// call before registering transactions found through addresses from BRWalletAddrsAhead()
+// returns the number of addresses generated
+size_t BRWalletGenerateAddrsUsedBy(BRWallet *wallet, BRTransaction *transactions[], size_t txCount)
+{
+    BRWalletAddressIndex *index;
+    const BRTransaction *tx;
+    const uint8_t *pkh;
+    UInt160 hash;
+    size_t i, j, n, internalCount, externalCount, count;
+    uint32_t chain;
+
+    assert(wallet != NULL);
+    assert(transactions != NULL || txCount == 0);
+    index = wallet->addrIndex;
+    pthread_mutex_lock(&wallet->lock);
+    pthread_mutex_lock(&index->lock);
+    internalCount = wallet->internalCount;
+    externalCount = wallet->externalCount;
+
+    for (i = 0; i < txCount; i++) {
+        tx = transactions[i];
+
+        for (j = 0; j < tx->outCount + tx->inCount; j++) {
+            if (j < tx->outCount) pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+            else {
+                const BRTxInput *input = &tx->inputs[j - tx->outCount];
+                size_t l = (input->witLen > 0) ? BRWitnessPKH(hash.u8, input->witness, input->witLen)
+                                               : BRSignaturePKH(hash.u8, input->signature, input->sigLen);
+
+                pkh = (l > 0) ? hash.u8 : NULL;
+            }
+
+            if (! pkh || (n = _BRWalletAddressIndexPosition(index, pkh, &chain)) == -1) continue;
+            if (chain == SEQUENCE_INTERNAL_CHAIN && n >= wallet->internalCount) wallet->internalCount = n + 1;
+            if (chain == SEQUENCE_EXTERNAL_CHAIN && n >= wallet->externalCount) wallet->externalCount = n + 1;
         }
     }
 
+    count = (wallet->internalCount - internalCount) + (wallet->externalCount - externalCount);
+    pthread_mutex_unlock(&index->lock);
     pthread_mutex_unlock(&wallet->lock);
-    return j;
+    return count;
 }
 
 // current wallet balance, not including transactions known to be invalid
@@ -552,20 +873,22 @@ size_t BRWalletAllAddrs(BRWallet *wallet, BRAddress addrs[], size_t addrsCount)
     
     assert(wallet != NULL);
     pthread_mutex_lock(&wallet->lock);
-    internalCount = (! addrs || array_count(wallet->internalChain) < addrsCount) ?
-                    array_count(wallet->internalChain) : addrsCount;
+    pthread_mutex_lock(&wallet->addrIndex->lock);
+    internalCount = (! addrs || wallet->internalCount < addrsCount) ? wallet->internalCount : addrsCount;
 
     for (i = 0; addrs && i < internalCount; i++) {
-        BRAddressFromHash160(addrs[i].s, sizeof(*addrs), wallet->addrParams, &wallet->internalChain[i]);
+        BRAddressFromHash160(addrs[i].s, sizeof(*addrs), wallet->addrParams, &wallet->addrIndex->internalChain[i]);
     }
 
-    externalCount = (! addrs || array_count(wallet->externalChain) < addrsCount - internalCount) ?
-                    array_count(wallet->externalChain) : addrsCount - internalCount;
+    externalCount = (! addrs || wallet->externalCount < addrsCount - internalCount) ?
+                    wallet->externalCount : addrsCount - internalCount;
 
     for (i = 0; addrs && i < externalCount; i++) {
-        BRAddressFromHash160(addrs[internalCount + i].s, sizeof(*addrs), wallet->addrParams, &wallet->externalChain[i]);
+        BRAddressFromHash160(addrs[internalCount + i].s, sizeof(*addrs), wallet->addrParams,
+                             &wallet->addrIndex->externalChain[i]);
     }
 
+    pthread_mutex_unlock(&wallet->addrIndex->lock);
     pthread_mutex_unlock(&wallet->lock);
     return internalCount + externalCount;
 }
@@ -580,7 +903,9 @@ int BRWalletContainsAddress(BRWallet *wallet, const char *addr)
     assert(addr != NULL);
     pthread_mutex_lock(&wallet->lock);
     if (addr) BRAddressHash160(&pkh, wallet->addrParams, addr);
-    r = BRSetContains(wallet->allPKH, &pkh);
+    pthread_mutex_lock(&wallet->addrIndex->lock);
+    r = _BRWalletContainsPKH(wallet, &pkh);
+    pthread_mutex_unlock(&wallet->addrIndex->lock);
     pthread_mutex_unlock(&wallet->lock);
     return r;
 }
@@ -731,26 +1056,24 @@ BRTransaction *BRWalletCreateTxForOutputsWithFeePerKb(BRWallet *wallet, uint64_t
 // returns true if all inputs were signed, or false if there was an error or not all inputs were able to be signed
 int BRWalletSignTransaction(BRWallet *wallet, BRTransaction *tx, uint8_t forkId, const void *seed, size_t seedLen)
 {
-    uint32_t j, internalIdx[tx->inCount], externalIdx[tx->inCount];
-    size_t i, internalCount = 0, externalCount = 0;
+    uint32_t chain, internalIdx[tx->inCount], externalIdx[tx->inCount];
+    size_t i, j, internalCount = 0, externalCount = 0;
     int r = 0;
     
     assert(wallet != NULL);
     assert(tx != NULL);
     pthread_mutex_lock(&wallet->lock);
+    pthread_mutex_lock(&wallet->addrIndex->lock);
     
     for (i = 0; tx && i < tx->inCount; i++) {
         const uint8_t *pkh = BRScriptPKH(tx->inputs[i].script, tx->inputs[i].scriptLen);
         
-        for (j = (uint32_t)array_count(wallet->internalChain); pkh && j > 0; j--) {
-            if (UInt160Eq(UInt160Get(pkh), wallet->internalChain[j - 1])) internalIdx[internalCount++] = j - 1;
-        }
-
-        for (j = (uint32_t)array_count(wallet->externalChain); pkh && j > 0; j--) {
-            if (UInt160Eq(UInt160Get(pkh), wallet->externalChain[j - 1])) externalIdx[externalCount++] = j - 1;
-        }
+        if (! pkh || (j = _BRWalletPKHIndex(wallet, pkh, &chain)) == -1) continue;
+        if (chain == SEQUENCE_INTERNAL_CHAIN) internalIdx[internalCount++] = (uint32_t)j;
+        else externalIdx[externalCount++] = (uint32_t)j;
     }
 
+    pthread_mutex_unlock(&wallet->addrIndex->lock);
     pthread_mutex_unlock(&wallet->lock);
 
     BRKey keys[internalCount + externalCount];
@@ -825,6 +1148,82 @@ int BRWalletRegisterTransaction(BRWallet *wallet, BRTransaction *tx)
     return r;
 }
 
+// adds transactions to the wallet under a single lock and with a single balance update, or returns 0 if none of them
+// are associated with the wallet; txs only recognized once a later tx extends the address chains get another pass
+size_t BRWalletRegisterTransactions(BRWallet *wallet, BRTransaction *transactions[], size_t txCount)
+{
+    BRTransaction *tx, **txs, **added;
+    const uint8_t *pkh;
+    size_t i, j, count, addedCount;
+
+    assert(wallet != NULL);
+    assert(transactions != NULL || txCount == 0);
+    if (txCount == 0) return 0;
+
+    array_new(txs, txCount);
+
+    for (i = 0; i < txCount; i++) {
+        assert(transactions[i] != NULL && BRTransactionIsSigned(transactions[i]));
+        if (transactions[i] && BRTransactionIsSigned(transactions[i])) array_add(txs, transactions[i]);
+    }
+
+    _BRWalletSortTxs(txs, array_count(txs));
+    array_new(added, array_count(txs));
+    pthread_mutex_lock(&wallet->lock);
+
+    do { // each pass keeps, in order, the txs not yet known to belong to the wallet
+        for (i = 0, count = 0, addedCount = array_count(added); i < array_count(txs); i++) {
+            tx = txs[i];
+            if (BRSetContains(wallet->allTx, tx)) continue;
+
+            if (! _BRWalletContainsTx(wallet, tx)) {
+                txs[count++] = tx;
+                continue;
+            }
+
+            BRSetAdd(wallet->allTx, tx);
+            _BRWalletInsertTx(wallet, tx);
+            array_add(added, tx);
+
+            for (j = 0; j < tx->outCount; j++) {
+                pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+                if (pkh) BRSetAdd(wallet->usedPKH, (void *)pkh);
+            }
+
+            // when a wallet address is used, extend the chains before checking the txs that follow
+            _BRWalletUnusedAddrs(wallet, NULL, SEQUENCE_GAP_LIMIT_EXTERNAL, SEQUENCE_EXTERNAL_CHAIN);
+            _BRWalletUnusedAddrs(wallet, NULL, SEQUENCE_GAP_LIMIT_INTERNAL, SEQUENCE_INTERNAL_CHAIN);
+        }
+
+        array_set_count(txs, count);
+    } while (count > 0 && array_count(added) > addedCount);
+
+    // keep track of unconfirmed non-wallet tx for invalid tx checks and child-pays-for-parent fees
+    for (i = 0; i < array_count(txs); i++) {
+        tx = txs[i];
+        if (tx->blockHeight == TX_UNCONFIRMED && ! BRSetContains(wallet->allTx, tx)) BRSetAdd(wallet->allTx, tx);
+    }
+
+    if (array_count(added) > 0) _BRWalletUpdateBalance(wallet);
+    pthread_mutex_unlock(&wallet->lock);
+    addedCount = array_count(added);
+
+    if (addedCount > 0) {
+        // usedPKH was rebuilt by the balance update, so extend the chains once more as BRWalletRegisterTransaction() does
+        BRWalletUnusedAddrs(wallet, NULL, SEQUENCE_GAP_LIMIT_EXTERNAL, SEQUENCE_EXTERNAL_CHAIN);
+        BRWalletUnusedAddrs(wallet, NULL, SEQUENCE_GAP_LIMIT_INTERNAL, SEQUENCE_INTERNAL_CHAIN);
+        if (wallet->balanceChanged) wallet->balanceChanged(wallet->callbackInfo, wallet->balance);
+
+        for (i = 0; wallet->txAdded && i < addedCount; i++) {
+            wallet->txAdded(wallet->callbackInfo, added[i]);
+        }
+    }
+
+    array_free(added);
+    array_free(txs);
+    return addedCount;
+}
+
 // removes a tx from the wallet, along with any tx that depend on its outputs
 void BRWalletRemoveTransaction(BRWallet *wallet, UInt256 txHash)
 {
@@ -1019,13 +1418,13 @@ static int _BRWalletContainsTxInput(BRWallet *wallet, const BRTransaction *tx, c
     uint32_t n = txInput->index;
 
     pkh = (t && n < t->outCount) ? BRScriptPKH(t->outputs[n].script, t->outputs[n].scriptLen) : NULL;
-    if (pkh && BRSetContains(wallet->allPKH, pkh)) return 1;
+    if (pkh && _BRWalletContainsPKH(wallet, pkh)) return 1;
 
     size_t l = ((txInput->witLen > 0)
                 ? BRWitnessPKH(hash.u8, txInput->witness, txInput->witLen)
                 : BRSignaturePKH(hash.u8, txInput->signature, txInput->sigLen));
 
-    if (l > 0 && BRSetContains(wallet->allPKH, &hash)) return 1;
+    if (l > 0 && _BRWalletContainsPKH(wallet, &hash)) return 1;
 
     return 0;
 }
@@ -1041,12 +1440,14 @@ int BRWalletTransactionIsResolved (BRWallet *wallet, const BRTransaction *tx) {
     _IsResolvedTransactionAssert (tx != NULL);
 
     pthread_mutex_lock(&wallet->lock);
+    pthread_mutex_lock(&wallet->addrIndex->lock);
     if (!BRTransactionIsSigned(tx)) r = 0;
     for (size_t i = 0; r && i < tx->inCount; i++) {
         if (_BRWalletContainsTxInput (wallet, tx, &tx->inputs[i]) &&
             NULL == BRSetGet(wallet->allTx, &tx->inputs[i].txHash))
             r = 0;
     }
+    pthread_mutex_unlock(&wallet->addrIndex->lock);
     pthread_mutex_unlock(&wallet->lock);
 
     return r;
@@ -1134,13 +1535,15 @@ uint64_t BRWalletAmountReceivedFromTx(BRWallet *wallet, const BRTransaction *tx)
     assert(wallet != NULL);
     assert(tx != NULL);
     pthread_mutex_lock(&wallet->lock);
+    pthread_mutex_lock(&wallet->addrIndex->lock);
     
     // TODO: don't include outputs below TX_MIN_OUTPUT_AMOUNT
     for (size_t i = 0; tx && i < tx->outCount; i++) {
         pkh = BRScriptPKH(tx->outputs[i].script, tx->outputs[i].scriptLen);
-        if (pkh && BRSetContains(wallet->allPKH, pkh)) amount += tx->outputs[i].amount;
+        if (pkh && _BRWalletContainsPKH(wallet, pkh)) amount += tx->outputs[i].amount;
     }
     
+    pthread_mutex_unlock(&wallet->addrIndex->lock);
     pthread_mutex_unlock(&wallet->lock);
     return amount;
 }
@@ -1153,6 +1556,7 @@ uint64_t BRWalletAmountSentByTx(BRWallet *wallet, const BRTransaction *tx)
     assert(wallet != NULL);
     assert(tx != NULL);
     pthread_mutex_lock(&wallet->lock);
+    pthread_mutex_lock(&wallet->addrIndex->lock);
     
     for (size_t i = 0; tx && i < tx->inCount; i++) {
         BRTransaction *t = BRSetGet(wallet->allTx, &tx->inputs[i].txHash);
@@ -1161,10 +1565,11 @@ uint64_t BRWalletAmountSentByTx(BRWallet *wallet, const BRTransaction *tx)
 
         if (t && n < t->outCount) {
             pkh = BRScriptPKH(t->outputs[n].script, t->outputs[n].scriptLen);
-            if (pkh && BRSetContains(wallet->allPKH, pkh)) amount += t->outputs[n].amount;
+            if (pkh && _BRWalletContainsPKH(wallet, pkh)) amount += t->outputs[n].amount;
         }
     }
     
+    pthread_mutex_unlock(&wallet->addrIndex->lock);
     pthread_mutex_unlock(&wallet->lock);
     return amount;
 }
@@ -1330,15 +1735,13 @@ void BRWalletFree(BRWallet *wallet)
 {
     assert(wallet != NULL);
     pthread_mutex_lock(&wallet->lock);
-    BRSetFree(wallet->allPKH);
     BRSetFree(wallet->usedPKH);
     BRSetFree(wallet->invalidTx);
     BRSetFree(wallet->pendingTx);
     BRSetApply(wallet->allTx, NULL, _setApplyFreeTx);
     BRSetFree(wallet->allTx);
     BRSetFree(wallet->spentOutputs);
-    array_free(wallet->internalChain);
-    array_free(wallet->externalChain);
+    BRWalletAddressIndexRelease(wallet->addrIndex);
     array_free(wallet->balanceHist);
     array_free(wallet->transactions);
     array_free(wallet->utxos);
@@ -58,9 +58,27 @@ inline static int BRUTXOEq(const void *utxo, const void *otherUtxo)
 
 typedef struct BRWalletStruct BRWallet;
 
+// the hash160 of each address derived from a master public key, for sharing among wallets created from the same
+// master public key (such as the BTC, BCH and BSV wallets of an account) so each address is only derived and stored once
+typedef struct BRWalletAddressIndexStruct BRWalletAddressIndex;
+
+// returns a reference counted address index for mpk that must be released by calling BRWalletAddressIndexRelease()
+BRWalletAddressIndex *BRWalletAddressIndexNew(BRMasterPubKey mpk);
+
+// adds a reference to index and returns it, thread-safe
+BRWalletAddressIndex *BRWalletAddressIndexRetain(BRWalletAddressIndex *index);
+
+// removes a reference to index, freeing it once no references remain, thread-safe
+void BRWalletAddressIndexRelease(BRWalletAddressIndex *index);
+
 // allocates and populates a BRWallet struct that must be freed by calling BRWalletFree()
 BRWallet *BRWalletNew(BRAddressParams addrParams, BRTransaction *transactions[], size_t txCount, BRMasterPubKey mpk);
 
+// same as BRWalletNew(), but addresses are derived through index, which may be shared with other wallets
+// the wallet holds its own reference to index until it's freed by calling BRWalletFree()
+BRWallet *BRWalletNewWithAddressIndex(BRAddressParams addrParams, BRTransaction *transactions[], size_t txCount,
+                                      BRWalletAddressIndex *index);
+
 // not thread-safe, set callbacks once after BRWalletNew(), before calling other BRWallet functions
 // info is a void pointer that will be passed along with each callback call
 // void balanceChanged(void *, uint64_t) - called when the wallet balance changes
@@ -83,6 +101,18 @@ void BRWalletSetCallbacks(BRWallet *wallet, void *info,
 // returns the number addresses written to addrs
 size_t BRWalletUnusedAddrs(BRWallet *wallet, BRAddress addrs[], uint32_t gapLimit, uint32_t internal);
 
+// writes to addrs the <count> chain addresses that follow those generated for the wallet, without generating them
+// they aren't included in BRWalletAllAddrs() and transactions using them aren't recognized until generated, either by
+// BRWalletUnusedAddrs() or BRWalletGenerateAddrsUsedBy()
+// returns the number addresses written to addrs
+size_t BRWalletAddrsAhead(BRWallet *wallet, BRAddress addrs[], uint32_t count, uint32_t internal);
+
+// generates for the wallet each address already derived from its master public key, but not yet generated for the
+// wallet, that the given transactions pay to or spend from, along with every address that precedes it in its chain
+// call before registering transactions found through addresses from BRWalletAddrsAhead()
+// returns the number of addresses generated
+size_t BRWalletGenerateAddrsUsedBy(BRWallet *wallet, BRTransaction *transactions[], size_t txCount);
+
 BRAddressParams BRWalletGetAddressParams (BRWallet *wallet);
 
 // returns the first unused external address (bech32 pay-to-witness-pubkey-hash)
@@ -165,6 +195,12 @@ int BRWalletContainsTransaction(BRWallet *wallet, const BRTransaction *tx);
 // adds a transaction to the wallet, or returns false if it isn't associated with the wallet
 int BRWalletRegisterTransaction(BRWallet *wallet, BRTransaction *tx);
 
+// adds a set of transactions to the wallet under a single lock, ordered so that each follows any it spends from
+// balanceChanged is called once, followed by txAdded for each added transaction
+// returns the number of transactions added; as with BRWalletRegisterTransaction(), the wallet keeps any transaction
+// that BRWalletTransactionForHash() then returns, and the caller keeps the rest
+size_t BRWalletRegisterTransactions(BRWallet *wallet, BRTransaction *transactions[], size_t txCount);
+
 // removes a tx from the wallet, along with any tx that depend on its outputs
 void BRWalletRemoveTransaction(BRWallet *wallet, UInt256 txHash);
 
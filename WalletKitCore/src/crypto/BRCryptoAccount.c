@@ -84,6 +84,7 @@ cryptoAccountCreateInternal (BRMasterPubKey btc,
     BRCryptoAccount account = malloc (sizeof (struct BRCryptoAccountRecord));
 
     account->btc = btc;
+    account->btcAddressIndex = BRWalletAddressIndexNew (btc);
     account->eth = eth;
     account->xrp = xrp;
     account->hbar = hbar;
@@ -228,6 +229,7 @@ if (bytesPtr > bytesEnd) return NULL; /* overkill */ \
 
 static void
 cryptoAccountRelease (BRCryptoAccount account) {
+    BRWalletAddressIndexRelease (account->btcAddressIndex);
     ethAccountRelease(account->eth);
     rippleAccountFree(account->xrp);
     hederaAccountFree(account->hbar);
@@ -16,6 +16,7 @@
 #include "support/BRBIP32Sequence.h"
 #include "support/BRBIP39Mnemonic.h"
 #include "support/BRKey.h"
+#include "bitcoin/BRWallet.h"
 #include "ethereum/blockchain/BREthereumAccount.h"
 #include "ripple/BRRippleAccount.h"
 #include "hedera/BRHederaAccount.h"
@@ -27,6 +28,7 @@ extern "C" {
 
 struct BRCryptoAccountRecord {
     BRMasterPubKey btc;
+    BRWalletAddressIndex *btcAddressIndex;  // shared by the account's BTC, BCH and BSV wallets
     BREthereumAccount eth;
     BRRippleAccount xrp;
     BRHederaAccount hbar;
@@ -66,6 +68,16 @@ cryptoAccountAsBTC (BRCryptoAccount account) {
     return account->btc;
 }
 
+/**
+ * The index of addresses derived from the account's BTC master public key.  Every Bitcoin-family
+ * wallet (BTC, BCH and BSV) is created from the same master public key and thus from this index,
+ * so that each address is derived and stored once, however many of those wallets exist.
+ */
+static inline BRWalletAddressIndex *
+cryptoAccountAsBTCAddressIndex (BRCryptoAccount account) {
+    return account->btcAddressIndex;
+}
+
 static inline BREthereumAccount
 cryptoAccountAsETH (BRCryptoAccount account) {
     return account->eth;
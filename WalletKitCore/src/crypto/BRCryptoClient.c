@@ -11,11 +11,13 @@
 #include "BRCryptoClientP.h"
 
 #include <errno.h>
+#include <inttypes.h>
 #include <math.h>  // round()
 #include <stdbool.h>
 #include <stdio.h>          // printf
 
 #include "support/BRArray.h"
+#include "support/BROSCompat.h"
 #include "BRCryptoAddressP.h"
 #include "BRCryptoHashP.h"
 #include "BRCryptoTransferP.h"
@@ -24,6 +26,7 @@
 #include "BRCryptoWalletManagerP.h"
 
 #define OFFSET_BLOCKS_IN_SECONDS       (3 * 24 * 60 * 60)  // 3 days
+#define QRY_ADDRESS_BATCH_MINIMUM      (50)                // addresses
 
 // MARK: Client Sync/Send Forward Declarations
 
@@ -135,11 +138,11 @@ cryptoClientP2PManagerSend (BRCryptoClientP2PManager p2p,
 // MARK: Client QRY (QueRY)
 
 static void cryptoClientQRYRequestBlockNumber  (BRCryptoClientQRYManager qry);
-static bool cryptoClientQRYRequestTransactionsOrTransfers (BRCryptoClientQRYManager qry,
-                                                           BRCryptoClientCallbackType type,
-                                                           OwnershipKept  BRSetOf(BRCryptoAddress) oldAddresses,
-                                                           OwnershipGiven BRSetOf(BRCryptoAddress) newAddresses,
-                                                           size_t requestId);
+static BRArrayOf(BRSetOf(BRCryptoAddress)) cryptoClientQRYPrepareAddressBatches (BRCryptoClientQRYManager qry,
+                                                                                BRCryptoWallet wallet);
+static void cryptoClientQRYRequestAddressBatches (BRCryptoClientQRYManager qry,
+                                                  OwnershipGiven BRArrayOf(BRSetOf(BRCryptoAddress)) batches,
+                                                  size_t requestId);
 static void cryptoClientQRYSubmitTransfer      (BRCryptoClientQRYManager qry,
                                                 BRCryptoWallet   wallet,
                                                 BRCryptoTransfer transfer);
@@ -171,6 +174,13 @@ cryptoClientQRYManagerCreate (BRCryptoClient client,
     qry->sync.completed = true;
     qry->sync.success   = false;
     qry->sync.unbounded = CRYPTO_CLIENT_QRY_IS_UNBOUNDED;
+    qry->sync.pending   = 0;
+    qry->sync.addresses = NULL;
+
+    qry->lookAheadDepth = CRYPTO_CLIENT_QRY_LOOK_AHEAD_DEPTH;
+
+    pthread_mutex_init_brd (&qry->lock, PTHREAD_MUTEX_NORMAL);
+    pthread_mutex_init_brd (&qry->recoveryLock, PTHREAD_MUTEX_NORMAL);
 
     // gwm->syncContext  = syncContext;
     // gwm->syncCallback = syncCallback;
@@ -179,6 +189,10 @@ cryptoClientQRYManagerCreate (BRCryptoClient client,
 
 extern void
 cryptoClientQRYManagerRelease (BRCryptoClientQRYManager qry) {
+    if (NULL != qry->sync.addresses) cryptoAddressSetRelease (qry->sync.addresses);
+    pthread_mutex_destroy (&qry->recoveryLock);
+    pthread_mutex_destroy (&qry->lock);
+
     memset (qry, 0, sizeof(*qry));
     free (qry);
 }
@@ -221,6 +235,12 @@ cryptoClientQRYManagerTickTock (BRCryptoClientQRYManager qry) {
 
     cryptoClientQRYRequestBlockNumber (qry);
 
+    BRCryptoWallet wallet = cryptoWalletManagerGetWallet (qry->manager);
+    BRArrayOf(BRSetOf(BRCryptoAddress)) batches = NULL;
+    size_t rid = SIZE_MAX;
+
+    pthread_mutex_lock (&qry->lock);
+
     if (qry->sync.completed && qry->sync.success) {
         // 1a) if so, advance the sync range by updating `begBlockNumber`
         qry->sync.begBlockNumber = (qry->sync.endBlockNumber >= qry->blockNumberOffset
@@ -240,26 +260,38 @@ cryptoClientQRYManagerTickTock (BRCryptoClientQRYManager qry) {
         qry->sync.rid = qry->requestId++;
         qry->sync.completed = false;
         qry->sync.success   = false;
+        qry->sync.pending   = 0;
 
-        BRCryptoWallet wallet = cryptoWalletManagerGetWallet (qry->manager);
-        BRSetOf(BRCryptoAddress) addresses = cryptoWalletGetAddressesForRecovery (wallet);
-        assert (0 != BRSetCount(addresses));
+        // 3b) Nothing has been requested yet for this `rid`.
+        if (NULL != qry->sync.addresses) cryptoAddressSetRelease (qry->sync.addresses);
+        qry->sync.addresses = cryptoAddressSetCreate (100);
 
         // We'll force the 'client' to return all transactions w/o regard to the `endBlockNumber`
         // Doing this ensures that the initial 'full-sync' returns everything.  Thus there is no
         // need to wait for a future 'tick tock' to get the recent and pending transactions'.  For
         // BTC the future 'tick tock' is minutes away; which is a burden on Users as they wait.
 
-        cryptoClientQRYRequestTransactionsOrTransfers (qry,
-                                                       (CRYPTO_CLIENT_REQUEST_USE_TRANSFERS == qry->byType
-                                                        ? CLIENT_CALLBACK_REQUEST_TRANSFERS
-                                                        : CLIENT_CALLBACK_REQUEST_TRANSACTIONS),
-                                                       NULL,
-                                                       addresses,
-                                                       qry->sync.rid);
+        batches = cryptoClientQRYPrepareAddressBatches (qry, wallet);
+        assert (0 != array_count (batches));
 
-        cryptoWalletGive (wallet);
+        rid = qry->sync.rid;
     }
+
+    pthread_mutex_unlock (&qry->lock);
+
+    // 3c) Make the requests outside of the lock; a client may announce synchronously.
+    if (NULL != batches)
+        cryptoClientQRYRequestAddressBatches (qry, batches, rid);
+
+    cryptoWalletGive (wallet);
+}
+
+extern void
+cryptoClientQRYManagerSetLookAheadDepth (BRCryptoClientQRYManager qry,
+                                         size_t depth) {
+    pthread_mutex_lock (&qry->lock);
+    qry->lookAheadDepth = depth;
+    pthread_mutex_unlock (&qry->lock);
 }
 
 #ifdef REFACTOR /* BTC */
@@ -598,137 +630,273 @@ cryptoClientQRYReleaseAddresses (BRArrayOf(char *) addresses) {
     array_free (addresses);
 }
 
+static BRCryptoClientCallbackType
+cryptoClientQRYGetRequestType (BRCryptoClientQRYManager qry) {
+    return (CRYPTO_CLIENT_REQUEST_USE_TRANSFERS == qry->byType
+            ? CLIENT_CALLBACK_REQUEST_TRANSFERS
+            : CLIENT_CALLBACK_REQUEST_TRANSACTIONS);
+}
+
 static bool
 cryptoClientQRYRequestTransactionsOrTransfers (BRCryptoClientQRYManager qry,
                                                BRCryptoClientCallbackType type,
-                                               OwnershipKept  BRSetOf(BRCryptoAddress) oldAddresses,
-                                               OwnershipGiven BRSetOf(BRCryptoAddress) newAddresses,
+                                               OwnershipGiven BRSetOf(BRCryptoAddress) addresses,
                                                size_t requestId) {
 
     BRCryptoWalletManager manager = cryptoWalletManagerTakeWeak(qry->manager);
     if (NULL == manager) {
-        cryptoAddressSetRelease(newAddresses);
+        cryptoAddressSetRelease(addresses);
         return false;
     }
 
-    // Determine the set of addresses needed as `newAddresses - oldAddresses`.  The elements in
-    // `addresses` ARE NOT owned by `addresses`; they remain owned by `newAddresses`
-    BRSetOf(BRCryptoAddress) addresses = BRSetCopy (newAddresses, NULL);
-
-    if (NULL != oldAddresses)
-        BRSetMinus (addresses, oldAddresses);
-
-    // If there are `addresses` then a reqeust is needed.
-    bool needRequest = BRSetCount (addresses) > 0;
-
-    if (needRequest) {
-        // Get an array of the remaining, needed `addresses`
-        BRArrayOf(char *) addressesEncoded = cryptoClientQRYGetAddresses (qry, addresses);
-
-        // Create a `calllbackState`; importantly, report `newAddress` as the accumulated addresses
-        // that have been requested.  Note, this specific request will be for `addresses` only.
-        // The elements in `newAddresses` are now owned by `callbackState`.
-        BRCryptoClientCallbackState callbackState = cryptoClientCallbackStateCreateGetTrans (type,
-                                                                                             newAddresses,
-                                                                                             requestId);
-
-        switch (type) {
-            case CLIENT_CALLBACK_REQUEST_TRANSFERS:
-                qry->client.funcGetTransfers (qry->client.context,
-                                              cryptoWalletManagerTake(manager),
-                                              callbackState,
-                                              (const char **) addressesEncoded,
-                                              array_count(addressesEncoded),
-                                              qry->sync.begBlockNumber,
-                                              (qry->sync.unbounded
-                                               ? BLOCK_HEIGHT_UNBOUND_VALUE
-                                               : qry->sync.endBlockNumber));
-                break;
+    // Get an array of the requested `addresses`
+    BRArrayOf(char *) addressesEncoded = cryptoClientQRYGetAddresses (qry, addresses);
 
-            case CLIENT_CALLBACK_REQUEST_TRANSACTIONS:
-                qry->client.funcGetTransactions (qry->client.context,
-                                                 cryptoWalletManagerTake(manager),
-                                                 callbackState,
-                                                 (const char **) addressesEncoded,
-                                                 array_count(addressesEncoded),
-                                                 qry->sync.begBlockNumber,
-                                                 (qry->sync.unbounded
-                                                  ? BLOCK_HEIGHT_UNBOUND_VALUE
-                                                  : qry->sync.endBlockNumber));
-                break;
+    // The sync's block range is updated, under the lock, as syncs start and complete.
+    pthread_mutex_lock (&qry->lock);
+    BRCryptoBlockNumber begBlockNumber = qry->sync.begBlockNumber;
+    BRCryptoBlockNumber endBlockNumber = (qry->sync.unbounded
+                                          ? BLOCK_HEIGHT_UNBOUND_VALUE
+                                          : qry->sync.endBlockNumber);
+    pthread_mutex_unlock (&qry->lock);
 
-            default:
-                assert (false);
-        }
+    // Create a `calllbackState`; the elements in `addresses` are now owned by `callbackState`.
+    BRCryptoClientCallbackState callbackState = cryptoClientCallbackStateCreateGetTrans (type,
+                                                                                         addresses,
+                                                                                         requestId);
 
-        cryptoClientQRYReleaseAddresses (addressesEncoded);
-    }
-    else {
-        // If `newAddresses` ownership was not transfered to `callbackState`, then release everything.
-        cryptoAddressSetRelease (newAddresses);
+    switch (type) {
+        case CLIENT_CALLBACK_REQUEST_TRANSFERS:
+            qry->client.funcGetTransfers (qry->client.context,
+                                          cryptoWalletManagerTake(manager),
+                                          callbackState,
+                                          (const char **) addressesEncoded,
+                                          array_count(addressesEncoded),
+                                          begBlockNumber,
+                                          endBlockNumber);
+            break;
+
+        case CLIENT_CALLBACK_REQUEST_TRANSACTIONS:
+            qry->client.funcGetTransactions (qry->client.context,
+                                             cryptoWalletManagerTake(manager),
+                                             callbackState,
+                                             (const char **) addressesEncoded,
+                                             array_count(addressesEncoded),
+                                             begBlockNumber,
+                                             endBlockNumber);
+            break;
+
+        default:
+            assert (false);
     }
 
+    cryptoClientQRYReleaseAddresses (addressesEncoded);
     cryptoWalletManagerGive (manager);
-    BRSetFree (addresses);
 
-    return needRequest;
+    return true;
 }
 
-extern void
-cwmAnnounceTransactions (OwnershipKept BRCryptoWalletManager manager,
-                         OwnershipGiven BRCryptoClientCallbackState callbackState,
-                         BRCryptoBoolean success,
-                         BRCryptoClientTransactionBundle *bundles,  // given elements, not array
-                         size_t bundlesCount) {
+///
+/// Determine the addresses still needed for the current sync as the wallet's recovery addresses,
+/// extended `lookAheadDepth` gap windows, less those already requested.  The needed addresses are
+/// split into up to `1 + lookAheadDepth` batches - one per window, roughly - that are requested
+/// concurrently; their results are merged as they are announced under the same `rid`.
+///
+/// Must be called with `qry->lock` held.  Returns the batches (possibly none), each an owned set.
+///
+static BRArrayOf(BRSetOf(BRCryptoAddress))
+cryptoClientQRYPrepareAddressBatches (BRCryptoClientQRYManager qry,
+                                      BRCryptoWallet wallet) {
+    BRSetOf(BRCryptoAddress) addresses = cryptoWalletGetAddressesForRecoveryAhead (wallet, qry->lookAheadDepth);
+
+    // Collect the `addresses` not yet requested, recording them as requested.
+    BRArrayOf(BRCryptoAddress) needed;
+    array_new (needed, BRSetCount (addresses));
 
-    BRCryptoClientQRYManager qry = manager->qryManager;
+    FOR_SET (BRCryptoAddress, address, addresses) {
+        if (!BRSetContains (qry->sync.addresses, address)) {
+            BRSetAdd (qry->sync.addresses, cryptoAddressTake (address));
+            array_add (needed, address);
+        }
+    }
 
-    // Process the results if the bundles are for our rid; otherwise simply discard;
-    if (callbackState->rid == qry->sync.rid) {
-        switch (success) {
-            case CRYPTO_TRUE: {
-                // Sort bundles to have the lowest blocknumber first.  Use of `mergesort` is
-                // appropriate given that the bundles are likely already ordered.  This minimizes
-                // dependency resolution between later transactions depending on prior transactions.
-#if 0
-                // TODO: Somehow sorts descending?
-                mergesort (bundles, bundlesCount, sizeof (BRCryptoClientTransactionBundle),
-                           (int (*) (const void *, const void *)) cryptoClientTransactionBundleCompare);
-#endif
+    // Avoid splitting a handful of addresses into tiny requests.
+    size_t neededCount = array_count (needed);
+    size_t batchCount  = MIN (1 + qry->lookAheadDepth,
+                              (neededCount + QRY_ADDRESS_BATCH_MINIMUM - 1) / QRY_ADDRESS_BATCH_MINIMUM);
+
+    BRArrayOf(BRSetOf(BRCryptoAddress)) batches;
+    array_new (batches, batchCount);
+
+    for (size_t batchIndex = 0, index = 0; batchIndex < batchCount; batchIndex++) {
+        // Spread any remainder over the leading batches.
+        size_t batchSize = neededCount / batchCount + (batchIndex < neededCount % batchCount ? 1 : 0);
+
+        BRSetOf(BRCryptoAddress) batch = cryptoAddressSetCreate (batchSize);
+        for (size_t end = index + batchSize; index < end; index++)
+            BRSetAdd (batch, cryptoAddressTake (needed[index]));
+
+        array_add (batches, batch);
+    }
+
+    qry->sync.pending += batchCount;
+
+    array_free (needed);
+    cryptoAddressSetRelease (addresses);
+
+    return batches;
+}
+
+static void
+cryptoClientQRYRequestAddressBatches (BRCryptoClientQRYManager qry,
+                                      OwnershipGiven BRArrayOf(BRSetOf(BRCryptoAddress)) batches,
+                                      size_t requestId) {
+    BRCryptoClientCallbackType type = cryptoClientQRYGetRequestType (qry);
+
+    for (size_t index = 0; index < array_count (batches); index++)
+        if (!cryptoClientQRYRequestTransactionsOrTransfers (qry, type, batches[index], requestId)) {
+            // The manager is gone; the request will never be announced.
+            pthread_mutex_lock (&qry->lock);
+            if (requestId == qry->sync.rid) {
+                qry->sync.pending  -= 1;
+                qry->sync.completed = true;
+                qry->sync.success   = false;
+            }
+            pthread_mutex_unlock (&qry->lock);
+        }
 
-                // Recover transfers from each bundle
-                for (size_t index = 0; index < bundlesCount; index++)
-                    cryptoWalletManagerRecoverTransfersFromTransactionBundle (manager, bundles[index]);
+    array_free (batches);
+}
+
+static bool
+cryptoClientQRYIsSyncRequest (BRCryptoClientQRYManager qry,
+                              size_t requestId) {
+    pthread_mutex_lock (&qry->lock);
+    bool isSyncRequest = (requestId == qry->sync.rid && !qry->sync.completed);
+    pthread_mutex_unlock (&qry->lock);
 
-                BRCryptoWallet wallet = cryptoWalletManagerGetWallet(manager);
+    return isSyncRequest;
+}
 
-                // We've completed a query for `oldAddresses`
-                BRSetOf(BRCryptoAddress) oldAddresses = callbackState->u.getTransactions.addresses;
+///
+/// Account for the announcement of one address batch for `requestId`.  If successful, then the
+/// batch's results have been recovered and any addresses now needed, given the wallet's newly
+/// used addresses, are returned as batches to request.  The sync completes once no batch remains
+/// in flight and none is needed.
+///
+/// Must be called with `qry->recoveryLock` held.  Returns the batches or NULL.
+///
+static BRArrayOf(BRSetOf(BRCryptoAddress))
+cryptoClientQRYAnnounceAddressBatch (BRCryptoClientQRYManager qry,
+                                     size_t requestId,
+                                     BRCryptoBoolean success) {
+    BRCryptoWallet wallet = cryptoWalletManagerGetWallet (qry->manager);
+    BRArrayOf(BRSetOf(BRCryptoAddress)) batches = NULL;
+
+    pthread_mutex_lock (&qry->lock);
+
+    // Skip out if a concurrent announcement completed (or a tick started another) sync.
+    if (requestId == qry->sync.rid && !qry->sync.completed) {
+        qry->sync.pending -= 1;
 
-                // We'll need another query if `newAddresses` is now larger then `oldAddresses`
-                BRSetOf(BRCryptoAddress) newAddresses = cryptoWalletGetAddressesForRecovery (wallet);
+        switch (success) {
+            case CRYPTO_TRUE:
+                batches = cryptoClientQRYPrepareAddressBatches (qry, wallet);
 
-                // Make the actual request; if none is needed, then we are done
-                if (!cryptoClientQRYRequestTransactionsOrTransfers (qry,
-                                                                    CLIENT_CALLBACK_REQUEST_TRANSACTIONS,
-                                                                    oldAddresses,
-                                                                    newAddresses,
-                                                                    callbackState->rid)) {
+                // If nothing is in flight and nothing is needed, then we are done.
+                if (0 == qry->sync.pending) {
                     qry->sync.completed = true;
                     qry->sync.success   = true;
                 }
-
-                cryptoWalletGive (wallet);
                 break;
 
             case CRYPTO_FALSE:
+                // Any batches still in flight will be ignored.
                 qry->sync.completed = true;
                 qry->sync.success   = false;
                 break;
-            }
         }
     }
 
+    pthread_mutex_unlock (&qry->lock);
+
+    cryptoWalletGive (wallet);
+
+    return batches;
+}
+
+// The bundle compare functions take bundles, not the pointers to array elements that `qsort()`
+// passes - which is why sorting with them directly produced a bogus order.  Sort entries holding
+// each bundle with its original index; the index breaks ties so the sort is stable, as `qsort()`
+// is not, and bundles in one block keep the order the client provided.
+
+typedef struct {
+    BRCryptoClientTransactionBundle bundle;
+    size_t index;
+} BRCryptoClientTransactionBundleSortEntry;
+
+static int
+cryptoClientTransactionBundleSortEntryCompare (const void *v1, const void *v2) {
+    const BRCryptoClientTransactionBundleSortEntry *e1 = v1;
+    const BRCryptoClientTransactionBundleSortEntry *e2 = v2;
+
+    int result = cryptoClientTransactionBundleCompare (e1->bundle, e2->bundle);
+    return (0 != result ? result : (e1->index < e2->index ? -1 : (e1->index > e2->index ? +1 : 0)));
+}
+
+private_extern void
+cryptoClientTransactionBundlesSort (BRCryptoClientTransactionBundle *bundles,
+                                    size_t bundlesCount) {
+    if (bundlesCount < 2) return;
+
+    BRCryptoClientTransactionBundleSortEntry *entries = calloc (bundlesCount, sizeof (BRCryptoClientTransactionBundleSortEntry));
+    for (size_t index = 0; index < bundlesCount; index++)
+        entries[index] = (BRCryptoClientTransactionBundleSortEntry) { bundles[index], index };
+
+    qsort (entries, bundlesCount, sizeof (BRCryptoClientTransactionBundleSortEntry),
+           cryptoClientTransactionBundleSortEntryCompare);
+
+    for (size_t index = 0; index < bundlesCount; index++)
+        bundles[index] = entries[index].bundle;
+
+    free (entries);
+}
+
+extern void
+cwmAnnounceTransactions (OwnershipKept BRCryptoWalletManager manager,
+                         OwnershipGiven BRCryptoClientCallbackState callbackState,
+                         BRCryptoBoolean success,
+                         BRCryptoClientTransactionBundle *bundles,  // given elements, not array
+                         size_t bundlesCount) {
+
+    BRCryptoClientQRYManager qry = manager->qryManager;
+    BRArrayOf(BRSetOf(BRCryptoAddress)) batches = NULL;
+
+    // Recover one batch at a time; the batches that follow depend on what was recovered.
+    pthread_mutex_lock (&qry->recoveryLock);
+
+    // Process the results if the bundles are for our rid; otherwise simply discard;
+    if (cryptoClientQRYIsSyncRequest (qry, callbackState->rid)) {
+        if (CRYPTO_TRUE == success) {
+            // Sort bundles to have the lowest blocknumber first.  This minimizes dependency
+            // resolution between later transactions depending on prior transactions.
+            cryptoClientTransactionBundlesSort (bundles, bundlesCount);
+
+            // Recover transfers from all the bundles
+            cryptoWalletManagerRecoverTransfersFromTransactionBundles (manager, bundles, bundlesCount);
+        }
+
+        // We've completed a query for `callbackState->u.getTransactions.addresses`; determine
+        // whatever addresses are now needed, if any.
+        batches = cryptoClientQRYAnnounceAddressBatch (qry, callbackState->rid, success);
+    }
+
+    pthread_mutex_unlock (&qry->recoveryLock);
+
+    // Use the same `rid` as we are in the same sync; a client may announce synchronously.
+    if (NULL != batches)
+        cryptoClientQRYRequestAddressBatches (qry, batches, callbackState->rid);
+
     for (size_t index = 0; index < bundlesCount; index++)
         cryptoClientTransactionBundleRelease (bundles[index]);
 
@@ -738,6 +906,38 @@ cwmAnnounceTransactions (OwnershipKept BRCryptoWalletManager manager,
 // MARK: - Announce Transfer
 
 
+typedef struct {
+    BRCryptoClientTransferBundle bundle;
+    size_t index;
+} BRCryptoClientTransferBundleSortEntry;
+
+static int
+cryptoClientTransferBundleSortEntryCompare (const void *v1, const void *v2) {
+    const BRCryptoClientTransferBundleSortEntry *e1 = v1;
+    const BRCryptoClientTransferBundleSortEntry *e2 = v2;
+
+    int result = cryptoClientTransferBundleCompare (e1->bundle, e2->bundle);
+    return (0 != result ? result : (e1->index < e2->index ? -1 : (e1->index > e2->index ? +1 : 0)));
+}
+
+private_extern void
+cryptoClientTransferBundlesSort (BRCryptoClientTransferBundle *bundles,
+                                 size_t bundlesCount) {
+    if (bundlesCount < 2) return;
+
+    BRCryptoClientTransferBundleSortEntry *entries = calloc (bundlesCount, sizeof (BRCryptoClientTransferBundleSortEntry));
+    for (size_t index = 0; index < bundlesCount; index++)
+        entries[index] = (BRCryptoClientTransferBundleSortEntry) { bundles[index], index };
+
+    qsort (entries, bundlesCount, sizeof (BRCryptoClientTransferBundleSortEntry),
+           cryptoClientTransferBundleSortEntryCompare);
+
+    for (size_t index = 0; index < bundlesCount; index++)
+        bundles[index] = entries[index].bundle;
+
+    free (entries);
+}
+
 extern void
 cwmAnnounceTransfers (OwnershipKept BRCryptoWalletManager manager,
                       OwnershipGiven BRCryptoClientCallbackState callbackState,
@@ -745,52 +945,33 @@ cwmAnnounceTransfers (OwnershipKept BRCryptoWalletManager manager,
                       OwnershipGiven BRCryptoClientTransferBundle *bundles, // given elements, not array
                       size_t bundlesCount) {
     BRCryptoClientQRYManager qry = manager->qryManager;
+    BRArrayOf(BRSetOf(BRCryptoAddress)) batches = NULL;
 
-    // Process the results if the bundles are for our rid; otherwise simply discard;
-    if (callbackState->rid == qry->sync.rid) {
-        switch (success) {
-            case CRYPTO_TRUE: {
-                // Sort bundles to have the lowest blocknumber first.  Use of `mergesort` is
-                // appropriate given that the bundles are likely already ordered.  This minimizes
-                // dependency resolution between later transfers depending on prior transfers.
-#if 0
-                // TODO: Somehow sorts descending?
-                mergesort (bundles, bundlesCount, sizeof (BRCryptoClientTransferBundle),
-                           (int (*) (const void *, const void *)) cryptoClientTransferBundleCompare);
-#endif
-                // Recover transfers from each bundle
-                for (size_t index = 0; index < bundlesCount; index++)
-                    cryptoWalletManagerRecoverTransferFromTransferBundle (manager, bundles[index]);
-
-                BRCryptoWallet wallet = cryptoWalletManagerGetWallet(manager);
-
-                // We've completed a query for `oldAddresses`
-                BRSetOf(BRCryptoAddress) oldAddresses = callbackState->u.getTransactions.addresses;
+    // Recover one batch at a time; the batches that follow depend on what was recovered.
+    pthread_mutex_lock (&qry->recoveryLock);
 
-                // We'll need another query if `newAddresses` is now larger then `oldAddresses`
-                BRSetOf(BRCryptoAddress) newAddresses = cryptoWalletGetAddressesForRecovery (wallet);
+    // Process the results if the bundles are for our rid; otherwise simply discard;
+    if (cryptoClientQRYIsSyncRequest (qry, callbackState->rid)) {
+        if (CRYPTO_TRUE == success) {
+            // Sort bundles to have the lowest blocknumber first.  This minimizes dependency
+            // resolution between later transfers depending on prior transfers.
+            cryptoClientTransferBundlesSort (bundles, bundlesCount);
+
+            // Recover transfers from each bundle
+            for (size_t index = 0; index < bundlesCount; index++)
+                cryptoWalletManagerRecoverTransferFromTransferBundle (manager, bundles[index]);
+        }
 
-                // Make the actual request; if none is needed, then we are done.  Use the
-                // same `rid` as we are in the same sync.
-                if (!cryptoClientQRYRequestTransactionsOrTransfers (qry,
-                                                                    CLIENT_CALLBACK_REQUEST_TRANSFERS,
-                                                                    oldAddresses,
-                                                                    newAddresses,
-                                                                    callbackState->rid)) {
-                    qry->sync.completed = true;
-                    qry->sync.success   = true;
-                }
+        // We've completed a query for `callbackState->u.getTransfers.addresses`; determine
+        // whatever addresses are now needed, if any.
+        batches = cryptoClientQRYAnnounceAddressBatch (qry, callbackState->rid, success);
+    }
 
-                cryptoWalletGive (wallet);
-                break;
+    pthread_mutex_unlock (&qry->recoveryLock);
 
-            case CRYPTO_FALSE:
-                qry->sync.completed = true;
-                qry->sync.success   = false;
-                break;
-            }
-        }
-    }
+    // Use the same `rid` as we are in the same sync; a client may announce synchronously.
+    if (NULL != batches)
+        cryptoClientQRYRequestAddressBatches (qry, batches, callbackState->rid);
 
     for (size_t index = 0; index < bundlesCount; index++)
         cryptoClientTransferBundleRelease (bundles[index]);
@@ -1050,6 +1231,50 @@ cryptoClientTransferBundleCompare (const BRCryptoClientTransferBundle b1,
                       :  0))));
 }
 
+// Parse a run of at most `maxDigits` decimal digits filling all of `field`; false otherwise
+static bool
+cryptoClientTransferBundleParseDigits (const char *field, size_t maxDigits, uint64_t *value) {
+    uint64_t result = 0;
+    size_t   digits = 0;
+
+    for (; '\0' != *field; field++, digits++) {
+        unsigned int digit = (unsigned int) (*field - '0');
+        if (digit > 9 || digits == maxDigits) return false;
+        result = 10 * result + digit;
+    }
+
+    *value = result;
+    return digits > 0;
+}
+
+extern uint64_t
+cryptoClientTransferBundleParseUInt64 (const char *field) {
+    uint64_t value = 0;
+    if (NULL == field) return value;
+
+    // 19 digits cannot overflow 64 bits
+    if (!cryptoClientTransferBundleParseDigits (field, 19, &value))
+        sscanf (field, "%" PRIu64, &value);
+
+    return value;
+}
+
+extern int64_t
+cryptoClientTransferBundleParseInt64 (const char *field) {
+    int64_t value = 0;
+    if (NULL == field) return value;
+
+    // 18 digits cannot overflow 63 bits; "%i" reads a leading '0' as octal, so leave that to sscanf
+    uint64_t digits;
+    if (('0' != field[0] || '\0' == field[1]) &&
+        cryptoClientTransferBundleParseDigits (field, 18, &digits))
+        value = (int64_t) digits;
+    else
+        sscanf (field, "%" PRIi64, &value);
+
+    return value;
+}
+
 // MARK: - Transaction Bundle
 
 extern BRCryptoClientTransactionBundle
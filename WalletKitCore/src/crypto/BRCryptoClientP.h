@@ -11,6 +11,7 @@
 #ifndef BRCryptoClientP_h
 #define BRCryptoClientP_h
 
+#include <pthread.h>
 #include "support/BRSet.h"
 
 #include "BRCryptoClient.h"
@@ -52,6 +53,29 @@ struct BRCryptoClientTransferBundleRecord {
     char **attributeVals;
 };
 
+/**
+ * Parse a transfer bundle's decimal `amount` or `fee`; a NULL or unparsable field is zero.
+ * Plain digit strings are parsed directly; anything else (signs, whitespace, very long values) is
+ * handed to `sscanf()` so results match the previous parsing exactly.
+ */
+private_extern uint64_t
+cryptoClientTransferBundleParseUInt64 (const char *field);
+
+private_extern int64_t
+cryptoClientTransferBundleParseInt64 (const char *field);
+
+/**
+ * Sort bundles, in place, lowest block first.  The sort is stable: bundles in the same block keep
+ * their given order.
+ */
+private_extern void
+cryptoClientTransactionBundlesSort (BRCryptoClientTransactionBundle *bundles,
+                                    size_t bundlesCount);
+
+private_extern void
+cryptoClientTransferBundlesSort (BRCryptoClientTransferBundle *bundles,
+                                 size_t bundlesCount);
+
 // MARK: - Client Callback
 
 typedef enum  {
@@ -220,12 +244,25 @@ struct BRCryptoClientQRYManagerRecord {
         BRCryptoBlockNumber begBlockNumber;
         BRCryptoBlockNumber endBlockNumber;
         size_t rid;
+        size_t pending;     // count of address-batch requests in flight for `rid`
+        BRSetOf(BRCryptoAddress) addresses; // all addresses requested for `rid`; owned
     } sync;
 
+    // The number of gap windows, beyond those required, to derive and request speculatively.
+    // Each window is requested as a separate batch under the sync's `rid`.
+    size_t lookAheadDepth;
+
     size_t requestId;
+    pthread_mutex_t lock;
+
+    // Held while the results of one announced batch are recovered and the batches that follow are
+    // prepared, so that concurrently announced batches of a sync recover into the wallet one at a
+    // time.  Taken before `lock`; never held while making a request.
+    pthread_mutex_t recoveryLock;
 };
 
 #define CRYPTO_CLIENT_QRY_IS_UNBOUNDED            (true)
+#define CRYPTO_CLIENT_QRY_LOOK_AHEAD_DEPTH        (2)
 
 extern BRCryptoClientQRYManager
 cryptoClientQRYManagerCreate (BRCryptoClient client,
@@ -246,6 +283,10 @@ cryptoClientQRYManagerDisconnect (BRCryptoClientQRYManager qry);
 extern void
 cryptoClientQRYManagerTickTock (BRCryptoClientQRYManager qry);
 
+extern void
+cryptoClientQRYManagerSetLookAheadDepth (BRCryptoClientQRYManager qry,
+                                         size_t depth);
+
 extern void
 cryptoClientQRYEstimateTransferFee (BRCryptoClientQRYManager qry,
                                     BRCryptoCookie   cookie,
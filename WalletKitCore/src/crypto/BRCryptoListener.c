@@ -19,6 +19,10 @@
 
 IMPLEMENT_CRYPTO_GIVE_TAKE (BRCryptoListener, cryptoListener)
 
+static void
+cryptoListenerSignalEvent (BRCryptoListener listener,
+                           BREvent *event);
+
 // MARK: - Generate Transfer Event
 
 typedef struct {
@@ -58,7 +62,7 @@ cryptoListenerGenerateTransferEvent (const BRCryptoTransferListener *listener,
         cryptoTransferTakeWeak (transfer),
         event };
 
-    eventHandlerSignalEvent(listener->listener->handler, (BREvent *) &listenerEvent);
+    cryptoListenerSignalEvent (listener->listener, (BREvent *) &listenerEvent);
 }
 
 // MARK: - Generate Wallet Event
@@ -97,7 +101,7 @@ cryptoListenerGenerateWalletEvent (const BRCryptoWalletListener *listener,
         cryptoWalletTakeWeak (wallet),
         event };
 
-    eventHandlerSignalEvent(listener->listener->handler, (BREvent *) &listenerEvent);
+    cryptoListenerSignalEvent (listener->listener, (BREvent *) &listenerEvent);
 }
 
 // MARK: - Generate Manager Event
@@ -133,7 +137,7 @@ cryptoListenerGenerateManagerEvent (const BRCryptoWalletManagerListener *listene
         cryptoWalletManagerTakeWeak (manager),
         event };
 
-    eventHandlerSignalEvent (listener->listener->handler, (BREvent *) &listenerEvent);
+    cryptoListenerSignalEvent (listener->listener, (BREvent *) &listenerEvent);
 }
 
 // MARK: - Generate Network Event
@@ -169,7 +173,7 @@ cryptoListenerGenerateNetworkEvent (const BRCryptoNetworkListener *listener,
         cryptoNetworkTakeWeak (network),
         event };
 
-    eventHandlerSignalEvent (listener->listener->handler, (BREvent *) &listenerEvent);
+    cryptoListenerSignalEvent (listener->listener, (BREvent *) &listenerEvent);
 }
 
 // MARK: - Generate System Event
@@ -205,7 +209,316 @@ cryptoListenerGenerateSystemEvent (BRCryptoListener listener,
         cryptoSystemTakeWeak (system),
         event };
 
-    eventHandlerSignalEvent (listener->handler, (BREvent *) &listenerEvent);
+    cryptoListenerSignalEvent (listener, (BREvent *) &listenerEvent);
+}
+
+// MARK: - Coalesce Events
+
+typedef union BRListenerPendingEventRecord {
+    BREvent base;
+    BRListenerSignalTransferEvent transfer;
+    BRListenerSignalWalletEvent wallet;
+    BRListenerSignalManagerEvent manager;
+    BRListenerSignalNetworkEvent network;
+    BRListenerSignalSystemEvent system;
+} BRListenerPendingEvent;
+
+typedef struct {
+    BREvent base;
+    BRCryptoListener listener;
+} BRListenerFlushEvent;
+
+/// Return the object that `event` is about, or NULL.  Fill `coalesceType` with the event's
+/// type if a later event of that type, for the same object, supersedes `event`, and with -1
+/// otherwise.  Fill `isLifecycle` with true if `event` creates or deletes the object.
+static void *
+cryptoListenerPendingGetObject (const BRListenerPendingEvent *event,
+                                int *coalesceType,
+                                bool *isLifecycle) {
+    const BREventType *type = event->base.type;
+
+    *coalesceType = -1;
+    *isLifecycle  = false;
+
+    if (type == &handleListenerSignalTransferEventType) {
+        BRCryptoTransferEventType transferType = event->transfer.event.type;
+        if (CRYPTO_TRANSFER_EVENT_CHANGED == transferType) *coalesceType = (int) transferType;
+        *isLifecycle = (CRYPTO_TRANSFER_EVENT_CREATED == transferType ||
+                        CRYPTO_TRANSFER_EVENT_DELETED == transferType);
+        return event->transfer.transfer;
+    }
+
+    if (type == &handleListenerSignalWalletEventType) {
+        BRCryptoWalletEventType walletType = event->wallet.event.type;
+        if (CRYPTO_WALLET_EVENT_BALANCE_UPDATED   == walletType ||
+            CRYPTO_WALLET_EVENT_FEE_BASIS_UPDATED == walletType) *coalesceType = (int) walletType;
+        *isLifecycle = (CRYPTO_WALLET_EVENT_CREATED == walletType ||
+                        CRYPTO_WALLET_EVENT_DELETED == walletType);
+        return event->wallet.wallet;
+    }
+
+    if (type == &handleListenerSignalManagerEventType) {
+        BRCryptoWalletManagerEventType managerType = event->manager.event.type;
+        if (CRYPTO_WALLET_MANAGER_EVENT_SYNC_CONTINUES       == managerType ||
+            CRYPTO_WALLET_MANAGER_EVENT_BLOCK_HEIGHT_UPDATED == managerType) *coalesceType = (int) managerType;
+        *isLifecycle = (CRYPTO_WALLET_MANAGER_EVENT_CREATED == managerType ||
+                        CRYPTO_WALLET_MANAGER_EVENT_DELETED == managerType);
+        return event->manager.manager;
+    }
+
+    return NULL;
+}
+
+/// Give everything that `event` holds: its references and its payload.  Used for an event that
+/// is dropped rather than delivered to a callback, which would otherwise give them.
+static void
+cryptoListenerPendingRelease (BRListenerPendingEvent *event) {
+    const BREventType *type = event->base.type;
+
+    if (type == &handleListenerSignalTransferEventType) {
+        if (CRYPTO_TRANSFER_EVENT_CHANGED == event->transfer.event.type) {
+            cryptoTransferStateRelease (&event->transfer.event.u.state.old);
+            cryptoTransferStateRelease (&event->transfer.event.u.state.new);
+        }
+
+        cryptoTransferGive      (event->transfer.transfer);
+        cryptoWalletGive        (event->transfer.wallet);
+        cryptoWalletManagerGive (event->transfer.manager);
+    }
+
+    else if (type == &handleListenerSignalWalletEventType) {
+        switch (event->wallet.event.type) {
+            case CRYPTO_WALLET_EVENT_TRANSFER_ADDED:
+            case CRYPTO_WALLET_EVENT_TRANSFER_CHANGED:
+            case CRYPTO_WALLET_EVENT_TRANSFER_SUBMITTED:
+            case CRYPTO_WALLET_EVENT_TRANSFER_DELETED:
+                cryptoTransferGive (event->wallet.event.u.transfer);
+                break;
+            case CRYPTO_WALLET_EVENT_BALANCE_UPDATED:
+                cryptoAmountGive (event->wallet.event.u.balanceUpdated.amount);
+                break;
+            case CRYPTO_WALLET_EVENT_FEE_BASIS_UPDATED:
+                cryptoFeeBasisGive (event->wallet.event.u.feeBasisUpdated.basis);
+                break;
+            case CRYPTO_WALLET_EVENT_FEE_BASIS_ESTIMATED:
+                cryptoFeeBasisGive (event->wallet.event.u.feeBasisEstimated.basis);
+                break;
+            default:
+                break;
+        }
+
+        cryptoWalletGive        (event->wallet.wallet);
+        cryptoWalletManagerGive (event->wallet.manager);
+    }
+
+    else if (type == &handleListenerSignalManagerEventType) {
+        switch (event->manager.event.type) {
+            case CRYPTO_WALLET_MANAGER_EVENT_WALLET_ADDED:
+            case CRYPTO_WALLET_MANAGER_EVENT_WALLET_CHANGED:
+            case CRYPTO_WALLET_MANAGER_EVENT_WALLET_DELETED:
+                cryptoWalletGive (event->manager.event.u.wallet);
+                break;
+            default:
+                break;
+        }
+
+        cryptoWalletManagerGive (event->manager.manager);
+    }
+
+    else if (type == &handleListenerSignalNetworkEventType) {
+        cryptoNetworkGive (event->network.network);
+    }
+
+    else if (type == &handleListenerSignalSystemEventType) {
+        switch (event->system.event.type) {
+            case CRYPTO_SYSTEM_EVENT_NETWORK_ADDED:
+            case CRYPTO_SYSTEM_EVENT_NETWORK_CHANGED:
+            case CRYPTO_SYSTEM_EVENT_NETWORK_DELETED:
+                cryptoNetworkGive (event->system.event.u.network);
+                break;
+            case CRYPTO_SYSTEM_EVENT_MANAGER_ADDED:
+            case CRYPTO_SYSTEM_EVENT_MANAGER_CHANGED:
+            case CRYPTO_SYSTEM_EVENT_MANAGER_DELETED:
+                cryptoWalletManagerGive (event->system.event.u.manager);
+                break;
+            default:
+                break;
+        }
+
+        cryptoSystemGive (event->system.system);
+    }
+
+    event->base.type = NULL;
+}
+
+/// Merge `newer` into `older` and then give everything that `newer` still holds.
+static void
+cryptoListenerPendingMerge (BRListenerPendingEvent *older,
+                            BRListenerPendingEvent *newer) {
+    const BREventType *type = older->base.type;
+
+    if (type == &handleListenerSignalTransferEventType) {
+        // Keep the first `old` and the last `new` state.
+        BRCryptoTransferState state = older->transfer.event.u.state.new;
+        older->transfer.event.u.state.new = newer->transfer.event.u.state.new;
+        newer->transfer.event.u.state.new = state;
+    }
+
+    else if (type == &handleListenerSignalWalletEventType) {
+        BRCryptoWalletEvent event = older->wallet.event;
+        older->wallet.event = newer->wallet.event;
+        newer->wallet.event = event;
+    }
+
+    else if (type == &handleListenerSignalManagerEventType) {
+        BRCryptoWalletManagerEvent event = older->manager.event;
+        older->manager.event = newer->manager.event;
+        newer->manager.event = event;
+    }
+
+    cryptoListenerPendingRelease (newer);
+}
+
+/// Add `event` to the pending events.  If it supersedes a pending event, that event is merged
+/// into it and removed, so that the merged event follows every event pending before it; some may
+/// depend on the superseded event, such as a TRANSFER_ADDED between two BALANCE_UPDATED events.
+/// Must hold the listener's `coalesceLock`.
+static void
+cryptoListenerPendingAdd (BRCryptoListener listener,
+                          BRListenerPendingEvent *event) {
+    int  coalesceType, pendingCoalesceType;
+    bool isLifecycle,  pendingIsLifecycle;
+
+    void *object = cryptoListenerPendingGetObject (event, &coalesceType, &isLifecycle);
+
+    for (size_t index = array_count (listener->pending); NULL != object && -1 != coalesceType && index > 0; index--) {
+        BRListenerPendingEvent *pending = &listener->pending[index - 1];
+
+        if (pending->base.type != event->base.type) continue;
+        if (object != cryptoListenerPendingGetObject (pending, &pendingCoalesceType, &pendingIsLifecycle)) continue;
+
+        // Never merge across the creation or deletion of the object
+        if (pendingIsLifecycle) break;
+
+        if (pendingCoalesceType == coalesceType) {
+            cryptoListenerPendingMerge (pending, event);
+            *event = *pending;
+            array_rm (listener->pending, index - 1);
+            break;
+        }
+    }
+
+    array_add (listener->pending, *event);
+}
+
+/// Give what every pending event holds, without delivering it, and forget any flush signaled for
+/// them.  Giving a reference can release an object, which then signals one more event, so repeat
+/// until none are pending.
+static void
+cryptoListenerPendingDiscard (BRCryptoListener listener) {
+    pthread_mutex_lock (&listener->coalesceLock);
+    while (array_count (listener->pending) > 0) {
+        BRArrayOf(BRListenerPendingEvent) events = listener->pending;
+        listener->pending    = listener->delivering;
+        listener->delivering = events;
+        pthread_mutex_unlock (&listener->coalesceLock);
+
+        for (size_t index = 0; index < array_count (events); index++)
+            cryptoListenerPendingRelease (&events[index]);
+        array_clear (events);
+
+        pthread_mutex_lock (&listener->coalesceLock);
+    }
+    listener->coalesceFlushSignaled = false;
+    pthread_mutex_unlock (&listener->coalesceLock);
+}
+
+/// Deliver all pending events, in order, as one batch on the handler's thread.
+static void
+cryptoListenerPendingDeliver (BRCryptoListener listener) {
+    pthread_mutex_lock (&listener->coalesceLock);
+    BRArrayOf(BRListenerPendingEvent) events = listener->pending;
+    listener->pending    = listener->delivering;
+    listener->delivering = events;
+    listener->coalesceFlushSignaled = false;
+    pthread_mutex_unlock (&listener->coalesceLock);
+
+    size_t eventsCount = array_count (events);
+    if (0 == eventsCount) return;
+
+    if (NULL != listener->batchCallback)
+        listener->batchCallback (listener->context, CRYPTO_TRUE, eventsCount);
+
+    for (size_t index = 0; index < eventsCount; index++)
+        events[index].base.type->eventDispatcher (listener->handler, &events[index].base);
+
+    if (NULL != listener->batchCallback)
+        listener->batchCallback (listener->context, CRYPTO_FALSE, eventsCount);
+
+    array_clear (events);
+}
+
+static void
+cryptoListenerFlushEventDispatcher (BREventHandler ignore,
+                                    BRListenerFlushEvent *event) {
+    cryptoListenerPendingDeliver (event->listener);
+}
+
+static BREventType handleListenerFlushEventType = {
+    "CWM: Handle Listener Flush Event",
+    sizeof (BRListenerFlushEvent),
+    (BREventDispatcher) cryptoListenerFlushEventDispatcher
+};
+
+static void
+cryptoListenerPeriodicDispatcher (BREventHandler ignore,
+                                  BREventTimeout *event) {
+    cryptoListenerPendingDeliver ((BRCryptoListener) event->context);
+}
+
+static void
+cryptoListenerSignalEvent (BRCryptoListener listener,
+                           BREvent *event) {
+    if (0 == listener->coalesceWindow) {
+        eventHandlerSignalEvent (listener->handler, event);
+        return;
+    }
+
+    BRListenerPendingEvent pending;
+    memcpy (&pending, event, event->type->eventSize);
+
+    pthread_mutex_lock (&listener->coalesceLock);
+    cryptoListenerPendingAdd (listener, &pending);
+
+    bool needsFlush = (array_count (listener->pending) >= listener->coalesceLimit &&
+                       !listener->coalesceFlushSignaled);
+    if (needsFlush) listener->coalesceFlushSignaled = true;
+    pthread_mutex_unlock (&listener->coalesceLock);
+
+    if (needsFlush) {
+        BRListenerFlushEvent flushEvent =
+        { { NULL, &handleListenerFlushEventType }, listener };
+
+        eventHandlerSignalEvent (listener->handler, (BREvent *) &flushEvent);
+    }
+}
+
+extern void
+cryptoListenerSetCoalescing (BRCryptoListener listener,
+                             unsigned int windowInMilliseconds,
+                             size_t batchLimit,
+                             BRCryptoListenerBatchCallback batchCallback) {
+    assert (!eventHandlerIsRunning (listener->handler));
+
+    listener->coalesceWindow = windowInMilliseconds;
+    listener->coalesceLimit  = (0 == batchLimit ? 1 : batchLimit);
+    listener->batchCallback  = batchCallback;
+
+    if (0 != windowInMilliseconds)
+        eventHandlerSetTimeoutDispatcher (listener->handler,
+                                          windowInMilliseconds,
+                                          (BREventDispatcher) cryptoListenerPeriodicDispatcher,
+                                          (void*) listener);
 }
 
 // MARK: - Event Type
@@ -216,7 +529,8 @@ cryptoListenerEventTypes[] = {
     &handleListenerSignalTransferEventType,
     &handleListenerSignalWalletEventType,
     &handleListenerSignalManagerEventType,
-    &handleListenerSignalSystemEventType
+    &handleListenerSignalSystemEventType,
+    &handleListenerFlushEventType
 };
 
 static const unsigned int
@@ -234,6 +548,7 @@ cryptoListenerCreate (BRCryptoListenerContext context,
 
     listener->ref = CRYPTO_REF_ASSIGN (cryptoListenerRelease);
     pthread_mutex_init_brd (&listener->lock, PTHREAD_MUTEX_NORMAL);
+    pthread_mutex_init_brd (&listener->coalesceLock, PTHREAD_MUTEX_NORMAL);
 
     listener->context          = context;
     listener->systemCallback   = systemCallback;
@@ -247,14 +562,26 @@ cryptoListenerCreate (BRCryptoListenerContext context,
                                             cryptoListenerEventTypesCount,
                                             &listener->lock);
 
+    listener->coalesceWindow = 0;
+    listener->coalesceLimit  = 1;
+    listener->coalesceFlushSignaled = false;
+    listener->batchCallback = NULL;
+    array_new (listener->pending,    16);
+    array_new (listener->delivering, 16);
+
     return listener;
 }
 
 static void
 cryptoListenerRelease (BRCryptoListener listener) {
-    eventHandlerStop (listener->handler);
+    cryptoListenerStop (listener);
+
     eventHandlerDestroy (listener->handler);
 
+    array_free (listener->pending);
+    array_free (listener->delivering);
+
+    pthread_mutex_destroy (&listener->coalesceLock);
     pthread_mutex_destroy (&listener->lock);
 
     memset (listener, 0, sizeof(*listener));
@@ -269,4 +596,9 @@ cryptoListenerStart (BRCryptoListener listener) {
 extern void
 cryptoListenerStop (BRCryptoListener listener) {
     eventHandlerStop (listener->handler);
+
+    // Stopping drops the queued events, a signaled flush among them; drop the pending events too,
+    // as the queue would have, so that a restarted listener starts empty and can signal a flush.
+    eventHandlerClear (listener->handler);
+    cryptoListenerPendingDiscard (listener);
 }
@@ -12,9 +12,11 @@
 #define BRCryptoListenerP_h
 
 #include "BRCryptoListener.h"
+#include "support/BRArray.h"
 #include "support/event/BREvent.h"
 
 #include <pthread.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +36,17 @@ struct BRCryptoListenerRecord {
     BRCryptoListenerWalletManagerCallback managerCallback;
     BRCryptoListenerWalletCallback        walletCallback;
     BRCryptoListenerTransferCallback      transferCallback;
+
+    // Coalescing; see `cryptoListenerSetCoalescing()`.  When `coalesceWindow` is non-zero, events
+    // are held in `pending`, where superseded events are merged, and then delivered in order, as a
+    // batch, on the handler's thread.  The `delivering` array is only used on that thread.
+    pthread_mutex_t coalesceLock;
+    unsigned int coalesceWindow;
+    size_t coalesceLimit;
+    bool coalesceFlushSignaled;
+    BRCryptoListenerBatchCallback batchCallback;
+    BRArrayOf(union BRListenerPendingEventRecord) pending;
+    BRArrayOf(union BRListenerPendingEventRecord) delivering;
 };
 
 extern void
@@ -8,6 +8,9 @@
 //  See the LICENSE file at the project root for license information.
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
+#include <ctype.h>
+#include <strings.h>
+
 #include "BRCryptoNetworkP.h"
 #include "BRCryptoUnit.h"
 #include "BRCryptoAddressP.h"
@@ -98,6 +101,120 @@ cryptoNetworkFeeRelease (BRCryptoNetworkFee networkFee) {
 
 IMPLEMENT_CRYPTO_GIVE_TAKE (BRCryptoNetwork, cryptoNetwork)
 
+/// MARK: - Network Currency Index
+
+#define CRYPTO_NETWORK_DEFAULT_CURRENCY_INDEX_CAPACITY      (10)
+
+// FNV-1a over the lowercased characters; consistent with both strcmp() and strcasecmp() equality
+static size_t
+cryptoNetworkCurrencyIndexHashString (const char *string) {
+    uint32_t hash = 0x811c9dc5;
+    for (; '\0' != *string; string++)
+        hash = (hash ^ (uint8_t) tolower ((uint8_t) *string)) * 0x01000193;
+    return hash;
+}
+
+static size_t
+cryptoNetworkCurrencyIndexHashUids (const BRCryptoCurrencyIndexEntry *entry) {
+    return cryptoNetworkCurrencyIndexHashString (entry->uids);
+}
+
+static int
+cryptoNetworkCurrencyIndexEqualUids (const BRCryptoCurrencyIndexEntry *entry1,
+                                     const BRCryptoCurrencyIndexEntry *entry2) {
+    return entry1 == entry2 || 0 == strcasecmp (entry1->uids, entry2->uids);
+}
+
+static size_t
+cryptoNetworkCurrencyIndexHashCode (const BRCryptoCurrencyIndexEntry *entry) {
+    return cryptoNetworkCurrencyIndexHashString (entry->code);
+}
+
+static int
+cryptoNetworkCurrencyIndexEqualCode (const BRCryptoCurrencyIndexEntry *entry1,
+                                     const BRCryptoCurrencyIndexEntry *entry2) {
+    return entry1 == entry2 || 0 == strcmp (entry1->code, entry2->code);
+}
+
+static size_t
+cryptoNetworkCurrencyIndexHashIssuer (const BRCryptoCurrencyIndexEntry *entry) {
+    return cryptoNetworkCurrencyIndexHashString (entry->issuer);
+}
+
+static int
+cryptoNetworkCurrencyIndexEqualIssuer (const BRCryptoCurrencyIndexEntry *entry1,
+                                       const BRCryptoCurrencyIndexEntry *entry2) {
+    return entry1 == entry2 || 0 == strcasecmp (entry1->issuer, entry2->issuer);
+}
+
+static void
+cryptoNetworkCurrencyIndexCreate (BRCryptoNetwork network) {
+    pthread_rwlock_init (&network->currencyIndexLock, NULL);
+    array_new (network->currencyIndexEntries, CRYPTO_NETWORK_DEFAULT_CURRENCY_INDEX_CAPACITY);
+
+    network->currencyIndexByUids = BRSetNew ((size_t (*) (const void *)) cryptoNetworkCurrencyIndexHashUids,
+                                             (int (*) (const void *, const void *)) cryptoNetworkCurrencyIndexEqualUids,
+                                             CRYPTO_NETWORK_DEFAULT_CURRENCY_INDEX_CAPACITY);
+    network->currencyIndexByCode = BRSetNew ((size_t (*) (const void *)) cryptoNetworkCurrencyIndexHashCode,
+                                             (int (*) (const void *, const void *)) cryptoNetworkCurrencyIndexEqualCode,
+                                             CRYPTO_NETWORK_DEFAULT_CURRENCY_INDEX_CAPACITY);
+    network->currencyIndexByIssuer = BRSetNew ((size_t (*) (const void *)) cryptoNetworkCurrencyIndexHashIssuer,
+                                               (int (*) (const void *, const void *)) cryptoNetworkCurrencyIndexEqualIssuer,
+                                               CRYPTO_NETWORK_DEFAULT_CURRENCY_INDEX_CAPACITY);
+}
+
+static void
+cryptoNetworkCurrencyIndexRelease (BRCryptoNetwork network) {
+    BRSetFree (network->currencyIndexByIssuer);
+    BRSetFree (network->currencyIndexByCode);
+    BRSetFree (network->currencyIndexByUids);
+
+    array_free_all (network->currencyIndexEntries, free);
+    pthread_rwlock_destroy (&network->currencyIndexLock);
+}
+
+// Index the association at `index`; the caller must hold `network->lock`.  If a key is already
+// indexed, the earlier association keeps it - just as a linear scan would find it first.
+static void
+cryptoNetworkCurrencyIndexAdd (BRCryptoNetwork network,
+                               size_t index) {
+    BRCryptoCurrency currency = network->associations[index].currency;
+
+    BRCryptoCurrencyIndexEntry *entry = malloc (sizeof (BRCryptoCurrencyIndexEntry));
+    *entry = (BRCryptoCurrencyIndexEntry) {
+        currency,
+        cryptoCurrencyGetUids   (currency),
+        cryptoCurrencyGetCode   (currency),
+        cryptoCurrencyGetIssuer (currency),
+        index
+    };
+
+    pthread_rwlock_wrlock (&network->currencyIndexLock);
+    array_add (network->currencyIndexEntries, entry);
+
+    if (!BRSetContains (network->currencyIndexByUids, entry))
+        BRSetAdd (network->currencyIndexByUids, entry);
+
+    if (!BRSetContains (network->currencyIndexByCode, entry))
+        BRSetAdd (network->currencyIndexByCode, entry);
+
+    if (NULL != entry->issuer && !BRSetContains (network->currencyIndexByIssuer, entry))
+        BRSetAdd (network->currencyIndexByIssuer, entry);
+    pthread_rwlock_unlock (&network->currencyIndexLock);
+}
+
+// Lookup `probe` in `index`; return the currency, taken, or NULL.
+static BRCryptoCurrency
+cryptoNetworkCurrencyIndexLookup (BRCryptoNetwork network,
+                                  BRSet *index,
+                                  const BRCryptoCurrencyIndexEntry *probe) {
+    pthread_rwlock_rdlock (&network->currencyIndexLock);
+    const BRCryptoCurrencyIndexEntry *entry = BRSetGet (index, probe);
+    BRCryptoCurrency currency = (NULL == entry ? NULL : cryptoCurrencyTake (entry->currency));
+    pthread_rwlock_unlock (&network->currencyIndexLock);
+    return currency;
+}
+
 extern BRCryptoNetwork
 cryptoNetworkAllocAndInit (size_t sizeInBytes,
                            BRCryptoBlockChainType type,
@@ -124,6 +241,7 @@ cryptoNetworkAllocAndInit (size_t sizeInBytes,
     network->currency = NULL;
     network->height = 0;
     array_new (network->associations, CRYPTO_NETWORK_DEFAULT_CURRENCY_ASSOCIATIONS);
+    cryptoNetworkCurrencyIndexCreate (network);
     array_new (network->fees, CRYPTO_NETWORK_DEFAULT_FEES);
 
     network->confirmationPeriodInSeconds = confirmationPeriodInSeconds;
@@ -159,6 +277,7 @@ cryptoNetworkRelease (BRCryptoNetwork network) {
         array_free (association->units);
     }
     array_free (network->associations);
+    cryptoNetworkCurrencyIndexRelease (network);
 
     for (size_t index = 0; index < array_count (network->fees); index++) {
         cryptoNetworkFeeGive (network->fees[index]);
@@ -295,14 +414,35 @@ cryptoNetworkGetCurrencyAt (BRCryptoNetwork network,
     return currency;
 }
 
+static BRCryptoCurrencyAssociation *
+cryptoNetworkLookupCurrency (BRCryptoNetwork network,
+                             BRCryptoCurrency currency) {
+    // lock is not held for this static method; caller must hold it
+    BRCryptoCurrencyIndexEntry probe = { .uids = cryptoCurrencyGetUids (currency) };
+
+    pthread_rwlock_rdlock (&network->currencyIndexLock);
+    const BRCryptoCurrencyIndexEntry *entry = BRSetGet (network->currencyIndexByUids, &probe);
+    pthread_rwlock_unlock (&network->currencyIndexLock);
+
+    // The uids index is case-insensitive; identical currencies have case-sensitive, equal uids.
+    if (NULL != entry && CRYPTO_TRUE == cryptoCurrencyIsIdentical (currency, entry->currency))
+        return &network->associations[entry->index];
+
+    // Only if uids differ in case alone; otherwise, a miss is a miss.
+    if (NULL != entry)
+        for (size_t index = 0; index < array_count(network->associations); index++) {
+            if (CRYPTO_TRUE == cryptoCurrencyIsIdentical (currency, network->associations[index].currency)) {
+                return &network->associations[index];
+            }
+        }
+    return NULL;
+}
+
 extern BRCryptoBoolean
 cryptoNetworkHasCurrency (BRCryptoNetwork network,
                           BRCryptoCurrency currency) {
-    BRCryptoBoolean r = CRYPTO_FALSE;
     pthread_mutex_lock (&network->lock);
-    for (size_t index = 0; index < array_count(network->associations) && CRYPTO_FALSE == r; index++) {
-        r = cryptoCurrencyIsIdentical (network->associations[index].currency, currency);
-    }
+    BRCryptoBoolean r = AS_CRYPTO_BOOLEAN (NULL != cryptoNetworkLookupCurrency (network, currency));
     pthread_mutex_unlock (&network->lock);
     return r;
 }
@@ -310,59 +450,22 @@ cryptoNetworkHasCurrency (BRCryptoNetwork network,
 extern BRCryptoCurrency
 cryptoNetworkGetCurrencyForCode (BRCryptoNetwork network,
                                    const char *code) {
-    BRCryptoCurrency currency = NULL;
-    pthread_mutex_lock (&network->lock);
-    for (size_t index = 0; index < array_count(network->associations); index++) {
-        if (0 == strcmp (code, cryptoCurrencyGetCode (network->associations[index].currency))) {
-            currency = cryptoCurrencyTake (network->associations[index].currency);
-            break;
-        }
-    }
-    pthread_mutex_unlock (&network->lock);
-    return currency;
+    BRCryptoCurrencyIndexEntry probe = { .code = code };
+    return cryptoNetworkCurrencyIndexLookup (network, network->currencyIndexByCode, &probe);
 }
 
 extern BRCryptoCurrency
 cryptoNetworkGetCurrencyForUids (BRCryptoNetwork network,
                                    const char *uids) {
-    BRCryptoCurrency currency = NULL;
-    pthread_mutex_lock (&network->lock);
-    for (size_t index = 0; index < array_count(network->associations); index++) {
-        if (0 == strcasecmp (uids, cryptoCurrencyGetUids (network->associations[index].currency))) {
-            currency = cryptoCurrencyTake (network->associations[index].currency);
-            break;
-        }
-    }
-    pthread_mutex_unlock (&network->lock);
-    return currency;
+    BRCryptoCurrencyIndexEntry probe = { .uids = uids };
+    return cryptoNetworkCurrencyIndexLookup (network, network->currencyIndexByUids, &probe);
 }
 
 extern BRCryptoCurrency
 cryptoNetworkGetCurrencyForIssuer (BRCryptoNetwork network,
                                    const char *issuer) {
-    BRCryptoCurrency currency = NULL;
-    pthread_mutex_lock (&network->lock);
-    for (size_t index = 0; index < array_count(network->associations); index++) {
-        const char *i = cryptoCurrencyGetIssuer(network->associations[index].currency);
-        if (NULL != i && 0 == strcasecmp (issuer, i)) {
-            currency = cryptoCurrencyTake (network->associations[index].currency);
-            break;
-        }
-    }
-    pthread_mutex_unlock (&network->lock);
-    return currency;
-}
-
-static BRCryptoCurrencyAssociation *
-cryptoNetworkLookupCurrency (BRCryptoNetwork network,
-                             BRCryptoCurrency currency) {
-    // lock is not held for this static method; caller must hold it
-    for (size_t index = 0; index < array_count(network->associations); index++) {
-        if (CRYPTO_TRUE == cryptoCurrencyIsIdentical (currency, network->associations[index].currency)) {
-            return &network->associations[index];
-        }
-    }
-    return NULL;
+    BRCryptoCurrencyIndexEntry probe = { .issuer = issuer };
+    return cryptoNetworkCurrencyIndexLookup (network, network->currencyIndexByIssuer, &probe);
 }
 
 extern BRCryptoUnit
@@ -429,6 +532,7 @@ cryptoNetworkAddCurrency (BRCryptoNetwork network,
     pthread_mutex_lock (&network->lock);
     array_new (association.units, 2);
     array_add (network->associations, association);
+    cryptoNetworkCurrencyIndexAdd (network, array_count (network->associations) - 1);
     pthread_mutex_unlock (&network->lock);
 }
 
@@ -15,6 +15,7 @@
 #include <stdbool.h>
 
 #include "support/BRArray.h"
+#include "support/BRSet.h"
 #include "BRCryptoBaseP.h"
 #include "BRCryptoHashP.h"
 #include "BRCryptoNetwork.h"
@@ -46,6 +47,21 @@ typedef struct {
     BRArrayOf(BRCryptoUnit) units;
 } BRCryptoCurrencyAssociation;
 
+/// MARK: - Currency Index
+
+/**
+ * An entry in a network's currency indexes; one per association.  The keys are the currency's own
+ * strings and `index` is the association's position in `network->associations` - associations are
+ * only ever appended, so it stays valid.  The currency is not taken; the association holds it.
+ */
+typedef struct {
+    BRCryptoCurrency currency;
+    const char *uids;
+    const char *code;
+    const char *issuer;
+    size_t index;
+} BRCryptoCurrencyIndexEntry;
+
 /// MARK: - Network Handlers
 
 typedef BRCryptoNetwork
@@ -126,6 +142,14 @@ struct BRCryptoNetworkRecord {
     BRCryptoCurrency currency;
     BRArrayOf(BRCryptoCurrencyAssociation) associations;
 
+    // Hashed indexes of `associations` by uids, code and issuer.  These have their own read-write
+    // lock so that lookups, which are frequent, need not serialize on `lock`.
+    pthread_rwlock_t currencyIndexLock;
+    BRArrayOf(BRCryptoCurrencyIndexEntry*) currencyIndexEntries;
+    BRSet *currencyIndexByUids;     // case-insensitive
+    BRSet *currencyIndexByCode;     // case-sensitive
+    BRSet *currencyIndexByIssuer;   // case-insensitive
+
     uint32_t confirmationPeriodInSeconds;
     uint32_t confirmationsUntilFinal;
 
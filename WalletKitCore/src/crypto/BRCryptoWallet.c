@@ -419,6 +419,14 @@ cryptoWalletGetAddressesForRecovery (BRCryptoWallet wallet) {
     return wallet->handlers->getAddressesForRecovery (wallet);
 }
 
+private_extern OwnershipGiven BRSetOf(BRCyptoAddress)
+cryptoWalletGetAddressesForRecoveryAhead (BRCryptoWallet wallet,
+                                          size_t depth) {
+    return (0 == depth || NULL == wallet->handlers->getAddressesForRecoveryAhead
+            ? wallet->handlers->getAddressesForRecovery (wallet)
+            : wallet->handlers->getAddressesForRecoveryAhead (wallet, depth));
+}
+
 extern BRCryptoFeeBasis
 cryptoWalletGetDefaultFeeBasis (BRCryptoWallet wallet) {
     return cryptoFeeBasisTake (wallet->defaultFeeBasis);
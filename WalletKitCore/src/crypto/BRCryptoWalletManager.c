@@ -83,6 +83,110 @@ cryptoWalletManagerStateDisconnectedInit(BRCryptoWalletManagerDisconnectReason r
     };
 }
 
+// MARK: - Address Intern
+
+// FNV-1a
+static size_t
+cryptoAddressInternHashString (const char *string) {
+    uint32_t hash = 0x811c9dc5;
+    for (; '\0' != *string; string++)
+        hash = (hash ^ (uint8_t) *string) * 0x01000193;
+    return hash;
+}
+
+static size_t
+cryptoAddressInternEntryHash (const void *entry) {
+    return ((const BRCryptoAddressInternEntry *) entry)->hashValue;
+}
+
+static int
+cryptoAddressInternEntryEqual (const void *entry1,
+                               const void *entry2) {
+    const BRCryptoAddressInternEntry *e1 = entry1;
+    const BRCryptoAddressInternEntry *e2 = entry2;
+    return e1 == e2 || (e1->hashValue == e2->hashValue && 0 == strcmp (e1->string, e2->string));
+}
+
+private_extern void
+cryptoAddressInternInit (BRCryptoAddressIntern *intern) {
+    pthread_mutex_init_brd (&intern->lock, PTHREAD_MUTEX_NORMAL);
+
+    // The entries and index are allocated on first use; only account-based handlers decode.
+    intern->handlers = NULL;
+    intern->entries  = NULL;
+    intern->entriesCount = 0;
+    intern->entriesNext  = 0;
+    intern->index = NULL;
+}
+
+private_extern void
+cryptoAddressInternRelease (BRCryptoAddressIntern *intern) {
+    for (size_t index = 0; index < intern->entriesCount; index++) {
+        free (intern->entries[index].string);
+        intern->handlers->release (intern->entries[index].address);
+    }
+
+    if (NULL != intern->entries) free (intern->entries);
+    if (NULL != intern->index)   BRSetFree (intern->index);
+
+    pthread_mutex_destroy (&intern->lock);
+}
+
+private_extern void *
+cryptoAddressInternDecode (BRCryptoAddressIntern *intern,
+                           const char *string,
+                           const BRCryptoAddressInternHandlers *handlers) {
+    // Nothing to intern; let the handler decide what a NULL string means
+    if (NULL == string) return handlers->decode (string);
+
+    BRCryptoAddressInternEntry probe = { (char *) string, cryptoAddressInternHashString (string), NULL };
+
+    pthread_mutex_lock (&intern->lock);
+    if (NULL == intern->handlers) {
+        intern->handlers = handlers;
+        intern->entries  = calloc (CRYPTO_WALLET_MANAGER_ADDRESS_INTERN_CAPACITY, sizeof (BRCryptoAddressInternEntry));
+        intern->index    = BRSetNew (cryptoAddressInternEntryHash,
+                                     cryptoAddressInternEntryEqual,
+                                     CRYPTO_WALLET_MANAGER_ADDRESS_INTERN_CAPACITY);
+    }
+    assert (handlers == intern->handlers);
+
+    BRCryptoAddressInternEntry *entry = BRSetGet (intern->index, &probe);
+    void *address = (NULL != entry ? handlers->clone (entry->address) : NULL);
+    pthread_mutex_unlock (&intern->lock);
+
+    if (NULL != address) return address;
+
+    // Decode outside of the lock - this is the expensive part.
+    address = handlers->decode (string);
+    if (NULL == address) return NULL;
+
+    pthread_mutex_lock (&intern->lock);
+    if (!BRSetContains (intern->index, &probe)) {
+        entry = &intern->entries[intern->entriesNext];
+
+        // Once full, replace the oldest entry
+        if (CRYPTO_WALLET_MANAGER_ADDRESS_INTERN_CAPACITY == intern->entriesCount) {
+            BRSetRemove (intern->index, entry);
+            free (entry->string);
+            handlers->release (entry->address);
+        }
+        else intern->entriesCount++;
+
+        *entry = (BRCryptoAddressInternEntry) {
+            strdup (string),
+            probe.hashValue,
+            handlers->clone (address)
+        };
+        BRSetAdd (intern->index, entry);
+
+        intern->entriesNext = (intern->entriesNext + 1) % CRYPTO_WALLET_MANAGER_ADDRESS_INTERN_CAPACITY;
+    }
+    pthread_mutex_unlock (&intern->lock);
+
+    return address;
+}
+
 /// =============================================================================================
 ///
 /// MARK: - Wallet Manager
@@ -214,6 +318,8 @@ cryptoWalletManagerAllocAndInit (size_t sizeInBytes,
     manager->ref = CRYPTO_REF_ASSIGN (cryptoWalletManagerRelease);
     pthread_mutex_init_brd (&manager->lock, PTHREAD_MUTEX_RECURSIVE);
 
+    cryptoAddressInternInit (&manager->addressIntern);
+
     BRCryptoTimestamp   earliestAccountTime = cryptoAccountGetTimestamp (account);
     BRCryptoBlockNumber earliestBlockNumber = cryptoNetworkGetBlockNumberAtOrBeforeTimestamp(network, earliestAccountTime);
     BRCryptoBlockNumber latestBlockNumber   = cryptoNetworkGetHeight (network);
@@ -348,6 +454,7 @@ cryptoWalletManagerRelease (BRCryptoWalletManager cwm) {
 
     // ... and finally individual memory allocations
     free (cwm->path);
+    cryptoAddressInternRelease (&cwm->addressIntern);
 
     pthread_mutex_unlock  (&cwm->lock);
     pthread_mutex_destroy (&cwm->lock);
@@ -1524,12 +1631,30 @@ cryptoWalletManagerRecoverTransfersFromTransactionBundle (BRCryptoWalletManager
     cwm->handlers->recoverTransfersFromTransactionBundle (cwm, bundle);
 }
 
+private_extern void
+cryptoWalletManagerRecoverTransfersFromTransactionBundles (BRCryptoWalletManager cwm,
+                                                           OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                                           size_t bundlesCount) {
+    if (NULL != cwm->handlers->recoverTransfersFromTransactionBundles)
+        cwm->handlers->recoverTransfersFromTransactionBundles (cwm, bundles, bundlesCount);
+    else
+        for (size_t index = 0; index < bundlesCount; index++)
+            cwm->handlers->recoverTransfersFromTransactionBundle (cwm, bundles[index]);
+}
+
 private_extern void
 cryptoWalletManagerRecoverTransferFromTransferBundle (BRCryptoWalletManager cwm,
                                                       OwnershipKept BRCryptoClientTransferBundle bundle) {
     cwm->handlers->recoverTransferFromTransferBundle (cwm, bundle);
 }
 
+private_extern void *
+cryptoWalletManagerDecodeAddress (BRCryptoWalletManager cwm,
+                                  const char *string,
+                                  const BRCryptoAddressInternHandlers *handlers) {
+    return cryptoAddressInternDecode (&cwm->addressIntern, string, handlers);
+}
+
 private_extern BRCryptoFeeBasis
 cryptoWalletManagerRecoverFeeBasisFromFeeEstimate (BRCryptoWalletManager cwm,
                                                    BRCryptoNetworkFee networkFee,
@@ -13,6 +13,7 @@
 
 #include <pthread.h>
 #include "support/BRArray.h"
+#include "support/BRSet.h"
 
 #include "BRCryptoBase.h"
 #include "BRCryptoNetwork.h"
@@ -100,6 +101,12 @@ typedef void
 (*BRCryptoWalletManagerRecoverTransfersFromTransactionBundleHandler) (BRCryptoWalletManager cwm,
                                                                       OwnershipKept BRCryptoClientTransactionBundle bundle);
 
+// Optional; when NULL, each bundle is passed to `recoverTransfersFromTransactionBundle`
+typedef void
+(*BRCryptoWalletManagerRecoverTransfersFromTransactionBundlesHandler) (BRCryptoWalletManager cwm,
+                                                                       OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                                                       size_t bundlesCount);
+
 typedef void
 (*BRCryptoWalletManagerRecoverTransferFromTransferBundleHandler) (BRCryptoWalletManager cwm,
                                                                   OwnershipKept BRCryptoClientTransferBundle bundle);
@@ -139,6 +146,7 @@ typedef struct {
     BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler recoverFeeBasisFromFeeEstimate;
     BRCryptoWalletManagerWalletSweeperValidateSupportedHandler validateSweeperSupported;
     BRCryptoWalletManagerCreateWalletSweeperHandler createSweeper;
+    BRCryptoWalletManagerRecoverTransfersFromTransactionBundlesHandler recoverTransfersFromTransactionBundles;
 } BRCryptoWalletManagerHandlers;
 
 // MARK: - Wallet Manager State
@@ -151,6 +159,64 @@ cryptoWalletManagerStateDisconnectedInit(BRCryptoWalletManagerDisconnectReason r
 
 // MARK: - Wallet Manager
 
+// MARK: - WalletManager Address Intern
+//
+// Recovering transfer bundles decodes the `to` and `from` address strings of every bundle, yet an
+// account's history mostly repeats the same few counterparties.  A manager keeps a bounded cache
+// from address string to the decoded, type-specific address; handlers supply the decode, clone
+// and release functions for their address type.
+
+#define CRYPTO_WALLET_MANAGER_ADDRESS_INTERN_CAPACITY       (256)
+
+typedef void *
+(*BRCryptoAddressInternDecodeHandler) (const char *string);
+
+typedef void *
+(*BRCryptoAddressInternCloneHandler) (const void *address);
+
+typedef void
+(*BRCryptoAddressInternReleaseHandler) (void *address);
+
+typedef struct {
+    BRCryptoAddressInternDecodeHandler decode;
+    BRCryptoAddressInternCloneHandler clone;
+    BRCryptoAddressInternReleaseHandler release;
+} BRCryptoAddressInternHandlers;
+
+typedef struct {
+    char *string;
+    size_t hashValue;
+    void *address;
+} BRCryptoAddressInternEntry;
+
+typedef struct {
+    pthread_mutex_t lock;
+    const BRCryptoAddressInternHandlers *handlers;
+
+    /// The entries, filled in order and then replaced oldest first once at capacity.
+    BRCryptoAddressInternEntry *entries;
+    size_t entriesCount;
+    size_t entriesNext;
+
+    BRSetOf(BRCryptoAddressInternEntry*) index;
+} BRCryptoAddressIntern;
+
+private_extern void
+cryptoAddressInternInit (BRCryptoAddressIntern *intern);
+
+private_extern void
+cryptoAddressInternRelease (BRCryptoAddressIntern *intern);
+
+/**
+ * Decode `string` as an address using `handlers`, returning an interned clone if `string` was
+ * decoded recently.  Returns an address owned by the caller or NULL if `string` does not decode.
+ * An intern must always be used with the same `handlers`.
+ */
+private_extern void *
+cryptoAddressInternDecode (BRCryptoAddressIntern *intern,
+                           const char *string,
+                           const BRCryptoAddressInternHandlers *handlers);
+
 struct BRCryptoWalletManagerRecord {
     BRCryptoBlockChainType type;
     const BRCryptoWalletManagerHandlers *handlers;
@@ -189,6 +255,9 @@ struct BRCryptoWalletManagerRecord {
     BRCryptoWalletManagerListener listener;
     BRCryptoWalletListener listenerWallet;
 //    BRCryptoListener listenerTrampoline;
+
+    /// Decoded addresses for transfer bundle recovery
+    BRCryptoAddressIntern addressIntern;
 };
 
 typedef void *BRCryptoWalletManagerCreateContext;
@@ -230,12 +299,27 @@ private_extern void
 cryptoWalletManagerRecoverTransfersFromTransactionBundle (BRCryptoWalletManager cwm,
                                                           OwnershipKept BRCryptoClientTransactionBundle bundle);
 
+private_extern void
+cryptoWalletManagerRecoverTransfersFromTransactionBundles (BRCryptoWalletManager cwm,
+                                                           OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                                           size_t bundlesCount);
+
 // Is it possible that the transfers do not have the 'submitted' state?  In some race between
 // the submit call and the included call?  Highly, highly unlikely but possible?
 private_extern void
 cryptoWalletManagerRecoverTransferFromTransferBundle (BRCryptoWalletManager cwm,
                                                       OwnershipKept BRCryptoClientTransferBundle bundle);
 
+/**
+ * Decode `string` as an address using `handlers`, consulting the manager's address intern first.
+ * Returns a decoded address owned by the caller (release it with the type's usual free function)
+ * or NULL if `string` does not decode.  A manager must always use the same `handlers`.
+ */
+private_extern void *
+cryptoWalletManagerDecodeAddress (BRCryptoWalletManager cwm,
+                                  const char *string,
+                                  const BRCryptoAddressInternHandlers *handlers);
+
 //private_extern void
 //cryptoWalletManagerGenerateTransferEvent (BRCryptoWalletManager cwm,
 //                                          BRCryptoWallet wallet,
@@ -76,6 +76,12 @@ typedef BRCryptoTransfer
 typedef OwnershipGiven BRSetOf(BRCryptoAddress)
 (*BRCryptoWalletGetAddressesForRecoveryHandler) (BRCryptoWallet wallet);
 
+/// Return the addresses for recovery extended `depth` gap windows beyond the last used address.
+/// Only meaningful for wallets that derive a sequence of addresses.
+typedef OwnershipGiven BRSetOf(BRCryptoAddress)
+(*BRCryptoWalletGetAddressesForRecoveryAheadHandler) (BRCryptoWallet wallet,
+                                                      size_t depth);
+
 typedef void
 (*BRCryptoWalletAnnounceTransfer) (BRCryptoWallet wallet,
                                    BRCryptoTransfer transfer,
@@ -96,6 +102,7 @@ typedef struct {
     BRCryptoWalletGetAddressesForRecoveryHandler getAddressesForRecovery;
     BRCryptoWalletAnnounceTransfer announceTransfer; // May be NULL
     BRCryptoWalletIsEqualHandler isEqual;
+    BRCryptoWalletGetAddressesForRecoveryAheadHandler getAddressesForRecoveryAhead; // May be NULL
 } BRCryptoWalletHandlers;
 
 
@@ -170,6 +177,10 @@ cryptoWalletRemTransfer (BRCryptoWallet wallet, BRCryptoTransfer transfer);
 private_extern OwnershipGiven BRSetOf(BRCyptoAddress)
 cryptoWalletGetAddressesForRecovery (BRCryptoWallet wallet);
 
+private_extern OwnershipGiven BRSetOf(BRCyptoAddress)
+cryptoWalletGetAddressesForRecoveryAhead (BRCryptoWallet wallet,
+                                          size_t depth);
+
 static inline void
 cryptoWalletGenerateEvent (BRCryptoWallet wallet,
                            BRCryptoWalletEvent event) {
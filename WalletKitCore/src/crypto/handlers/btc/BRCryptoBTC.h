@@ -23,6 +23,8 @@
 #include "bitcoin/BRChainParams.h"
 #include "bitcoin/BRPaymentProtocol.h"
 
+#include "support/BRSet.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -161,6 +163,12 @@ cryptoWalletManagerCoerceBTC (BRCryptoWalletManager manager, BRCryptoBlockChainT
 
 extern BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBTC;
 
+/// Parse each of `bundles` into `btcTransactions` (NULL if unparsable), in parallel where worthwhile
+private_extern void
+cryptoWalletManagerParseBundlesBTC (OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                    size_t bundlesCount,
+                                    BRTransaction **btcTransactions);
+
 // MAKR: - Wallet Manger P2P
 
 extern BRCryptoClientP2PManager
@@ -175,8 +183,28 @@ typedef struct BRCryptoWalletSweeperBTCRecord {
     uint8_t isSegwit;
     char * sourceAddress;
     BRArrayOf(BRTransaction *) txns;
+
+    /// The source's forms, precomputed so that transaction inputs and outputs can be matched
+    /// without rendering an address.  The pubKey is serialized per the key's compression.
+    uint8_t sourceScript[25];
+    size_t  sourceScriptLen;
+    uint8_t sourcePubKey[65];
+    size_t  sourcePubKeyLen;
+
+    /// The UTXOs paying to the source, maintained as transactions are added; also the outpoints
+    /// spent by the source, so that transactions can be added in any order.
+    BRSetOf(BRWalletSweeperUTXO *) utxos;
+    BRSetOf(BRWalletSweeperUTXO *) spent;
+    uint64_t balance;
 } *BRCryptoWalletSweeperBTC;
 
+private_extern BRCryptoWalletSweeper
+cryptoWalletSweeperCreateAsBTC (BRCryptoBlockChainType type,
+                                BRCryptoKey key,
+                                BRCryptoUnit unit,
+                                BRAddressParams addrParams,
+                                BRCryptoBoolean isSegwit);
+
 // MARK: - Payment Protocol
 
 // MARK: Payment Protocol Bitpay Builder
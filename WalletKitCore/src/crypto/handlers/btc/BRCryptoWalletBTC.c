@@ -331,19 +331,14 @@ cryptoWalletCreateTransferMultipleBTC (BRCryptoWallet wallet,
                                          wallet->type));
 }
 
-static OwnershipGiven BRSetOf(BRCryptoAddress)
-cryptoWalletGetAddressesForRecoveryBTC (BRCryptoWallet wallet) {
-    BRCryptoWalletBTC walletBTC = cryptoWalletCoerceBTC(wallet);
-    BRWallet *btcWallet = walletBTC->wid;
-
-    size_t btcAddressesCount = BRWalletAllAddrs (btcWallet, NULL, 0);
-    BRAddress *btcAddresses = calloc (btcAddressesCount, sizeof (BRAddress));
-    BRWalletAllAddrs (btcWallet, btcAddresses, btcAddressesCount);
-
+static void
+cryptoWalletAddAddressesForRecoveryBTC (BRCryptoWallet wallet,
+                                        BRWallet *btcWallet,
+                                        BRSetOf(BRCryptoAddress) addresses,
+                                        BRAddress *btcAddresses,
+                                        size_t btcAddressesCount) {
     BRCryptoAddress replacedAddress = NULL;
 
-    BRSetOf(BRCryptoAddress) addresses = cryptoAddressSetCreate (btcAddressesCount);
-
     for (size_t index = 0; index < btcAddressesCount; index++) {
         // The currency, may or may not have a legacy address;
         BRAddress btcPrimaryAddress = btcAddresses[index];
@@ -360,6 +355,44 @@ cryptoWalletGetAddressesForRecoveryBTC (BRCryptoWallet wallet) {
             if (replacedAddress) cryptoAddressGive (replacedAddress);
         }
     }
+}
+
+static OwnershipGiven BRSetOf(BRCryptoAddress)
+cryptoWalletGetAddressesForRecoveryBTC (BRCryptoWallet wallet) {
+    BRCryptoWalletBTC walletBTC = cryptoWalletCoerceBTC(wallet);
+    BRWallet *btcWallet = walletBTC->wid;
+
+    size_t btcAddressesCount = BRWalletAllAddrs (btcWallet, NULL, 0);
+    BRAddress *btcAddresses = calloc (btcAddressesCount, sizeof (BRAddress));
+    BRWalletAllAddrs (btcWallet, btcAddresses, btcAddressesCount);
+
+    BRSetOf(BRCryptoAddress) addresses = cryptoAddressSetCreate (btcAddressesCount);
+    cryptoWalletAddAddressesForRecoveryBTC (wallet, btcWallet, addresses, btcAddresses, btcAddressesCount);
+
+    free (btcAddresses);
+
+    return addresses;
+}
+
+static OwnershipGiven BRSetOf(BRCryptoAddress)
+cryptoWalletGetAddressesForRecoveryAheadBTC (BRCryptoWallet wallet,
+                                             size_t depth) {
+    BRCryptoWalletBTC walletBTC = cryptoWalletCoerceBTC(wallet);
+    BRWallet *btcWallet = walletBTC->wid;
+
+    BRSetOf(BRCryptoAddress) addresses = cryptoWalletGetAddressesForRecoveryBTC (wallet);
+
+    // Add `depth` extended gap windows past the wallet's addresses on each chain.  These are not
+    // generated for the wallet - so they don't join `BRWalletAllAddrs()` or the bloom filter; only
+    // those that recovered transactions turn out to use are generated, when they are recovered.
+    uint32_t externalCount = (uint32_t) (depth * SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED);
+    uint32_t internalCount = (uint32_t) (depth * SEQUENCE_GAP_LIMIT_INTERNAL_EXTENDED);
+
+    BRAddress *btcAddresses = calloc (externalCount + internalCount, sizeof (BRAddress));
+    size_t btcAddressesCount = BRWalletAddrsAhead (btcWallet, btcAddresses, externalCount, SEQUENCE_EXTERNAL_CHAIN);
+    btcAddressesCount += BRWalletAddrsAhead (btcWallet, &btcAddresses[btcAddressesCount], internalCount, SEQUENCE_INTERNAL_CHAIN);
+
+    cryptoWalletAddAddressesForRecoveryBTC (wallet, btcWallet, addresses, btcAddresses, btcAddressesCount);
 
     free (btcAddresses);
 
@@ -377,7 +410,8 @@ BRCryptoWalletHandlers cryptoWalletHandlersBTC = {
     cryptoWalletCreateTransferMultipleBTC,
     cryptoWalletGetAddressesForRecoveryBTC,
     NULL,
-    cryptoWalletIsEqualBTC
+    cryptoWalletIsEqualBTC,
+    cryptoWalletGetAddressesForRecoveryAheadBTC
 };
 
 BRCryptoWalletHandlers cryptoWalletHandlersBCH = {
@@ -391,7 +425,8 @@ BRCryptoWalletHandlers cryptoWalletHandlersBCH = {
     cryptoWalletCreateTransferMultipleBTC,
     cryptoWalletGetAddressesForRecoveryBTC,
     NULL,
-    cryptoWalletIsEqualBTC
+    cryptoWalletIsEqualBTC,
+    cryptoWalletGetAddressesForRecoveryAheadBTC
 };
 
 BRCryptoWalletHandlers cryptoWalletHandlersBSV = {
@@ -405,5 +440,6 @@ BRCryptoWalletHandlers cryptoWalletHandlersBSV = {
     cryptoWalletCreateTransferMultipleBTC,
     cryptoWalletGetAddressesForRecoveryBTC,
     NULL,
-    cryptoWalletIsEqualBTC
+    cryptoWalletIsEqualBTC,
+    cryptoWalletGetAddressesForRecoveryAheadBTC
 };
@@ -10,6 +10,9 @@
 //
 #include "BRCryptoBTC.h"
 
+#include <unistd.h>         // sysconf()
+#include "support/BROSCompat.h"
+
 #include "crypto/BRCryptoAccountP.h"
 #include "crypto/BRCryptoNetworkP.h"
 #include "crypto/BRCryptoKeyP.h"
@@ -95,9 +98,9 @@ cryptoWalletManagerCreateWalletsBTC (BRCryptoWalletManager manager,
     BRArrayOf(BRCryptoWallet) wallets;
     array_new (wallets, 1);
 
-    // Get the btcMasterPublicKey
+    // Get the btcAddressIndex; shared by the account's BTC, BCH and BSV wallets
     BRCryptoAccount account = cryptoWalletManagerGetAccount(manager);
-    BRMasterPubKey btcMPK = cryptoAccountAsBTC(account);
+    BRWalletAddressIndex *btcAddressIndex = cryptoAccountAsBTCAddressIndex(account);
     
     // Get the btcChainParams
     BRCryptoNetwork network = cryptoWalletManagerGetNetwork(manager);
@@ -111,9 +114,10 @@ cryptoWalletManagerCreateWalletsBTC (BRCryptoWalletManager manager,
     }
 
     // Since the BRWallet callbacks are not set, none of these transactions generate callbacks.
-    // And, in fact, looking at BRWalletNew(), there is not even an attempt to generate callbacks
+    // And, in fact, looking at BRWalletNewWithAddressIndex(), there is not even an attempt to generate callbacks
     // even if they could have been specified.
-    BRWallet *btcWallet = BRWalletNew (btcChainParams->addrParams, transactions, array_count(transactions), btcMPK);
+    BRWallet *btcWallet = BRWalletNewWithAddressIndex (btcChainParams->addrParams, transactions, array_count(transactions),
+                                                       btcAddressIndex);
 
     // Free `transactions` before any non-local exists.
     array_free (transactions);
@@ -228,8 +232,8 @@ cryptoWalletManagerCreateWalletBTC (BRCryptoWalletManager manager,
                                     BRCryptoCurrency currency) {
     assert (NULL == manager->wallet);
     
-    // Get the btcMasterPublicKey
-    BRMasterPubKey btcMPK = cryptoAccountAsBTC(manager->account);
+    // Get the btcAddressIndex; shared by the account's BTC, BCH and BSV wallets
+    BRWalletAddressIndex *btcAddressIndex = cryptoAccountAsBTCAddressIndex(manager->account);
 
     // Get the btcChainParams
     const BRChainParams *btcChainParams = cryptoNetworkAsBTC(manager->network);
@@ -241,9 +245,10 @@ cryptoWalletManagerCreateWalletBTC (BRCryptoWalletManager manager,
     // Create the BTC wallet
     //
     // Since the BRWallet callbacks are not set, none of these transactions generate callbacks.
-    // And, in fact, looking at BRWalletNew(), there is not even an attempt to generate callbacks
+    // And, in fact, looking at BRWalletNewWithAddressIndex(), there is not even an attempt to generate callbacks
     // even if they could have been specified.
-    BRWallet *btcWallet = BRWalletNew (btcChainParams->addrParams, transactions, array_count(transactions), btcMPK);
+    BRWallet *btcWallet = BRWalletNewWithAddressIndex (btcChainParams->addrParams, transactions, array_count(transactions),
+                                                       btcAddressIndex);
     assert (NULL != btcWallet);
 
     // The btcWallet now should include *all* the transactions
@@ -290,49 +295,52 @@ cryptoWalletManagerCreateWalletBTC (BRCryptoWalletManager manager,
     return wallet;
 }
 
-static void
-cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC (BRCryptoWalletManager manager,
-                                                             OwnershipKept BRCryptoClientTransactionBundle bundle) {
-    BRTransaction *btcTransaction = BRTransactionParse (bundle->serialization, bundle->serializationCount);
+// A bundle whose transaction is not (or is no longer) included is handled as an error: it is not
+// registered and, if the wallet holds it, it is removed.  This was historically written against
+// TRANSFER_STATUS_ERRORED, whose value coincides with CRYPTO_TRANSFER_STATE_INCLUDED.
+static bool
+cryptoWalletManagerBundleIsNotIncludedBTC (OwnershipKept BRCryptoClientTransactionBundle bundle) {
+    return CRYPTO_TRANSFER_STATE_INCLUDED != bundle->status;
+}
 
-    bool error = TRANSFER_STATUS_ERRORED != bundle->status;
-    bool needRegistration = (!error && NULL != btcTransaction && BRTransactionIsSigned (btcTransaction));
-    bool needFree = true;
+// Convert from `uint64_t` to `uint32_t` with a bit of care regarding BLOCK_HEIGHT_UNBOUND and
+// TX_UNCONFIRMED - they are directly coercible but be explicit about it.
+static uint32_t
+cryptoWalletManagerBundleBlockHeightBTC (OwnershipKept BRCryptoClientTransactionBundle bundle) {
+    return (BLOCK_HEIGHT_UNBOUND == bundle->blockHeight ? TX_UNCONFIRMED : (uint32_t) bundle->blockHeight);
+}
 
-    BRWallet *btcWallet = cryptoWalletAsBTC(manager->wallet);
+static bool
+cryptoWalletManagerBundleNeedsRegistrationBTC (BRWallet *btcWallet,
+                                               OwnershipKept BRCryptoClientTransactionBundle bundle,
+                                               BRTransaction *btcTransaction) {
+    return (!cryptoWalletManagerBundleIsNotIncludedBTC (bundle) &&
+            NULL != btcTransaction &&
+            BRTransactionIsSigned (btcTransaction) &&
+            NULL == BRWalletTransactionForHash (btcWallet, btcTransaction->txHash));
+}
 
-    // Convert from `uint64_t` to `uint32_t` with a bit of care regarding BLOCK_HEIGHT_UNBOUND
-    // and TX_UNCONFIRMED - they are directly coercible but be explicit about it.
-    uint32_t btcBlockHeight = (BLOCK_HEIGHT_UNBOUND == bundle->blockHeight ? TX_UNCONFIRMED : (uint32_t) bundle->blockHeight);
-    uint32_t btcTimestamp   = (uint32_t) bundle->timestamp;
+static void
+cryptoWalletManagerUpdateTransactionFromBundleBTC (BRWallet *btcWallet,
+                                                   OwnershipKept BRCryptoClientTransactionBundle bundle,
+                                                   OwnershipGiven BRTransaction *btcTransaction) {
+    if (NULL == btcTransaction) return;
 
+    bool notIncluded = cryptoWalletManagerBundleIsNotIncludedBTC (bundle);
 
-    //     if (needRegistration) {
-    //         if (0 == pthread_mutex_lock (&manager->lock)) {
-    //             // confirm completion is for in-progress sync
-    //             needRegistration &= (rid == BRClientSyncManagerScanStateGetRequestId (&manager->scanState) && manager->isConnected);
-    //             pthread_mutex_unlock (&manager->lock);
-    //         } else {
-    //             assert (0);
-    //         }
-    //     }
-
-    if (needRegistration) {
-        if (NULL == BRWalletTransactionForHash (btcWallet, btcTransaction->txHash)) {
-            // BRWalletRegisterTransaction doesn't reliably report if the txn was added to the wallet.
-            BRWalletRegisterTransaction (btcWallet, btcTransaction);
-            if (btcTransaction == BRWalletTransactionForHash (btcWallet, btcTransaction->txHash)) {
-                // If our transaction made it into the wallet, do not deallocate it
-                needFree = false;
-            }
-        }
-    }
+    // BRWalletRegisterTransaction doesn't reliably report if the txn was added to the wallet.  If
+    // our transaction made it into the wallet, do not deallocate it.  Check before any removal
+    // below, which frees the wallet's transaction.
+    bool needFree = (btcTransaction != BRWalletTransactionForHash (btcWallet, btcTransaction->txHash));
+
+    uint32_t btcBlockHeight = cryptoWalletManagerBundleBlockHeightBTC (bundle);
+    uint32_t btcTimestamp   = (uint32_t) bundle->timestamp;
 
     // Check if the wallet knows about transaction.  This is an important check.  If the wallet
     // does not know about the tranaction then the subsequent BRWalletUpdateTransactions will
     // free the transaction (with BRTransactionFree()).
     if (BRWalletContainsTransaction (btcWallet, btcTransaction)) {
-        if (error) {
+        if (notIncluded) {
             // On an error, remove the transaction.  This will cascade through BRWallet callbacks
             // to produce `balanceUpdated` and `txDeleted`.  The later will be handled by removing
             // a BRTransactionWithState from the BRWalletManager.
@@ -358,6 +366,194 @@ cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC (BRCryptoWalletManag
     }
 }
 
+static void
+cryptoWalletManagerRecoverTransfersFromTransactionBundleBTC (BRCryptoWalletManager manager,
+                                                             OwnershipKept BRCryptoClientTransactionBundle bundle) {
+    BRTransaction *btcTransaction = BRTransactionParse (bundle->serialization, bundle->serializationCount);
+    BRWallet *btcWallet = cryptoWalletAsBTC(manager->wallet);
+
+    if (cryptoWalletManagerBundleNeedsRegistrationBTC (btcWallet, bundle, btcTransaction))
+        BRWalletRegisterTransaction (btcWallet, btcTransaction);
+
+    cryptoWalletManagerUpdateTransactionFromBundleBTC (btcWallet, bundle, btcTransaction);
+}
+
+// Parsing a bundle, which includes hashing its transaction, is the bulk of the work in recovering
+// a large set of bundles and is independent of every other bundle.  Spread it over a few threads,
+// each parsing a contiguous slice; registration with the wallet remains serial and in order.
+#define PARSE_BUNDLES_PER_THREAD_MINIMUM    (64)
+#define PARSE_THREADS_MAXIMUM               (8)
+
+typedef struct {
+    OwnershipKept BRCryptoClientTransactionBundle *bundles;
+    BRTransaction **btcTransactions;
+    size_t beg;
+    size_t end;
+} BRCryptoParseBundlesSliceBTC;
+
+static void *
+cryptoWalletManagerParseBundlesSliceBTC (BRCryptoParseBundlesSliceBTC *slice) {
+    for (size_t index = slice->beg; index < slice->end; index++)
+        slice->btcTransactions[index] = BRTransactionParse (slice->bundles[index]->serialization,
+                                                            slice->bundles[index]->serializationCount);
+    return NULL;
+}
+
+private_extern void
+cryptoWalletManagerParseBundlesBTC (OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                    size_t bundlesCount,
+                                    BRTransaction **btcTransactions) {
+    long processors = sysconf (_SC_NPROCESSORS_ONLN);
+
+    size_t threadsCount = MIN (bundlesCount / PARSE_BUNDLES_PER_THREAD_MINIMUM,
+                               MIN (PARSE_THREADS_MAXIMUM, (processors > 0 ? (size_t) processors : 1)));
+    if (0 == threadsCount) threadsCount = 1;
+
+    BRCryptoParseBundlesSliceBTC slices[threadsCount];
+    pthread_t threads[threadsCount];
+
+    for (size_t index = 0; index < threadsCount; index++) {
+        slices[index] = (BRCryptoParseBundlesSliceBTC) {
+            bundles,
+            btcTransactions,
+            bundlesCount *  index      / threadsCount,
+            bundlesCount * (index + 1) / threadsCount
+        };
+        threads[index] = PTHREAD_NULL;
+    }
+
+    // Slice 0 is parsed on this thread; if a thread can't be created, parse its slice here too.
+    for (size_t index = 1; index < threadsCount; index++)
+        if (0 != pthread_create (&threads[index], NULL, (ThreadRoutine) cryptoWalletManagerParseBundlesSliceBTC, &slices[index])) {
+            threads[index] = PTHREAD_NULL;
+            cryptoWalletManagerParseBundlesSliceBTC (&slices[index]);
+        }
+
+    cryptoWalletManagerParseBundlesSliceBTC (&slices[0]);
+
+    for (size_t index = 1; index < threadsCount; index++)
+        if (PTHREAD_NULL != threads[index])
+            pthread_join (threads[index], NULL);
+}
+
+// An included bundle's transaction that the wallet holds, at the bundle's block height and timestamp
+typedef struct {
+    UInt256 txHash;
+    uint32_t blockHeight;
+    uint32_t timestamp;
+    bool wasRegistered;     // registered from the bundle, already at `blockHeight` and `timestamp`
+} BRCryptoBundleUpdateBTC;
+
+static int
+cryptoBundleUpdateCompareBTC (const void *u1, const void *u2) {
+    const BRCryptoBundleUpdateBTC *e1 = u1, *e2 = u2;
+    return (e1->blockHeight < e2->blockHeight ? -1 : (e1->blockHeight > e2->blockHeight ? +1 :
+           (e1->timestamp   < e2->timestamp   ? -1 : (e1->timestamp   > e2->timestamp   ? +1 : 0))));
+}
+
+static void
+cryptoWalletManagerRecoverTransfersFromTransactionBundlesBTC (BRCryptoWalletManager manager,
+                                                              OwnershipKept BRCryptoClientTransactionBundle *bundles,
+                                                              size_t bundlesCount) {
+    BRWallet *btcWallet = cryptoWalletAsBTC(manager->wallet);
+
+    BRArrayOf(BRTransaction *) btcTransactions;
+    array_new (btcTransactions, bundlesCount);
+    array_set_count (btcTransactions, bundlesCount);
+
+    BRArrayOf(BRTransaction *) btcRegistrations;
+    array_new (btcRegistrations, bundlesCount);
+
+    BRArrayOf(BRCryptoBundleUpdateBTC) updates;
+    array_new (updates, bundlesCount);
+
+    BRArrayOf(UInt256) hashes;
+    array_new (hashes, bundlesCount);
+
+    bool *needFree = calloc (bundlesCount, sizeof (bool));
+
+    // Parse every bundle and register all the new transactions with the wallet at once.  The
+    // wallet orders them, takes its lock once and updates the balance once, rather than per bundle.
+    cryptoWalletManagerParseBundlesBTC (bundles, bundlesCount, btcTransactions);
+
+    // Register each transaction at its bundle's block height and timestamp, so that the wallet
+    // orders it by them and does not take an included transaction as pending.
+    for (size_t index = 0; index < bundlesCount; index++)
+        if (cryptoWalletManagerBundleNeedsRegistrationBTC (btcWallet, bundles[index], btcTransactions[index])) {
+            btcTransactions[index]->blockHeight = cryptoWalletManagerBundleBlockHeightBTC (bundles[index]);
+            btcTransactions[index]->timestamp   = (uint32_t) bundles[index]->timestamp;
+            array_add (btcRegistrations, btcTransactions[index]);
+        }
+
+    // Bundles may have been found through look-ahead addresses that the wallet has yet to generate
+    // (see `cryptoWalletGetAddressesForRecoveryAheadBTC()`); generate those in use, so that their
+    // transactions are recognized.
+    BRWalletGenerateAddrsUsedBy (btcWallet, btcRegistrations, array_count (btcRegistrations));
+
+    BRWalletRegisterTransactions (btcWallet, btcRegistrations, array_count (btcRegistrations));
+
+    // As `cryptoWalletManagerUpdateTransactionFromBundleBTC()` does for each bundle: an included
+    // bundle updates the wallet's transaction; one not included removes it.  Decide which parsed
+    // transactions were not taken by the wallet before any removal frees the wallet's.
+    for (size_t index = 0; index < bundlesCount; index++) {
+        BRTransaction *btcTransaction = btcTransactions[index];
+        if (NULL == btcTransaction) continue;
+
+        BRTransaction *btcWalletTransaction = BRWalletTransactionForHash (btcWallet, btcTransaction->txHash);
+        needFree[index] = (btcTransaction != btcWalletTransaction);
+
+        if (!cryptoWalletManagerBundleIsNotIncludedBTC (bundles[index]) &&
+            BRWalletContainsTransaction (btcWallet, btcTransaction))
+            array_add (updates, ((BRCryptoBundleUpdateBTC) {
+                btcTransaction->txHash,
+                cryptoWalletManagerBundleBlockHeightBTC (bundles[index]),
+                (uint32_t) bundles[index]->timestamp,
+                !needFree[index]
+            }));
+    }
+
+    // BRWalletUpdateTransactions() takes one block height and timestamp for all of its
+    // transactions; update all those in a block at once, with one balance update at most.  The
+    // wallet skips, and so reports nothing for, those just registered, which are already at the
+    // bundle's block height and timestamp; report them here as the wallet would have.
+    qsort (updates, array_count (updates), sizeof (BRCryptoBundleUpdateBTC), cryptoBundleUpdateCompareBTC);
+
+    for (size_t beg = 0, end = 0; beg < array_count (updates); beg = end) {
+        for (end = beg + 1; end < array_count (updates) && 0 == cryptoBundleUpdateCompareBTC (&updates[beg], &updates[end]); end++);
+
+        array_clear (hashes);
+        for (size_t index = beg; index < end; index++)
+            array_add (hashes, updates[index].txHash);
+
+        BRWalletUpdateTransactions (btcWallet, hashes, array_count (hashes), updates[beg].blockHeight, updates[beg].timestamp);
+
+        array_clear (hashes);
+        for (size_t index = beg; index < end; index++)
+            if (updates[index].wasRegistered) array_add (hashes, updates[index].txHash);
+
+        if (array_count (hashes) > 0)
+            cryptoWalletManagerBTCTxUpdated (manager, hashes, array_count (hashes), updates[beg].blockHeight, updates[beg].timestamp);
+    }
+
+    // On an error, remove the transaction; see `cryptoWalletManagerUpdateTransactionFromBundleBTC()`
+    for (size_t index = 0; index < bundlesCount; index++)
+        if (NULL != btcTransactions[index] &&
+            cryptoWalletManagerBundleIsNotIncludedBTC (bundles[index]) &&
+            BRWalletContainsTransaction (btcWallet, btcTransactions[index]))
+            BRWalletRemoveTransaction (btcWallet, btcTransactions[index]->txHash);
+
+    // Free those for which ownership hasn't been passed
+    for (size_t index = 0; index < bundlesCount; index++)
+        if (needFree[index])
+            BRTransactionFree (btcTransactions[index]);
+
+    free (needFree);
+    array_free (hashes);
+    array_free (updates);
+    array_free (btcRegistrations);
+    array_free (btcTransactions);
+}
+
 static void
 cryptoWalletManagerRecoverTransferFromTransferBundleBTC (BRCryptoWalletManager cwm,
                                                                 OwnershipKept BRCryptoClientTransferBundle bundle) {
@@ -399,25 +595,11 @@ cryptoWalletManagerCreateWalletSweeperBTC (BRCryptoWalletManager cwm,
     BRCryptoCurrency currency = cryptoWalletGetCurrency (wallet);
     BRCryptoUnit unit = cryptoNetworkGetUnitAsBase (cwm->network, currency);
 
-    BRCryptoWalletSweeper sweeper = cryptoWalletSweeperAllocAndInit (sizeof (struct BRCryptoWalletSweeperBTCRecord),
-                                                                         cwm->type,
-                                                                         key,
-                                                                         unit);
-
-    BRCryptoWalletSweeperBTC sweeperBTC = (BRCryptoWalletSweeperBTC) sweeper;
-
-    BRKey *keyCore = cryptoKeyGetCore (key);
-    BRAddressParams addrParams = cryptoNetworkAsBTC (cwm->network)->addrParams;
-
-    size_t addressLength = BRKeyLegacyAddr (keyCore, NULL, 0, addrParams);
-    char  *address = malloc (addressLength + 1);
-    BRKeyLegacyAddr (keyCore, address, addressLength, addrParams);
-    address[addressLength] = '\0';
-
-    sweeperBTC->addrParams = addrParams;
-    sweeperBTC->isSegwit = CRYPTO_ADDRESS_SCHEME_BTC_SEGWIT == cwm->addressScheme;
-    sweeperBTC->sourceAddress = address;
-    array_new (sweeperBTC->txns, 100);
+    BRCryptoWalletSweeper sweeper = cryptoWalletSweeperCreateAsBTC (cwm->type,
+                                                                    key,
+                                                                    unit,
+                                                                    cryptoNetworkAsBTC (cwm->network)->addrParams,
+                                                                    AS_CRYPTO_BOOLEAN (CRYPTO_ADDRESS_SCHEME_BTC_SEGWIT == cwm->addressScheme));
 
     cryptoUnitGive (unit);
     cryptoCurrencyGive (currency);
@@ -650,7 +832,8 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBTC = {
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
-    cryptoWalletManagerCreateWalletSweeperBTC
+    cryptoWalletManagerCreateWalletSweeperBTC,
+    cryptoWalletManagerRecoverTransfersFromTransactionBundlesBTC
 };
 
 BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBCH = {
@@ -668,7 +851,8 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBCH = {
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
-    cryptoWalletManagerCreateWalletSweeperBTC
+    cryptoWalletManagerCreateWalletSweeperBTC,
+    cryptoWalletManagerRecoverTransfersFromTransactionBundlesBTC
 };
 
 BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBSV = {
@@ -686,5 +870,6 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBSV = {
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
-    cryptoWalletManagerCreateWalletSweeperBTC
+    cryptoWalletManagerCreateWalletSweeperBTC,
+    cryptoWalletManagerRecoverTransfersFromTransactionBundlesBTC
 };
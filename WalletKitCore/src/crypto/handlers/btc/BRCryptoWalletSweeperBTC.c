@@ -11,6 +11,7 @@
 #include "BRCryptoBTC.h"
 #include "crypto/BRCryptoWalletSweeperP.h"
 #include "crypto/BRCryptoAmountP.h"
+#include "crypto/BRCryptoKeyP.h"
 #include "ethereum/util/BRUtilMath.h"
 
 // MARK: Forward Declarations
@@ -30,8 +31,64 @@ BRWalletSweeperCreateTransaction (BRCryptoWalletSweeperBTC sweeper,
 static uint64_t
 BRWalletSweeperGetBalance (BRCryptoWalletSweeperBTC sweeper);
 
+static void
+BRWalletSweeperUpdateUTXOs (BRCryptoWalletSweeperBTC sweeper,
+                            BRTransaction *txn);
+
+static size_t
+BRWalletSweeperUTXOHash (const void *utxo);
+
+static int
+BRWalletSweeperUTXOEq (const void *utxo, const void *otherUtxo);
+
 // MARK: - Handlers
 
+private_extern BRCryptoWalletSweeper
+cryptoWalletSweeperCreateAsBTC (BRCryptoBlockChainType type,
+                                BRCryptoKey key,
+                                BRCryptoUnit unit,
+                                BRAddressParams addrParams,
+                                BRCryptoBoolean isSegwit) {
+    BRCryptoWalletSweeper sweeper = cryptoWalletSweeperAllocAndInit (sizeof (struct BRCryptoWalletSweeperBTCRecord),
+                                                                     type,
+                                                                     key,
+                                                                     unit);
+
+    BRCryptoWalletSweeperBTC sweeperBTC = (BRCryptoWalletSweeperBTC) sweeper;
+
+    BRKey *keyCore = cryptoKeyGetCore (key);
+
+    size_t addressLength = BRKeyLegacyAddr (keyCore, NULL, 0, addrParams);
+    char  *address = malloc (addressLength + 1);
+    BRKeyLegacyAddr (keyCore, address, addressLength, addrParams);
+    address[addressLength] = '\0';
+
+    sweeperBTC->addrParams = addrParams;
+    sweeperBTC->isSegwit = CRYPTO_TRUE == isSegwit;
+    sweeperBTC->sourceAddress = address;
+    array_new (sweeperBTC->txns, 100);
+
+    // The legacy address is pay-to-pubkey-hash; its scriptPubKey is the only output script that
+    // renders as `sourceAddress`.
+    UInt160 pkh = BRKeyHash160 (keyCore);
+    uint8_t *script = sweeperBTC->sourceScript;
+    script[0]  = OP_DUP;
+    script[1]  = OP_HASH160;
+    script[2]  = sizeof (pkh);
+    memcpy (&script[3], pkh.u8, sizeof (pkh));
+    script[23] = OP_EQUALVERIFY;
+    script[24] = OP_CHECKSIG;
+    sweeperBTC->sourceScriptLen = 25;
+
+    sweeperBTC->sourcePubKeyLen = BRKeyPubKey (keyCore, sweeperBTC->sourcePubKey, sizeof (sweeperBTC->sourcePubKey));
+
+    sweeperBTC->utxos = BRSetNew (BRWalletSweeperUTXOHash, BRWalletSweeperUTXOEq, 100);
+    sweeperBTC->spent = BRSetNew (BRWalletSweeperUTXOHash, BRWalletSweeperUTXOEq, 100);
+    sweeperBTC->balance = 0;
+
+    return sweeper;
+}
+
 static BRCryptoWalletSweeperBTC
 cryptoWalletSweeperCoerce (BRCryptoWalletSweeper sweeper) {
     assert (CRYPTO_NETWORK_TYPE_BTC == sweeper->type ||
@@ -63,6 +120,7 @@ cryptoWalletSweeperAddTransactionFromBundleBTC (BRCryptoWalletSweeper sweeper,
     BRTransaction * txn = BRTransactionParse (bundle->serialization, bundle->serializationCount);
     if (NULL != txn) {
         array_add (sweeperBTC->txns, txn);
+        BRWalletSweeperUpdateUTXOs (sweeperBTC, txn);
     } else {
         status = CRYPTO_WALLET_SWEEPER_INVALID_TRANSACTION;
     }
@@ -156,6 +214,8 @@ cryptoWalletSweeperReleaseBTC (BRCryptoWalletSweeper sweeper) {
     BRCryptoWalletSweeperBTC sweeperBTC = cryptoWalletSweeperCoerce (sweeper);
     
     free (sweeperBTC->sourceAddress);
+    BRSetFreeAll (sweeperBTC->utxos, free);
+    BRSetFreeAll (sweeperBTC->spent, free);
     for (size_t index = 0; index < array_count(sweeperBTC->txns); index++) {
         BRTransactionFree (sweeperBTC->txns[index]);
     }
@@ -172,13 +232,13 @@ typedef struct {
     uint64_t amount;
 } BRWalletSweeperUTXO;
 
-inline static size_t BRWalletSweeperUTXOHash(const void *utxo)
+static size_t BRWalletSweeperUTXOHash(const void *utxo)
 {
     // (hash xor n)*FNV_PRIME, lifted from BRWallet's BRUTXOHash
     return (size_t)((((const BRWalletSweeperUTXO *)utxo)->txHash.u32[0] ^ ((const BRWalletSweeperUTXO *)utxo)->utxoIndex)*0x01000193);
 }
 
-inline static int BRWalletSweeperUTXOEq(const void *utxo, const void *otherUtxo)
+static int BRWalletSweeperUTXOEq(const void *utxo, const void *otherUtxo)
 {
     // lifted from BRWallet's BRUTXOEq
     return (utxo == otherUtxo || (UInt256Eq(((const BRWalletSweeperUTXO *)utxo)->txHash, ((const BRWalletSweeperUTXO *)otherUtxo)->txHash) &&
@@ -201,42 +261,66 @@ inline static uint64_t BRWalletSweeperCalculateMinOutputAmount(uint64_t feePerKb
     return (amount > TX_MIN_OUTPUT_AMOUNT) ? amount : TX_MIN_OUTPUT_AMOUNT;
 }
 
-inline static int BRWalletSweeperIsSourceInput(BRTxInput *input, BRAddressParams addrParams, char * sourceAddress) {
-    size_t addressLength = BRTxInputAddress (input, NULL, 0, addrParams);
-    char * address = malloc (addressLength + 1);
-    BRTxInputAddress (input, address, addressLength, addrParams);
-    address[addressLength] = '\0';
-
-    int match = 0 == strcmp (sourceAddress, address);
-
-    free (address);
-    return match;
+inline static int BRWalletSweeperIsSourceScript(BRCryptoWalletSweeperBTC sweeper, const uint8_t *script, size_t scriptLen) {
+    return (NULL != script &&
+            scriptLen == sweeper->sourceScriptLen &&
+            0 == memcmp (script, sweeper->sourceScript, scriptLen));
 }
 
-inline static int BRWalletSweeperIsSourceOutput(BRTxOutput *output, BRAddressParams addrParams, char * sourceAddress) {
-    size_t addressLength = BRTxOutputAddress (output, NULL, 0, addrParams);
-    char * address = malloc (addressLength + 1);
-    BRTxOutputAddress (output, address, addressLength, addrParams);
-    address[addressLength] = '\0';
-
-    int match = 0 == strcmp (sourceAddress, address);
+inline static int BRWalletSweeperIsSourceInput(BRCryptoWalletSweeperBTC sweeper, const BRTxInput *input) {
+    // As BRTxInputAddress, prefer the input's scriptPubKey, if known.
+    if (NULL != input->script && 0 != input->scriptLen)
+        return BRWalletSweeperIsSourceScript (sweeper, input->script, input->scriptLen);
+
+    // Otherwise a pay-to-pubkey-hash scriptSig, `<sig> <pubKey>`, must push the source's pubKey
+    // last.  Compare the pubKey itself rather than rendering its hash160 as an address.  (The
+    // source address is legacy; a witness never renders as it.)
+    const uint8_t *sig = input->signature;
+    size_t sigLen = input->sigLen, pkLen = sweeper->sourcePubKeyLen;
+
+    return (NULL != sig && 0 != pkLen && sigLen > pkLen + 1 &&
+            sig[0] <= OP_PUSHDATA4 &&
+            sig[sigLen - pkLen - 1] == pkLen &&
+            0 == memcmp (&sig[sigLen - pkLen], sweeper->sourcePubKey, pkLen) &&
+            2 == BRScriptElements (NULL, 0, sig, sigLen));
+}
 
-    free (address);
-    return match;
+inline static int BRWalletSweeperIsSourceOutput(BRCryptoWalletSweeperBTC sweeper, const BRTxOutput *output) {
+    return BRWalletSweeperIsSourceScript (sweeper, output->script, output->scriptLen);
 }
 
-static BRSetOf(BRWalletSweeperUTXO *)
-BRWalletSweeperGetUTXOs (BRCryptoWalletSweeperBTC sweeper) {
-    BRSet * utxos = BRSetNew(BRWalletSweeperUTXOHash, BRWalletSweeperUTXOEq, 100);
+static void
+BRWalletSweeperUpdateUTXOs (BRCryptoWalletSweeperBTC sweeper,
+                            BRTransaction *txn) {
+    // Record the outpoints spent by the source.  They are kept, even once matched to a UTXO, so
+    // that a spending transaction may be added before the transaction it spends and so that a
+    // duplicate transaction does not resurrect a spent output.
+    for (uint32_t i = 0; i < txn->inCount; i++) {
+        if (BRWalletSweeperIsSourceInput (sweeper, &txn->inputs[i])) {
+            BRWalletSweeperUTXO value = { txn->inputs[i].txHash, txn->inputs[i].index };
+            // other values are not used during lookup
+
+            if (NULL == BRSetGet (sweeper->spent, &value)) {
+                BRWalletSweeperUTXO *spent = malloc (sizeof(BRWalletSweeperUTXO));
+                *spent = value;
+                BRSetAdd (sweeper->spent, spent);
+            }
 
-    // TODO(fix): This is horrible; we should be building up this knowledge as transactions are added
+            BRWalletSweeperUTXO *utxo = BRSetRemove (sweeper->utxos, &value);
+            if (NULL != utxo) {
+                sweeper->balance -= utxo->amount;
+                free (utxo);
+            }
+        }
+    }
 
-    // loop through and add all the unspent outputs
-    for (size_t index = 0; index < array_count (sweeper->txns); index++) {
-        BRTransaction *txn = sweeper->txns[index];
+    // Add the unspent outputs paying to the source.
+    for (uint32_t i = 0; i < txn->outCount; i++) {
+        if (BRWalletSweeperIsSourceOutput (sweeper, &txn->outputs[i])) {
+            BRWalletSweeperUTXO value = { txn->txHash, i };
 
-        for (uint32_t i = 0; i < txn->outCount; i++) {
-            if (BRWalletSweeperIsSourceOutput (&txn->outputs[i], sweeper->addrParams, sweeper->sourceAddress)) {
+            if (NULL == BRSetGet (sweeper->spent, &value) &&
+                NULL == BRSetGet (sweeper->utxos, &value)) {
                 BRWalletSweeperUTXO * utxo = malloc (sizeof(BRWalletSweeperUTXO));
                 utxo->txHash = txn->txHash;
                 utxo->utxoIndex = i;
@@ -244,35 +328,11 @@ BRWalletSweeperGetUTXOs (BRCryptoWalletSweeperBTC sweeper) {
                 utxo->script = txn->outputs[i].script;
                 utxo->scriptLen = txn->outputs[i].scriptLen;
 
-                utxo = BRSetAdd (utxos, utxo);
-                if (NULL != utxo) {
-                    free (utxo);
-                }
-            }
-        }
-    }
-
-    // loop through and remove all the unspent outputs
-    for (size_t index = 0; index < array_count (sweeper->txns); index++) {
-        BRTransaction *txn = sweeper->txns[index];
-
-        for (uint32_t i = 0; i < txn->inCount; i++) {
-            if (BRWalletSweeperIsSourceInput (&txn->inputs[i], sweeper->addrParams, sweeper->sourceAddress)) {
-                BRWalletSweeperUTXO value = {0};
-                BRWalletSweeperUTXO * utxo = &value;
-                value.txHash = txn->inputs[i].txHash;
-                value.utxoIndex = txn->inputs[i].index;
-                // other values are not used during lookup
-
-                utxo = BRSetRemove (utxos, utxo);
-                if (NULL != utxo) {
-                    free (utxo);
-                }
+                BRSetAdd (sweeper->utxos, utxo);
+                sweeper->balance += utxo->amount;
             }
         }
     }
-
-    return utxos;
 }
 
 static BRCryptoWalletSweeperStatus
@@ -287,8 +347,7 @@ BRWalletSweeperBuildTransaction (BRCryptoWalletSweeperBTC sweeper,
 
     // based on BRWallet's BRWalletCreateTxForOutputs
 
-    BRSetOf(BRWalletSweeperUTXO *) outputs = BRWalletSweeperGetUTXOs (sweeper);
-    FOR_SET (BRWalletSweeperUTXO *, utxo, outputs) {
+    FOR_SET (BRWalletSweeperUTXO *, utxo, sweeper->utxos) {
         BRTransactionAddInput(transaction,
                               utxo->txHash,
                               utxo->utxoIndex,
@@ -302,7 +361,6 @@ BRWalletSweeperBuildTransaction (BRCryptoWalletSweeperBTC sweeper,
                               TXIN_SEQUENCE);
         balanceAmount += utxo->amount;
     }
-    BRSetFreeAll (outputs, free);
 
     size_t txnSize = BRTransactionVSize(transaction) + TX_OUTPUT_SIZE;
     if (txnSize > TX_MAX_SIZE) {
@@ -371,15 +429,7 @@ BRWalletSweeperEstimateFee (BRCryptoWalletSweeperBTC sweeper,
 
 static uint64_t
 BRWalletSweeperGetBalance (BRCryptoWalletSweeperBTC sweeper) {
-    uint64_t balance = 0;
-
-    BRSetOf(BRWalletSweeperUTXO *) outputs = BRWalletSweeperGetUTXOs (sweeper);
-    FOR_SET (BRWalletSweeperUTXO *, utxo, outputs) {
-        balance += utxo->amount;
-    }
-    BRSetFreeAll (outputs, free);
-
-    return balance;
+    return sweeper->balance;
 }
 
 
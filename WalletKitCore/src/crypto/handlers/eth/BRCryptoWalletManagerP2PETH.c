@@ -838,7 +838,8 @@ cryptoWalletManagerCreateP2PManagerETH (BRCryptoWalletManager manager) {
                           nodes,
                           blocks,
                           transactions,
-                          logs);
+                          logs,
+                          cryptoWalletManagerGetPath (manager));
 
     return p2pBase;
 }
@@ -185,6 +185,29 @@ cryptoWalletManagerRecoverTransfersFromTransactionBundleHBAR (BRCryptoWalletMana
     assert (0);
 }
 
+// MARK: - Address Intern
+
+static void *
+cryptoWalletManagerDecodeAddressHBAR (const char *string) {
+    return hederaAddressCreateFromString (string, false);
+}
+
+static void *
+cryptoWalletManagerCloneAddressHBAR (const void *address) {
+    return hederaAddressClone ((BRHederaAddress) address);
+}
+
+static void
+cryptoWalletManagerReleaseAddressHBAR (void *address) {
+    hederaAddressFree ((BRHederaAddress) address);
+}
+
+static const BRCryptoAddressInternHandlers cryptoAddressInternHandlersHBAR = {
+    cryptoWalletManagerDecodeAddressHBAR,
+    cryptoWalletManagerCloneAddressHBAR,
+    cryptoWalletManagerReleaseAddressHBAR
+};
+
 static void
 cryptoWalletManagerRecoverTransferFromTransferBundleHBAR (BRCryptoWalletManager manager,
                                                           OwnershipKept BRCryptoClientTransferBundle bundle) {
@@ -192,11 +215,10 @@ cryptoWalletManagerRecoverTransferFromTransferBundleHBAR (BRCryptoWalletManager
     
     BRHederaAccount hbarAccount = cryptoAccountAsHBAR (manager->account);
     
-    BRHederaUnitTinyBar amountHbar, feeHbar = 0;
-    sscanf(bundle->amount, "%" PRIi64, &amountHbar);
-    if (NULL != bundle->fee) sscanf(bundle->fee, "%" PRIi64, &feeHbar);
-    BRHederaAddress toAddress   = hederaAddressCreateFromString(bundle->to,   false);
-    BRHederaAddress fromAddress = hederaAddressCreateFromString(bundle->from, false);
+    BRHederaUnitTinyBar amountHbar = cryptoClientTransferBundleParseInt64 (bundle->amount);
+    BRHederaUnitTinyBar feeHbar    = cryptoClientTransferBundleParseInt64 (bundle->fee);
+    BRHederaAddress toAddress   = cryptoWalletManagerDecodeAddress (manager, bundle->to,   &cryptoAddressInternHandlersHBAR);
+    BRHederaAddress fromAddress = cryptoWalletManagerDecodeAddress (manager, bundle->from, &cryptoAddressInternHandlersHBAR);
     // Convert the hash string to bytes
     BRHederaTransactionHash txHash;
     memset(txHash.bytes, 0x00, sizeof(txHash.bytes));
@@ -183,6 +183,29 @@ cryptoWalletManagerRecoverTransfersFromTransactionBundleXRP (BRCryptoWalletManag
     assert (0);
 }
 
+// MARK: - Address Intern
+
+static void *
+cryptoWalletManagerDecodeAddressXRP (const char *string) {
+    return rippleAddressCreateFromString (string, false);
+}
+
+static void *
+cryptoWalletManagerCloneAddressXRP (const void *address) {
+    return rippleAddressClone ((BRRippleAddress) address);
+}
+
+static void
+cryptoWalletManagerReleaseAddressXRP (void *address) {
+    rippleAddressFree ((BRRippleAddress) address);
+}
+
+static const BRCryptoAddressInternHandlers cryptoAddressInternHandlersXRP = {
+    cryptoWalletManagerDecodeAddressXRP,
+    cryptoWalletManagerCloneAddressXRP,
+    cryptoWalletManagerReleaseAddressXRP
+};
+
 static void
 cryptoWalletManagerRecoverTransferFromTransferBundleXRP (BRCryptoWalletManager manager,
                                                          OwnershipKept BRCryptoClientTransferBundle bundle) {
@@ -190,15 +213,13 @@ cryptoWalletManagerRecoverTransferFromTransferBundleXRP (BRCryptoWalletManager m
 
     BRRippleAccount xrpAccount = cryptoAccountAsXRP(manager->account);
     
-    BRRippleUnitDrops amountDrops = 0;
-    sscanf(bundle->amount, "%" PRIu64, &amountDrops);
+    BRRippleUnitDrops amountDrops = cryptoClientTransferBundleParseUInt64 (bundle->amount);
 
-    BRRippleUnitDrops feeDrops = 0;
-    if (NULL != bundle->fee) sscanf(bundle->fee, "%" PRIu64, &feeDrops);
+    BRRippleUnitDrops feeDrops = cryptoClientTransferBundleParseUInt64 (bundle->fee);
     BRRippleFeeBasis xrpFeeBasis = { feeDrops, 1};
 
-    BRRippleAddress toAddress   = rippleAddressCreateFromString (bundle->to,   false);
-    BRRippleAddress fromAddress = rippleAddressCreateFromString (bundle->from, false);
+    BRRippleAddress toAddress   = cryptoWalletManagerDecodeAddress (manager, bundle->to,   &cryptoAddressInternHandlersXRP);
+    BRRippleAddress fromAddress = cryptoWalletManagerDecodeAddress (manager, bundle->from, &cryptoAddressInternHandlersXRP);
     // Convert the hash string to bytes
     BRRippleTransactionHash txId;
     hexDecode(txId.bytes, sizeof(txId.bytes), bundle->hash, strlen(bundle->hash));
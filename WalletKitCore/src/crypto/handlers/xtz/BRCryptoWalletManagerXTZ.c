@@ -217,6 +217,29 @@ cwmParseUInt64 (const char *string, bool *error) {
     return strtoull(string, NULL, 0);
 }
 
+// MARK: - Address Intern
+
+static void *
+cryptoWalletManagerDecodeAddressXTZ (const char *string) {
+    return tezosAddressCreateFromString (string, false);
+}
+
+static void *
+cryptoWalletManagerCloneAddressXTZ (const void *address) {
+    return tezosAddressClone ((BRTezosAddress) address);
+}
+
+static void
+cryptoWalletManagerReleaseAddressXTZ (void *address) {
+    tezosAddressFree ((BRTezosAddress) address);
+}
+
+static const BRCryptoAddressInternHandlers cryptoAddressInternHandlersXTZ = {
+    cryptoWalletManagerDecodeAddressXTZ,
+    cryptoWalletManagerCloneAddressXTZ,
+    cryptoWalletManagerReleaseAddressXTZ
+};
+
 static void
 cryptoWalletManagerRecoverTransferFromTransferBundleXTZ (BRCryptoWalletManager manager,
                                                          OwnershipKept BRCryptoClientTransferBundle bundle) {
@@ -224,13 +247,13 @@ cryptoWalletManagerRecoverTransferFromTransferBundleXTZ (BRCryptoWalletManager m
 
     BRTezosAccount xtzAccount = cryptoAccountAsXTZ(manager->account);
     
-    BRTezosUnitMutez amountMutez, feeMutez = 0;
-    sscanf(bundle->amount, "%" PRIu64, &amountMutez);
-    if (NULL != bundle->fee) sscanf(bundle->fee, "%" PRIu64, &feeMutez);
-    BRTezosAddress toAddress   = tezosAddressCreateFromString (bundle->to,   false);
-    BRTezosAddress fromAddress = tezosAddressCreateFromString (bundle->from, false);
+    BRTezosUnitMutez amountMutez = (BRTezosUnitMutez) cryptoClientTransferBundleParseUInt64 (bundle->amount);
+    BRTezosUnitMutez feeMutez    = (BRTezosUnitMutez) cryptoClientTransferBundleParseUInt64 (bundle->fee);
+    BRTezosAddress toAddress   = cryptoWalletManagerDecodeAddress (manager, bundle->to,   &cryptoAddressInternHandlersXTZ);
+    BRTezosAddress fromAddress = cryptoWalletManagerDecodeAddress (manager, bundle->from, &cryptoAddressInternHandlersXTZ);
     // Convert the hash string to bytes
-    BRTezosHash txId = cryptoHashAsXTZ (cryptoHashCreateFromStringAsXTZ (bundle->hash));
+    BRCryptoHash hash = cryptoHashCreateFromStringAsXTZ (bundle->hash);
+    BRTezosHash txId = cryptoHashAsXTZ (hash);
     int error = (CRYPTO_TRANSFER_STATE_ERRORED == bundle->status);
 
     bool xtzTransferNeedFree = true;
@@ -239,7 +262,6 @@ cryptoWalletManagerRecoverTransferFromTransferBundleXTZ (BRCryptoWalletManager m
     // create BRCryptoTransfer
     
     BRCryptoWallet wallet = cryptoWalletManagerGetWallet (manager);
-    BRCryptoHash hash = cryptoHashCreateAsXTZ (txId);
     
     // A transaction may include a "burn" transfer to target address 'unknown' in addition to the normal transfer, both sharing the same hash. Typically occurs when sending to an un-revealed address.
     // It must be included since the burn amount is subtracted from wallet balance, but is not considered a normal fee.
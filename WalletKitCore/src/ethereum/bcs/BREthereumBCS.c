@@ -180,7 +180,8 @@ bcsCreate (BREthereumNetwork network,
            OwnershipGiven BRSetOf(BREthereumNodeConfig) peers,
            OwnershipGiven BRSetOf(BREthereumBlock) blocks,
            OwnershipGiven BRSetOf(BREthereumTransaction) transactions,
-           OwnershipGiven BRSetOf(BREthereumLog) logs) {
+           OwnershipGiven BRSetOf(BREthereumLog) logs,
+           const char *storagePath) {
 
     BREthereumBCS bcs = (BREthereumBCS) calloc (1, sizeof(struct BREthereumBCSStruct));
 
@@ -190,7 +191,8 @@ bcsCreate (BREthereumNetwork network,
     bcs->accountState = accountStateCreateEmpty ();
     bcs->mode = mode;
     bcs->filterForAddressOnTransactions = bloomFilterCreateAddress(bcs->address);
-    bcs->filterForAddressOnLogs = logTopicGetBloomFilterAddress(bcs->address);
+    bcs->queryForAddressOnLogs = bloomQueryCreate ();
+    logTopicAddToBloomQueryAddress (bcs->address, bcs->queryForAddressOnLogs);
 
     bcs->listener = listener;
 
@@ -298,7 +300,12 @@ bcsCreate (BREthereumNetwork network,
                                bcs->les,
                                bcs->handler);
 
-    bcs->pow = proofOfWorkCreate();
+    // Rinkeby is sealed by Clique, not Ethash; there is no proof-of-work to verify.
+    bcs->pow = (ethNetworkRinkeby == network ? NULL : proofOfWorkCreateWithPath (storagePath));
+
+    // If we'll be validating announced headers, get the head's Ethash cache ready now.
+    if (NULL != bcs->pow && bcs->chain != bcs->genesis && ETHEREUM_BOOLEAN_IS_TRUE (handleSync))
+        proofOfWorkGenerate (bcs->pow, blockGetHeader (bcs->chain));
 
     return bcs;
 }
@@ -333,7 +340,7 @@ bcsDestroy (BREthereumBCS bcs) {
 
     lesRelease (bcs->les);
     bcsSyncRelease(bcs->sync);
-    proofOfWorkRelease(bcs->pow);
+    if (NULL != bcs->pow) proofOfWorkRelease(bcs->pow);
 
     // TODO: We'll need to announce things to our `listener`
 
@@ -348,6 +355,7 @@ bcsDestroy (BREthereumBCS bcs) {
 
     // Logs
     BRSetFreeAll (bcs->logs, (void (*) (void*)) logRelease);
+    bloomQueryRelease (bcs->queryForAddressOnLogs);
     
     // pending transactions/logs are in bcs->transactions/logs; thus already released.
     array_free (bcs->pendingTransactions);
@@ -1260,7 +1268,7 @@ bcsBlockHasMatchingTransactions (BREthereumBCS bcs,
 static BREthereumBoolean
 bcsBlockHasMatchingLogs (BREthereumBCS bcs,
                          BREthereumBlock block) {
-    return blockHeaderMatch (blockGetHeader (block), bcs->filterForAddressOnLogs);
+    return blockHeaderMatchQuery (blockGetHeader (block), bcs->queryForAddressOnLogs);
 }
 
 static BREthereumBoolean
@@ -1748,7 +1756,7 @@ bcsHandleTransactionReceipts (BREthereumBCS bcs,
     size_t receiptsCount = array_count(receipts);
     for (size_t ti = 0; ti < receiptsCount; ti++) { // transactionIndex
         BREthereumTransactionReceipt receipt = receipts[ti];
-        if (ETHEREUM_BOOLEAN_IS_TRUE (transactionReceiptMatch(receipt, bcs->filterForAddressOnLogs))) {
+        if (ETHEREUM_BOOLEAN_IS_TRUE (transactionReceiptMatchQuery(receipt, bcs->queryForAddressOnLogs))) {
             size_t logsCount = transactionReceiptGetLogsCount(receipt);
             for (size_t li = 0; li < logsCount; li++) { // logIndex
                 BREthereumLog log = transactionReceiptGetLog(receipt, li);
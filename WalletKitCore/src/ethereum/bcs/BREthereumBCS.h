@@ -165,6 +165,7 @@ typedef struct {
  *
  * @parameters
  * @parameter headers - is this a BRArray; assume so for now.
+ * @parameter storagePath - the directory for persisted Ethash caches; may be NULL.
  */
 extern BREthereumBCS
 bcsCreate (BREthereumNetwork network,
@@ -174,7 +175,8 @@ bcsCreate (BREthereumNetwork network,
            BRSetOf(BREthereumNodeConfig) peers,
            BRSetOf(BREthereumBlock) blocks,
            BRSetOf(BREthereumTransaction) transactions,
-           BRSetOf(BREthereumLog) logs);
+           BRSetOf(BREthereumLog) logs,
+           const char *storagePath);
 
 extern void
 bcsStart (BREthereumBCS bcs);
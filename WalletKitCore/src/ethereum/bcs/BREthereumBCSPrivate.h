@@ -90,10 +90,10 @@ struct BREthereumBCSStruct {
     BREthereumBloomFilter filterForAddressOnTransactions;
 
     /**
-     * A BloomFilter with address for application to logs.  For logs, the bloom filter is based
+     * A BloomQuery with address for application to logs.  For logs, the bloom filter is based
      * on matching `LogTopic` data.
      */
-    BREthereumBloomFilter filterForAddressOnLogs;
+    BREthereumBloomQuery queryForAddressOnLogs;
 
     /**
      * The listener interested in BCS events
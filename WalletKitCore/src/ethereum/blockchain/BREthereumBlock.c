@@ -307,12 +307,18 @@ blockHeaderMatch (BREthereumBlockHeader header,
     return bloomFilterMatch(header->logsBloom, filter);
 }
 
+extern BREthereumBoolean
+blockHeaderMatchQuery (BREthereumBlockHeader header,
+                       BREthereumBloomQuery query) {
+    return bloomQueryMatch (query, &header->logsBloom);
+}
+
 extern BREthereumBoolean
 blockHeaderMatchAddress (BREthereumBlockHeader header,
                          BREthereumAddress address) {
     return AS_ETHEREUM_BOOLEAN
-    (ETHEREUM_BOOLEAN_IS_TRUE (blockHeaderMatch (header, bloomFilterCreateAddress (address))) ||
-     ETHEREUM_BOOLEAN_IS_TRUE (blockHeaderMatch (header, logTopicGetBloomFilterAddress (address))));
+    (ETHEREUM_BOOLEAN_IS_TRUE (bloomFilterMatchHash (&header->logsBloom, ethAddressGetHash (address))) ||
+     ETHEREUM_BOOLEAN_IS_TRUE (bloomFilterMatchHash (&header->logsBloom, logTopicGetBloomHashAddress (address))));
 }
 
 extern uint64_t
@@ -538,6 +544,10 @@ blockHeaderRlpEncode (BREthereumBlockHeader header,
     BRRlpItem items[15];
     size_t itemsCount = ETHEREUM_BOOLEAN_IS_TRUE(withNonce) ? 15 : 13;
 
+    // Without the nonce this is the Ethash 'seal' encoding whose hash must match the miner's;
+    // encode zero scalars canonically, as the empty string.
+    int zeroAsEmptyString = ETHEREUM_BOOLEAN_IS_FALSE(withNonce);
+
     items[ 0] = ethHashRlpEncode(header->parentHash, coder);
     items[ 1] = ethHashRlpEncode(header->ommersHash, coder);
     items[ 2] = ethAddressRlpEncode(header->beneficiary, coder);
@@ -545,11 +555,11 @@ blockHeaderRlpEncode (BREthereumBlockHeader header,
     items[ 4] = ethHashRlpEncode(header->transactionsRoot, coder);
     items[ 5] = ethHashRlpEncode(header->receiptsRoot, coder);
     items[ 6] = bloomFilterRlpEncode(header->logsBloom, coder);
-    items[ 7] = rlpEncodeUInt256 (coder, header->difficulty, 0);
-    items[ 8] = rlpEncodeUInt64(coder, header->number, 0);
-    items[ 9] = rlpEncodeUInt64(coder, header->gasLimit, 0);
-    items[10] = rlpEncodeUInt64(coder, header->gasUsed, 0);
-    items[11] = rlpEncodeUInt64(coder, header->timestamp, 0);
+    items[ 7] = rlpEncodeUInt256 (coder, header->difficulty, zeroAsEmptyString);
+    items[ 8] = rlpEncodeUInt64(coder, header->number, zeroAsEmptyString);
+    items[ 9] = rlpEncodeUInt64(coder, header->gasLimit, zeroAsEmptyString);
+    items[10] = rlpEncodeUInt64(coder, header->gasUsed, zeroAsEmptyString);
+    items[11] = rlpEncodeUInt64(coder, header->timestamp, zeroAsEmptyString);
     items[12] = rlpEncodeBytes(coder, header->extraData, header->extraDataCount);
 
     if (ETHEREUM_BOOLEAN_IS_TRUE(withNonce)) {
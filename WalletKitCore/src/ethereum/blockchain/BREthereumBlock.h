@@ -133,6 +133,14 @@ extern BREthereumBoolean
 blockHeaderMatch (BREthereumBlockHeader header,
                   BREthereumBloomFilter filter);
 
+/**
+ * Check if any of the addresses/topics in `query` match the header's logs bloom filter.  Prefer
+ * this over blockHeaderMatch() when checking many headers against the same addresses.
+ */
+extern BREthereumBoolean
+blockHeaderMatchQuery (BREthereumBlockHeader header,
+                       BREthereumBloomQuery query);
+
 extern BREthereumBoolean
 blockHeaderMatchAddress (BREthereumBlockHeader header,
                          BREthereumAddress address);
@@ -569,16 +577,36 @@ blockFree (BREthereumBlock block);
 
 /// MARK: - Proof of Work
 
+/**
+ * Create an Ethash 'light' verifier whose per-epoch caches are held in memory only, and thus
+ * regenerated on each create.
+ */
 extern BREthereumProofOfWork
 proofOfWorkCreate (void);
 
+/**
+ * As proofOfWorkCreate() but the per-epoch caches are persisted, memory-mapped, in `path`; if
+ * `path` is NULL the caches are held in memory only.
+ */
+extern BREthereumProofOfWork
+proofOfWorkCreateWithPath (const char *path);
+
 extern void
 proofOfWorkRelease (BREthereumProofOfWork pow);
 
+/**
+ * Request, in the background, the cache needed to verify `header` - or the cache for the next
+ * epoch if `header` is close to an epoch boundary.
+ */
 extern void
 proofOfWorkGenerate (BREthereumProofOfWork pow,
                      BREthereumBlockHeader header);
 
+/**
+ * Compute `header`'s Ethash result as `n` and its mix digest as `m`.  If the header's cache is not
+ * yet available this waits for it.  A header with zero difficulty (not sealed by Ethash) produces
+ * an `n` of zero and an empty `m`, both of which denote 'no POW'.
+ */
 extern void
 proofOfWorkCompute (BREthereumProofOfWork pow,
                     BREthereumBlockHeader header,
@@ -9,7 +9,9 @@
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
+#include "support/BRArray.h"
 #include "BREthereumBloomFilter.h"
 
 /* Forward Declarations */
@@ -89,9 +91,135 @@ bloomFilterEqual (const BREthereumBloomFilter filter1, const BREthereumBloomFilt
             : ETHEREUM_BOOLEAN_FALSE);
 }
 
+//
+// Whole filter operations are performed a word at a time, which compilers vectorize; the filter
+// bytes need not be word aligned, hence the `memcpy()`
+//
+#define ETHEREUM_BLOOM_FILTER_WORDS   (ETHEREUM_BLOOM_FILTER_BYTES / sizeof (uint64_t))
+
+static inline uint64_t
+bloomFilterGetWord (const BREthereumBloomFilter *filter, size_t index) {
+    uint64_t word;
+    memcpy (&word, &filter->bytes[index * sizeof (uint64_t)], sizeof (uint64_t));
+    return word;
+}
+
 extern BREthereumBoolean
 bloomFilterMatch (const BREthereumBloomFilter filter, const BREthereumBloomFilter other) {
-    return bloomFilterEqual(filter, bloomFilterOr(filter, other));
+    // `other` is contained in `filter` if no bit of `other` is missing from `filter`
+    uint64_t missing = 0;
+    for (size_t i = 0; i < ETHEREUM_BLOOM_FILTER_WORDS; i++)
+        missing |= bloomFilterGetWord (&other, i) & ~bloomFilterGetWord (&filter, i);
+    return AS_ETHEREUM_BOOLEAN (0 == missing);
+}
+
+static int
+bloomFilterIntersects (const BREthereumBloomFilter *filter1, const BREthereumBloomFilter *filter2) {
+    uint64_t common = 0;
+    for (size_t i = 0; i < ETHEREUM_BLOOM_FILTER_WORDS; i++)
+        common |= bloomFilterGetWord (filter1, i) & bloomFilterGetWord (filter2, i);
+    return 0 != common;
+}
+
+//
+// Bloom Query
+//
+
+/**
+ * The three bits, as (byteIndex, bitMask) pairs, that the bloom filter of one hash sets.
+ */
+typedef struct {
+    uint8_t byteIndex[3];
+    uint8_t bitMask[3];
+} BREthereumBloomQueryElement;
+
+static BREthereumBloomQueryElement
+bloomQueryElementCreate (const BREthereumHash hash) {
+    BREthereumBloomQueryElement element;
+    for (size_t i = 0; i < 3; i++) {
+        unsigned int byteIndex, bitIndex;
+        bloomFilterExtractLocation (bloomFilterCreateIndex (hash.bytes[2 * i], hash.bytes[2 * i + 1]),
+                                    &byteIndex, &bitIndex);
+        element.byteIndex[i] = (uint8_t) byteIndex;
+        element.bitMask[i]   = (uint8_t) (1 << bitIndex);
+    }
+    return element;
+}
+
+static inline int
+bloomQueryElementMatch (const BREthereumBloomQueryElement *element,
+                        const BREthereumBloomFilter *filter) {
+    return ((filter->bytes[element->byteIndex[0]] & element->bitMask[0]) &&
+            (filter->bytes[element->byteIndex[1]] & element->bitMask[1]) &&
+            (filter->bytes[element->byteIndex[2]] & element->bitMask[2]));
+}
+
+extern BREthereumBoolean
+bloomFilterMatchHash (const BREthereumBloomFilter *filter, const BREthereumHash hash) {
+    BREthereumBloomQueryElement element = bloomQueryElementCreate (hash);
+    return AS_ETHEREUM_BOOLEAN (bloomQueryElementMatch (&element, filter));
+}
+
+/**
+ * With this many elements, or more, first AND the filter with the union of all elements; it is
+ * cheaper than the probes when nothing intersects.
+ */
+#define BLOOM_QUERY_UNION_THRESHOLD     (8)
+
+struct BREthereumBloomQueryRecord {
+    BRArrayOf(BREthereumBloomQueryElement) elements;
+    BREthereumBloomFilter any;
+};
+
+extern BREthereumBloomQuery
+bloomQueryCreate (void) {
+    BREthereumBloomQuery query = calloc (1, sizeof (struct BREthereumBloomQueryRecord));
+    array_new (query->elements, 4);
+    query->any = empty;
+    return query;
+}
+
+extern void
+bloomQueryRelease (BREthereumBloomQuery query) {
+    array_free (query->elements);
+    free (query);
+}
+
+extern void
+bloomQueryAddHash (BREthereumBloomQuery query, const BREthereumHash hash) {
+    BREthereumBloomQueryElement element = bloomQueryElementCreate (hash);
+    for (size_t i = 0; i < 3; i++)
+        query->any.bytes[element.byteIndex[i]] |= element.bitMask[i];
+    array_add (query->elements, element);
+}
+
+extern void
+bloomQueryAddData (BREthereumBloomQuery query, const BRRlpData data) {
+    bloomQueryAddHash (query, ethHashCreateFromData (data));
+}
+
+extern void
+bloomQueryAddAddress (BREthereumBloomQuery query, const BREthereumAddress address) {
+    bloomQueryAddHash (query, ethAddressGetHash (address));
+}
+
+extern size_t
+bloomQueryGetCount (BREthereumBloomQuery query) {
+    return array_count (query->elements);
+}
+
+extern BREthereumBoolean
+bloomQueryMatch (BREthereumBloomQuery query, const BREthereumBloomFilter *filter) {
+    size_t count = array_count (query->elements);
+
+    if (count >= BLOOM_QUERY_UNION_THRESHOLD && !bloomFilterIntersects (filter, &query->any))
+        return ETHEREUM_BOOLEAN_FALSE;
+
+    for (size_t index = 0; index < count; index++)
+        if (bloomQueryElementMatch (&query->elements[index], filter))
+            return ETHEREUM_BOOLEAN_TRUE;
+
+    return ETHEREUM_BOOLEAN_FALSE;
 }
 
 //
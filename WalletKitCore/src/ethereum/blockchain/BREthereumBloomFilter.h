@@ -99,6 +99,13 @@ bloomFilterEqual (const BREthereumBloomFilter filter1, const BREthereumBloomFilt
 extern BREthereumBoolean
 bloomFilterMatch (const BREthereumBloomFilter filter, const BREthereumBloomFilter other);
 
+/**
+ * Check if the bloom filter for `hash` is contained in `filter`; equivalent to, but cheaper than,
+ * `bloomFilterMatch (*filter, bloomFilterCreateHash (hash))`.
+ */
+extern BREthereumBoolean
+bloomFilterMatchHash (const BREthereumBloomFilter *filter, const BREthereumHash hash);
+
 extern BRRlpItem
 bloomFilterRlpEncode(BREthereumBloomFilter filter, BRRlpCoder coder);
 
@@ -111,6 +118,47 @@ bloomFilterRlpDecode (BRRlpItem item, BRRlpCoder coder);
 extern char *
 bloomFilterAsString (BREthereumBloomFilter filter);
 
+/**
+ * A BloomQuery holds the precomputed bit positions for a set of hashes (typically addresses and
+ * log topics) and matches a BloomFilter if *any* one of them is contained in the filter.  Only the
+ * three bits of each hash are probed - no 2048-bit filters are created, ORed or compared - and
+ * for larger sets a single word-wise AND of the filter with the union of all the hashes rejects
+ * filters that share no bit with the query at all.
+ */
+typedef struct BREthereumBloomQueryRecord *BREthereumBloomQuery;
+
+extern BREthereumBloomQuery
+bloomQueryCreate (void);
+
+extern void
+bloomQueryRelease (BREthereumBloomQuery query);
+
+extern void
+bloomQueryAddHash (BREthereumBloomQuery query, const BREthereumHash hash);
+
+/**
+ * Add `data` - computes the hash of `data`
+ */
+extern void
+bloomQueryAddData (BREthereumBloomQuery query, const BRRlpData data);
+
+/**
+ * Add `address` - computes the hash of `address`; as per bloomFilterCreateAddress()
+ */
+extern void
+bloomQueryAddAddress (BREthereumBloomQuery query, const BREthereumAddress address);
+
+extern size_t
+bloomQueryGetCount (BREthereumBloomQuery query);
+
+/**
+ * Check if any hash in `query` is contained in `filter`.
+ *
+ * @returns TRUE on a match, FALSE if `query` is empty or nothing matches.
+ */
+extern BREthereumBoolean
+bloomQueryMatch (BREthereumBloomQuery query, const BREthereumBloomFilter *filter);
+
 #ifdef __cplusplus
 }
 #endif
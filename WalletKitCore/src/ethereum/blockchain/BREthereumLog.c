@@ -62,12 +62,22 @@ logTopicCreateAddress (BREthereumAddress raw) {
     return topic;
 }
 
-extern BREthereumBloomFilter
-logTopicGetBloomFilter (BREthereumLogTopic topic) {
+extern BREthereumHash
+logTopicGetBloomHash (BREthereumLogTopic topic) {
     BRRlpData data;
     data.bytes = topic.bytes;
     data.bytesCount = sizeof (topic.bytes);
-    return bloomFilterCreateData(data);
+    return ethHashCreateFromData(data);
+}
+
+extern BREthereumHash
+logTopicGetBloomHashAddress (BREthereumAddress address) {
+    return logTopicGetBloomHash (logTopicCreateAddress (address));
+}
+
+extern BREthereumBloomFilter
+logTopicGetBloomFilter (BREthereumLogTopic topic) {
+    return bloomFilterCreateHash (logTopicGetBloomHash (topic));
 }
 
 extern BREthereumBloomFilter
@@ -75,6 +85,18 @@ logTopicGetBloomFilterAddress (BREthereumAddress address) {
     return logTopicGetBloomFilter (logTopicCreateAddress(address));
 }
 
+extern void
+logTopicAddToBloomQuery (BREthereumLogTopic topic,
+                         BREthereumBloomQuery query) {
+    bloomQueryAddHash (query, logTopicGetBloomHash (topic));
+}
+
+extern void
+logTopicAddToBloomQueryAddress (BREthereumAddress address,
+                                BREthereumBloomQuery query) {
+    logTopicAddToBloomQuery (logTopicCreateAddress (address), query);
+}
+
 static int
 logTopicMatchesAddressBool (BREthereumLogTopic topic,
                         BREthereumAddress address) {
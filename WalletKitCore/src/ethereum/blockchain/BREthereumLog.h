@@ -45,6 +45,26 @@ logTopicGetBloomFilter (BREthereumLogTopic topic);
 extern BREthereumBloomFilter
 logTopicGetBloomFilterAddress (BREthereumAddress address);
 
+/**
+ * The hash of `topic` from which its bloom filter bits derive.
+ */
+extern BREthereumHash
+logTopicGetBloomHash (BREthereumLogTopic topic);
+
+extern BREthereumHash
+logTopicGetBloomHashAddress (BREthereumAddress address);
+
+extern void
+logTopicAddToBloomQuery (BREthereumLogTopic topic,
+                         BREthereumBloomQuery query);
+
+/**
+ * Add the topic for `address` to `query`; as per logTopicGetBloomFilterAddress()
+ */
+extern void
+logTopicAddToBloomQueryAddress (BREthereumAddress address,
+                                BREthereumBloomQuery query);
+
 extern BREthereumBoolean
 logTopicMatchesAddress (BREthereumLogTopic topic,
                         BREthereumAddress address);
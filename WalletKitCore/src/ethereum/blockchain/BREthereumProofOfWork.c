@@ -9,12 +9,27 @@
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
 #include <stdlib.h>
-#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "support/BRArray.h"
-#include "support/BRSet.h"
+#include "support/BRInt.h"
+#include "support/BRCrypto.h"
+#include "support/BROSCompat.h"
 #include "support/rlp/BRRlp.h"
 #include "BREthereumBlock.h"
 
+//
+// Ethash - https://github.com/ethereum/wiki/wiki/Ethash
+//
+// We are a light client; we never build the (multi-GB) dataset.  Instead we build the per-epoch
+// 'cache' (16MB growing by 128KB per epoch) and derive the 128 dataset items that a header's
+// `hashimoto` touches directly from the cache - that is `hashimoto_light`.
+//
 #define POW_WORD_BYTES            (4)
 #define POW_DATA_SET_INIT         (1 << 30)
 #define POW_DATA_SET_GROWTH       (1 << 23)
@@ -27,141 +42,571 @@
 #define POW_CACHE_ROUNDS          (3)
 #define POW_ACCESSES              (64)
 
-//
-// Proof Of Work
-//
-struct BREthereumProofOfWorkStruct {
-    int foo;
-};
+#define POW_HASH_WORDS            (POW_HASH_BYTES / POW_WORD_BYTES)    // 16
+#define POW_MIX_WORDS             (POW_MIX_BYTES  / POW_WORD_BYTES)    // 32
+#define POW_MIX_HASHES            (POW_MIX_BYTES  / POW_HASH_BYTES)    // 2
+#define POW_FNV_PRIME             (0x01000193)
 
-extern BREthereumProofOfWork
-proofOfWorkCreate (void) {
-    BREthereumProofOfWork pow = calloc (1, sizeof (struct BREthereumProofOfWorkStruct));
+// Start generating the next epoch's cache once a header is this close to the epoch boundary.
+// At ~15 seconds per block this is about 12 hours ahead.
+#define POW_EPOCH_LOOKAHEAD       (3000)
 
-    pow->foo = 0;
+// Keep the current and the next epoch's caches in memory
+#define POW_CACHES_IN_MEMORY      (2)
 
-    return pow;
+#define POW_EPOCH_NONE            (UINT64_MAX)
+
+#define POW_PTHREAD_NAME          ("Core Ethereum PoW")
+#define POW_PTHREAD_STACK_SIZE    (64 * 1024)
+
+// A persisted cache is `<path>/ethash-cache-<epoch>`; it starts with a fixed-size header, padded
+// such that the cache nodes themselves remain 64-byte aligned within the mapping.
+#define POW_CACHE_FILE_PREFIX     "ethash-cache"
+#define POW_CACHE_FILE_MAGIC      "ETHASHC1"
+#define POW_CACHE_FILE_HEADER     (64)
+
+static inline uint32_t
+powFNV (uint32_t v1, uint32_t v2) {
+    return (v1 * POW_FNV_PRIME) ^ v2;
 }
 
-extern void
-proofOfWorkRelease (BREthereumProofOfWork pow) {
-    free (pow);
+static int
+powIsPrime (uint64_t x) {
+    if (x < 2) return 0;
+    if (0 == x % 2) return 2 == x;
+    for (uint64_t d = 3; d * d <= x; d += 2)
+        if (0 == x % d) return 0;
+    return 1;
 }
 
-#if defined (INCLUDE_UNUSED_FUNCTIONS)
 static uint64_t
-powEpoch (BREthereumBlockHeader header) {
-    return blockHeaderGetNonce(header) / POW_EPOCH;
+powEpoch (uint64_t number) {
+    return number / POW_EPOCH;
 }
 
 static uint64_t
-powPrime (uint64_t x, uint64_t y) {
-    return (0 == x % y
-            ? x
-            : powPrime (x - 2 * y, y));
+powCacheSize (uint64_t epoch) {
+    uint64_t size = (uint64_t) POW_CACHE_INIT + (uint64_t) POW_CACHE_GROWTH * epoch - POW_HASH_BYTES;
+    while (!powIsPrime (size / POW_HASH_BYTES))
+        size -= 2 * POW_HASH_BYTES;
+    return size;
 }
 
 static uint64_t
-powDatasetSize (BREthereumBlockHeader header) {
-    return powPrime (POW_DATA_SET_INIT + POW_DATA_SET_GROWTH * powEpoch(header) - POW_MIX_BYTES,
-                     POW_MIX_BYTES);
+powDatasetSize (uint64_t epoch) {
+    uint64_t size = (uint64_t) POW_DATA_SET_INIT + (uint64_t) POW_DATA_SET_GROWTH * epoch - POW_MIX_BYTES;
+    while (!powIsPrime (size / POW_MIX_BYTES))
+        size -= 2 * POW_MIX_BYTES;
+    return size;
 }
 
-static uint64_t
-powCacheSize (BREthereumBlockHeader header) {
-    return powPrime (POW_CACHE_INIT + POW_CACHE_GROWTH * powEpoch(header) - POW_HASH_BYTES,
-                     POW_HASH_BYTES);
+static void
+powSeedHash (uint64_t epoch, uint8_t seed[32]) {
+    memset (seed, 0, 32);
+    for (uint64_t i = 0; i < epoch; i++)
+        BRKeccak256 (seed, seed, 32);
 }
 
-static BREthereumHash
-powSeedHashInternal (uint64_t number) {
-    BREthereumHash bytes;
+///
+/// MARK: - Cache Generation
+///
+/// Sequentially fill the cache with Keccak-512 of the seed hash and then apply
+/// POW_CACHE_ROUNDS of Sergio Demian Lerner's 'RandMemoHash'.
+///
+static void
+powCacheGenerate (uint8_t *cache, uint64_t size, uint64_t epoch) {
+    size_t n = (size_t) (size / POW_HASH_BYTES);
+    uint8_t seed[32], temp[POW_HASH_BYTES];
 
-    if (0 == number)
-        memset (bytes.bytes, 0, 32);
-    else
-        bytes = powSeedHashInternal(number - POW_EPOCH);
+    powSeedHash (epoch, seed);
 
-    return hashCreateFromData ((BRRlpData) { 32, bytes.bytes });
+    BRKeccak512 (&cache[0], seed, sizeof (seed));
+    for (size_t i = 1; i < n; i++)
+        BRKeccak512 (&cache[i * POW_HASH_BYTES], &cache[(i - 1) * POW_HASH_BYTES], POW_HASH_BYTES);
+
+    for (size_t round = 0; round < POW_CACHE_ROUNDS; round++)
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t *src = &cache[((i + n - 1) % n) * POW_HASH_BYTES];
+            const uint8_t *rnd = &cache[(UInt32GetLE (&cache[i * POW_HASH_BYTES]) % n) * POW_HASH_BYTES];
+
+            for (size_t k = 0; k < POW_HASH_BYTES; k++)
+                temp[k] = src[k] ^ rnd[k];
+
+            BRKeccak512 (&cache[i * POW_HASH_BYTES], temp, POW_HASH_BYTES);
+        }
 }
 
-static BREthereumHash
-powSeedHash (BREthereumBlockHeader header) {
-    return powSeedHashInternal(blockHeaderGetNumber(header));
+///
+/// MARK: - Hashimoto Light
+///
+
+// Compute dataset item `index` from the `cache` of `n` nodes; result as little-endian words.
+static void
+powDatasetItem (const uint8_t *cache, uint32_t n, uint32_t index, uint32_t item[POW_HASH_WORDS]) {
+    uint8_t mix[POW_HASH_BYTES];
+    uint32_t words[POW_HASH_WORDS];
+
+    memcpy (mix, &cache[(size_t) (index % n) * POW_HASH_BYTES], POW_HASH_BYTES);
+    UInt32SetLE (mix, UInt32GetLE (mix) ^ index);
+    BRKeccak512 (mix, mix, POW_HASH_BYTES);
+
+    for (size_t k = 0; k < POW_HASH_WORDS; k++)
+        words[k] = UInt32GetLE (&mix[k * POW_WORD_BYTES]);
+
+    for (uint32_t j = 0; j < POW_PARENTS; j++) {
+        const uint8_t *parent = &cache[(size_t) (powFNV (index ^ j, words[j % POW_HASH_WORDS]) % n) * POW_HASH_BYTES];
+        for (size_t k = 0; k < POW_HASH_WORDS; k++)
+            words[k] = powFNV (words[k], UInt32GetLE (&parent[k * POW_WORD_BYTES]));
+    }
+
+    for (size_t k = 0; k < POW_HASH_WORDS; k++)
+        UInt32SetLE (&mix[k * POW_WORD_BYTES], words[k]);
+    BRKeccak512 (mix, mix, POW_HASH_BYTES);
+
+    for (size_t k = 0; k < POW_HASH_WORDS; k++)
+        item[k] = UInt32GetLE (&mix[k * POW_WORD_BYTES]);
+}
+
+static void
+powHashimotoLight (const uint8_t *cache,
+                   uint64_t cacheSize,
+                   uint64_t datasetSize,
+                   const uint8_t hash[32],
+                   uint64_t nonce,
+                   uint8_t digest[32],
+                   uint8_t result[32]) {
+    uint32_t cacheNodes = (uint32_t) (cacheSize / POW_HASH_BYTES);
+    uint32_t rows       = (uint32_t) (datasetSize / POW_MIX_BYTES);
+
+    // s = Keccak512 (hash ++ nonce), with the nonce little-endian
+    uint8_t seed[32 + 8], s[POW_HASH_BYTES + 32];
+    memcpy (seed, hash, 32);
+    UInt64SetLE (&seed[32], nonce);
+    BRKeccak512 (s, seed, sizeof (seed));
+
+    uint32_t mix[POW_MIX_WORDS], item[POW_MIX_WORDS];
+    for (size_t k = 0; k < POW_MIX_WORDS; k++)
+        mix[k] = UInt32GetLE (&s[(k % POW_HASH_WORDS) * POW_WORD_BYTES]);
+
+    uint32_t s0 = mix[0];
+    for (uint32_t i = 0; i < POW_ACCESSES; i++) {
+        uint32_t p = (powFNV (i ^ s0, mix[i % POW_MIX_WORDS]) % rows) * POW_MIX_HASHES;
+        for (uint32_t h = 0; h < POW_MIX_HASHES; h++)
+            powDatasetItem (cache, cacheNodes, p + h, &item[h * POW_HASH_WORDS]);
+        for (size_t k = 0; k < POW_MIX_WORDS; k++)
+            mix[k] = powFNV (mix[k], item[k]);
+    }
+
+    // Compress the mix to 8 words; that is the 'mix digest'
+    for (size_t k = 0; k < POW_MIX_WORDS / 4; k++)
+        UInt32SetLE (&digest[k * POW_WORD_BYTES],
+                     powFNV (powFNV (powFNV (mix[4 * k], mix[4 * k + 1]), mix[4 * k + 2]), mix[4 * k + 3]));
+
+    // result = Keccak256 (s ++ digest)
+    memcpy (&s[POW_HASH_BYTES], digest, 32);
+    BRKeccak256 (result, s, sizeof (s));
+}
+
+///
+/// MARK: - Cache
+///
+typedef struct {
+    uint64_t epoch;
+    uint64_t size;
+    uint8_t *bytes;
+
+    /// The mmap() region holding `bytes`, or NULL if `bytes` is malloc()ed.
+    void *map;
+    size_t mapSize;
+
+    /// For LRU replacement
+    uint64_t used;
+
+    /// One for being installed in `pow->caches`, plus one per in-progress `hashimoto`.  Protected
+    /// by `pow->lock`; the last reference releases the cache.
+    size_t refs;
+} BREthereumProofOfWorkCache;
+
+static void
+powCacheRelease (BREthereumProofOfWorkCache *cache) {
+    if (NULL != cache->map) munmap (cache->map, cache->mapSize);
+    else if (NULL != cache->bytes) free (cache->bytes);
+
+    memset (cache, 0, sizeof (BREthereumProofOfWorkCache));
+    free (cache);
+}
+
+static void
+powCacheGive (BREthereumProofOfWorkCache *cache) {
+    if (0 == --cache->refs)
+        powCacheRelease (cache);
+}
+
+static char *
+powCacheFilename (const char *path, uint64_t epoch, const char *suffix) {
+    size_t filenameLength = strlen (path) + 1 + strlen (POW_CACHE_FILE_PREFIX) + 1 + 20 + strlen (suffix) + 1;
+    char  *filename       = malloc (filenameLength);
+    snprintf (filename, filenameLength, "%s/%s-%llu%s", path, POW_CACHE_FILE_PREFIX, (unsigned long long) epoch, suffix);
+    return filename;
+}
+
+static void
+powCacheFileHeaderFill (uint8_t header[POW_CACHE_FILE_HEADER], uint64_t epoch, uint64_t size) {
+    memset (header, 0, POW_CACHE_FILE_HEADER);
+    memcpy (&header[0], POW_CACHE_FILE_MAGIC, 8);
+    UInt64SetLE (&header[ 8], epoch);
+    UInt64SetLE (&header[16], size);
+}
+
+static int
+powCacheLoad (BREthereumProofOfWorkCache *cache, const char *filename, uint64_t epoch, uint64_t size) {
+    size_t mapSize = (size_t) (POW_CACHE_FILE_HEADER + size);
+    uint8_t header[POW_CACHE_FILE_HEADER];
+    struct stat status;
+
+    int fd = open (filename, O_RDONLY);
+    if (-1 == fd) return 0;
+
+    if (0 != fstat (fd, &status) || (off_t) mapSize != status.st_size) { close (fd); return 0; }
+
+    void *map = mmap (NULL, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (MAP_FAILED == map) return 0;
+
+    // The header is written last; a mismatch implies an interrupted or foreign file
+    powCacheFileHeaderFill (header, epoch, size);
+    if (0 != memcmp (map, header, POW_CACHE_FILE_HEADER)) { munmap (map, mapSize); return 0; }
+
+    cache->epoch   = epoch;
+    cache->size    = size;
+    cache->map     = map;
+    cache->mapSize = mapSize;
+    cache->bytes   = (uint8_t *) map + POW_CACHE_FILE_HEADER;
+    return 1;
+}
+
+static int
+powCacheCreateMapped (BREthereumProofOfWorkCache *cache, const char *filename, uint64_t epoch, uint64_t size) {
+    size_t mapSize = (size_t) (POW_CACHE_FILE_HEADER + size);
+    char  *tmpname = malloc (strlen (filename) + 5);
+    sprintf (tmpname, "%s.tmp", filename);
+
+    int fd = open (tmpname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (-1 == fd) { free (tmpname); return 0; }
+
+    void *map = (0 == ftruncate (fd, (off_t) mapSize)
+                 ? mmap (NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                 : MAP_FAILED);
+    close (fd);
+
+    if (MAP_FAILED == map) { unlink (tmpname); free (tmpname); return 0; }
+
+    powCacheGenerate ((uint8_t *) map + POW_CACHE_FILE_HEADER, size, epoch);
+    powCacheFileHeaderFill (map, epoch, size);
+
+    // Only a complete, synced file gets the epoch's name.  If either fails we still have a
+    // perfectly good in-memory cache; we just won't find it on the next start.
+    if (0 != msync (map, mapSize, MS_SYNC) || 0 != rename (tmpname, filename))
+        unlink (tmpname);
+    free (tmpname);
+
+    cache->epoch   = epoch;
+    cache->size    = size;
+    cache->map     = map;
+    cache->mapSize = mapSize;
+    cache->bytes   = (uint8_t *) map + POW_CACHE_FILE_HEADER;
+    return 1;
+}
+
+static BREthereumProofOfWorkCache *
+powCacheCreate (const char *path, uint64_t epoch) {
+    BREthereumProofOfWorkCache *cache = calloc (1, sizeof (BREthereumProofOfWorkCache));
+
+    uint64_t size = powCacheSize (epoch);
+
+    if (NULL != path) {
+        char *filename = powCacheFilename (path, epoch, "");
+        int   success  = (powCacheLoad         (cache, filename, epoch, size) ||
+                          powCacheCreateMapped (cache, filename, epoch, size));
+        free (filename);
+
+        if (success) {
+            // Caches two or more epochs back are never needed again.
+            if (epoch >= 2) {
+                char *stale = powCacheFilename (path, epoch - 2, "");
+                unlink (stale);
+                free (stale);
+            }
+            return cache;
+        }
+    }
+
+    // No path or no file system; hold the cache in memory only.
+    cache->epoch = epoch;
+    cache->size  = size;
+    cache->bytes = malloc ((size_t) size);
+    powCacheGenerate (cache->bytes, size, epoch);
+    return cache;
+}
+
+//
+// Proof Of Work
+//
+struct BREthereumProofOfWorkStruct {
+    /// The directory for persisted caches; NULL if caches are not persisted.
+    char *path;
+
+    /// The installed caches; an empty slot is NULL.
+    BREthereumProofOfWorkCache *caches[POW_CACHES_IN_MEMORY];
+    uint64_t used;
+
+    /// The epochs currently being generated, by any thread.
+    BRArrayOf(uint64_t) generating;
+
+    /// The epoch requested of the background thread, or POW_EPOCH_NONE.
+    uint64_t requested;
+
+    pthread_t thread;
+    int threadQuit;
+
+    /// Protects all of the above; signalled when a cache is installed or a request is made.
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+};
+
+static BREthereumProofOfWorkCache *
+powCacheLookup (BREthereumProofOfWork pow, uint64_t epoch) {
+    for (size_t index = 0; index < POW_CACHES_IN_MEMORY; index++)
+        if (NULL != pow->caches[index] && epoch == pow->caches[index]->epoch) {
+            pow->caches[index]->used = ++pow->used;
+            return pow->caches[index];
+        }
+    return NULL;
+}
+
+static int
+powCacheIsGenerating (BREthereumProofOfWork pow, uint64_t epoch) {
+    for (size_t index = 0; index < array_count (pow->generating); index++)
+        if (epoch == pow->generating[index]) return 1;
+    return 0;
+}
+
+static void
+powCacheInstall (BREthereumProofOfWork pow, BREthereumProofOfWorkCache *cache) {
+    size_t victim = 0;
+    for (size_t index = 0; index < POW_CACHES_IN_MEMORY; index++) {
+        if (NULL == pow->caches[index]) { victim = index; break; }
+        if (pow->caches[index]->used < pow->caches[victim]->used)
+            victim = index;
+    }
+
+    // A victim still in use by `proofOfWorkCompute()` is released by its last user.
+    if (NULL != pow->caches[victim]) powCacheGive (pow->caches[victim]);
+
+    cache->refs = 1;
+    cache->used = ++pow->used;
+    pow->caches[victim] = cache;
 }
 
-static BREthereumData
-powLittleRMH (BREthereumData x, uint64_t i, uint64_t n) {
-    return x;
+// Generate (or load) and install the cache for `epoch`.  Called with `pow->lock` held and with
+// `epoch` not already being generated; the lock is released during the (slow) generation.
+static void
+powCacheGenerateAndInstall (BREthereumProofOfWork pow, uint64_t epoch) {
+    array_add (pow->generating, epoch);
+    pthread_mutex_unlock (&pow->lock);
+
+    BREthereumProofOfWorkCache *cache = powCacheCreate (pow->path, epoch);
+
+    pthread_mutex_lock (&pow->lock);
+    powCacheInstall (pow, cache);
+    for (size_t index = 0; index < array_count (pow->generating); index++)
+        if (epoch == pow->generating[index]) {
+            array_rm (pow->generating, index);
+            break;
+        }
+    pthread_cond_broadcast (&pow->cond);
 }
 
-static BREthereumData
-powBigRMH (BREthereumData x, uint64_t n) {
-    for (uint64_t i = 0; i < n; i++)
-        powLittleRMH(x, i, n);
-    return x;
+// Return the cache for `epoch`, generating it if needed, with a reference taken for the caller;
+// give it back with `powCacheGive()`.  Only waits on a generation of this same `epoch`.  Called
+// with `pow->lock` held.
+static BREthereumProofOfWorkCache *
+powCacheAcquire (BREthereumProofOfWork pow, uint64_t epoch) {
+    BREthereumProofOfWorkCache *cache;
+
+    while (NULL == (cache = powCacheLookup (pow, epoch))) {
+        if (!powCacheIsGenerating (pow, epoch))
+            powCacheGenerateAndInstall (pow, epoch);
+        else
+            pthread_cond_wait (&pow->cond, &pow->lock);
+    }
+
+    cache->refs += 1;
+    return cache;
 }
 
-static BREthereumData
-powCacheRounds (BREthereumData x, uint64_t y, uint64_t n) {
-    return (0 == y
-            ? x
-            : (1 == y
-               ? powBigRMH (x, n)
-               : powCacheRounds (powBigRMH (x, n), y - 1, n)));
+static void *
+powThread (BREthereumProofOfWork pow) {
+    pthread_setname_brd (pthread_self(), POW_PTHREAD_NAME);
+
+    pthread_mutex_lock (&pow->lock);
+    while (!pow->threadQuit) {
+        if (POW_EPOCH_NONE != pow->requested) {
+            uint64_t epoch = pow->requested;
+            pow->requested = POW_EPOCH_NONE;
+
+            if (NULL == powCacheLookup (pow, epoch) && !powCacheIsGenerating (pow, epoch))
+                powCacheGenerateAndInstall (pow, epoch);
+        }
+        else pthread_cond_wait (&pow->cond, &pow->lock);
+    }
+    pthread_mutex_unlock (&pow->lock);
+
+    return NULL;
 }
 
+// Ask the background thread for the cache of `epoch`.  Called with `pow->lock` held.
 static void
-powBigFNV (BREthereumData x,
-           BREthereumData y) {
+powCacheRequest (BREthereumProofOfWork pow, uint64_t epoch) {
+    for (size_t index = 0; index < POW_CACHES_IN_MEMORY; index++)
+        if (NULL != pow->caches[index] && epoch == pow->caches[index]->epoch) return;
+
+    if (epoch == pow->requested || powCacheIsGenerating (pow, epoch)) return;
+
+    pow->requested = epoch;
+
+    if (PTHREAD_NULL == pow->thread) {
+        pthread_attr_t attr;
+        pthread_attr_init (&attr);
+        pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_JOINABLE);
+        pthread_attr_setstacksize (&attr, POW_PTHREAD_STACK_SIZE);
+
+        if (0 != pthread_create (&pow->thread, &attr, (ThreadRoutine) powThread, pow))
+            pow->thread = PTHREAD_NULL;  // `proofOfWorkCompute()` will generate synchronously.
+        pthread_attr_destroy (&attr);
+    }
+
+    pthread_cond_broadcast (&pow->cond);
 }
 
-static BREthereumData
-powMix (BREthereumData m,
-        BREthereumData c,
-        uint64_t i,
-        uint64_t p) {
-    return (0 == p
-            ? m
-            : m);
+extern BREthereumProofOfWork
+proofOfWorkCreate (void) {
+    return proofOfWorkCreateWithPath (NULL);
 }
 
-static BREthereumData
-powParents (BREthereumData c,
-            uint64_t i,
-            uint64_t p,
-            BREthereumData m) {
-    return (p < POW_PARENTS - 1
-            ? powParents(c, i, p + 1, powMix (m, c, i, p + 1))
-            : powMix (m, c, i, p + 1));
+extern BREthereumProofOfWork
+proofOfWorkCreateWithPath (const char *path) {
+    BREthereumProofOfWork pow = calloc (1, sizeof (struct BREthereumProofOfWorkStruct));
+
+    pow->path = (NULL == path || 0 == strlen (path) ? NULL : strdup (path));
+
+    for (size_t index = 0; index < POW_CACHES_IN_MEMORY; index++)
+        pow->caches[index] = NULL;
+    pow->used = 0;
+
+    array_new (pow->generating, POW_CACHES_IN_MEMORY);
+    pow->requested = POW_EPOCH_NONE;
+
+    pow->thread = PTHREAD_NULL;
+    pow->threadQuit = 0;
+
+    pthread_mutex_init_brd (&pow->lock, PTHREAD_MUTEX_NORMAL);
+    pthread_cond_init (&pow->cond, NULL);
+
+    return pow;
 }
 
-static BREthereumData
-powDatasetItem (BREthereumData c,
-                uint64_t i) {
-    return powParents(c, i, -i, (BREthereumData) { 0, NULL });
+extern void
+proofOfWorkRelease (BREthereumProofOfWork pow) {
+    pthread_mutex_lock (&pow->lock);
+    pow->threadQuit = 1;
+    pthread_cond_broadcast (&pow->cond);
+    pthread_mutex_unlock (&pow->lock);
+
+    // An in-progress generation completes (and is persisted) before the thread exits.
+    if (PTHREAD_NULL != pow->thread)
+        pthread_join (pow->thread, NULL);
+
+    for (size_t index = 0; index < POW_CACHES_IN_MEMORY; index++)
+        if (NULL != pow->caches[index]) powCacheGive (pow->caches[index]);
+    array_free (pow->generating);
+
+    pthread_cond_destroy  (&pow->cond);
+    pthread_mutex_destroy (&pow->lock);
+
+    if (NULL != pow->path) free (pow->path);
+    free (pow);
 }
-// On and On and On....
-#endif
 
 extern void
-proofOfWorkGenerate(BREthereumProofOfWork pow,
-                       BREthereumBlockHeader header) {
-    //
+proofOfWorkGenerate (BREthereumProofOfWork pow,
+                     BREthereumBlockHeader header) {
+    uint64_t number = blockHeaderGetNumber (header);
+    uint64_t epoch  = powEpoch (number);
+
+    pthread_mutex_lock (&pow->lock);
+    if (number % POW_EPOCH >= POW_EPOCH - POW_EPOCH_LOOKAHEAD)
+        powCacheRequest (pow, epoch + 1);
+    else
+        powCacheRequest (pow, epoch);
+    pthread_mutex_unlock (&pow->lock);
+}
+
+static BREthereumHash
+powHeaderHashWithoutNonce (BREthereumBlockHeader header) {
+    BRRlpCoder coder = rlpCoderCreate();
+    BRRlpItem  item  = blockHeaderRlpEncode (header, ETHEREUM_BOOLEAN_FALSE, RLP_TYPE_NETWORK, coder);
+
+    BREthereumHash hash = ethHashCreateFromData (rlpItemGetDataSharedDontRelease (coder, item));
+
+    rlpItemRelease (coder, item);
+    rlpCoderRelease (coder);
+
+    return hash;
 }
 
 extern void
 proofOfWorkCompute (BREthereumProofOfWork pow,
-                       BREthereumBlockHeader header,
-                       UInt256 *n,
-                       BREthereumHash *m) {
+                    BREthereumBlockHeader header,
+                    UInt256 *n,
+                    BREthereumHash *m) {
     assert (NULL != n && NULL != m);
 
-    // On and on and on
+    // A header without difficulty is not sealed by Ethash (post-merge); report 'no POW'.
+    if (uint256EQL (blockHeaderGetDifficulty (header), UINT256_ZERO)) {
+        *n = UINT256_ZERO;
+        *m = EMPTY_HASH_INIT;
+        return;
+    }
+
+    uint64_t number = blockHeaderGetNumber (header);
+    uint64_t epoch  = powEpoch (number);
+
+    BREthereumHash hash = powHeaderHashWithoutNonce (header);
+    uint8_t result[32];
+
+    pthread_mutex_lock (&pow->lock);
+
+    // Get ahead of the epoch boundary so that the first header of the next epoch won't wait.
+    if (number % POW_EPOCH >= POW_EPOCH - POW_EPOCH_LOOKAHEAD)
+        powCacheRequest (pow, epoch + 1);
+
+    BREthereumProofOfWorkCache *cache = powCacheAcquire (pow, epoch);
+    pthread_mutex_unlock (&pow->lock);
+
+    // Hash without the lock; our reference keeps `cache` alive even if it is evicted meanwhile.
+    powHashimotoLight (cache->bytes,
+                       cache->size,
+                       powDatasetSize (epoch),
+                       hash.bytes,
+                       blockHeaderGetNonce (header),
+                       m->bytes,
+                       result);
 
-    // TODO: Actually compute something.
+    pthread_mutex_lock (&pow->lock);
+    powCacheGive (cache);
+    pthread_mutex_unlock (&pow->lock);
 
-    // For now, return values that allow subsequent use to succeed
-    *n = UINT256_ZERO;
-    *m = blockHeaderGetMixHash (header);
+    // The result is a big-endian 256-bit number; UInt256 holds little-endian.
+    *n = UInt256Reverse (UInt256Get (result));
 }
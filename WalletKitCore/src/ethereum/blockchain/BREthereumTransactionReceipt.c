@@ -71,10 +71,16 @@ transactionReceiptMatch (BREthereumTransactionReceipt receipt,
     return bloomFilterMatch(receipt->bloomFilter, filter);
 }
 
+extern BREthereumBoolean
+transactionReceiptMatchQuery (BREthereumTransactionReceipt receipt,
+                              BREthereumBloomQuery query) {
+    return bloomQueryMatch (query, &receipt->bloomFilter);
+}
+
 extern BREthereumBoolean
 transactionReceiptMatchAddress (BREthereumTransactionReceipt receipt,
                                 BREthereumAddress address) {
-    return transactionReceiptMatch(receipt, logTopicGetBloomFilterAddress(address));
+    return bloomFilterMatchHash (&receipt->bloomFilter, logTopicGetBloomHashAddress (address));
 }
 
 extern void
@@ -46,6 +46,10 @@ extern BREthereumBoolean
 transactionReceiptMatch (BREthereumTransactionReceipt receipt,
                          BREthereumBloomFilter filter);
 
+extern BREthereumBoolean
+transactionReceiptMatchQuery (BREthereumTransactionReceipt receipt,
+                              BREthereumBloomQuery query);
+
 extern BREthereumBoolean
 transactionReceiptMatchAddress (BREthereumTransactionReceipt receipt,
                                 BREthereumAddress address);
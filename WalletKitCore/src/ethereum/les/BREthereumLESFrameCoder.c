@@ -9,6 +9,7 @@
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
 #include <stdlib.h>
+#include <pthread.h>
 #include "support/BRArray.h"
 #include "support/BRCrypto.h"
 #include "support/BRKey.h"
@@ -51,15 +52,13 @@ struct BREthereumLESFrameCoderContext {
     //Encrpty Key for AES-CTR frame
     uint8_t* aesEncryptKey;
     
-    //AES Cipher Total Amount
-    size_t aesEncryptCipherLen;
-
     //Decrypty Key for AES-CTR frame
     uint8_t* aesDecryptKey;
-    
-    //Decrypt Cipher Total Amount
-    size_t aesDecrptyCipherLen;
-    
+
+    // AES-256 round keys, expanded once in frameCoderInit() rather than for every block, for the
+    // header/frame MACs (mac-secret) and for the egress/ingress AES-CTR streams (aes-secret)
+    uint8_t macRoundKeys[15][16];
+    uint8_t aesRoundKeys[15][16];
 };
 
 //
@@ -122,44 +121,6 @@ static const uint8_t sboxi[256] = {
 
 #define xt(x) (((x) << 1) ^ ((((x) >> 7) & 1)*0x1b))
 
-static void _BRAES256ECBEncrypt(const void *key32, void *buf16)
-{
-    size_t i, j;
-    uint32_t key[32/4], buf[16/4];
-    uint8_t *x = (uint8_t *)buf, *k = (uint8_t *)key, r = 1, a, b, c, d, e;
-    
-    memcpy(key, key32, sizeof(key));
-    memcpy(buf, buf16, sizeof(buf));
-    
-    for (i = 0; i < 14; i++) {
-        for (j = 0; j < 4; j++) buf[j] ^= key[j + (i & 1)*4]; // add round key
-        
-        for (j = 0; j < 16; j++) x[j] = sbox[x[j]]; // sub bytes
-        
-        // shift rows
-        a = x[1], x[1] = x[5], x[5] = x[9], x[9] = x[13], x[13] = a, a = x[10], x[10] = x[2], x[2] = a;
-        a = x[3], x[3] = x[15], x[15] = x[11], x[11] = x[7], x[7] = a, a = x[14], x[14] = x[6], x[6] = a;
-        
-        for (j = 0; i < 13 && j < 16; j += 4) { // mix columns
-            a = x[j], b = x[j + 1], c = x[j + 2], d = x[j + 3], e = a ^ b ^ c ^ d;
-            x[j] ^= e ^ xt(a ^ b), x[j + 1] ^= e ^ xt(b ^ c), x[j + 2] ^= e ^ xt(c ^ d), x[j + 3] ^= e ^ xt(d ^ a);
-        }
-        
-        if ((i % 2) != 0) { // expand key
-            k[0] ^= sbox[k[29]] ^ r, k[1] ^= sbox[k[30]], k[2] ^= sbox[k[31]], k[3] ^= sbox[k[28]], r = xt(r);
-            for (j = 4; j < 16; j++) k[j] ^= k[j - 4];
-            k[16] ^= sbox[k[12]], k[17] ^= sbox[k[13]], k[18] ^= sbox[k[14]], k[19] ^= sbox[k[15]];
-            for (j = 20; j < 32; j++) k[j] ^= k[j - 4];
-        }
-    }
-    
-    var_clean(&r, &a, &b, &c, &d, &e);
-    for (i = 0; i < 4; i++) buf[i] ^= key[i]; // final add round key
-    mem_clean(key, sizeof(key));
-    memcpy(buf16, buf, sizeof(buf));
-    mem_clean(buf, sizeof(buf));
-}
-
 #pragma clang diagnostic push
 #pragma GCC diagnostic push
 #pragma clang diagnostic ignored "-Wunused-function"
@@ -212,10 +173,111 @@ static void _BRAES256ECBDecrypt(const void *key32, void *buf16)
 }
 #pragma clang diagnostic pop
 #pragma GCC diagnostic pop
+
+// expands key32 into the 15 round keys used by _BRAES256ECBEncryptExpanded(); this is the key schedule that
+// _BRAES256ECBDecrypt() computes on the fly, run forwards
+static void _BRAES256ExpandKey(const void *key32, uint8_t roundKeys[15][16])
+{
+    size_t i, j;
+    uint8_t k[32], r = 1;
+    
+    memcpy(k, key32, sizeof(k));
+    
+    for (i = 0; i < 14; i++) {
+        memcpy(roundKeys[i], &k[(i & 1)*16], 16);
+        
+        if ((i % 2) != 0) { // expand key
+            k[0] ^= sbox[k[29]] ^ r, k[1] ^= sbox[k[30]], k[2] ^= sbox[k[31]], k[3] ^= sbox[k[28]], r = xt(r);
+            for (j = 4; j < 16; j++) k[j] ^= k[j - 4];
+            k[16] ^= sbox[k[12]], k[17] ^= sbox[k[13]], k[18] ^= sbox[k[14]], k[19] ^= sbox[k[15]];
+            for (j = 20; j < 32; j++) k[j] ^= k[j - 4];
+        }
+    }
+    
+    memcpy(roundKeys[14], k, 16);
+    var_clean(&r);
+    mem_clean(k, sizeof(k));
+}
+
+// T-table for the combined sub bytes and mix columns steps, one little-endian column per entry, (2s, s, s, 3s) for
+// row 0; rows 1-3 use the same entry rotated left by 8, 16 and 24 bits
+static uint32_t aesTable[256];
+static pthread_once_t aesTableOnce = PTHREAD_ONCE_INIT;
+
+static void _BRAESTableInit(void)
+{
+    for (size_t i = 0; i < 256; i++) {
+        uint32_t s = sbox[i], s2 = (uint8_t)xt(sbox[i]), s3 = s2 ^ s;
+        aesTable[i] = s2 | (s << 8) | (s << 16) | (s3 << 24);
+    }
+}
+
+#define rol32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define aesColumn(c, j) (aesTable[(c)[(j)] & 0xff] ^ rol32(aesTable[((c)[((j) + 1) % 4] >> 8) & 0xff], 8) ^\
+                         rol32(aesTable[((c)[((j) + 2) % 4] >> 16) & 0xff], 16) ^ rol32(aesTable[(c)[((j) + 3) % 4] >> 24], 24))
+#define aesSubColumn(c, j) ((uint32_t)sbox[(c)[(j)] & 0xff] | (uint32_t)sbox[((c)[((j) + 1) % 4] >> 8) & 0xff] << 8 |\
+                            (uint32_t)sbox[((c)[((j) + 2) % 4] >> 16) & 0xff] << 16 | (uint32_t)sbox[(c)[((j) + 3) % 4] >> 24] << 24)
+
+// AES-256 encrypts a single block using pre-expanded round keys, with each round done as table lookups on the state's
+// four columns
+static void _BRAES256ECBEncryptExpanded(uint8_t roundKeys[15][16], void *buf16)
+{
+    uint32_t x[4], c[4];
+    uint8_t *y = buf16;
+    size_t i, j;
+    
+    for (j = 0; j < 4; j++) x[j] = UInt32GetLE(&y[j*4]) ^ UInt32GetLE(&roundKeys[0][j*4]); // add round key
+    
+    for (i = 1; i < 14; i++) { // sub bytes, shift rows, mix columns, add round key
+        c[0] = aesColumn(x, 0), c[1] = aesColumn(x, 1), c[2] = aesColumn(x, 2), c[3] = aesColumn(x, 3);
+        for (j = 0; j < 4; j++) x[j] = c[j] ^ UInt32GetLE(&roundKeys[i][j*4]);
+    }
+    
+    // final round, no mix columns
+    c[0] = aesSubColumn(x, 0), c[1] = aesSubColumn(x, 1), c[2] = aesSubColumn(x, 2), c[3] = aesSubColumn(x, 3);
+    for (j = 0; j < 4; j++) UInt32SetLE(&y[j*4], c[j] ^ UInt32GetLE(&roundKeys[14][j*4]));
+    mem_clean(x, sizeof(x));
+    mem_clean(c, sizeof(c));
+}
+
+// AES-256-CTR encrypts/decrypts len bytes of buf in place, advancing the counter in iv16 by one for each (partial) block
+static void _BRAES256CTRExpanded(uint8_t roundKeys[15][16], uint8_t *iv16, uint8_t *buf, size_t len)
+{
+    uint8_t x[16];
+    size_t i, j;
+    
+    for (i = 0; i < len; i += 16) {
+        memcpy(x, iv16, 16);
+        _BRAES256ECBEncryptExpanded(roundKeys, x);
+        j = 16;
+        do { iv16[--j]++; } while (iv16[j] == 0 && j > 0); // increment iv with overflow
+        for (j = 0; j < 16 && i + j < len; j++) buf[i + j] ^= x[j];
+    }
+    
+    mem_clean(x, sizeof(x));
+}
+
+// updates mac with aes(mac-secret, mac.digest()[0..15]) ^ seed16, where seed16 is that same digest if NULL, and returns
+// the first 16 bytes of the new digest
+static void _frameCoderUpdateMac(BREthereumLESFrameCoder fCoder, BRKeccak mac, const uint8_t *seed16, uint8_t *mac16)
+{
+    uint8_t digest[32], x[16];
+    
+    keccak_digest(mac, digest);
+    memcpy(x, digest, 16);
+    _BRAES256ECBEncryptExpanded(fCoder->macRoundKeys, x);
+    bytesXOR(x, (uint8_t *) (NULL != seed16 ? seed16 : digest), x, 16);
+    keccak_update(mac, x, 16);
+    keccak_digest(mac, digest);
+    memcpy(mac16, digest, 16);
+}
+
 //
 // Public Functions
 //
 BREthereumLESFrameCoder frameCoderCreate(void) {
+    pthread_once (&aesTableOnce, _BRAESTableInit);
+
     BREthereumLESFrameCoder coder = (BREthereumLESFrameCoder) calloc (1, sizeof(struct BREthereumLESFrameCoderContext));
     coder->aesDecryptKey = NULL;
     coder->aesEncryptKey = NULL;
@@ -275,12 +337,12 @@ BREthereumBoolean frameCoderInit(BREthereumLESFrameCoder fcoder,
     array_new(fcoder->aesEncryptKey, 32);
     array_add_array(fcoder->aesDecryptKey, &keyMaterial[32], 32);
     array_add_array(fcoder->aesEncryptKey, &keyMaterial[32], 32);
-    fcoder->aesDecrptyCipherLen = 0;
-    fcoder->aesEncryptCipherLen = 0;
+    _BRAES256ExpandKey(&keyMaterial[32], fcoder->aesRoundKeys);
 
     // mac-secret = sha3(ecdhe-shared-secret || aes-secret)
     BRKeccak256(&keyMaterial[32], keyMaterial, 64);
     memcpy(fcoder->macSecretKey.u8,&keyMaterial[32], 32);
+    _BRAES256ExpandKey(fcoder->macSecretKey.u8, fcoder->macRoundKeys);
     
     // Initiator:
     // egress-mac = sha3.update(mac-secret ^ recipient-nonce || auth-sent-init)
@@ -359,78 +421,54 @@ void frameCoderRelease(BREthereumLESFrameCoder fcoder) {
     if(fcoder->ingressMac != NULL){
         keccak_release(fcoder->ingressMac);
     }
+    mem_clean(fcoder, sizeof(struct BREthereumLESFrameCoderContext));
     free(fcoder);
 }
 
-void frameCoderEncrypt(BREthereumLESFrameCoder fCoder, uint8_t* payload, size_t payloadSize, uint8_t** rlpBytes, size_t * rlpBytesSize) {
-
-    uint8_t headerPlain[HEADER_LEN] = {(uint8_t)((payloadSize >> 16) & 0xff), (uint8_t)((payloadSize >> 8) & 0xff), (uint8_t)(payloadSize & 0xff), 0xc2, 0x80, 0x80, 0};
-    
-    uint8_t headerCipher[HEADER_LEN];
-    fCoder->aesEncryptCipherLen += HEADER_LEN;
-    BRAESCTR_OFFSET(headerCipher, HEADER_LEN, fCoder->aesEncryptKey, 32, fCoder->ivEnc.u8, headerPlain, fCoder->aesEncryptCipherLen);
-    
-    // Encrypt HEADER-MAC
-    uint8_t egressDigest[32];
-    keccak_digest(fCoder->egressMac, egressDigest);
-
-    uint8_t macSecret[HEADER_LEN];
-    memcpy(macSecret, egressDigest, HEADER_LEN);
-   _BRAES256ECBEncrypt(fCoder->macSecretKey.u8, macSecret);
-   
-    uint8_t xORMacCipher[16];
-    bytesXOR(macSecret, headerCipher, xORMacCipher, 16);
+size_t frameCoderEncryptedSize(size_t payloadSize) {
+    // header_cipher + header_mac + frame_cipher (payload + padding) + frame_mac
+    return HEADER_LEN + MAC_LEN + payloadSize + (16 - (payloadSize % 16)) % 16 + MAC_LEN;
+}
 
-    keccak_update(fCoder->egressMac, xORMacCipher, 16);
-    
-    keccak_digest(fCoder->egressMac, egressDigest);
+void frameCoderEncryptInto(BREthereumLESFrameCoder fCoder, const uint8_t* payload, size_t payloadSize, uint8_t* frame) {
+
+    size_t frameDataSize = payloadSize + (16 - (payloadSize % 16)) % 16;
+    uint8_t* headerCipher = frame;
+    uint8_t* headerMac = &frame[HEADER_LEN];
+    uint8_t* frameCipher = &frame[HEADER_LEN + MAC_LEN];
+    uint8_t* frameMac = &frameCipher[frameDataSize];
+    
+    // The header and frame are encrypted in place, in `frame`.
+    memset(headerCipher, 0, HEADER_LEN);
+    headerCipher[0] = (uint8_t)((payloadSize >> 16) & 0xff);
+    headerCipher[1] = (uint8_t)((payloadSize >> 8) & 0xff);
+    headerCipher[2] = (uint8_t)(payloadSize & 0xff);
+    headerCipher[3] = 0xc2;
+    headerCipher[4] = 0x80;
+    headerCipher[5] = 0x80;
+    _BRAES256CTRExpanded(fCoder->aesRoundKeys, fCoder->ivEnc.u8, headerCipher, HEADER_LEN);
+    
+    // header-mac = egress-mac.update(aes(mac-secret, egress-mac.digest) ^ header-ciphertext).digest
+    _frameCoderUpdateMac(fCoder, fCoder->egressMac, headerCipher, headerMac);
+    
+    memmove(frameCipher, payload, payloadSize);
+    memset(&frameCipher[payloadSize], 0, frameDataSize - payloadSize);
+    _BRAES256CTRExpanded(fCoder->aesRoundKeys, fCoder->ivEnc.u8, frameCipher, frameDataSize);
+    
+    // frame-mac = egress-mac.update(aes(mac-secret, egress-mac.update(frame-ciphertext).digest) ^ fmac-seed).digest
+    keccak_update(fCoder->egressMac, frameCipher, frameDataSize);
+    _frameCoderUpdateMac(fCoder, fCoder->egressMac, NULL, frameMac);
+}
 
-    uint8_t headerMac[16];
-    memcpy(headerMac, egressDigest, 16);
+void frameCoderEncrypt(BREthereumLESFrameCoder fCoder, uint8_t* payload, size_t payloadSize, uint8_t** rlpBytes, size_t * rlpBytesSize) {
 
-    //Allocate the oBytes and oBytesSize
-    size_t payloadPadding = (16 - (payloadSize % 16)) % 16;
-    size_t oBytesSize = 32 + payloadSize + payloadPadding + 16; // header_cipher + headerMac + payload + padding + frameMac
-    
+    size_t oBytesSize = frameCoderEncryptedSize(payloadSize);
     uint8_t * oBytes = (uint8_t*)malloc(oBytesSize);
 
-    memcpy(oBytes, headerCipher, HEADER_LEN);
-    memcpy(&oBytes[HEADER_LEN], headerMac, HEADER_LEN);
-    
-    uint8_t * frameCipher = &oBytes[32];
-    
-    // TODO: Need AES-CTRL encryption to frameCipher
-    uint8_t frameData[payloadPadding + payloadSize];
-    size_t frameDataSize = payloadPadding + payloadSize;
-    memcpy(frameData, payload, payloadSize);
-    
-    if(payloadPadding){
-        memset(&frameData[payloadSize], 0, payloadPadding);
-    }
-    
-    fCoder->aesEncryptCipherLen += frameDataSize;
-    BRAESCTR_OFFSET(frameCipher, frameDataSize, fCoder->aesEncryptKey, 32, fCoder->ivEnc.u8, frameData, fCoder->aesEncryptCipherLen);
-    
-    keccak_update(fCoder->egressMac, frameCipher, payloadSize + payloadPadding);
-    
-    keccak_digest(fCoder->egressMac, egressDigest);
-    
-    uint8_t fmac_seed[16];
-    memcpy(fmac_seed, egressDigest, 16);
-    memcpy(macSecret, egressDigest, 16);
-    
-    _BRAES256ECBEncrypt(fCoder->macSecretKey.u8, macSecret);
-    bytesXOR(macSecret, fmac_seed, xORMacCipher, 16);
-
-    keccak_update(fCoder->egressMac, xORMacCipher, 16);
-    
-    keccak_digest(fCoder->egressMac, egressDigest);
-
-    memcpy(&oBytes[32 + payloadSize + payloadPadding],egressDigest, 16);
+    frameCoderEncryptInto(fCoder, payload, payloadSize, oBytes);
     
     *rlpBytes = oBytes;
     *rlpBytesSize = oBytesSize;
-    
 }
 
 BREthereumBoolean frameCoderDecryptHeader(BREthereumLESFrameCoder fCoder, uint8_t * oBytes, size_t outSize) {
@@ -441,31 +479,14 @@ BREthereumBoolean frameCoderDecryptHeader(BREthereumLESFrameCoder fCoder, uint8_
     uint8_t* headerCipher = oBytes;
     uint8_t* headerMac = &oBytes[HEADER_LEN];
     
-    uint8_t mac_secret[HEADER_LEN];
-    uint8_t ingressDigest[32];
-    
-    //Digest the ingressMac and store it in mac_secret
-    keccak_digest(fCoder->ingressMac, ingressDigest);
-    memcpy(mac_secret, ingressDigest, HEADER_LEN);
-    
-    _BRAES256ECBEncrypt(fCoder->macSecretKey.u8, mac_secret);
-
-    uint8_t xORMacCipher[HEADER_LEN];
-    bytesXOR(mac_secret, headerCipher, xORMacCipher, HEADER_LEN);
-    
-    keccak_update(fCoder->ingressMac, xORMacCipher, HEADER_LEN);
-    
-    uint8_t headerMacExpected[HEADER_LEN];
-    
-    keccak_digest(fCoder->ingressMac, ingressDigest);
-    memcpy(headerMacExpected, ingressDigest, HEADER_LEN);
+    uint8_t headerMacExpected[MAC_LEN];
+    _frameCoderUpdateMac(fCoder, fCoder->ingressMac, headerCipher, headerMacExpected);
 
-    if(memcmp(headerMacExpected, headerMac, HEADER_LEN) != 0) {
+    if(memcmp(headerMacExpected, headerMac, MAC_LEN) != 0) {
         return ETHEREUM_BOOLEAN_FALSE;
     }
     
-    fCoder->aesDecrptyCipherLen += HEADER_LEN;
-    BRAESCTR_OFFSET(oBytes, HEADER_LEN, fCoder->aesEncryptKey, 32, fCoder->ivDec.u8, headerCipher, fCoder->aesDecrptyCipherLen);
+    _BRAES256CTRExpanded(fCoder->aesRoundKeys, fCoder->ivDec.u8, headerCipher, HEADER_LEN);
     
     return ETHEREUM_BOOLEAN_TRUE;
     
@@ -476,33 +497,15 @@ BREthereumBoolean frameCoderDecryptFrame(BREthereumLESFrameCoder fCoder, uint8_t
     uint8_t* frameCipherText = oBytes;
     uint8_t* frameMac = &oBytes[outSize - MAC_LEN];
 
+    uint8_t frameMacExpected[MAC_LEN];
     keccak_update(fCoder->ingressMac, frameCipherText, outSize - MAC_LEN);
+    _frameCoderUpdateMac(fCoder, fCoder->ingressMac, NULL, frameMacExpected);
     
-    uint8_t fmacSeed[16];
-    uint8_t fmacSeedEncrypt[16];
-
-    uint8_t ingressDigest[32];
-   
-    keccak_digest(fCoder->ingressMac, ingressDigest);
-    memcpy(fmacSeed, ingressDigest, 16);
-    memcpy(fmacSeedEncrypt, ingressDigest, 16);
-   
-    uint8_t xORMacCipher[16];
-    _BRAES256ECBEncrypt(fCoder->macSecretKey.u8, fmacSeedEncrypt);
-    bytesXOR(fmacSeedEncrypt,fmacSeed, xORMacCipher, 16);
-    
-    keccak_update(fCoder->ingressMac, xORMacCipher, 16);
-    
-    uint8_t framMacExpected[16];
-    keccak_digest(fCoder->ingressMac, ingressDigest);
-    memcpy(framMacExpected, ingressDigest, 16);
-    
-    if(memcmp(framMacExpected, frameMac, 16) != 0) {
+    if(memcmp(frameMacExpected, frameMac, MAC_LEN) != 0) {
         return ETHEREUM_BOOLEAN_FALSE;
     }
 
-    fCoder->aesDecrptyCipherLen += (outSize - MAC_LEN);
-    BRAESCTR_OFFSET(oBytes, outSize - MAC_LEN, fCoder->aesEncryptKey, 32, fCoder->ivDec.u8, frameCipherText, fCoder->aesDecrptyCipherLen);
+    _BRAES256CTRExpanded(fCoder->aesRoundKeys, fCoder->ivDec.u8, frameCipherText, outSize - MAC_LEN);
     
     return ETHEREUM_BOOLEAN_TRUE;
 }
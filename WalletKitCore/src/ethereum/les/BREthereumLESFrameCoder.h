@@ -75,6 +75,21 @@ extern void frameCoderRelease(BREthereumLESFrameCoder coder);
  */
  extern void frameCoderEncrypt(BREthereumLESFrameCoder fCoder, uint8_t* payload, size_t payloadSize, uint8_t** rlpBytes, size_t * rlpBytesSize);
 
+/**
+ * Returns the size in bytes of the encrypted packet for a payload of `payloadSize` bytes
+ * @param payloadSize - the size in bytes of the payload
+ */
+extern size_t frameCoderEncryptedSize(size_t payloadSize);
+
+/**
+ * Encrypts a single packet, in place, into a caller-owned buffer
+ * @param fCoder - the frame coder context
+ * @param payload - the payload that will be encrypted
+ * @param payloadSize - the size in bytes of the payload
+ * @param frame - the destination, at least `frameCoderEncryptedSize(payloadSize)` bytes
+ */
+extern void frameCoderEncryptInto(BREthereumLESFrameCoder fCoder, const uint8_t* payload, size_t payloadSize, uint8_t* frame);
+
 /**
  * Authenticates and decrypts the header from a packet
  * @param fCoder - the frame coder context
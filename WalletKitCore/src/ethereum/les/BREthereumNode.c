@@ -2021,16 +2021,24 @@ nodeSend (BREthereumNode node,
             // RLP encoding of a list; thus we use `rlpDecodeList`.
             BRRlpData data = rlpDecodeListSharedDontRelease(node->coder.rlp, item);
 
-            // Encrypt the length-less data
-            BRRlpData encryptedData;
+            // Encrypt the length-less data, in place, into the reusable sendDataBuffer
+            size_t encryptedCount = frameCoderEncryptedSize (data.bytesCount);
+
             pthread_mutex_lock (&node->lock);
-            frameCoderEncrypt(node->frameCoder,
-                              data.bytes, data.bytesCount,
-                              &encryptedData.bytes, &encryptedData.bytesCount);
+            if (encryptedCount > node->sendDataBuffer.bytesCount) {
+                // Expand sendDataBuffer, with some margin
+                node->sendDataBuffer = (BRRlpData) {
+                    2 * encryptedCount,
+                    realloc(node->sendDataBuffer.bytes, 2 * encryptedCount)
+                };
+            }
+
+            frameCoderEncryptInto (node->frameCoder,
+                                   data.bytes, data.bytesCount,
+                                   node->sendDataBuffer.bytes);
 
-            error = nodeEndpointSendData (node->remote, route, encryptedData.bytes, encryptedData.bytesCount);
+            error = nodeEndpointSendData (node->remote, route, node->sendDataBuffer.bytes, encryptedCount);
             pthread_mutex_unlock (&node->lock);
-            rlpDataRelease(encryptedData);
             break;
         }
     }
@@ -16,6 +16,114 @@
 
 #define AS_UINT64(x)  ((uint64_t) (x))
 
+//
+// 64-bit Limbs
+//
+// The arithmetic below operates on UInt256 as four 64-bit 'limbs', least significant first.  When
+// the compiler provides them we use `unsigned __int128` for the 64x64 => 128 bit products and the
+// `__builtin_{add,sub}_overflow()` intrinsics for carries and borrows; otherwise we fall back to
+// portable C that computes identical results.
+//
+#if defined (__SIZEOF_INT128__)
+#  define UINT256_USE_UINT128
+typedef unsigned __int128 uint128_t;
+#endif
+
+#if defined (__has_builtin)
+#  if __has_builtin (__builtin_add_overflow) && __has_builtin (__builtin_sub_overflow)
+#    define UINT256_USE_BUILTIN_OVERFLOW
+#  endif
+#elif defined (__GNUC__) && __GNUC__ >= 5
+#  define UINT256_USE_BUILTIN_OVERFLOW
+#endif
+
+#define UINT256_LIMBS   (sizeof (UInt256) / sizeof (uint64_t))
+
+// Return (+ x y carry) mod 2^64; update `carry`, either 0 or 1, with the carry out.
+static inline uint64_t
+limbAddCarry (uint64_t x, uint64_t y, uint64_t *carry) {
+#if defined (UINT256_USE_BUILTIN_OVERFLOW)
+    uint64_t sum;
+    uint64_t carry1 = __builtin_add_overflow (x, y, &sum);
+    uint64_t carry2 = __builtin_add_overflow (sum, *carry, &sum);
+#else
+    uint64_t sum    = x + y;
+    uint64_t carry1 = (sum < x);
+    sum += *carry;
+    uint64_t carry2 = (sum < *carry);
+#endif
+    *carry = carry1 | carry2;
+    return sum;
+}
+
+// Return (- x y borrow) mod 2^64; update `borrow`, either 0 or 1, with the borrow out.
+static inline uint64_t
+limbSubBorrow (uint64_t x, uint64_t y, uint64_t *borrow) {
+#if defined (UINT256_USE_BUILTIN_OVERFLOW)
+    uint64_t diff;
+    uint64_t borrow1 = __builtin_sub_overflow (x, y, &diff);
+    uint64_t borrow2 = __builtin_sub_overflow (diff, *borrow, &diff);
+#else
+    uint64_t diff    = x - y;
+    uint64_t borrow1 = (x < y);
+    uint64_t borrow2 = (diff < *borrow);
+    diff -= *borrow;
+#endif
+    *borrow = borrow1 | borrow2;
+    return diff;
+}
+
+// Return the low 64 bits of (+ (* x y) z carry); update `carry` with the high 64 bits.  This
+// can't overflow: (2^64 - 1)^2 + 2 * (2^64 - 1) = 2^128 - 1.
+static inline uint64_t
+limbMulAdd (uint64_t x, uint64_t y, uint64_t z, uint64_t *carry) {
+#if defined (UINT256_USE_UINT128)
+    uint128_t total = (uint128_t) x * y + z + *carry;
+    *carry = (uint64_t) (total >> 64);
+    return (uint64_t) total;
+#else
+    uint64_t xl = (uint32_t) x, xh = x >> 32;
+    uint64_t yl = (uint32_t) y, yh = y >> 32;
+
+    uint64_t ll = xl * yl, lh = xl * yh, hl = xh * yl, hh = xh * yh;
+
+    // Sum the middle terms with the high half of `ll`; none of these can overflow
+    uint64_t middle = (ll >> 32) + (uint32_t) lh + (uint32_t) hl;
+
+    uint64_t lo = (middle << 32) | (uint32_t) ll;
+    uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+
+    uint64_t c = 0;
+    lo = limbAddCarry (lo, z, &c);       hi += c; c = 0;
+    lo = limbAddCarry (lo, *carry, &c);  hi += c;
+
+    *carry = hi;
+    return lo;
+#endif
+}
+
+// The number of limbs in `x` upto and including the most significant, non-zero limb.
+static inline size_t
+limbsCount (const uint64_t *x) {
+    size_t count = UINT256_LIMBS;
+    while (count > 0 && 0 == x[count - 1]) count--;
+    return count;
+}
+
+// Fill `z`, which must be zeroed with at least `xCount + yCount` limbs, with (* x y).
+static void
+limbsMul (const uint64_t *x, size_t xCount, const uint64_t *y, size_t yCount, uint64_t *z) {
+    // Use 'grade school' long multiplication in base 2^64, skipping the zero high limbs of both
+    // `x` and `y`.  Most values - gas, gas prices, amounts - fit in one or two limbs.
+    for (size_t xi = 0; xi < xCount; xi++) {
+        uint64_t carry = 0;
+        if (0 == x[xi]) continue;
+        for (size_t yi = 0; yi < yCount; yi++)
+            z[xi + yi] = limbMulAdd (x[xi], y[yi], z[xi + yi], &carry);
+        z[xi + yCount] = carry;
+    }
+}
+
 extern UInt256
 uint256Create (uint64_t value) {
     UInt256 result = { .u64 = { value, 0, 0, 0}};
@@ -69,17 +177,13 @@ uint256Add_Overflow (const UInt256 y, const UInt256 x, int *overflow) {
     assert (overflow != NULL);
     
     UInt256 z = UINT256_ZERO;
-    unsigned int count = sizeof (UInt256) / sizeof(uint32_t);
-    
-    // x = xa*2^0 + xb*2^32 + ...
-    // y = ya*2^0 + yb*2^32 + ...
-    // z = (xa + ya)*2^0 + (xb + yb)*2^32 + ...
+
+    // x = xa*2^0 + xb*2^64 + ...
+    // y = ya*2^0 + yb*2^64 + ...
+    // z = (xa + ya)*2^0 + (xb + yb)*2^64 + ...
     uint64_t carry = 0;
-    for (int i = 0; i < count; i++) {
-        uint64_t sum = AS_UINT64(x.u32[i]) + AS_UINT64(y.u32[i]) + carry;
-        carry = sum >> 32;
-        z.u32[i] = (uint32_t) sum;
-    }
+    for (size_t i = 0; i < UINT256_LIMBS; i++)
+        z.u64[i] = limbAddCarry (x.u64[i], y.u64[i], &carry);
     
     *overflow = (int) carry;
     return (0 != carry
@@ -90,39 +194,24 @@ uint256Add_Overflow (const UInt256 y, const UInt256 x, int *overflow) {
 extern UInt512
 uint256Add (UInt256 x, UInt256 y) {
     UInt512 z = UINT512_ZERO;
-    unsigned int count = sizeof (UInt256) / sizeof(uint32_t);
-    
-    // x = xa*2^0 + xb*2^32 + ...
-    // y = ya*2^0 + yb*2^32 + ...
-    // z = (xa + ya)*2^0 + (xb + yb)*2^32 + ...
+
+    // x = xa*2^0 + xb*2^64 + ...
+    // y = ya*2^0 + yb*2^64 + ...
+    // z = (xa + ya)*2^0 + (xb + yb)*2^64 + ...
     uint64_t carry = 0;
-    for (int i = 0; i < count; i++) {
-        uint64_t sum = AS_UINT64(x.u32[i]) + AS_UINT64(y.u32[i]) + carry;
-        carry = sum >> 32;
-        z.u32[i] = (uint32_t) sum;
-    }
-    z.u32[count] = (uint32_t) carry;
+    for (size_t i = 0; i < UINT256_LIMBS; i++)
+        z.u64[i] = limbAddCarry (x.u64[i], y.u64[i], &carry);
+    z.u64[UINT256_LIMBS] = carry;
     return z;
 }
 
 static UInt256
 uint256Sub_x_gt_y (UInt256 x, UInt256 y) {
     UInt256 z = UINT256_ZERO;
-    unsigned int count = sizeof (UInt256) / sizeof(uint32_t);
-    
+
     uint64_t borrow = 0;
-    for (int i = 0; i < count; i++) {
-        uint64_t diff;
-        if (AS_UINT64(x.u32[i]) >= (AS_UINT64(y.u32[i]) + borrow)) {
-            diff = AS_UINT64(x.u32[i]) - (AS_UINT64(y.u32[i]) + borrow);
-            borrow = 0;
-        }
-        else {
-            diff = ((AS_UINT64(1) << 32) + AS_UINT64(x.u32[i])) - (AS_UINT64(y.u32[i]) + borrow);
-            borrow = 1;
-        }
-        z.u32[i] = (uint32_t) diff;
-    }
+    for (size_t i = 0; i < UINT256_LIMBS; i++)
+        z.u64[i] = limbSubBorrow (x.u64[i], y.u64[i], &borrow);
     return z;
 }
 
@@ -148,34 +237,44 @@ extern UInt512
 uint256Mul (const UInt256 x, const UInt256 y) {
     //  assert (__LITTLE_ENDIAN__ == BYTE_ORDER);
     UInt512 z = UINT512_ZERO;
-    
-    size_t count = sizeof (UInt256) / sizeof(uint32_t);
-    
-    // Use 'grade school' long multiplication in base 32.  For UInt256 we'll have 8 32-bit value
-    // and perform 64 32-bit multiplications.  A more sophisticated algorith, e.g. Katasuba, can
-    // perform just 27 32-bit multiplications.  For our application, not a big enough savings for
-    // the added complexity.
-    for (size_t xi = 0; xi < count; xi++) {
-        uint64_t carry = 0;
-        if (x.u32[xi] == 0) continue;
-        for (size_t yi = 0; yi < count; yi++) {
-            uint64_t total = z.u32[yi + xi] + carry + AS_UINT64 (y.u32[yi]) * AS_UINT64 (x.u32[xi]);
-            carry = total >> 32;
-            z.u32[yi + xi] = (uint32_t) total;
-        }
-        z.u32[xi + count] += carry;
-    }
+    limbsMul (x.u64, limbsCount (x.u64), y.u64, limbsCount (y.u64), z.u64);
     return z;
 }
 
 extern UInt256
 uint256Mul_Overflow (UInt256 x, UInt256 y, int *overflow) {
-    return uint256Coerce (uint256Mul (x, y), overflow);
+    assert (NULL != overflow);
+
+    size_t xCount = limbsCount (x.u64);
+    size_t yCount = limbsCount (y.u64);
+
+    // If the product surely fits in 256 bits, skip the UInt512.
+    if (xCount + yCount <= UINT256_LIMBS) {
+        UInt256 z = UINT256_ZERO;
+        limbsMul (x.u64, xCount, y.u64, yCount, z.u64);
+        *overflow = 0;
+        return z;
+    }
+
+    UInt512 z = UINT512_ZERO;
+    limbsMul (x.u64, xCount, y.u64, yCount, z.u64);
+    return uint256Coerce (z, overflow);
 }
 
 extern UInt256
 uint256Mul_Small (UInt256 x, uint32_t y, int *overflow) {
-    return uint256Mul_Overflow(x, uint256Create (y), overflow);
+    assert (NULL != overflow);
+
+    UInt256 z = UINT256_ZERO;
+
+    uint64_t carry = 0;
+    for (size_t i = 0; i < UINT256_LIMBS; i++)
+        z.u64[i] = limbMulAdd (x.u64[i], y, 0, &carry);
+
+    *overflow = (0 != carry);
+    return (0 != carry
+            ? UINT256_ZERO
+            : z);
 }
 
 extern UInt256
@@ -185,6 +284,12 @@ uint256Mul_Double (UInt256 x, double y, int *overflow, int *negative, double *re
     *negative = (y < 0.0);
     if (*negative) y = -y;
 
+    // An integral `y` that fits in uint32_t is an exact multiplication, with no remainder.
+    if (y <= UINT32_MAX && y == floor (y)) {
+        if (NULL != rem) *rem = 0.0;
+        return uint256Mul_Small (x, (uint32_t) y, overflow);
+    }
+
     // Multiplying a large double times a large uint32 will overflow uint64; so we'll
     // operate on uint16 types.
     //
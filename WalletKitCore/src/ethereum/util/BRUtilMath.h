@@ -79,8 +79,6 @@ uint256CreateParse (const char *number, int base, BRCoreParseStatus *status);
  * @param number: a base10 number with one optional decimal point.
  * @param decimals: number of decimals after the decimal point
  * @param error: pointer to a boolean error.
- *
- * @warn Requires stack size of at least 3 * (strlen(number) + digits). [We are sloppy]
  */
 extern UInt256
 uint256CreateParseDecimal (const char *number, int decimals, BRCoreParseStatus *status);
@@ -173,6 +171,15 @@ uint256CoerceLongDouble (UInt256 value, int *overflow);
 extern char *
 uint256CoerceString (UInt256 x, int base);
 
+/**
+ * Fill `buffer` with the string representation of `x` in `base`, as per uint256CoerceString(),
+ * but without allocating.  Returns the string length, excluding the terminating '\0'.  If the
+ * returned length is not less than `bufferSize` then the string did not fit and `buffer` holds
+ * an empty string (if `bufferSize` is not zero).  A `bufferSize` of 257 always suffices.
+ */
+extern size_t
+uint256CoerceStringInto (UInt256 x, int base, char *buffer, size_t bufferSize);
+
 extern char *
 uint256CoerceStringPrefaced (UInt256 x, int base, const char *preface);
 
@@ -185,6 +192,14 @@ uint256CoerceStringPrefaced (UInt256 x, int base, const char *preface);
 extern char *
 uint256CoerceStringDecimal (UInt256 x, int decimals);
 
+/**
+ * Fill `buffer` with the decimal string representation of `x`, as per uint256CoerceStringDecimal(),
+ * but without allocating.  Returns the string length, excluding the terminating '\0', with the
+ * same semantics as uint256CoerceStringInto().
+ */
+extern size_t
+uint256CoerceStringDecimalInto (UInt256 x, int decimals, char *buffer, size_t bufferSize);
+
 
 /**
  * Returns a '0x' prefaced hex string
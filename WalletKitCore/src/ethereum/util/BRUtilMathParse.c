@@ -65,6 +65,12 @@ stringParseIsDecimal(const char *number) {
 
 #define SURELY_ENOUGH_CHARS 100     // No more than ~78 in UInt256
 
+static size_t
+parseMaximumDigitsForUInt256InBase (int base);
+
+static void
+parseUInt256AccumulateDigits (UInt256 *value, const char *digits, size_t count, int base, int *overflow);
+
 extern UInt256
 uint256CreateParseDecimal (const char *string, int decimals, BRCoreParseStatus *status) {
     // Check basic `string` content.
@@ -78,76 +84,56 @@ uint256CreateParseDecimal (const char *string, int decimals, BRCoreParseStatus *
     
     if (CORE_PARSE_OK != *status)
         return UINT256_ZERO;
-    
-    // Get a 'new' string so strsep() can overwrite it.
-    char splitterA [SURELY_ENOUGH_CHARS];
-    char *splitter = splitterA;
-    strcpy (splitter, string);
-    
-    char *whole = strsep(&splitter, ".");
-    char *fract = strsep(&splitter, ".");
-    
-    if (NULL == whole) whole = "";
-    if (NULL == fract) fract = "";
-    
-   size_t fractLen = strlen(fract);
-    
+
+    // Find `whole` and `fract` in place; `string` is <whole>[.<fract>]
+    const char *whole = string;
+    const char *point = strchr (string, '.');
+    size_t wholeLen = (NULL == point ? strlen (string) : (size_t) (point - string));
+
+    const char *fract = (NULL == point ? "" : point + 1);
+    size_t fractLen = strlen (fract);
+
     // Strip trailing '0'
-    for (size_t i = 0; i < fractLen; i++) {
-        if ('0' == fract[fractLen - 1 - i])
-            fract[fractLen - 1 - i] = '\0';
-        else
-            break;
-    }
-    
+    while (fractLen > 0 && '0' == fract[fractLen - 1]) fractLen--;
+
     // Too many fractional digits
-    fractLen = strlen(fract);
     if (fractLen > decimals) {
         *status = CORE_PARSE_UNDERFLOW;
         return UINT256_ZERO;
     }
-    
-    // Get a 'new' string with `whole`, `fract` and some padding '0' tacked on.
-    char number [2 * SURELY_ENOUGH_CHARS];
-    strcpy(number, whole);
-    strcat(number, fract);
-    
-    char *padding = &number[strlen(number)];
-    // Pad with '0'
-    for (; fractLen < decimals; fractLen++)
-        *padding++ = '0';
-    *padding = 0;
-    
-    return uint256CreateParse(number, 10, status);
-}
 
+    // The value is <whole><fract> followed by `padding` zeros.  Strip leading '0's, across both
+    // `whole` and `fract`, before counting the digits.
+    size_t padding = (size_t) decimals - fractLen;
 
-//    > max064
-//    18446744073709551615
-//    > (number->string max064 2)
-//    "1111111111111111111111111111111111111111111111111111111111111111"
-//    > (string-length (number->string max064 2))
-//    64
-//    > (number->string max064 10)
-//    "18446744073709551615"
-//    > (string-length (number->string max064 10))
-//    20
-//    >(number->string max064 16)
-//    "FFFFFFFFFFFFFFFF"
-//    > (string-length (number->string max064 16))
-//    16
-
-// The maximum digits allowed in a string so as to prevent overflow in uint64_t
-static size_t
-parseMaximumDigitsForUInt64InBase (int base) {
-    switch (base) {
-        case 2:  return 64;
-        case 10: return 19;
-        case 16: return 16;
-        default: BRFail();
+    while (wholeLen > 0 && '0' == *whole) { whole++; wholeLen--; }
+    if (0 == wholeLen)
+        while (fractLen > 0 && '0' == *fract) { fract++; fractLen--; }
+
+    // If no digits remain, we've a value of '0'
+    if (0 == wholeLen && 0 == fractLen) return UINT256_ZERO;
+
+    if (wholeLen + fractLen + padding > parseMaximumDigitsForUInt256InBase (10)) {
+        *status = CORE_PARSE_OVERFLOW;
+        return UINT256_ZERO;
     }
+
+    UInt256 value = UINT256_ZERO;
+    int overflow = 0;
+
+    parseUInt256AccumulateDigits (&value, whole, wholeLen, 10, &overflow);
+    parseUInt256AccumulateDigits (&value, fract, fractLen, 10, &overflow);
+    parseUInt256AccumulateDigits (&value, NULL,  padding,  10, &overflow);
+
+    if (overflow) {
+        *status = CORE_PARSE_OVERFLOW;
+        return UINT256_ZERO;
+    }
+
+    return value;
 }
 
+
 static size_t
 parseMaximumDigitsForUInt256InBase (int base) {
     switch (base) {
@@ -158,55 +144,56 @@ parseMaximumDigitsForUInt256InBase (int base) {
     }
 }
 
-// Compute (expt base power)
-static UInt256
-parseUInt256Power (int base, int power, int *overflow) {
-    size_t maxPower = parseMaximumDigitsForUInt64InBase(base);
-    
-    if (power > maxPower) {
-        *overflow = 1;
-        return UINT256_ZERO;
-    }
-    
-    uint64_t value = 1;
-    while (power-- > 0)
-        value *= (uint64_t) base;  // slow, but yeah.
-    
-    // Reality is that this can overflow for 16^16 = 2^64 (one too many).  We'll handle it.
-    //  Probably also for 2^256... can't handle that one similarly.
-    *overflow = 0;
-    if (value == 0) {
-        UInt256 result = UINT256_ZERO;
-        result.u64[1] = 1;
-        return result;
+// The maximum digits, and their scale, that fit in a uint32_t chunk
+static size_t
+parseMaximumDigitsForUInt32InBase (int base, uint32_t *scale) {
+    switch (base) {
+        case 2:  *scale = 1u << 31;      return 31;
+        case 10: *scale = 1000000000u;   return 9;
+        case 16: *scale = 1u << 28;      return 7;
+        default: BRFail();
     }
-    else return uint256Create(value);
 }
 
-// Compute (* value (expt base power))
-static UInt256
-parseUInt256ScaleByPower (UInt256 value, int base, int power, int *overflow) {
-    UInt256 scale = parseUInt256Power(base, power, overflow);
-    return (*overflow
-            ? UINT256_ZERO
-            : uint256Mul_Overflow(value, scale, overflow));
+static uint32_t
+parseDigitValue (char digit) {
+    return (uint32_t) (isdigit (digit) ? digit - '0' : tolower (digit) - 'a' + 10);
 }
 
-static UInt256
-parseUInt64 (const char *string, int digits, int base) {
-    size_t maxDigits = parseMaximumDigitsForUInt64InBase(base);
-    assert (digits <= maxDigits );
-    
-    //
-    char number[1 + maxDigits], *numberEnd;
-    strncpy (number, string, maxDigits);
-    number[maxDigits] = '\0';
-
-    errno = 0;
-    uint64_t value = strtoull (number, &numberEnd, base);
-    if (0 == errno && (*number == '\0' || numberEnd == NULL || *numberEnd != '\0'))
-        errno = EINVAL;
-    return uint256Create (value);
+// Compute (+ (* value mul) add) in place; set `overflow` if the result exceeds 256 bits
+static void
+parseUInt256MulAdd (UInt256 *value, uint32_t mul, uint32_t add, int *overflow) {
+    uint64_t carry = add;
+    for (size_t i = 0; i < sizeof (UInt256) / sizeof (uint32_t); i++) {
+        uint64_t product = (uint64_t) value->u32[i] * mul + carry;
+        value->u32[i] = (uint32_t) product;
+        carry = product >> 32;
+    }
+    if (0 != carry) *overflow = 1;
+}
+
+// Append `count` digits, already validated for `base`, to `value` - as (+ (* value (expt base count)) digits).
+// The digits are consumed in uint32_t sized chunks.  If `digits` is NULL, append `count` zeros.
+static void
+parseUInt256AccumulateDigits (UInt256 *value, const char *digits, size_t count, int base, int *overflow) {
+    uint32_t chunkScale;
+    size_t chunkDigits = parseMaximumDigitsForUInt32InBase (base, &chunkScale);
+
+    while (count > 0) {
+        size_t   digitsCount = (count < chunkDigits ? count : chunkDigits);
+        uint32_t scale = (digitsCount == chunkDigits ? chunkScale : 1);
+        uint32_t chunk = 0;
+
+        for (size_t i = 0; i < digitsCount; i++) {
+            if (digitsCount != chunkDigits) scale *= (uint32_t) base;
+            chunk = chunk * (uint32_t) base + (NULL == digits ? 0 : parseDigitValue (digits[i]));
+        }
+
+        parseUInt256MulAdd (value, scale, chunk, overflow);
+
+        if (NULL != digits) digits += digitsCount;
+        count -= digitsCount;
+    }
 }
 
 extern UInt256
@@ -254,44 +241,16 @@ uint256CreateParse (const char *string, int base, BRCoreParseStatus *status) {
         return UINT256_ZERO;
     }
     
-    // We'll process this many digits in `string`.
-    size_t stringChunks = parseMaximumDigitsForUInt64InBase(base);
-
-    // Fill this in.
+    // Fill this in; process `string` as big endian, no matter the base, in uint32_t sized chunks
     UInt256 value = UINT256_ZERO;
+    int overflow = 0;
 
-    // For parsing a string like "123.45", the character at index 0 is '1'.  So by parsing chunks
-    // with ascending index, we naturally treat `string` as big endian - no matter the base.
-    // Eventually, when `parseUInt64()` calls `strtoull` we'll still be using big endian.
-    for (size_t index = 0; index < length; index += stringChunks) {
-        // On the first time through, get an initial value
-        if (index == 0) {
-            value = parseUInt64(string, (int) stringChunks, base);
-            if (errno != 0) {
-                *status = CORE_PARSE_STRANGE_DIGITS;
-                return UINT256_ZERO;
-            }
-        }
-        
-        // Otherwise, we'll scale value and add in the next chunk.
-        else {
-            // This many remain - if more than stringChunks, we'll scale by just stringChunks
-            int remainingDigits = (int) (length - index);
-            int scalingDigits = remainingDigits >= stringChunks ? (int) stringChunks : remainingDigits;
-            
-            int scaleOverflow = 0, addOverflow = 0;
-            
-            // Scale (aka shift the value by scalingDigits)
-            value = parseUInt256ScaleByPower(value, base, scalingDigits, &scaleOverflow);
-            
-            // Add in the next chuck.
-            value = uint256Add_Overflow(value, parseUInt64(&string[index], (int) stringChunks, base), &addOverflow);
-            if (scaleOverflow || addOverflow) {
-                *status = CORE_PARSE_OVERFLOW;
-                return UINT256_ZERO;
-            }
-        }
+    parseUInt256AccumulateDigits (&value, string, length, base, &overflow);
+    if (overflow) {
+        *status = CORE_PARSE_OVERFLOW;
+        return UINT256_ZERO;
     }
+
     *status = CORE_PARSE_OK;
     return value;
 }
@@ -299,127 +258,152 @@ uint256CreateParse (const char *string, int base, BRCoreParseStatus *status) {
 //
 //
 //
-static char *
-coerceReverseString (const char *s) {
-    size_t len = strlen(s);
-    char *t = calloc (1 + len, 1);
-    for (size_t i = 0; i < len; i++)
-        t[len - i - 1] = s[i];
-    return t;
-}
 
-extern char *
-uint256CoerceString (UInt256 x, int base) {
+// The maximum digits in a UInt256 string, no matter the base (base 2 needs the most)
+#define COERCE_STRING_MAXIMUM_DIGITS      (256)
+
+// The largest power of 10 that fits in the `uint32_t` divisor of `uint256Div_Small()`
+#define COERCE_STRING_BASE10_CHUNK        (1000000000u)
+#define COERCE_STRING_BASE10_CHUNK_DIGITS (9)
+
+// Fill `digits` with `x` in `base`, from the end of the buffer backward; return the first digit.
+static const char *
+coerceStringDigits (UInt256 x, int base, char digits[COERCE_STRING_MAXIMUM_DIGITS + 1]) {
+    char *digit = &digits[COERCE_STRING_MAXIMUM_DIGITS];
+    *digit = '\0';
+
     // Handle 0 explicitly, rather than in each case
     if (uint256EQL(x, UINT256_ZERO)) {
-        char *result = calloc (2, 1);
-        result[0] = '0';
-        return result;
+        *--digit = '0';
+        return digit;
     }
-    
+
+    // Bytes in `x` upto and including the most significant, non-zero byte.  We explicitly handled
+    // the '0 == x' case up-front; thus x.u8 *always* has a non-zero value.
+    size_t bytesCount = sizeof (x.u8);
+    while (0 == x.u8[bytesCount - 1]) bytesCount--;     // TODO: LITTLE ENDIAN only
+
     switch (base) {
             // We'll just hex encode the UInt256 based on the (little endian) bytes.  This WILL produce
             // a result with an even number of characters - as 15 becomes 0f (aka 0x0f).  This is
             // actually correct (or at least reasonably correct); if only because, if you want to convert
             // back to a value, the hexDecode() WILL expect an even number of characters.
-        case 16: {
-            // Reverse and 'strip zeros'
-            UInt256 xr = UInt256Reverse(x);  // TODO: LITTLE ENDIAN only
-            size_t xrIndex = 0;
-            // We explicitly handled the '0 == x' case up-front.  Thus xr.u8 *always*
-            // eventually has a non-zero value.
-            while (0 == xr.u8[xrIndex]) xrIndex++;
-            // Encode
-            return hexEncodeCreate (NULL, &xr.u8[xrIndex], sizeof (xr.u8) - xrIndex);
-        }
-            
-            // Repeatedly divide by 10; append the result with the remainder.
-        case 10: {
-            char r[257];
-            memset (r, 0, 257);
-            for (int i = 0; i < 256 && !uint256EQL(x, UINT256_ZERO); i++) {
+        case 16:
+            for (size_t index = 0; index < bytesCount; index++) {
+                *--digit = (char) _hexc (x.u8[index]);
+                *--digit = (char) _hexc (x.u8[index] >> 4);
+            }
+            return digit;
+
+            // Repeatedly divide by 10^9; prepend each remainder as nine digits - except for the most
+            // significant remainder which gets no leading zeros.
+        case 10:
+            while (!uint256EQL(x, UINT256_ZERO)) {
                 uint32_t rem;
-                x = uint256Div_Small(x, (uint32_t) base, &rem);
-                r[i] = '0' + rem;
+                x = uint256Div_Small (x, COERCE_STRING_BASE10_CHUNK, &rem);
+
+                int last = uint256EQL(x, UINT256_ZERO);
+                for (size_t count = 0; count < COERCE_STRING_BASE10_CHUNK_DIGITS && (!last || 0 != rem); count++) {
+                    *--digit = (char) ('0' + rem % 10);
+                    rem /= 10;
+                }
             }
-            return coerceReverseString(r);
-        }
-            
-            // Get the base 16 result and then swap hex values for binary strings.
-        case 2: {
-            static const char *hex2Binary[16] = {
-                [ 0] = "0000", [ 1] = "0001", [ 2] = "0010", [ 3] = "0011",
-                [ 4] = "0100", [ 5] = "0101", [ 6] = "0110", [ 7] = "0111",
-                [ 8] = "1000", [ 9] = "1001", [10] = "1010", [11] = "1011",
-                [12] = "1100", [13] = "1101", [14] = "1110", [15] = "1111",
-            };
-            char * base16    = uint256CoerceString (x, 16);
-            size_t base16Len = strlen (base16);
-            
-            char *r = malloc (4 * base16Len + 1);
-            for (int i = 0; i < base16Len; i++)
-                strcpy (&r[4 * i], hex2Binary[_hexu(base16[i])]);
-            r[4 * base16Len] = '\0';
-            free (base16);
-            // strip zeros?
-            return r;
-        }
+            return digit;
+
+            // Like base 16, expand each byte; every byte becomes eight binary digits.
+        case 2:
+            for (size_t index = 0; index < bytesCount; index++)
+                for (size_t bit = 0; bit < 8; bit++)
+                    *--digit = (char) ('0' + ((x.u8[index] >> bit) & 1));
+            return digit;
+
         default:
             BRFail();
     }
 }
 
+// Copy `string`, of `stringLength`, into `buffer` if it fits; otherwise leave `buffer` empty.
+static size_t
+coerceStringFill (const char *string, size_t stringLength, char *buffer, size_t bufferSize) {
+    if (stringLength < bufferSize) memcpy (buffer, string, stringLength + 1);
+    else if (bufferSize > 0)       buffer[0] = '\0';
+    return stringLength;
+}
+
+extern size_t
+uint256CoerceStringInto (UInt256 x, int base, char *buffer, size_t bufferSize) {
+    char digits[COERCE_STRING_MAXIMUM_DIGITS + 1];
+    const char *string = coerceStringDigits (x, base, digits);
+    return coerceStringFill (string, (size_t) (&digits[COERCE_STRING_MAXIMUM_DIGITS] - string), buffer, bufferSize);
+}
+
+extern char *
+uint256CoerceString (UInt256 x, int base) {
+    char digits[COERCE_STRING_MAXIMUM_DIGITS + 1];
+    return strdup (coerceStringDigits (x, base, digits));
+}
+
 extern char *
 uint256CoerceStringPrefaced (UInt256 x, int base, const char *preface) {
-    char *string = uint256CoerceString (x, base);
-    if (NULL == preface || 0 == strcmp ("", preface)) return string;
-    char *stringToFree = string; // save the pointer to string
+    char digits[COERCE_STRING_MAXIMUM_DIGITS + 1];
+    const char *string = coerceStringDigits (x, base, digits);
+    if (NULL == preface || 0 == strcmp ("", preface)) return strdup (string);
 
     // Strip off leading zeros in `string` but be sure to leave at least one digit
     while ('\0' != string[0] && '0' == string[0] && '\0' != string[1]) string++;
 
-    char *result = malloc (strlen(preface) + strlen (string) + 1);
-    strcpy (result, preface);
-    strcat (result, string);
+    size_t prefaceLength = strlen (preface);
+    size_t stringLength  = (size_t) (&digits[COERCE_STRING_MAXIMUM_DIGITS] - string);
 
-    free (stringToFree);
+    char *result = malloc (prefaceLength + stringLength + 1);
+    memcpy (result, preface, prefaceLength);
+    memcpy (&result[prefaceLength], string, stringLength + 1);
 
     return result;
 }
 
-extern char * 
-uint256CoerceStringDecimal (UInt256 x, int decimals) {
-    char *string = uint256CoerceString(x, 10);
-    
-    if (0 == decimals)
-        return string;
-    
-    int slength = (int) strlen (string);
-    if (decimals >= slength) {
-        char *result = calloc ((size_t) decimals + 3, 1);  // 0.<decimals>'\0'
-        
-        // Fill to decimals
-        char format [10];
-        sprintf (format, "0.%%%ds", decimals);
-        sprintf (result, format, string);
-        
-        // Replace fills of ' ' with '0'
-        for (int i = 0; i < decimals + 2; i++) {
-            if (' ' == result[i])
-                result[i] = '0';
-        }
-        free (string);
-        return result;
+extern size_t
+uint256CoerceStringDecimalInto (UInt256 x, int decimals, char *buffer, size_t bufferSize) {
+    char digits[COERCE_STRING_MAXIMUM_DIGITS + 1];
+    const char *string = coerceStringDigits (x, 10, digits);
+    size_t slength = (size_t) (&digits[COERCE_STRING_MAXIMUM_DIGITS] - string);
+
+    if (decimals <= 0)
+        return coerceStringFill (string, slength, buffer, bufferSize);
+
+    size_t dlength = (size_t) decimals;
+
+    // Either 0.<zeros><string> or <whole>.<decimals>
+    size_t length = (dlength >= slength ? dlength + 2 : slength + 1);
+    if (length >= bufferSize)
+        return coerceStringFill (NULL, length, buffer, bufferSize);
+
+    char *result = buffer;
+    if (dlength >= slength) {
+        *result++ = '0';
+        *result++ = '.';
+        memset (result, '0', dlength - slength);
+        memcpy (&result[dlength - slength], string, slength + 1);
     }
     else {
-        int dindex = slength - decimals;
-        char *result = calloc ((size_t) slength + 2, 1);  // <whole>.<decimals>'\0'
-        strncpy (result, string, dindex);
+        size_t dindex = slength - dlength;
+        memcpy (result, string, dindex);
         result[dindex] = '.';
-        strcpy (&result[dindex+1], &string[dindex]);
-        free (string);
-        return result;
+        memcpy (&result[dindex + 1], &string[dindex], dlength + 1);
     }
+    return length;
+}
+
+extern char * 
+uint256CoerceStringDecimal (UInt256 x, int decimals) {
+    // Most every result fits on the stack; only a huge `decimals` needs a second pass.
+    char buffer[COERCE_STRING_MAXIMUM_DIGITS + 2];
+    size_t length = uint256CoerceStringDecimalInto (x, decimals, buffer, sizeof (buffer));
+    if (length < sizeof (buffer)) return strdup (buffer);
+
+    char *result = malloc (length + 1);
+    uint256CoerceStringDecimalInto (x, decimals, result, length + 1);
+    return result;
 }
 
 extern char *
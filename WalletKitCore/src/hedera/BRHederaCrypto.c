@@ -30,6 +30,17 @@ BRKey hederaKeyCreate (UInt512 seed)
     return deriveHederaKeyFromSeed(seed, 0);
 }
 
+int hederaVerifySignatures (const uint8_t **bodies,
+                            const size_t *bodySizes,
+                            const uint8_t **signatures,
+                            const uint8_t **publicKeys,
+                            size_t count,
+                            int *valid)
+{
+    if (0 == count) return 1;
+    return ed25519_verify_batch (signatures, bodies, bodySizes, publicKeys, count, valid);
+}
+
 
 #define ED25519_SEED_KEY "ed25519 seed"
 static void _deriveKeyImpl(BRKey *key, const void *seed, size_t seedLen, int depth, va_list vlist)
@@ -22,6 +22,30 @@ BRKey hederaKeyCreate(UInt512 seed);
 
 void hederaKeyGetPublicKey (BRKey key, uint8_t * publicKey);
 
+/**
+ * Verify the ed25519 signatures over a set of transaction bodies.  The signatures are checked
+ * together as one batch; if the batch fails each one is checked on its own.
+ *
+ * Nothing in WalletKitCore calls this: transfers arrive from the BlockSet API already decoded,
+ * without signatures, and the only signature produced here is the one
+ * hederaTransactionSignTransaction() has just made.  It is for hosts that hold signed bodies.
+ *
+ * @param bodies - the signed body bytes
+ * @param bodySizes - the size of each body
+ * @param signatures - the 64 byte signatures
+ * @param publicKeys - the 32 byte signer public keys
+ * @param count - the number of signatures
+ * @param valid - filled with 1 or 0 for each signature
+ *
+ * @return 1 if every signature is valid, 0 otherwise
+ */
+int hederaVerifySignatures (const uint8_t **bodies,
+                            const size_t *bodySizes,
+                            const uint8_t **signatures,
+                            const uint8_t **publicKeys,
+                            size_t count,
+                            int *valid);
+
 #ifdef __cplusplus
 }
 #endif
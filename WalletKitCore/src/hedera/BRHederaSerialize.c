@@ -12,75 +12,82 @@
 #include "proto/Transaction.pb-c.h"
 #include "proto/TransactionBody.pb-c.h"
 #include <stdlib.h>
+#include <string.h>
 
-const size_t max_memo_size = 100L;
+#define MAX_MEMO_SIZE   (100)
 
-Proto__AccountID * createAccountID (BRHederaAddress address)
+const size_t max_memo_size = MAX_MEMO_SIZE;
+
+// The protobuf-c object graphs below are built entirely on the stack and point directly at the
+// caller's data - the addresses, memo, keys, signature and body bytes.  Nothing is allocated
+// except the buffer that receives the packed bytes, and then only by the non-'Into' functions.
+
+static void initAccountID (Proto__AccountID *protoAccountID, BRHederaAddress address)
 {
-    Proto__AccountID *protoAccountID = calloc(1, sizeof(Proto__AccountID));
     proto__account_id__init(protoAccountID);
     protoAccountID->shardnum = hederaAddressGetShard (address);
     protoAccountID->realmnum = hederaAddressGetRealm (address);
     protoAccountID->accountnum = hederaAddressGetAccount (address);
-    return protoAccountID;
 }
 
-Proto__Timestamp * createTimeStamp  (BRHederaTimeStamp timeStamp)
+static void initTimeStamp (Proto__Timestamp *ts, BRHederaTimeStamp timeStamp)
 {
-    Proto__Timestamp *ts = calloc(1, sizeof(Proto__Timestamp));
     proto__timestamp__init(ts);
     ts->seconds = timeStamp.seconds;
     ts->nanos = timeStamp.nano;
-    return ts;
-}
-
-Proto__TransactionID * createProtoTransactionID (BRHederaAddress address, BRHederaTimeStamp timeStamp)
-{
-    Proto__TransactionID *txID = calloc(1, sizeof(Proto__TransactionID));
-    proto__transaction_id__init(txID);
-    txID->transactionvalidstart = createTimeStamp(timeStamp);
-    txID->accountid = createAccountID(address);
-
-    return txID;
-}
-
-Proto__Duration * createTransactionDuration(int64_t seconds)
-{
-    Proto__Duration * duration = calloc(1, sizeof(Proto__Duration));
-    proto__duration__init(duration);
-    duration->seconds = seconds;
-    return duration;
 }
 
-Proto__AccountAmount * createAccountAmount (BRHederaAddress address, int64_t amount)
+static void initAccountAmount (Proto__AccountAmount *accountAmount,
+                               Proto__AccountID *accountID,
+                               BRHederaAddress address, int64_t amount)
 {
-    Proto__AccountAmount * accountAmount = calloc(1, sizeof(Proto__AccountAmount));
     proto__account_amount__init(accountAmount);
-    accountAmount->accountid = createAccountID(address);
+    initAccountID (accountID, address);
+    accountAmount->accountid = accountID;
     accountAmount->amount = amount;
-    return accountAmount;
 }
 
-uint8_t * hederaTransactionBodyPack (BRHederaAddress source,
-                                       BRHederaAddress target,
-                                       BRHederaAddress nodeAddress,
-                                       BRHederaUnitTinyBar amount,
-                                       BRHederaTimeStamp timeStamp,
-                                       BRHederaUnitTinyBar fee,
-                                       const char * memo,
-                                       size_t *size)
+size_t hederaTransactionBodyPackInto (BRHederaAddress source,
+                                      BRHederaAddress target,
+                                      BRHederaAddress nodeAddress,
+                                      BRHederaUnitTinyBar amount,
+                                      BRHederaTimeStamp timeStamp,
+                                      BRHederaUnitTinyBar fee,
+                                      const char * memo,
+                                      uint8_t *buffer,
+                                      size_t bufferSize)
 {
-    Proto__TransactionBody *body = calloc(1, sizeof(Proto__TransactionBody));
-    proto__transaction_body__init(body);
+    Proto__TransactionBody body;
+    proto__transaction_body__init(&body);
 
     // Create a transaction ID
-    body->transactionid = createProtoTransactionID(source, timeStamp);
-    body->nodeaccountid = createAccountID(nodeAddress);
-    body->transactionfee = (uint64_t)fee;
+    Proto__TransactionID txID;
+    Proto__Timestamp txValidStart;
+    Proto__AccountID txAccountID;
+    proto__transaction_id__init(&txID);
+    initTimeStamp (&txValidStart, timeStamp);
+    initAccountID (&txAccountID, source);
+    txID.transactionvalidstart = &txValidStart;
+    txID.accountid = &txAccountID;
+    body.transactionid = &txID;
+
+    Proto__AccountID nodeAccountID;
+    initAccountID (&nodeAccountID, nodeAddress);
+    body.nodeaccountid = &nodeAccountID;
+    body.transactionfee = (uint64_t)fee;
 
     // Docs say the limit of 100 is enforced. The max size of not defined
     // in the .proto file so I guess we just have to trust that it is string with max 100 chars
-    if (memo) body->memo = strndup(memo, max_memo_size);
+    char memoTruncated[MAX_MEMO_SIZE + 1];
+    if (memo) {
+        if (strnlen (memo, max_memo_size + 1) <= max_memo_size)
+            body.memo = (char *) memo;
+        else {
+            memcpy (memoTruncated, memo, max_memo_size);
+            memoTruncated[max_memo_size] = '\0';
+            body.memo = memoTruncated;
+        }
+    }
 
     // Set the duration
     // *** NOTE 1 *** if the transaction is unable to be verified in this
@@ -88,57 +95,88 @@ uint8_t * hederaTransactionBodyPack (BRHederaAddress source,
     // is 120. I have set ours to 180 since it requires a couple of extra hops
     // *** NOTE 2 *** if you change this value then it will break the unit tests
     // since it will change the serialized bytes.
-    body->transactionvalidduration = createTransactionDuration(180);
+    Proto__Duration duration;
+    proto__duration__init(&duration);
+    duration.seconds = 180;
+    body.transactionvalidduration = &duration;
 
     // We are creating a "Cryto Transfer" transaction which has a transfer list
-    body->data_case =  PROTO__TRANSACTION_BODY__DATA_CRYPTO_TRANSFER;
-    body->cryptotransfer = calloc(1, sizeof(Proto__CryptoTransferTransactionBody));
-    proto__crypto_transfer_transaction_body__init(body->cryptotransfer);
-    body->cryptotransfer->transfers = calloc(1, sizeof(Proto__TransferList));
-    proto__transfer_list__init(body->cryptotransfer->transfers);
+    Proto__CryptoTransferTransactionBody cryptoTransfer;
+    Proto__TransferList transfers;
+    proto__crypto_transfer_transaction_body__init(&cryptoTransfer);
+    proto__transfer_list__init(&transfers);
+    body.data_case =  PROTO__TRANSACTION_BODY__DATA_CRYPTO_TRANSFER;
+    body.cryptotransfer = &cryptoTransfer;
+    cryptoTransfer.transfers = &transfers;
 
     // We are only supporting sending from A to B at this point - so create 2 transfers
-    body->cryptotransfer->transfers->n_accountamounts = 2;
-    body->cryptotransfer->transfers->accountamounts = calloc(2, sizeof(Proto__AccountAmount*));
     // NOTE - the amounts in the transfer MUST add up to 0
-    body->cryptotransfer->transfers->accountamounts[0] = createAccountAmount(source, -(amount));
-    body->cryptotransfer->transfers->accountamounts[1] = createAccountAmount(target, amount);
+    Proto__AccountAmount accountAmounts[2];
+    Proto__AccountID accountAmountIDs[2];
+    Proto__AccountAmount *accountAmountRefs[2] = { &accountAmounts[0], &accountAmounts[1] };
+    initAccountAmount (&accountAmounts[0], &accountAmountIDs[0], source, -(amount));
+    initAccountAmount (&accountAmounts[1], &accountAmountIDs[1], target, amount);
+    transfers.n_accountamounts = 2;
+    transfers.accountamounts = accountAmountRefs;
+
+    // Serialize the transaction body, if it fits
+    size_t size = proto__transaction_body__get_packed_size(&body);
+    if (NULL != buffer && size <= bufferSize)
+        proto__transaction_body__pack(&body, buffer);
+
+    return size;
+}
 
-    // Serialize the transaction body
-    *size = proto__transaction_body__get_packed_size(body);
+uint8_t * hederaTransactionBodyPack (BRHederaAddress source,
+                                       BRHederaAddress target,
+                                       BRHederaAddress nodeAddress,
+                                       BRHederaUnitTinyBar amount,
+                                       BRHederaTimeStamp timeStamp,
+                                       BRHederaUnitTinyBar fee,
+                                       const char * memo,
+                                       size_t *size)
+{
+    *size = hederaTransactionBodyPackInto (source, target, nodeAddress, amount, timeStamp, fee, memo, NULL, 0);
     uint8_t * buffer = calloc(1, *size);
-    proto__transaction_body__pack(body, buffer);
-
-    // Free the body object now that we have serialized to bytes
-    proto__transaction_body__free_unpacked(body, NULL);
-
+    hederaTransactionBodyPackInto (source, target, nodeAddress, amount, timeStamp, fee, memo, buffer, *size);
     return buffer;
 }
 
-Proto__SignatureMap * createSigMap(uint8_t *signature, uint8_t * publicKey)
+size_t hederaTransactionPackInto (const uint8_t * signature, size_t signatureSize,
+                                  const uint8_t * publicKey, size_t publicKeySize,
+                                  const uint8_t * body, size_t bodySize,
+                                  uint8_t *buffer,
+                                  size_t bufferSize)
 {
-    Proto__SignatureMap * sigMap = calloc(1, sizeof(Proto__SignatureMap));
-    proto__signature_map__init(sigMap);
-    sigMap->sigpair = calloc(1, sizeof(Proto__SignaturePair*)); // A single signature
-    sigMap->sigpair[0] = calloc(1, sizeof(Proto__SignaturePair));
-    proto__signature_pair__init(sigMap->sigpair[0]);
-    sigMap->sigpair[0]->signature_case = PROTO__SIGNATURE_PAIR__SIGNATURE_ED25519;
-
-    // We need to take copies of the the following fields or else we
-    // get a double free assert.  They will get freed later in the call
-    // to proto__transaction__free_unpacked
-    uint8_t * pubKeyBuffer = calloc(1, 32);
-    memcpy(pubKeyBuffer, publicKey, 32);
-    uint8_t * sigCopy = calloc(1, 64);
-    memcpy(sigCopy, signature, 64);
-
-    sigMap->sigpair[0]->pubkeyprefix.data = pubKeyBuffer;
-    sigMap->sigpair[0]->pubkeyprefix.len = 32;
-    sigMap->sigpair[0]->ed25519.data = sigCopy;
-    sigMap->sigpair[0]->ed25519.len = 64;
-    sigMap->n_sigpair = 1;
-
-    return sigMap;
+    Proto__Transaction transaction;
+    proto__transaction__init(&transaction);
+
+    // Attach the signature - a single ed25519 signature pair
+    Proto__SignatureMap sigMap;
+    Proto__SignaturePair sigPair;
+    Proto__SignaturePair *sigPairRef = &sigPair;
+    proto__signature_map__init(&sigMap);
+    proto__signature_pair__init(&sigPair);
+    sigPair.signature_case = PROTO__SIGNATURE_PAIR__SIGNATURE_ED25519;
+    sigPair.pubkeyprefix.data = (uint8_t *) publicKey;
+    sigPair.pubkeyprefix.len = publicKeySize;
+    sigPair.ed25519.data = (uint8_t *) signature;
+    sigPair.ed25519.len = signatureSize;
+    sigMap.sigpair = &sigPairRef;
+    sigMap.n_sigpair = 1;
+    transaction.sigmap = &sigMap;
+
+    // Attach the body bytes
+    transaction.bodybytes.data = (uint8_t *) body;
+    transaction.bodybytes.len = bodySize;
+    transaction.body_data_case = PROTO__TRANSACTION__BODY_DATA_BODY_BYTES;
+
+    // Get the packed bytes, if they fit
+    size_t size = proto__transaction__get_packed_size(&transaction);
+    if (NULL != buffer && size <= bufferSize)
+        proto__transaction__pack(&transaction, buffer);
+
+    return size;
 }
 
 uint8_t * hederaTransactionPack (uint8_t * signature, size_t signatureSize,
@@ -146,28 +184,8 @@ uint8_t * hederaTransactionPack (uint8_t * signature, size_t signatureSize,
                                       uint8_t * body, size_t bodySize,
                                       size_t * serializedSize)
 {
-    struct _Proto__Transaction * transaction = calloc(1, sizeof(struct _Proto__Transaction));
-    proto__transaction__init(transaction);
-    transaction->body_data_case = PROTO__TRANSACTION__BODY_DATA_BODY_BYTES;
-
-    // Attach the signature and the bytes to our transaction object
-    transaction->sigmap = createSigMap(signature, publicKey);
-
-    // The call to free_unpacked below will delete the .data field, so take
-    // a copy here so we don't get a double free
-    uint8_t * bodyCopy = calloc(1, bodySize);
-    memcpy(bodyCopy, body, bodySize);
-    transaction->bodybytes.data = bodyCopy;
-    transaction->bodybytes.len = bodySize;
-    transaction->body_data_case = PROTO__TRANSACTION__BODY_DATA_BODY_BYTES;
-
-    // Get the packed bytes
-    *serializedSize = proto__transaction__get_packed_size(transaction);
+    *serializedSize = hederaTransactionPackInto (signature, signatureSize, publicKey, publicKeySize, body, bodySize, NULL, 0);
     uint8_t * serializeBytes = calloc(1, *serializedSize);
-    proto__transaction__pack(transaction, serializeBytes);
-
-    // Free the transaction now that we have serialized to bytes
-    proto__transaction__free_unpacked(transaction, NULL);
-
+    hederaTransactionPackInto (signature, signatureSize, publicKey, publicKeySize, body, bodySize, serializeBytes, *serializedSize);
     return serializeBytes;
 }
@@ -18,6 +18,20 @@
 extern "C" {
 #endif
 
+/**
+ * Pack a transaction body into `buffer`, but only if the packed size fits in `bufferSize`.  Returns
+ * the packed size in either case; call with a NULL `buffer` to get the size alone.
+ */
+size_t hederaTransactionBodyPackInto (BRHederaAddress source,
+                                      BRHederaAddress target,
+                                      BRHederaAddress nodeAddress,
+                                      BRHederaUnitTinyBar amount,
+                                      BRHederaTimeStamp timeStamp,
+                                      BRHederaUnitTinyBar fee,
+                                      const char * memo,
+                                      uint8_t *buffer,
+                                      size_t bufferSize);
+
 uint8_t * hederaTransactionBodyPack (BRHederaAddress source,
                                      BRHederaAddress target,
                                           BRHederaAddress nodeAddress,
@@ -27,6 +41,16 @@ uint8_t * hederaTransactionBodyPack (BRHederaAddress source,
                                           const char * memo,
                                           size_t *size);
 
+/**
+ * Pack a signed transaction into `buffer`, with the same size semantics as
+ * hederaTransactionBodyPackInto().
+ */
+size_t hederaTransactionPackInto (const uint8_t * signature, size_t signatureSize,
+                                  const uint8_t * publicKey, size_t publicKeySize,
+                                  const uint8_t * body, size_t bodySize,
+                                  uint8_t *buffer,
+                                  size_t bufferSize);
+
 uint8_t * hederaTransactionPack (uint8_t * signature, size_t signatureSize,
                                       uint8_t * publicKey, size_t publicKeySize,
                                       uint8_t * body, size_t bodySize,
@@ -33,8 +33,21 @@ struct BRHederaTransactionRecord {
     uint64_t blockHeight;
     int error;
     char * memo;
+
+    // The packed body; what is signed.  Cached so that re-signing or re-serializing doesn't
+    // repack it.  Anything that changes the body must release it.
+    uint8_t * bodyBytes;
+    size_t bodySize;
 };
 
+static void
+hederaTransactionReleaseBody (BRHederaTransaction transaction)
+{
+    if (transaction->bodyBytes) free (transaction->bodyBytes);
+    transaction->bodyBytes = NULL;
+    transaction->bodySize = 0;
+}
+
 char * createTransactionID(BRHederaAddress address, BRHederaTimeStamp timeStamp)
 {
     char buffer[128] = {0};
@@ -155,6 +168,7 @@ extern void hederaTransactionFree (BRHederaTransaction transaction)
     if (transaction->target) hederaAddressFree (transaction->target);
     if (transaction->nodeAddress) hederaAddressFree (transaction->nodeAddress);
     if (transaction->memo) free(transaction->memo);
+    hederaTransactionReleaseBody (transaction);
     free (transaction);
 }
 
@@ -162,7 +176,9 @@ extern void hederaTransactionSetMemo(BRHederaTransaction transaction, const char
 {
     assert(transaction);
     assert(memo);
+    if (transaction->memo) free (transaction->memo);
     transaction->memo = strdup(memo);
+    hederaTransactionReleaseBody (transaction);
 }
 
 extern char * // Caller owns memory and must free calling "free"
@@ -196,58 +212,60 @@ hederaTransactionSignTransaction (BRHederaTransaction transaction,
     unsigned char temp[32] = {0}; // Use the public key that is sent in instead
     ed25519_create_keypair (temp, privateKey, key.secret.u8);
 
-    // First we need to serialize the body since it is the thing we sign
-    size_t bodySize;
-    uint8_t * body = hederaTransactionBodyPack (transaction->source,
-                                                transaction->target,
-                                                transaction->nodeAddress,
-                                                transaction->amount,
-                                                transaction->timeStamp,
-                                                fee,
-                                                transaction->memo,
-                                                &bodySize);
+    // First we need to serialize the body since it is the thing we sign; unless we've done so.
+    if (NULL == transaction->bodyBytes) {
+        transaction->bodySize = hederaTransactionBodyPackInto (transaction->source,
+                                                               transaction->target,
+                                                               transaction->nodeAddress,
+                                                               transaction->amount,
+                                                               transaction->timeStamp,
+                                                               fee,
+                                                               transaction->memo,
+                                                               NULL, 0);
+        transaction->bodyBytes = malloc (transaction->bodySize);
+        hederaTransactionBodyPackInto (transaction->source,
+                                       transaction->target,
+                                       transaction->nodeAddress,
+                                       transaction->amount,
+                                       transaction->timeStamp,
+                                       fee,
+                                       transaction->memo,
+                                       transaction->bodyBytes, transaction->bodySize);
+    }
 
     // Create signature from the body bytes
     unsigned char signature[64];
     memset (signature, 0x00, 64);
-    ed25519_sign(signature, body, bodySize, publicKey.pubKey, privateKey);
-
-    // Serialize the full transaction including signature and public key
-    uint8_t * serializedBytes = hederaTransactionPack (signature, 64,
-                                                       publicKey.pubKey, 32,
-                                                       body, bodySize,
-                                                       &transaction->serializedSize);
-
-    // Create the hash from the serialized bytes
-    BRSHA384(transaction->hash.bytes, serializedBytes, transaction->serializedSize);
-
-    // We are now done with the body - it was copied to the serialized bytes so we
-    // must clean up it now.
-    free (body);
+    ed25519_sign(signature, transaction->bodyBytes, transaction->bodySize, publicKey.pubKey, privateKey);
 
     // Due to how the Hedera API works the "node account id" of the server we will submit to
     // is included in the signing data so we MUST get the server to use the correct node.
     // The BDB server implementation requires that we add in the node account id along with
-    // the serialized bytes.
-    uint8_t nodeAccountId[HEDERA_ADDRESS_SERIALIZED_SIZE];
-    hederaAddressSerialize (transaction->nodeAddress, nodeAccountId, HEDERA_ADDRESS_SERIALIZED_SIZE);
-
-    // The buffer has to hold the nodeAccountId and the serialized bytes
-    transaction->serializedBytes = calloc(1, transaction->serializedSize + HEDERA_ADDRESS_SERIALIZED_SIZE);
-
-    // First copy the nodeAccountId,
-    memcpy(transaction->serializedBytes, nodeAccountId, HEDERA_ADDRESS_SERIALIZED_SIZE);
-
-    // Now copy the serialized transaction bytes after the node account id
-    memcpy(transaction->serializedBytes + HEDERA_ADDRESS_SERIALIZED_SIZE, serializedBytes, transaction->serializedSize);
-
-    // Cleanup temporary buffers
-    free (serializedBytes);
+    // the serialized bytes.  So the buffer has to hold the nodeAccountId followed by the
+    // serialized transaction bytes, including the signature and public key, which we pack
+    // in place.
+    size_t packedSize = hederaTransactionPackInto (signature, 64,
+                                                   publicKey.pubKey, 32,
+                                                   transaction->bodyBytes, transaction->bodySize,
+                                                   NULL, 0);
+
+    transaction->serializedBytes = malloc (HEDERA_ADDRESS_SERIALIZED_SIZE + packedSize);
+    hederaAddressSerialize (transaction->nodeAddress, transaction->serializedBytes, HEDERA_ADDRESS_SERIALIZED_SIZE);
+
+    uint8_t * packedBytes = transaction->serializedBytes + HEDERA_ADDRESS_SERIALIZED_SIZE;
+    hederaTransactionPackInto (signature, 64,
+                               publicKey.pubKey, 32,
+                               transaction->bodyBytes, transaction->bodySize,
+                               packedBytes, packedSize);
+
+    // Create the hash from the serialized transaction bytes
+    BRSHA384(transaction->hash.bytes, packedBytes, packedSize);
 
     // Create the transaction id
+    if (transaction->transactionId) free (transaction->transactionId);
     transaction->transactionId = createTransactionID(transaction->source, transaction->timeStamp);
 
-    transaction->serializedSize += HEDERA_ADDRESS_SERIALIZED_SIZE; // This will be our new size of serialized bytes
+    transaction->serializedSize = HEDERA_ADDRESS_SERIALIZED_SIZE + packedSize;
     return transaction->serializedSize;
 }
 
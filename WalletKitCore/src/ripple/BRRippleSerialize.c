@@ -20,6 +20,7 @@
 #include "BRRipplePrivateStructs.h"
 #include "BRRippleAddress.h"
 #include "support/BRArray.h"
+#include "support/BRInt.h"
 
 // Forward declarations
 static int get_content(uint8_t *buffer, BRRippleField *field);
@@ -43,50 +44,48 @@ int compare_function(const void *field1, const void *field2) {
     return(fieldid1 - fieldid2);
 }
 
+static int fieldid_size(int type, int code)
+{
+    // See add_fieldid() below
+    return (type < 16 && code < 16) ? 1 : ((type < 16 || code < 16) ? 2 : 3);
+}
+
+static int length_size(int length)
+{
+    // See add_length() below
+    return (length <= 192) ? 1 : ((length <= 12480) ? 2 : ((length <= 918744) ? 3 : 0));
+}
+
 /**
- * Calculate the buffer size needed to store a serialized transaction
+ * Calculate the number of bytes add_fieldid() and add_content() will write for a field
  *
- * @param fields      An array of fields
- * @param num_fields  The size of the array
- * @return the size of the buffer needed
+ * @param field  A ripple field
+ * @return the serialized size of the field
  */
-uint32_t calculate_buffer_size(BRRippleField *fields, uint32_t num_fields)
+static uint32_t field_size(BRRippleField *field)
 {
-    // The fieldid is stored as 2-4 bytes. Since a few extra bytes won't hurt
-    // just allocate 4 bytes per field to be safe.
-    uint32_t size = num_fields * 4;
-    // Figure out the approximate size of the buffer we need to make
-    for (size_t i = 0; i < num_fields; i++) {
-        // Add on the potential size of the fieldid
-        switch (fields[i].typeCode) {
-            case 1:
-                size += 2; // 16-bit integers
-                break;
-            case 2:
-                size += 4; // 32-bit integers
-                break;
-            case 6:
-                size += 8; // 64-bit integers
-                break;
-            case 7:
-                if (fields[i].fieldCode == 4) {
-                    size += sizeof(fields[i].data.signature.signature);
-                    size += 4; // max needed to store length
-                } else if (fields[i].fieldCode == 3) {
-                    size += sizeof(fields[i].data.publicKey.pubKey);
-                    size += 4; // max needed to store length
-                }
-                break;
-            case 8:
-                // Accounts - which is really the address of 20 bytes plus
-                // 1 extra byte for the size.
-                if (fields[i].fieldCode == 1 || fields[i].fieldCode == 3) {
-                    size += 21; // 20 bytes for the address, 1 for the length
-                }
-                break;
-        }
+    uint32_t size = (uint32_t) fieldid_size(field->typeCode, field->fieldCode);
+    switch (field->typeCode) {
+        case 1:
+            return size + 2; // 16-bit integers
+        case 2:
+            return size + 4; // 32-bit integers
+        case 6:
+            return size + 8; // 64-bit integers
+        case 7:
+            if (field->fieldCode == 3) {
+                return size + 1 + 33;
+            } else if (field->fieldCode == 4) {
+                int length = field->data.signature.sig_length;
+                return size + (uint32_t) (length_size(length) + length);
+            }
+            return size;
+        case 8:
+            // Accounts - the raw address plus 1 byte for the length.
+            return size + 1 + (uint32_t) rippleAddressGetRawSize(field->data.address);
+        default:
+            return size;
     }
-    return size;
 }
 
 int add_fieldid(int type, int code, uint8_t *buffer)
@@ -123,31 +122,18 @@ int add_fieldid(int type, int code, uint8_t *buffer)
 }
 
 int add_uint16(uint16_t i, uint8_t* buffer) {
-    /* Copy the 2 bytes to the buffer */
-    buffer[0] = (uint8_t)(i >> 8);
-    buffer[1] = i & 0XFF;
+    UInt16SetBE(buffer, i);
     return 2;
 }
 
 int add_uint32(uint32_t i, uint8_t* buffer) {
-    /* Copy 4 bytes to the buffer */
-    buffer[0] = i >> 24;
-    buffer[1] = ((i >> 16) & 0xff);
-    buffer[2] = ((i >> 8) & 0xff);
-    buffer[3] = i & 0xff;
+    UInt32SetBE(buffer, i);
     return 4;
 }
 
 int add_uint64(uint64_t i, uint8_t* buffer)
 {
-    buffer[0] = (i >> 56);
-    buffer[1] = (i >> 48) & 0xff;
-    buffer[2] = (i >> 40) & 0xff;
-    buffer[3] = (i >> 32) & 0xff;
-    buffer[4] = (i >> 24) & 0xff;
-    buffer[5] = (i >> 16) & 0xff;
-    buffer[6] = (i >> 8) & 0xff;
-    buffer[7] = (i & 0xff);
+    UInt64SetBE(buffer, i);
     return 8;
 }
 
@@ -236,10 +222,8 @@ int add_content(BRRippleField *field, uint8_t *buffer)
             // Both are Ripple addresses
             int address_length = rippleAddressGetRawSize(field->data.address);
             add_length(address_length, buffer);
-
-            uint8_t address_bytes[address_length];
-            rippleAddressGetRawBytes (field->data.address, address_bytes, address_length);
-            return(1 + add_raw(address_bytes, address_length, &buffer[1]));
+            rippleAddressGetRawBytes (field->data.address, &buffer[1], address_length);
+            return(1 + address_length);
             break;
         }
         default:
@@ -249,16 +233,23 @@ int add_content(BRRippleField *field, uint8_t *buffer)
 
 extern uint32_t rippleSerialize (BRRippleField *fields, uint32_t num_fields, uint8_t * buffer, uint32_t bufferSize)
 {
-    // Create the stucture to hold the results
-    uint32_t size = calculate_buffer_size(fields, num_fields);
-    
+    // The values (fields) in the Ripple transaction are sorted by type code and
+    // field code (asc).  Callers normally build them in that order already; only
+    // sort when they didn't.
+    bool sorted = true;
+    uint32_t size = 0;
+    for (size_t i = 0; i < num_fields; i++) {
+        if (i > 0 && compare_function(&fields[i - 1], &fields[i]) > 0) sorted = false;
+        size += field_size(&fields[i]);
+    }
+
     if (bufferSize < size) {
         return size;
     }
 
-    // The values (fields) in the Ripple transaction are sorted by
-    // type code and field code (asc)
-    qsort(fields, num_fields, sizeof(BRRippleField), compare_function);
+    if (!sorted) {
+        qsort(fields, num_fields, sizeof(BRRippleField), compare_function);
+    }
 
     // serialize all the fields adding the field IDs and content to the buffer
     uint32_t buffer_index = 0;
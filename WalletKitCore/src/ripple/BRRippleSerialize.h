@@ -16,13 +16,18 @@
 #include "support/BRArray.h"
 
 /**
- * Serialize an unsorted array of fields
+ * Serialize an array of fields.  The fields are written in canonical order (by type code
+ * and then field code); an array that is not already in that order is sorted in place.
  *
  * @param fields      pointer to BRArrayOf(BRRippleField). NOTE: the address of the array
  *                    must be passed in due to a possible realloc of the array (and new memory location)
  * @param num_fields  the number of fields to serialize
+ * @param buffer      the output buffer; may be NULL if bufferSize is 0
+ * @param bufferSize  the size of buffer
  *
- * @return number of bytes read
+ * @return the serialized size.  Nothing is written unless it is <= bufferSize, so a nonzero
+ *         result is not success by itself: pass a NULL buffer and 0 to get the size, then
+ *         serialize into a buffer of at least that size.
  */
 extern uint32_t rippleSerialize(BRRippleField * fields, uint32_t num_fields,
                      uint8_t *buffer, uint32_t bufferSize);
@@ -89,6 +89,14 @@ struct BRRippleSerializedTransactionRecord {
     uint32_t size;
     uint8_t  *buffer;
     uint8_t  txHash[32];
+
+    // Where the TxnSignature field sits in buffer, when we produced it; removing it gives
+    // back the bytes that were signed.  Zero if the bytes came from elsewhere.
+    uint32_t signatureOffset;
+    uint32_t signatureSize;
+
+    // A hash of the secret that made the signature; the signature stands for the same key only.
+    UInt256 signingKey;
 };
 typedef struct BRRippleSerializedTransactionRecord *BRRippleSerializedTransaction;
 
@@ -267,65 +275,67 @@ extern void rippleTransactionFree(BRRippleTransaction transaction)
     free(transaction);
 }
 
+// The fields are set in canonical order - by type code and then field code - so
+// that rippleSerialize() has no need to sort them.
 int setFieldInfo(BRRippleField *fields, BRRippleTransaction transaction,
                   uint8_t * signature, int sig_length)
 {
     int index = 0;
     
     // Convert all the content to ripple fields
-    fields[index].typeCode = 8;
-    fields[index].fieldCode = 1;
-    fields[index++].data.address = transaction->sourceAddress;
-
     fields[index].typeCode = 1;
     fields[index].fieldCode = 2;
     fields[index++].data.i16 = transaction->transactionType;
 
+    fields[index].typeCode = 2;
+    fields[index].fieldCode = 2;
+    fields[index++].data.i32 = transaction->flags;
+
     fields[index].typeCode = 2;
     fields[index].fieldCode = 4;
     fields[index++].data.i32 = transaction->sequence;
 
-    fields[index].typeCode = 6;
-    fields[index].fieldCode = 8;
-    fields[index++].data.i64 = transaction->fee;
-    
-    // Payment info
-    fields[index].typeCode = 8;
-    fields[index].fieldCode = 3;
-    fields[index++].data.address = transaction->payment.targetAddress;
+    // Always add in the destination tag - the Ripple system will ignore it
+    // but exchanges use it to identify internally hosted accounts that share
+    // a single ripple address.
+    fields[index].typeCode = 2;
+    fields[index].fieldCode = 14;
+    fields[index++].data.i32 = transaction->payment.destinationTag;
+
+    if (transaction->lastLedgerSequence > 0) {
+        fields[index].typeCode = 2;
+        fields[index].fieldCode = 27;
+        fields[index++].data.i32 = transaction->lastLedgerSequence;
+    }
 
+    // Payment info
     fields[index].typeCode = 6;
     fields[index].fieldCode = 1;
     fields[index++].data.i64 = transaction->payment.amount.amount.u64Amount; // XRP only
 
+    fields[index].typeCode = 6;
+    fields[index].fieldCode = 8;
+    fields[index++].data.i64 = transaction->fee;
+
     // Public key info
     fields[index].typeCode = 7;
     fields[index].fieldCode = 3;
     fields[index++].data.publicKey = transaction->publicKey;
 
-    fields[index].typeCode = 2;
-    fields[index].fieldCode = 2;
-    fields[index++].data.i32 = transaction->flags;
-
-    // Always add in the destination tag - the Ripple system will ignore it
-    // but exchanges use it to identify internally hosted accounts that share
-    // a single ripple address.
-    fields[index].typeCode = 2;
-    fields[index].fieldCode = 14;
-    fields[index++].data.i32 = transaction->payment.destinationTag;
-
     if (signature) {
         fields[index].typeCode = 7;
         fields[index].fieldCode = 4;
         memcpy(&fields[index].data.signature.signature, signature, sig_length);
         fields[index++].data.signature.sig_length = sig_length;
     }
-    
-    if (transaction->lastLedgerSequence > 0) {
-        fields[index].typeCode = 2;
-        fields[index].fieldCode = 27;
-        fields[index++].data.i32 = transaction->lastLedgerSequence;
-    }
+
+    fields[index].typeCode = 8;
+    fields[index].fieldCode = 1;
+    fields[index++].data.address = transaction->sourceAddress;
+
+    fields[index].typeCode = 8;
+    fields[index].fieldCode = 3;
+    fields[index++].data.address = transaction->payment.targetAddress;
 
     return index;
 }
@@ -340,46 +350,6 @@ static uint64_t calculateFee(BRRippleTransaction transaction)
     return transaction->feeBasis.pricePerCostFactor * transaction->feeBasis.costFactor;
 }
 
-/*
- * Serialize the transaction
- *
- * @return serializedTransaction  valid BRRippleSerializedTransaction handle OR
- *                                NULL if unable to serialize
- */
-static BRRippleSerializedTransaction
-rippleTransactionSerializeImpl (BRRippleTransaction transaction,
-                            uint8_t *signature, int sig_length)
-{
-    assert(transaction);
-    assert(transaction->transactionType == RIPPLE_TX_TYPE_PAYMENT);
-    // NOTE - the address fields will hold a BRRippleAddress pointer BUT
-    // they are owned by the the transaction or transfer so we don't need
-    // to worry about the memory.
-    BRRippleField fields[11];
-
-    transaction->fee = calculateFee(transaction);
-    uint32_t num_fields = (uint32_t) setFieldInfo(fields, transaction, signature, sig_length);
-
-    BRRippleSerializedTransaction signedBytes = NULL;
-
-    uint32_t size = rippleSerialize(fields, num_fields, 0, 0);
-    if (size > 0) {
-        // I guess we will be sending back something
-        // TODO validate the serialized bytes
-        signedBytes = calloc(1, sizeof(struct BRRippleSerializedTransactionRecord));
-        signedBytes->size = size + 512; // Allocate an extra 512 bytes for safety
-        signedBytes->buffer = calloc(1, signedBytes->size);
-        signedBytes->size = rippleSerialize(fields, num_fields, signedBytes->buffer, signedBytes->size);
-        if (0 == signedBytes->size) {
-            // Something bad happened - free memory and set pointer to NULL
-            // LOG somewhere ???
-            rippleSerializedTransactionRecordFree(&signedBytes);
-            signedBytes = NULL;
-        }
-    }
-    return signedBytes;
-}
-
 static void createTransactionHash(BRRippleSerializedTransaction signedBytes)
 {
     assert(signedBytes);
@@ -400,15 +370,28 @@ static void createTransactionHash(BRRippleSerializedTransaction signedBytes)
     memcpy(signedBytes->txHash, md64, 32);
 }
 
+static int
+rippleSerializedTransactionHasUnsignedBytes (BRRippleSerializedTransaction signedBytes,
+                                             uint8_t *unsignedBytes, uint32_t unsignedSize,
+                                             uint32_t signatureOffset,
+                                             UInt256 signingKey)
+{
+    return (0 != signedBytes->signatureSize &&
+            UInt256Eq (signingKey, signedBytes->signingKey) &&
+            signatureOffset == signedBytes->signatureOffset &&
+            unsignedSize + signedBytes->signatureSize == signedBytes->size &&
+            0 == memcmp (signedBytes->buffer, unsignedBytes, signatureOffset) &&
+            0 == memcmp (&signedBytes->buffer[signatureOffset + signedBytes->signatureSize],
+                         &unsignedBytes[signatureOffset],
+                         unsignedSize - signatureOffset));
+}
+
 extern size_t
 rippleTransactionSerializeAndSign(BRRippleTransaction transaction, BRKey * privateKey,
                                   BRKey *publicKey, uint32_t sequence, uint32_t lastLedgerSequence)
 {
-    // If this transaction was previously signed - delete that info
-    if (transaction->signedBytes) {
-        free(transaction->signedBytes);
-        transaction->signedBytes = 0;
-    }
+    assert(transaction);
+    assert(transaction->transactionType == RIPPLE_TX_TYPE_PAYMENT);
 
     // Add in the provided parameters
     transaction->sequence = sequence;
@@ -416,25 +399,74 @@ rippleTransactionSerializeAndSign(BRRippleTransaction transaction, BRKey * priva
     
     // Add the public key to the transaction
     transaction->publicKey = *publicKey;
-    
-    // Serialize and sign the tx bytes
-    BRRippleSerializedTransaction serializedBytes = rippleTransactionSerializeImpl (transaction, 0, 0);
-    BRRippleSignature sig = signBytes(privateKey, serializedBytes->buffer, serializedBytes->size);
 
-    transaction->signedBytes = rippleTransactionSerializeImpl(transaction, sig->signature, sig->sig_length);
-    
-    rippleSignatureDelete(sig);
-    rippleSerializedTransactionRecordFree(&serializedBytes);
+    transaction->fee = calculateFee(transaction);
+
+    // NOTE - the address fields will hold a BRRippleAddress pointer BUT
+    // they are owned by the the transaction or transfer so we don't need
+    // to worry about the memory.
+    BRRippleField fields[11];
+    uint32_t num_fields = (uint32_t) setFieldInfo(fields, transaction, NULL, 0);
+
+    // The TxnSignature field (7, 4) goes after the other blob fields
+    uint32_t signatureIndex = 0;
+    while (signatureIndex < num_fields && fields[signatureIndex].typeCode <= 7) signatureIndex++;
+
+    uint32_t unsignedSize    = rippleSerialize(fields, num_fields, NULL, 0);
+    uint32_t signatureOffset = rippleSerialize(fields, signatureIndex, NULL, 0);
+
+    uint8_t unsignedBytes[unsignedSize];
+    rippleSerialize(fields, num_fields, unsignedBytes, unsignedSize);
 
-    // If we got a valid result then generate a hash
+    UInt256 signingKey;
+    BRSHA256 (signingKey.u8, privateKey->secret.u8, sizeof (privateKey->secret.u8));
+
+    // If these bytes are what we signed last time, with this key, then that signature still stands
+    if (transaction->signedBytes &&
+        rippleSerializedTransactionHasUnsignedBytes (transaction->signedBytes,
+                                                     unsignedBytes, unsignedSize,
+                                                     signatureOffset, signingKey))
+        return transaction->signedBytes->size;
+
+    // If this transaction was previously signed - delete that info
     if (transaction->signedBytes) {
-        // Create and store a transaction hash of the transaction - the hash is attached to the signed
-        // bytes object and will get destroyed if a subsequent serialization is done.
-        createTransactionHash(transaction->signedBytes);
+        rippleSerializedTransactionRecordFree(&transaction->signedBytes);
+        transaction->signedBytes = NULL;
     }
 
-    // Return the pointer to the signed byte object (or perhaps NULL)
-    return (NULL == transaction->signedBytes ? 0 : transaction->signedBytes->size);
+    // Sign the tx bytes
+    BRRippleSignature sig = signBytes(privateKey, unsignedBytes, unsignedSize);
+
+    // ... and splice the signature into them
+    BRRippleField signatureField;
+    memset(&signatureField, 0x00, sizeof(BRRippleField));
+    signatureField.typeCode = 7;
+    signatureField.fieldCode = 4;
+    signatureField.data.signature = *sig;
+
+    uint32_t signatureSize = rippleSerialize(&signatureField, 1, NULL, 0);
+
+    BRRippleSerializedTransaction signedBytes = calloc(1, sizeof(struct BRRippleSerializedTransactionRecord));
+    signedBytes->size   = unsignedSize + signatureSize;
+    signedBytes->buffer = malloc(signedBytes->size);
+    signedBytes->signatureOffset = signatureOffset;
+    signedBytes->signatureSize   = signatureSize;
+    signedBytes->signingKey      = signingKey;
+
+    memcpy(signedBytes->buffer, unsignedBytes, signatureOffset);
+    rippleSerialize(&signatureField, 1, &signedBytes->buffer[signatureOffset], signatureSize);
+    memcpy(&signedBytes->buffer[signatureOffset + signatureSize],
+           &unsignedBytes[signatureOffset],
+           unsignedSize - signatureOffset);
+
+    rippleSignatureDelete(sig);
+
+    // Create and store a transaction hash of the transaction - the hash is attached to the signed
+    // bytes object and will get destroyed if a subsequent serialization is done.
+    createTransactionHash(signedBytes);
+    transaction->signedBytes = signedBytes;
+
+    return transaction->signedBytes->size;
 }
 
 extern uint8_t* rippleTransactionSerialize(BRRippleTransaction transaction, size_t * bufferSize)
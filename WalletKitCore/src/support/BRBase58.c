@@ -34,44 +34,85 @@
 // base58 and base58check encoding: https://en.bitcoin.it/wiki/Base58Check_encoding
 static const char * bitcoinAlphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
+// the bitcoin alphabet's digit values, or -1 for an invalid character
+static const int8_t bitcoinDigits[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8, -1, -1, -1, -1, -1, -1,
+    -1,  9, 10, 11, 12, 13, 14, 15, 16, -1, 17, 18, 19, 20, 21, -1,
+    22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, -1, -1, -1, -1, -1,
+    -1, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, -1, 44, 45, 46,
+    47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+// The base conversions work a word at a time: encoding holds the number in 32-bit limbs of base 58^5 and
+// consumes up to four bytes per pass; decoding holds it in 32-bit limbs of base 2^32 and consumes up to five
+// digits per pass.  Limbs are least significant first.
+#define BASE58_POW5 656356768u // 58^5
+
 // returns the number of characters written to str including NULL terminator, or total strLen needed if str is NULL
 size_t BRBase58EncodeEx(char *str, size_t strLen, const uint8_t *data, size_t dataLen, const char *alphabet)
 {
     const char * chars = alphabet;
     assert(strlen(alphabet) >= 58);
 
-    size_t i, j, len, zcount = 0;
+    size_t i, j, k, len, zcount = 0, limbCount = 0;
     
     assert(data != NULL);
     while (zcount < dataLen && data && data[zcount] == 0) zcount++; // count leading zeroes
 
-    uint8_t buf[(dataLen - zcount)*138/100 + 1]; // log(256)/log(58), rounded up
+    uint32_t limbs[((dataLen - zcount)*138/100 + 1)/5 + 1]; // log(256)/log(58), rounded up, five digits per limb
     
-    memset(buf, 0, sizeof(buf));
-    
-    for (i = zcount; data && i < dataLen; i++) {
-        uint32_t carry = data[i];
+    for (i = zcount; data && i < dataLen; i += k) {
+        uint64_t carry = 0;
+        
+        for (k = 0; k < 4 && i + k < dataLen; k++) carry = (carry << 8) | data[i + k];
         
-        for (j = sizeof(buf); j > 0; j--) {
-            carry += (uint32_t)buf[j - 1] << 8;
-            buf[j - 1] = carry % 58;
-            carry /= 58;
+        for (j = 0; j < limbCount; j++) {
+            carry += (uint64_t)limbs[j] << (8*k);
+            limbs[j] = (uint32_t)(carry % BASE58_POW5);
+            carry /= BASE58_POW5;
+        }
+        
+        while (carry > 0) {
+            limbs[limbCount++] = (uint32_t)(carry % BASE58_POW5);
+            carry /= BASE58_POW5;
         }
         
         var_clean(&carry);
     }
     
-    i = 0;
-    while (i < sizeof(buf) && buf[i] == 0) i++; // skip leading zeroes
-    len = (zcount + sizeof(buf) - i) + 1;
+    // the most significant limb holds one to five digits; all others hold exactly five
+    uint32_t top = (limbCount > 0) ? limbs[limbCount - 1] : 0;
+    size_t topDigits = 0;
+    
+    while (top > 0) topDigits++, top /= 58;
+    len = zcount + (limbCount > 0 ? topDigits + 5*(limbCount - 1) : 0) + 1;
 
     if (str && len <= strLen) {
-        while (zcount-- > 0) *(str++) = chars[0];
-        while (i < sizeof(buf)) *(str++) = chars[buf[i++]];
-        *str = '\0';
+        char *s = &str[len - 1];
+        
+        *s = '\0';
+        
+        for (j = 0; j < limbCount; j++) {
+            uint32_t limb = limbs[j];
+            
+            for (k = (j + 1 < limbCount) ? 5 : topDigits; k > 0; k--) *(--s) = chars[limb % 58], limb /= 58;
+        }
+        
+        while (zcount-- > 0) *(--s) = chars[0];
     }
     
-    mem_clean(buf, sizeof(buf));
+    mem_clean(limbs, sizeof(limbs));
     return (! str || len <= strLen) ? len : 0;
 }
 
@@ -80,76 +121,82 @@ size_t BRBase58Encode(char *str, size_t strLen, const uint8_t *data, size_t data
     return BRBase58EncodeEx(str, strLen, data, dataLen, bitcoinAlphabet);
 }
 
+// decodes str using the digit values in digits; an invalid digit ends the decode if isStrict is 0, otherwise it
+// fails the decode
 // returns the number of bytes written to data, or total dataLen needed if data is NULL
-size_t BRBase58Decode(uint8_t *data, size_t dataLen, const char *str)
+static size_t _BRBase58DecodeDigits(uint8_t *data, size_t dataLen, const char *str, const int8_t digits[256],
+                                    int isStrict)
 {
-    size_t i = 0, j, len, zcount = 0;
+    size_t i, j, len, zcount = 0, limbCount = 0, byteCount = 0;
+    int invalid = 0;
 
-    assert(str != NULL);
-    while (str && *str == '1') str++, zcount++; // count leading zeroes
+    while (str && digits[*(const uint8_t *)str] == 0) str++, zcount++; // count leading zeroes
     
-    uint8_t buf[(str) ? strlen(str)*733/1000 + 1 : 0]; // log(58)/log(256), rounded up
+    uint32_t limbs[(str) ? (strlen(str)*733/1000 + 1)/4 + 1 : 1]; // log(58)/log(256), rounded up, four bytes per limb
     
-    memset(buf, 0, sizeof(buf));
-    
-    while (str && *str) {
-        uint32_t carry = *(const uint8_t *)(str++);
-        
-        switch (carry) {
-            case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
-                carry -= '1';
-                break;
-                
-            case 'A': case 'B': case 'C': case 'D': case 'E': case 'F': case 'G': case 'H':
-                carry += 9 - 'A';
-                break;
-                
-            case 'J': case 'K': case 'L': case 'M': case 'N':
-                carry += 17 - 'J';
-                break;
-                
-            case 'P': case 'Q': case 'R': case 'S': case 'T': case 'U': case 'V': case 'W': case 'X': case 'Y':
-            case 'Z':
-                carry += 22 - 'P';
-                break;
-                
-            case 'a': case 'b': case 'c': case 'd': case 'e': case 'f': case 'g': case 'h': case 'i': case 'j':
-            case 'k':
-                carry += 33 - 'a';
-                break;
-                
-            case 'm': case 'n': case 'o': case 'p': case 'q': case 'r': case 's': case 't': case 'u': case 'v':
-            case 'w': case 'x': case 'y': case 'z':
-                carry += 44 - 'm';
-                break;
-                
-            default:
-                carry = UINT32_MAX;
+    while (str && *str && ! invalid) {
+        uint64_t carry = 0, multiplier = 1;
+        
+        for (i = 0; i < 5 && *str; i++, str++) {
+            int8_t digit = digits[*(const uint8_t *)str];
+            
+            if (digit < 0) { invalid = 1; break; } // invalid base58 digit
+            carry = carry*58 + (uint64_t)digit;
+            multiplier *= 58;
         }
         
-        if (carry >= 58) break; // invalid base58 digit
+        if (invalid && isStrict) break;
+        
+        for (j = 0; j < limbCount; j++) {
+            carry += limbs[j]*multiplier;
+            limbs[j] = (uint32_t)carry;
+            carry >>= 32;
+        }
         
-        for (j = sizeof(buf); j > 0; j--) {
-            carry += (uint32_t)buf[j - 1]*58;
-            buf[j - 1] = carry & 0xff;
-            carry >>= 8;
+        while (carry > 0) {
+            limbs[limbCount++] = (uint32_t)carry;
+            carry >>= 32;
         }
         
         var_clean(&carry);
     }
     
-    while (i < sizeof(buf) && buf[i] == 0) i++; // skip leading zeroes
-    len = zcount + sizeof(buf) - i;
+    if (invalid && isStrict) {
+        mem_clean(limbs, sizeof(limbs));
+        return 0;
+    }
+    
+    // skip the most significant limb's leading zero bytes
+    uint32_t top = (limbCount > 0) ? limbs[limbCount - 1] : 0;
+    size_t topBytes = 0;
+    
+    while (top > 0) topBytes++, top >>= 8;
+    if (limbCount > 0) byteCount = topBytes + 4*(limbCount - 1);
+    len = zcount + byteCount;
 
     if (data && len <= dataLen) {
+        uint8_t *d = &data[len];
+        
+        for (j = 0; j < limbCount; j++) {
+            uint32_t limb = limbs[j];
+            
+            for (i = (j + 1 < limbCount) ? 4 : topBytes; i > 0; i--) *(--d) = (uint8_t)limb, limb >>= 8;
+        }
+        
         if (zcount > 0) memset(data, 0, zcount);
-        memcpy(&data[zcount], &buf[i], sizeof(buf) - i);
     }
 
-    mem_clean(buf, sizeof(buf));
+    mem_clean(limbs, sizeof(limbs));
     return (! data || len <= dataLen) ? len : 0;
 }
 
+// returns the number of bytes written to data, or total dataLen needed if data is NULL
+size_t BRBase58Decode(uint8_t *data, size_t dataLen, const char *str)
+{
+    assert(str != NULL);
+    return _BRBase58DecodeDigits(data, dataLen, str, bitcoinDigits, 0);
+}
+
 // returns the number of characters written to str including NULL terminator, or total strLen needed if str is NULL
 size_t BRBase58CheckEncode(char *str, size_t strLen, const uint8_t *data, size_t dataLen)
 {
@@ -193,52 +240,63 @@ size_t BRBase58CheckDecode(uint8_t *data, size_t dataLen, const char *str)
     return (! data || len <= dataLen) ? len : 0;
 }
 
-size_t BRBase58DecodeEx(uint8_t* data, size_t dataLen, const char *str, const char* alphabet)
+// returns the number of strings written to str, stopping at the first that does not fit in strStride
+size_t BRBase58CheckEncodeBatch(char *str, size_t strStride, const uint8_t *data, size_t dataLen, size_t count)
 {
-    int reverseLookup[256];
-    memset(&reverseLookup[0], -1, sizeof(reverseLookup));
-    int map_num = 0;
-    for (int i = 0; i < strlen(alphabet); i++) {
-        reverseLookup[(int) alphabet[i]] = map_num++;
+    uint8_t buf[dataLen + 256/8];
+    size_t i;
+
+    assert(str != NULL);
+    assert(data != NULL || dataLen == 0 || count == 0);
+
+    for (i = 0; i < count; i++, data += dataLen, str += strStride) {
+        if (dataLen > 0) memcpy(buf, data, dataLen);
+        BRSHA256_2(&buf[dataLen], buf, dataLen);
+        if (BRBase58Encode(str, strStride, buf, dataLen + 4) == 0) break;
     }
 
-    // Skip and count leading zeroes
-    size_t zcount = 0;
-    while (str && reverseLookup[(int) *str] == 0) str++, zcount++;
-
-    // Create buffer large enough to hold the decode bytes
-    int bufSize = (str) ? (int)(strlen(str)*733/1000 + 1) : 0;
-    uint8_t buf[bufSize];
-    memset(buf, 0, sizeof(buf));
-
-    // Do the decoding
-    while (str && *str)
-    {
-        int carry = reverseLookup[(int) *str];
-        if (carry == -1) return 0;
-
-        for (int i = bufSize - 1; i >= 0; i--)
-        {
-            carry += 58 * buf[i];
-            buf[i] = carry % 256;
-            carry /= 256;
+    mem_clean(buf, sizeof(buf));
+    return i;
+}
+
+// returns the number of strings successfully decoded
+size_t BRBase58CheckDecodeBatch(uint8_t *data, size_t dataStride, size_t dataLens[], const char *strs[], size_t count)
+{
+    uint8_t md[256/8], buf[dataStride + 4];
+    size_t i, len, decoded = 0;
+
+    assert(data != NULL);
+    assert(dataLens != NULL);
+    assert(strs != NULL || count == 0);
+
+    for (i = 0; i < count; i++, data += dataStride) {
+        // a string that decodes larger than the stride, with its checksum, is reported as invalid
+        len = (strs[i]) ? BRBase58Decode(buf, sizeof(buf), strs[i]) : 0;
+        
+        if (len >= 4) {
+            len -= 4;
+            BRSHA256_2(md, buf, len);
+            if (memcmp(&buf[len], md, sizeof(uint32_t)) != 0) len = 0; // verify checksum
         }
-        str++;
+        else len = 0;
+        
+        if (len > 0) memcpy(data, buf, len), decoded++;
+        dataLens[i] = len;
     }
 
-    // Skip leading zeros in buf
-    size_t i = 0;
-    while(buf[i] == 0) { i++; }
-
-    // Calculate the length
-    size_t len = zcount + sizeof(buf) - i;
+    mem_clean(buf, sizeof(buf));
+    return decoded;
+}
 
-    // If the caller has passed in buffer large enough then copy to it
-    if (data && len <= dataLen) {
-        if (zcount > 0) memset(data, 0, zcount);
-        memcpy(&data[zcount], &buf[i], sizeof(buf) - i);
+size_t BRBase58DecodeEx(uint8_t* data, size_t dataLen, const char *str, const char* alphabet)
+{
+    int8_t digits[256];
+    
+    memset(digits, -1, sizeof(digits));
+    for (size_t i = 0; i < 58 && alphabet[i]; i++) {
+        digits[(uint8_t) alphabet[i]] = (int8_t) i;
     }
 
-    // ONLY return 0 if the user passed in a buffer but it was not large enough
-    return (! data || len <= dataLen) ? len : 0;
+    // an invalid digit fails the decode, rather than ending it as BRBase58Decode does
+    return _BRBase58DecodeDigits(data, dataLen, str, digits, 1);
 }
@@ -51,6 +51,16 @@ size_t BRBase58CheckEncode(char *str, size_t strLen, const uint8_t *data, size_t
 // returns the number of bytes written to data, or total dataLen needed if data is NULL
 size_t BRBase58CheckDecode(uint8_t *data, size_t dataLen, const char *str);
 
+// base58check encodes count payloads of dataLen bytes each, stored consecutively in data, writing each NULL
+// terminated string at strStride intervals in str
+// returns the number of strings written, stopping at the first that does not fit in strStride
+size_t BRBase58CheckEncodeBatch(char *str, size_t strStride, const uint8_t *data, size_t dataLen, size_t count);
+
+// base58check decodes count strings, writing each payload at dataStride intervals in data and its length to
+// dataLens; an invalid string, or one whose payload does not fit in dataStride, gets a length of zero
+// returns the number of strings successfully decoded
+size_t BRBase58CheckDecodeBatch(uint8_t *data, size_t dataStride, size_t dataLens[], const char *strs[], size_t count);
+
 // Extended versions of base58 encode/decode that allow caller to control
 // the alphabet being used.  This is needed for Ripple (and perhaps others)
 
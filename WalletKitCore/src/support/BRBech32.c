@@ -38,6 +38,20 @@
                     (-(((x) >> 26) & 1) & 0x26508e6d) ^ (-(((x) >> 27) & 1) & 0x1ea119fa) ^\
                     (-(((x) >> 28) & 1) & 0x3d4233dd) ^ (-(((x) >> 29) & 1) & 0x2a1462b3))
 
+static const char bech32Chars[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+// the bech32 digit values of either case, or -1 for an invalid character
+static const int8_t bech32Digits[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    15, -1, 10, 17, 21, 20, 26, 30,  7,  5, -1, -1, -1, -1, -1, -1,
+    -1, 29, -1, 24, 13, 25,  9,  8, 23, -1, 18, 22, 31, 27, 19, -1,
+     1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1,
+    -1, 29, -1, 24, 13, 25,  9,  8, 23, -1, 18, 22, 31, 27, 19, -1,
+     1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1
+};
+
 // returns the number of bytes written to data42 (maximum of 42)
 size_t BRBech32Decode(char *hrp84, uint8_t *data42, const char *addr)
 {
@@ -64,17 +78,8 @@ size_t BRBech32Decode(char *hrp84, uint8_t *data42, const char *addr)
     memset(buf, 0, sizeof(buf));
 
     for (i = sep + 1, j = -1; i < addrLen; i++, j++) {
-        switch (tolower(addr[i])) {
-            case 'q': c = 0;  break; case 'p': c = 1;  break; case 'z': c = 2;  break; case 'r': c = 3;  break;
-            case 'y': c = 4;  break; case '9': c = 5;  break; case 'x': c = 6;  break; case '8': c = 7;  break;
-            case 'g': c = 8;  break; case 'f': c = 9;  break; case '2': c = 10; break; case 't': c = 11; break;
-            case 'v': c = 12; break; case 'd': c = 13; break; case 'w': c = 14; break; case '0': c = 15; break;
-            case 's': c = 16; break; case '3': c = 17; break; case 'j': c = 18; break; case 'n': c = 19; break;
-            case '5': c = 20; break; case '4': c = 21; break; case 'k': c = 22; break; case 'h': c = 23; break;
-            case 'c': c = 24; break; case 'e': c = 25; break; case '6': c = 26; break; case 'm': c = 27; break;
-            case 'u': c = 28; break; case 'a': c = 29; break; case '7': c = 30; break; case 'l': c = 31; break;
-            default: return 0; // invalid bech32 digit
-        }
+        if (bech32Digits[(uint8_t)addr[i]] < 0) return 0; // invalid bech32 digit
+        c = (uint8_t)bech32Digits[(uint8_t)addr[i]];
         
         chk = polymod(chk) ^ c;
         if (j == -1) ver = c;
@@ -96,50 +101,113 @@ size_t BRBech32Decode(char *hrp84, uint8_t *data42, const char *addr)
     return 2 + bufLen;
 }
 
-// data must contain a valid BIP141 witness program
-// returns the number of bytes written to addr91 (maximum of 91)
-size_t BRBech32Encode(char *addr91, const char *hrp, const uint8_t data[])
+// writes the checksum state after hrp to chk
+// returns the length of hrp, or SIZE_MAX if hrp is invalid
+static size_t _BRBech32HrpChecksum(uint32_t *chk, const char *hrp)
 {
-    static const char chars[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
-    char addr[91];
-    uint32_t x, chk = 1;
-    uint8_t ver, a, b = 0, c = 0;
-    size_t i, j, len;
-
-    assert(addr91 != NULL);
-    assert(hrp != NULL);
-    assert(data != NULL);
+    uint32_t x = 1;
+    size_t i, j;
     
     for (i = 0; hrp && hrp[i]; i++) {
-        if (i > 83 || hrp[i] < 33 || hrp[i] > 126 || isupper(hrp[i])) return 0;
-        chk = polymod(chk) ^ (hrp[i] >> 5);
-        addr[i] = hrp[i];
+        if (i > 83 || hrp[i] < 33 || hrp[i] > 126 || isupper(hrp[i])) return SIZE_MAX;
+        x = polymod(x) ^ (hrp[i] >> 5);
     }
     
-    chk = polymod(chk);
-    for (j = 0; j < i; j++) chk = polymod(chk) ^ (hrp[j] & 0x1f);
+    x = polymod(x);
+    for (j = 0; j < i; j++) x = polymod(x) ^ (hrp[j] & 0x1f);
+    *chk = x;
+    return i;
+}
+
+// encodes data, a BIP141 witness program, continuing from hrpChk, the checksum state after hrp
+// returns the number of bytes written to addr91 (maximum of 91)
+static size_t _BRBech32EncodeProgram(char *addr91, const char *hrp, size_t hrpLen, uint32_t hrpChk,
+                                     const uint8_t data[])
+{
+    char addr[91];
+    uint32_t x, chk = hrpChk;
+    uint8_t ver, a, b = 0, c = 0;
+    size_t i = hrpLen, j, len;
+    
+    memcpy(addr, hrp, hrpLen);
     addr[i++] = '1';
     if (i < 1 || data == NULL || (data[0] > OP_0 && data[0] < OP_1)) return 0;
     ver = (data[0] >= OP_1) ? data[0] + 1 - OP_1 : 0;
     len = data[1];
     if (ver > 16 || len < 2 || len > 40 || i + 1 + len + 6 >= 91) return 0;
     chk = polymod(chk) ^ ver;
-    addr[i++] = chars[ver];
+    addr[i++] = bech32Chars[ver];
     
     for (j = 0; j <= len; j++) {
         a = b, b = (j < len) ? data[2 + j] : 0;
         x = (j % 5)*8 - ((j % 5)*8/5)*5;
         c = ((a << (5 - x)) | (b >> (3 + x))) & 0x1f;
-        if (j < len || j % 5 > 0) chk = polymod(chk) ^ c, addr[i++] = chars[c];
+        if (j < len || j % 5 > 0) chk = polymod(chk) ^ c, addr[i++] = bech32Chars[c];
         if (x >= 2) c = (b >> (x - 2)) & 0x1f;
-        if (x >= 2 && j < len) chk = polymod(chk) ^ c, addr[i++] = chars[c];
+        if (x >= 2 && j < len) chk = polymod(chk) ^ c, addr[i++] = bech32Chars[c];
     }
     
     for (j = 0; j < 6; j++) chk = polymod(chk);
     chk ^= 1;
-    for (j = 0; j < 6; ++j) addr[i++] = chars[(chk >> ((5 - j)*5)) & 0x1f];
+    for (j = 0; j < 6; ++j) addr[i++] = bech32Chars[(chk >> ((5 - j)*5)) & 0x1f];
     addr[i++] = '\0';
     memcpy(addr91, addr, i);
     return i;
 }
 
+// data must contain a valid BIP141 witness program
+// returns the number of bytes written to addr91 (maximum of 91)
+size_t BRBech32Encode(char *addr91, const char *hrp, const uint8_t data[])
+{
+    uint32_t chk = 1;
+    size_t hrpLen;
+
+    assert(addr91 != NULL);
+    assert(hrp != NULL);
+    assert(data != NULL);
+    
+    hrpLen = _BRBech32HrpChecksum(&chk, hrp);
+    return (hrpLen != SIZE_MAX) ? _BRBech32EncodeProgram(addr91, hrp, hrpLen, chk, data) : 0;
+}
+
+// returns the number of addresses written to addrs91, stopping at the first program that fails to encode
+size_t BRBech32EncodeBatch(char *addrs91, const char *hrp, const uint8_t *data, size_t dataStride, size_t count)
+{
+    uint32_t chk = 1;
+    size_t i, hrpLen;
+
+    assert(addrs91 != NULL);
+    assert(hrp != NULL);
+    assert(data != NULL || count == 0);
+    
+    // the checksum state after hrp is shared by every address
+    hrpLen = _BRBech32HrpChecksum(&chk, hrp);
+    if (hrpLen == SIZE_MAX) return 0;
+    
+    for (i = 0; i < count; i++, data += dataStride, addrs91 += 91) {
+        if (_BRBech32EncodeProgram(addrs91, hrp, hrpLen, chk, data) == 0) break;
+    }
+    
+    return i;
+}
+
+// returns the number of addresses successfully decoded
+size_t BRBech32DecodeBatch(uint8_t *data42, size_t dataLens[], const char *hrp, const char *addrs[], size_t count)
+{
+    char hrp84[84];
+    size_t i, len, decoded = 0;
+
+    assert(data42 != NULL);
+    assert(dataLens != NULL);
+    assert(hrp != NULL);
+    assert(addrs != NULL || count == 0);
+    
+    for (i = 0; i < count; i++, data42 += 42) {
+        len = (addrs[i]) ? BRBech32Decode(hrp84, data42, addrs[i]) : 0;
+        if (len > 0 && strcmp(hrp84, hrp) != 0) len = 0;
+        if (len > 0) decoded++;
+        dataLens[i] = len;
+    }
+    
+    return decoded;
+}
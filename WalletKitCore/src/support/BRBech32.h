@@ -42,6 +42,16 @@ size_t BRBech32Decode(char *hrp84, uint8_t *data42, const char *addr);
 // returns the number of bytes written to addr91 (maximum of 91)
 size_t BRBech32Encode(char *addr91, const char *hrp, const uint8_t data[]);
 
+// encodes count BIP141 witness programs, stored at dataStride intervals in data, writing each address at 91 byte
+// intervals in addrs91
+// returns the number of addresses written, stopping at the first program that fails to encode
+size_t BRBech32EncodeBatch(char *addrs91, const char *hrp, const uint8_t *data, size_t dataStride, size_t count);
+
+// decodes count addresses, writing each witness program at 42 byte intervals in data42 and its length to dataLens;
+// an invalid address, or one whose human readable part is not hrp, gets a length of zero
+// returns the number of addresses successfully decoded
+size_t BRBech32DecodeBatch(uint8_t *data42, size_t dataLens[], const char *hrp, const char *addrs[], size_t count);
+
 #ifdef __cplusplus
 }
 #endif
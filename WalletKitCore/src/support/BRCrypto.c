@@ -27,6 +27,13 @@
 #include <string.h>
 #include <assert.h>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BR_KECCAK_X4 1 // 4-way keccak-f[1600] with AVX2, selected at runtime
+#else
+#define BR_KECCAK_X4 0
+#endif
+
 // endian swapping
 #if __BIG_ENDIAN__ || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
 #define be32(x) (x)
@@ -191,6 +198,39 @@ void BRSHA256(void *md32, const void *data, size_t dataLen)
     mem_clean(buf, sizeof(buf));
 }
 
+// sha-256 of the concatenation of count buffers, without first copying them together
+void BRSHA256Vec(void *md32, const void *const data[], const size_t dataLens[], size_t count)
+{
+    size_t i, j, n, len = 0, fill = 0;
+    uint32_t x[16], buf[] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c,
+                              0x1f83d9ab, 0x5be0cd19 }; // initial buffer values
+
+    assert(md32 != NULL);
+    assert(data != NULL || count == 0);
+
+    for (i = 0; i < count; i++) {
+        assert(data[i] != NULL || dataLens[i] == 0);
+        len += dataLens[i];
+
+        for (j = 0; j < dataLens[i]; j += n) { // process data in 64 byte blocks, carrying partial blocks over
+            n = (dataLens[i] - j < 64 - fill) ? dataLens[i] - j : 64 - fill;
+            memcpy((uint8_t *)x + fill, (const uint8_t *)data[i] + j, n);
+            fill += n;
+            if (fill == 64) _BRSHA256Compress(buf, x), fill = 0;
+        }
+    }
+
+    memset((uint8_t *)x + fill, 0, 64 - fill); // clear remainder of x
+    ((uint8_t *)x)[fill] = 0x80; // append padding
+    if (fill >= 56) _BRSHA256Compress(buf, x), memset(x, 0, 64); // length goes to next block
+    x[14] = be32((uint32_t)(len >> 29)), x[15] = be32((uint32_t)(len << 3)); // append length in bits
+    _BRSHA256Compress(buf, x); // finalize
+    for (i = 0; i < 8; i++) buf[i] = be32(buf[i]); // endian swap
+    memcpy(md32, buf, 32); // write to md
+    mem_clean(x, sizeof(x));
+    mem_clean(buf, sizeof(buf));
+}
+
 // double-sha-256 = sha-256(sha-256(x))
 void BRSHA256_2(void *md32, const void *data, size_t dataLen)
 {
@@ -399,54 +439,233 @@ void BRHash160(void *md20, const void *data, size_t datalen)
 // bitwise left rotation
 #define rol64(a, b) ((a) << (b) ^ ((a) >> (64 - (b))))
 
-static void _BRSHA3Compress(uint64_t *r, const uint64_t *x, size_t blockSize)
+static const uint64_t _keccakRC[] = { // keccak round constants
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000, 0x000000000000808b,
+    0x0000000080000001, 0x8000000080008081, 0x8000000000008009, 0x000000000000008a, 0x0000000000000088,
+    0x0000000080008009, 0x000000008000000a, 0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+    0x8000000000008003, 0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+// one fully unrolled keccak round, theta/rho/pi/chi/iota, reading lanes I##xy and writing lanes O##xy, where the
+// lanes (1,0), (2,0), (3,1), (2,2), (2,3), (0,4) are held complemented so chi needs only one NOT per plane
+#define keccakRound(I, O, rc) do { \
+    C0 = I##00 ^ I##01 ^ I##02 ^ I##03 ^ I##04; \
+    C1 = I##10 ^ I##11 ^ I##12 ^ I##13 ^ I##14; \
+    C2 = I##20 ^ I##21 ^ I##22 ^ I##23 ^ I##24; \
+    C3 = I##30 ^ I##31 ^ I##32 ^ I##33 ^ I##34; \
+    C4 = I##40 ^ I##41 ^ I##42 ^ I##43 ^ I##44; \
+    D0 = C4 ^ rol64(C1, 1); \
+    D1 = C0 ^ rol64(C2, 1); \
+    D2 = C1 ^ rol64(C3, 1); \
+    D3 = C2 ^ rol64(C4, 1); \
+    D4 = C3 ^ rol64(C0, 1); \
+    B0 = I##00 ^ D0; \
+    B1 = rol64(I##11 ^ D1, 44); \
+    B2 = rol64(I##22 ^ D2, 43); \
+    B3 = rol64(I##33 ^ D3, 21); \
+    B4 = rol64(I##44 ^ D4, 14); \
+    N = ~B2; \
+    O##00 = B0 ^ (B1 | B2) ^ (rc); \
+    O##10 = B1 ^ (N | B3); \
+    O##20 = B2 ^ (B3 & B4); \
+    O##30 = B3 ^ (B4 | B0); \
+    O##40 = B4 ^ (B0 & B1); \
+    B0 = rol64(I##30 ^ D3, 28); \
+    B1 = rol64(I##41 ^ D4, 20); \
+    B2 = rol64(I##02 ^ D0, 3); \
+    B3 = rol64(I##13 ^ D1, 45); \
+    B4 = rol64(I##24 ^ D2, 61); \
+    N = ~B4; \
+    O##01 = B0 ^ (B1 | B2); \
+    O##11 = B1 ^ (B2 & B3); \
+    O##21 = B2 ^ (B3 | N); \
+    O##31 = B3 ^ (B4 | B0); \
+    O##41 = B4 ^ (B0 & B1); \
+    B0 = rol64(I##10 ^ D1, 1); \
+    B1 = rol64(I##21 ^ D2, 6); \
+    B2 = rol64(I##32 ^ D3, 25); \
+    B3 = rol64(I##43 ^ D4, 8); \
+    B4 = rol64(I##04 ^ D0, 18); \
+    N = ~B3; \
+    O##02 = B0 ^ (B1 | B2); \
+    O##12 = B1 ^ (B2 & B3); \
+    O##22 = B2 ^ (N & B4); \
+    O##32 = N ^ (B4 | B0); \
+    O##42 = B4 ^ (B0 & B1); \
+    B0 = rol64(I##40 ^ D4, 27); \
+    B1 = rol64(I##01 ^ D0, 36); \
+    B2 = rol64(I##12 ^ D1, 10); \
+    B3 = rol64(I##23 ^ D2, 15); \
+    B4 = rol64(I##34 ^ D3, 56); \
+    N = ~B3; \
+    O##03 = B0 ^ (B1 & B2); \
+    O##13 = B1 ^ (B2 | B3); \
+    O##23 = B2 ^ (N | B4); \
+    O##33 = N ^ (B4 & B0); \
+    O##43 = B4 ^ (B0 | B1); \
+    B0 = rol64(I##20 ^ D2, 62); \
+    B1 = rol64(I##31 ^ D3, 55); \
+    B2 = rol64(I##42 ^ D4, 39); \
+    B3 = rol64(I##03 ^ D0, 41); \
+    B4 = rol64(I##14 ^ D1, 2); \
+    N = ~B1; \
+    O##04 = B0 ^ (N & B2); \
+    O##14 = N ^ (B2 | B3); \
+    O##24 = B2 ^ (B3 & B4); \
+    O##34 = B3 ^ (B4 | B0); \
+    O##44 = B4 ^ (B0 & B1); \
+} while (0)
+
+// keccak-f[1600] permutation of the 25 lane state s[x + 5*y]
+void BRKeccakF1600(uint64_t s[25])
 {
-    static const uint64_t k[] = { // keccak round constants
-        0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000, 0x000000000000808b,
-        0x0000000080000001, 0x8000000080008081, 0x8000000000008009, 0x000000000000008a, 0x0000000000000088,
-        0x0000000080008009, 0x000000008000000a, 0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
-        0x8000000000008003, 0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
-        0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
-    };
+    uint64_t a00 = s[0], a10 = s[1], a20 = s[2], a30 = s[3], a40 = s[4], a01 = s[5], a11 = s[6], a21 = s[7], a31 = s[8],
+        a41 = s[9], a02 = s[10], a12 = s[11], a22 = s[12], a32 = s[13], a42 = s[14], a03 = s[15], a13 = s[16],
+        a23 = s[17], a33 = s[18], a43 = s[19], a04 = s[20], a14 = s[21], a24 = s[22], a34 = s[23], a44 = s[24];
+    uint64_t e00, e10, e20, e30, e40, e01, e11, e21, e31, e41, e02, e12, e22, e32, e42, e03, e13, e23, e33, e43, e04,
+        e14, e24, e34, e44, C0, C1, C2, C3, C4, D0, D1, D2, D3, D4, B0, B1, B2, B3, B4, N;
     
-    size_t i, j;
-    uint64_t a[5], b[5], r0, r1;
+    a10 = ~a10, a20 = ~a20, a31 = ~a31, a22 = ~a22, a23 = ~a23, a04 = ~a04; // lane complementing transform
     
-    for (i = 0; i < blockSize/sizeof(uint64_t); i++) r[i] ^= le64(x[i]);
+    for (size_t i = 0; i < 24; i += 2) {
+        keccakRound(a, e, _keccakRC[i]);
+        keccakRound(e, a, _keccakRC[i + 1]);
+    }
     
-    for (i = 0; i < 24; i++) { // permute r
-        // theta(r)
-        for (j = 0; j < 5; j++) a[j] = r[j] ^ r[j + 5] ^ r[j + 10] ^ r[j + 15] ^ r[j + 20];
-        b[0] = rol64(a[1], 1) ^ a[4], b[1] = rol64(a[2], 1) ^ a[0], b[2] = rol64(a[3], 1) ^ a[1];
-        b[3] = rol64(a[4], 1) ^ a[2], b[4] = rol64(a[0], 1) ^ a[3];
-        for (j = 0; j < 5; j++) r[j] ^= b[j], r[j + 5] ^= b[j], r[j + 10] ^= b[j], r[j + 15] ^= b[j], r[j + 20] ^= b[j];
-        
-        // rho(r)
-        r[1] = rol64(r[1], 1), r[2] = rol64(r[2], 62), r[3] = rol64(r[3], 28), r[4] = rol64(r[4], 27);
-        r[5] = rol64(r[5], 36), r[6] = rol64(r[6], 44), r[7] = rol64(r[7], 6), r[8] = rol64(r[8], 55);
-        r[9] = rol64(r[9], 20), r[10] = rol64(r[10], 3), r[11] = rol64(r[11], 10), r[12] = rol64(r[12], 43);
-        r[13] = rol64(r[13], 25), r[14] = rol64(r[14], 39), r[15] = rol64(r[15], 41), r[16] = rol64(r[16], 45);
-        r[17] = rol64(r[17], 15), r[18] = rol64(r[18], 21), r[19] = rol64(r[19], 8), r[20] = rol64(r[20], 18);
-        r[21] = rol64(r[21], 2), r[22] = rol64(r[22], 61), r[23] = rol64(r[23], 56), r[24] = rol64(r[24], 14);
-        
-        // pi(r)
-        r1 = r[1], r[1] = r[6], r[6] = r[9], r[9] = r[22], r[22] = r[14], r[14] = r[20], r[20] = r[2], r[2] = r[12],
-        r[12] = r[13], r[13] = r[19], r[19] = r[23], r[23] = r[15], r[15] = r[4], r[4] = r[24], r[24] = r[21];
-        r[21] = r[8], r[8] = r[16], r[16] = r[5], r[5] = r[3], r[3] = r[18], r[18] = r[17], r[17] = r[11], r[11] = r[7];
-        r[7] = r[10], r[10] = r1; // r[0] left as is
-        
-        for (j = 0; j < 25; j += 5) { // chi(r)
-            r0 = r[0 + j], r1 = r[1 + j], r[0 + j] ^= ~r1 & r[2 + j], r[1 + j] ^= ~r[2 + j] & r[3 + j];
-            r[2 + j] ^= ~r[3 + j] & r[4 + j], r[3 + j] ^= ~r[4 + j] & r0, r[4 + j] ^= ~r0 & r1;
-        }
-        
-        *r ^= k[i]; // iota(r, i)
+    a10 = ~a10, a20 = ~a20, a31 = ~a31, a22 = ~a22, a23 = ~a23, a04 = ~a04;
+    s[0] = a00, s[1] = a10, s[2] = a20, s[3] = a30, s[4] = a40, s[5] = a01, s[6] = a11, s[7] = a21, s[8] = a31,
+        s[9] = a41, s[10] = a02, s[11] = a12, s[12] = a22, s[13] = a32, s[14] = a42, s[15] = a03, s[16] = a13,
+        s[17] = a23, s[18] = a33, s[19] = a43, s[20] = a04, s[21] = a14, s[22] = a24, s[23] = a34, s[24] = a44;
+}
+
+static void _BRSHA3Compress(uint64_t *r, const uint64_t *x, size_t blockSize)
+{
+    for (size_t i = 0; i < blockSize/sizeof(uint64_t); i++) r[i] ^= le64(x[i]);
+    BRKeccakF1600(r);
+}
+
+#if BR_KECCAK_X4
+#define xor4(a, b) _mm256_xor_si256((a), (b))
+#define andn4(a, b) _mm256_andnot_si256((a), (b))
+#define rol4(a, b) _mm256_or_si256(_mm256_slli_epi64((a), (b)), _mm256_srli_epi64((a), 64 - (b)))
+
+// the same round as keccakRound() over four interleaved states, one per 64bit element of each AVX2 register
+#define keccakRound4(I, O, rc) do { \
+    C0 = xor4(xor4(xor4(xor4(I##00, I##01), I##02), I##03), I##04); \
+    C1 = xor4(xor4(xor4(xor4(I##10, I##11), I##12), I##13), I##14); \
+    C2 = xor4(xor4(xor4(xor4(I##20, I##21), I##22), I##23), I##24); \
+    C3 = xor4(xor4(xor4(xor4(I##30, I##31), I##32), I##33), I##34); \
+    C4 = xor4(xor4(xor4(xor4(I##40, I##41), I##42), I##43), I##44); \
+    D0 = xor4(C4, rol4(C1, 1)); \
+    D1 = xor4(C0, rol4(C2, 1)); \
+    D2 = xor4(C1, rol4(C3, 1)); \
+    D3 = xor4(C2, rol4(C4, 1)); \
+    D4 = xor4(C3, rol4(C0, 1)); \
+    B0 = xor4(I##00, D0); \
+    B1 = rol4(xor4(I##11, D1), 44); \
+    B2 = rol4(xor4(I##22, D2), 43); \
+    B3 = rol4(xor4(I##33, D3), 21); \
+    B4 = rol4(xor4(I##44, D4), 14); \
+    O##00 = xor4(xor4(B0, andn4(B1, B2)), rc); \
+    O##10 = xor4(B1, andn4(B2, B3)); \
+    O##20 = xor4(B2, andn4(B3, B4)); \
+    O##30 = xor4(B3, andn4(B4, B0)); \
+    O##40 = xor4(B4, andn4(B0, B1)); \
+    B0 = rol4(xor4(I##30, D3), 28); \
+    B1 = rol4(xor4(I##41, D4), 20); \
+    B2 = rol4(xor4(I##02, D0), 3); \
+    B3 = rol4(xor4(I##13, D1), 45); \
+    B4 = rol4(xor4(I##24, D2), 61); \
+    O##01 = xor4(B0, andn4(B1, B2)); \
+    O##11 = xor4(B1, andn4(B2, B3)); \
+    O##21 = xor4(B2, andn4(B3, B4)); \
+    O##31 = xor4(B3, andn4(B4, B0)); \
+    O##41 = xor4(B4, andn4(B0, B1)); \
+    B0 = rol4(xor4(I##10, D1), 1); \
+    B1 = rol4(xor4(I##21, D2), 6); \
+    B2 = rol4(xor4(I##32, D3), 25); \
+    B3 = rol4(xor4(I##43, D4), 8); \
+    B4 = rol4(xor4(I##04, D0), 18); \
+    O##02 = xor4(B0, andn4(B1, B2)); \
+    O##12 = xor4(B1, andn4(B2, B3)); \
+    O##22 = xor4(B2, andn4(B3, B4)); \
+    O##32 = xor4(B3, andn4(B4, B0)); \
+    O##42 = xor4(B4, andn4(B0, B1)); \
+    B0 = rol4(xor4(I##40, D4), 27); \
+    B1 = rol4(xor4(I##01, D0), 36); \
+    B2 = rol4(xor4(I##12, D1), 10); \
+    B3 = rol4(xor4(I##23, D2), 15); \
+    B4 = rol4(xor4(I##34, D3), 56); \
+    O##03 = xor4(B0, andn4(B1, B2)); \
+    O##13 = xor4(B1, andn4(B2, B3)); \
+    O##23 = xor4(B2, andn4(B3, B4)); \
+    O##33 = xor4(B3, andn4(B4, B0)); \
+    O##43 = xor4(B4, andn4(B0, B1)); \
+    B0 = rol4(xor4(I##20, D2), 62); \
+    B1 = rol4(xor4(I##31, D3), 55); \
+    B2 = rol4(xor4(I##42, D4), 39); \
+    B3 = rol4(xor4(I##03, D0), 41); \
+    B4 = rol4(xor4(I##14, D1), 2); \
+    O##04 = xor4(B0, andn4(B1, B2)); \
+    O##14 = xor4(B1, andn4(B2, B3)); \
+    O##24 = xor4(B2, andn4(B3, B4)); \
+    O##34 = xor4(B3, andn4(B4, B0)); \
+    O##44 = xor4(B4, andn4(B0, B1)); \
+} while (0)
+
+// four keccak-f[1600] permutations at once, s[i][j] is lane i of state j
+__attribute__((target("avx2")))
+static void _BRKeccakF1600x4(uint64_t s[25][4])
+{
+    __m256i a00 = _mm256_loadu_si256((const __m256i *)s[0]), a10 = _mm256_loadu_si256((const __m256i *)s[1]),
+        a20 = _mm256_loadu_si256((const __m256i *)s[2]), a30 = _mm256_loadu_si256((const __m256i *)s[3]),
+        a40 = _mm256_loadu_si256((const __m256i *)s[4]), a01 = _mm256_loadu_si256((const __m256i *)s[5]),
+        a11 = _mm256_loadu_si256((const __m256i *)s[6]), a21 = _mm256_loadu_si256((const __m256i *)s[7]),
+        a31 = _mm256_loadu_si256((const __m256i *)s[8]), a41 = _mm256_loadu_si256((const __m256i *)s[9]),
+        a02 = _mm256_loadu_si256((const __m256i *)s[10]), a12 = _mm256_loadu_si256((const __m256i *)s[11]),
+        a22 = _mm256_loadu_si256((const __m256i *)s[12]), a32 = _mm256_loadu_si256((const __m256i *)s[13]),
+        a42 = _mm256_loadu_si256((const __m256i *)s[14]), a03 = _mm256_loadu_si256((const __m256i *)s[15]),
+        a13 = _mm256_loadu_si256((const __m256i *)s[16]), a23 = _mm256_loadu_si256((const __m256i *)s[17]),
+        a33 = _mm256_loadu_si256((const __m256i *)s[18]), a43 = _mm256_loadu_si256((const __m256i *)s[19]),
+        a04 = _mm256_loadu_si256((const __m256i *)s[20]), a14 = _mm256_loadu_si256((const __m256i *)s[21]),
+        a24 = _mm256_loadu_si256((const __m256i *)s[22]), a34 = _mm256_loadu_si256((const __m256i *)s[23]),
+        a44 = _mm256_loadu_si256((const __m256i *)s[24]);
+    __m256i e00, e10, e20, e30, e40, e01, e11, e21, e31, e41, e02, e12, e22, e32, e42, e03, e13, e23, e33, e43, e04,
+        e14, e24, e34, e44, C0, C1, C2, C3, C4, D0, D1, D2, D3, D4, B0, B1, B2, B3, B4;
+    
+    for (size_t i = 0; i < 24; i += 2) {
+        keccakRound4(a, e, _mm256_set1_epi64x((long long)_keccakRC[i]));
+        keccakRound4(e, a, _mm256_set1_epi64x((long long)_keccakRC[i + 1]));
     }
     
-    mem_clean(a, sizeof(a));
-    mem_clean(b, sizeof(b));
-    var_clean(&r0, &r1);
+    _mm256_storeu_si256((__m256i *)s[0], a00);
+    _mm256_storeu_si256((__m256i *)s[1], a10);
+    _mm256_storeu_si256((__m256i *)s[2], a20);
+    _mm256_storeu_si256((__m256i *)s[3], a30);
+    _mm256_storeu_si256((__m256i *)s[4], a40);
+    _mm256_storeu_si256((__m256i *)s[5], a01);
+    _mm256_storeu_si256((__m256i *)s[6], a11);
+    _mm256_storeu_si256((__m256i *)s[7], a21);
+    _mm256_storeu_si256((__m256i *)s[8], a31);
+    _mm256_storeu_si256((__m256i *)s[9], a41);
+    _mm256_storeu_si256((__m256i *)s[10], a02);
+    _mm256_storeu_si256((__m256i *)s[11], a12);
+    _mm256_storeu_si256((__m256i *)s[12], a22);
+    _mm256_storeu_si256((__m256i *)s[13], a32);
+    _mm256_storeu_si256((__m256i *)s[14], a42);
+    _mm256_storeu_si256((__m256i *)s[15], a03);
+    _mm256_storeu_si256((__m256i *)s[16], a13);
+    _mm256_storeu_si256((__m256i *)s[17], a23);
+    _mm256_storeu_si256((__m256i *)s[18], a33);
+    _mm256_storeu_si256((__m256i *)s[19], a43);
+    _mm256_storeu_si256((__m256i *)s[20], a04);
+    _mm256_storeu_si256((__m256i *)s[21], a14);
+    _mm256_storeu_si256((__m256i *)s[22], a24);
+    _mm256_storeu_si256((__m256i *)s[23], a34);
+    _mm256_storeu_si256((__m256i *)s[24], a44);
 }
+#endif
 
 // sha3-256: http://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.202.pdf
 void BRSHA3_256(void *md32, const void *data, size_t dataLen)
@@ -498,6 +717,97 @@ void BRKeccak256(void *md32, const void *data, size_t dataLen)
     mem_clean(buf, sizeof(buf));
 }
 
+// keccak-512: https://keccak.team/files/Keccak-submission-3.pdf
+void BRKeccak512(void *md64, const void *data, size_t dataLen)
+{
+    size_t i;
+    uint64_t x[9], buf[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    
+    assert(md64 != NULL);
+    assert(data != NULL || dataLen == 0);
+    
+    for (i = 0; i <= dataLen; i += 72) { // process data in 72 byte blocks
+        memcpy(x, (const uint8_t *)data + i, (i + 72 < dataLen) ? 72 : dataLen - i);
+        if (i + 72 > dataLen) break;
+        _BRSHA3Compress(buf, x, 72);
+    }
+    
+    memset((uint8_t *)x + (dataLen - i), 0, 72 - (dataLen - i)); // clear remainder of x
+    ((uint8_t *)x)[dataLen - i] |= 0x01; // append padding
+    ((uint8_t *)x)[71] |= 0x80;
+    _BRSHA3Compress(buf, x, 72); // finalize
+    for (i = 0; i < 8; i++) buf[i] = le64(buf[i]); // endian swap
+    memcpy(md64, buf, 64); // write to md
+    mem_clean(x, sizeof(x));
+    mem_clean(buf, sizeof(buf));
+}
+
+// keccak-256 of count messages, writing count*32 bytes to md32s. Where AVX2 is available four messages are absorbed
+// together, and each of the four states is refilled with the next message as soon as its current one is finalized
+void BRKeccak256Batch(void *md32s, const void *const data[], const size_t dataLens[], size_t count)
+{
+    assert(md32s != NULL || count == 0);
+    assert(data != NULL || count == 0);
+    assert(dataLens != NULL || count == 0);
+    
+#if BR_KECCAK_X4
+    if (count > 1 && __builtin_cpu_supports("avx2")) {
+        uint64_t s[25][4], x[17], h;
+        size_t i, j, len, msg[4], off[4], next = 0, active = 0;
+        
+        memset(s, 0, sizeof(s));
+        
+        for (j = 0; j < 4; j++) {
+            off[j] = 0;
+            msg[j] = (next < count) ? next++ : SIZE_MAX;
+            if (msg[j] != SIZE_MAX) active++;
+        }
+        
+        while (active > 0) {
+            for (j = 0; j < 4; j++) { // absorb the next block of each message
+                if (msg[j] == SIZE_MAX) continue;
+                assert(data[msg[j]] != NULL || dataLens[msg[j]] == 0);
+                len = dataLens[msg[j]] - off[j];
+                
+                if (len >= 136) memcpy(x, (const uint8_t *)data[msg[j]] + off[j], 136);
+                else {
+                    if (len > 0) memcpy(x, (const uint8_t *)data[msg[j]] + off[j], len);
+                    memset((uint8_t *)x + len, 0, 136 - len); // clear remainder of x
+                    ((uint8_t *)x)[len] |= 0x01; // append padding
+                    ((uint8_t *)x)[135] |= 0x80;
+                }
+                
+                for (i = 0; i < 17; i++) s[i][j] ^= le64(x[i]);
+            }
+            
+            _BRKeccakF1600x4(s);
+            
+            for (j = 0; j < 4; j++) { // write out finalized messages and start the next ones
+                if (msg[j] == SIZE_MAX) continue;
+                if (dataLens[msg[j]] - off[j] >= 136) { off[j] += 136; continue; }
+                
+                for (i = 0; i < 4; i++) {
+                    h = le64(s[i][j]); // endian swap
+                    memcpy((uint8_t *)md32s + msg[j]*32 + i*8, &h, 8);
+                }
+                
+                for (i = 0; i < 25; i++) s[i][j] = 0;
+                off[j] = 0;
+                msg[j] = (next < count) ? next++ : SIZE_MAX;
+                if (msg[j] == SIZE_MAX) active--;
+            }
+        }
+        
+        mem_clean(s, sizeof(s));
+        mem_clean(x, sizeof(x));
+        var_clean(&h);
+        return;
+    }
+#endif
+    
+    for (size_t i = 0; i < count; i++) BRKeccak256((uint8_t *)md32s + i*32, data[i], dataLens[i]);
+}
+
 // basic md5 functions
 #define F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
 #define G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
@@ -41,6 +41,9 @@ void BRSHA256(void *md32, const void *data, size_t dataLen);
 
 void BRSHA224(void *md28, const void *data, size_t dataLen);
 
+// sha-256 of the concatenation of count buffers, without first copying them together
+void BRSHA256Vec(void *md32, const void *const data[], const size_t dataLens[], size_t count);
+
 // double-sha-256 = sha-256(sha-256(x))
 void BRSHA256_2(void *md32, const void *data, size_t dataLen);
 
@@ -60,6 +63,15 @@ void BRSHA3_256(void *md32, const void *data, size_t dataLen);
 // keccak-256: https://keccak.team/files/Keccak-submission-3.pdf
 void BRKeccak256(void *md32, const void *data, size_t dataLen);
 
+// keccak-512: https://keccak.team/files/Keccak-submission-3.pdf
+void BRKeccak512(void *md64, const void *data, size_t dataLen);
+
+// keccak-256 of count messages, data[i] of dataLens[i] bytes, writing count*32 bytes to md32s
+void BRKeccak256Batch(void *md32s, const void *const data[], const size_t dataLens[], size_t count);
+
+// keccak-f[1600] permutation of the 25 lane state s[x + 5*y], shared by the above and the streaming keccak in ethereum
+void BRKeccakF1600(uint64_t s[25]);
+
 // md5 - for non-cryptographic use only
 void BRMD5(void *md16, const void *data, size_t dataLen);
 
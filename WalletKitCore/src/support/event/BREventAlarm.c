@@ -15,6 +15,7 @@
 #include <sys/time.h>
 #include "support/BRAssert.h"
 #include "support/BRArray.h"
+#include "support/BRSet.h"
 #include "support/BROSCompat.h"
 #include "BREvent.h"
 #include "BREventAlarm.h"
@@ -98,35 +99,67 @@ typedef struct {
 
     /// The alarm's period.  For a ONE_SHOT alarm, this is ignored/zeroed.
     struct timespec period;
+
+    /// The alarm's position in the clock's heap and the order in which it was (re)inserted; the
+    /// later orders alarms with the same expiration first-in, first-out.
+    size_t index;
+    uint64_t sequence;
 } BREventAlarm;
 
-static BREventAlarm
+static BREventAlarm *
 alarmCreatePeriodic (BREventAlarmContext context,
                      BREventAlarmCallback callback,
                      struct timespec expiration,  // first expiration...
                      struct timespec period,      // ...thereafter increment
                      BREventAlarmId identifier) {
-    return (BREventAlarm) {
+    BREventAlarm *alarm = malloc (sizeof (BREventAlarm));
+    *alarm = (BREventAlarm) {
         .type = ALARM_PERIODIC,
         .identifier = identifier,
         .context = context,
         .callback = callback,
         .expiration = expiration,
         .period = period };
+    return alarm;
 }
 
-static BREventAlarm
+static BREventAlarm *
 alarmCreate (BREventAlarmContext context,
              BREventAlarmCallback callback,
              struct timespec expiration,
              BREventAlarmId identifier) {
-    return (BREventAlarm) {
+    BREventAlarm *alarm = malloc (sizeof (BREventAlarm));
+    *alarm = (BREventAlarm) {
         .type = ALARM_ONE_SHOT,
         .identifier = identifier,
         .context = context,
         .callback = callback,
         .expiration = expiration,
         .period = { .tv_sec = 0, .tv_nsec = 0 } };
+    return alarm;
+}
+
+static void
+alarmRelease (BREventAlarm *alarm) {
+    free (alarm);
+}
+
+static size_t
+alarmHashValue (const void *alarm) {
+    // Identifiers are sequential; scatter them (Knuth's multiplicative hash) so that BRSet's linear
+    // probing does not see one long cluster.
+    return (size_t) (2654435761u * (uint32_t) ((const BREventAlarm *) alarm)->identifier);
+}
+
+static int
+alarmHashEqual (const void *alarm1, const void *alarm2) {
+    return ((const BREventAlarm *) alarm1)->identifier == ((const BREventAlarm *) alarm2)->identifier;
+}
+
+static int
+alarmIsBefore (BREventAlarm *alarm1, BREventAlarm *alarm2) {
+    int compare = timespecCompare (&alarm1->expiration, &alarm2->expiration);
+    return -1 == compare || (0 == compare && alarm1->sequence < alarm2->sequence);
 }
 
 static int
@@ -160,12 +193,24 @@ struct BREventAlarmClock {
     /// Identifier of the next alarm created.
     BREventAlarmId identifier;
 
-    /// An BRArrayOf alarms, sorted by alarm.expiration ascending.
-    BREventAlarm *alarms;
+    /// A binary min-heap of alarms, ordered by alarm.expiration (then alarm.sequence); thus
+    /// alarms[0] is the next to expire.  Each alarm holds its own index for O(log n) removal.
+    BRArrayOf(BREventAlarm*) alarms;
+
+    /// The same alarms, as a set indexed by alarm.identifier
+    BRSetOf(BREventAlarm*) alarmsById;
+
+    /// The sequence of the next alarm (re)inserted
+    uint64_t sequence;
 
     /// The time of the next timeout
     struct timespec timeout;
 
+    /// The identifier of the alarm whose callback is in progress.  Callbacks are invoked on the
+    /// clock's thread but *without* holding `lock`; `condExpired` is signalled when they complete.
+    BREventAlarmId expiring;
+    pthread_cond_t condExpired;
+
     // Thread
     pthread_t thread;
     pthread_cond_t cond;
@@ -188,13 +233,16 @@ alarmClockCreate (void) {
     BREventAlarmClock clock = calloc (1, sizeof (struct BREventAlarmClock));
 
     clock->identifier = ALARM_ID_NONE;
+    clock->expiring   = ALARM_ID_NONE;
     array_new(clock->alarms, 5);
+    clock->alarmsById = BRSetNew (alarmHashValue, alarmHashEqual, 5);
 
-    // Create the PTHREAD CONDition variable
+    // Create the PTHREAD CONDition variables
     {
         pthread_condattr_t attr;
         pthread_condattr_init(&attr);
         pthread_cond_init(&clock->cond, &attr);
+        pthread_cond_init(&clock->condExpired, &attr);
         pthread_condattr_destroy(&attr);
     }
 
@@ -219,27 +267,91 @@ alarmClockDestroy (BREventAlarmClock clock) {
 
     assert (PTHREAD_NULL == clock->thread);
     pthread_cond_destroy(&clock->cond);
+    pthread_cond_destroy(&clock->condExpired);
     pthread_mutex_destroy(&clock->lock);
     pthread_mutex_destroy(&clock->lockOnStartStop);
 
+    for (size_t index = 0; index < array_count (clock->alarms); index++)
+        alarmRelease (clock->alarms[index]);
+    BRSetFree (clock->alarmsById);
     array_free (clock->alarms);
+
     if (clock == alarmClock)
-        free (alarmClock);
         alarmClock = NULL;
+    free (clock);
 }
 
+/// MARK: - Heap
+
 static void
-alarmClockInsertAlarm (BREventAlarmClock clock,
-                       BREventAlarm alarm) {
+alarmClockHeapSet (BREventAlarmClock clock,
+                   size_t index,
+                   BREventAlarm *alarm) {
+    clock->alarms[index] = alarm;
+    alarm->index = index;
+}
+
+static void
+alarmClockHeapSiftUp (BREventAlarmClock clock,
+                      size_t index) {
+    BREventAlarm *alarm = clock->alarms[index];
+
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!alarmIsBefore (alarm, clock->alarms[parent])) break;
+        alarmClockHeapSet (clock, index, clock->alarms[parent]);
+        index = parent;
+    }
+    alarmClockHeapSet (clock, index, alarm);
+}
+
+static void
+alarmClockHeapSiftDown (BREventAlarmClock clock,
+                        size_t index) {
     size_t count = array_count (clock->alarms);
-    size_t index = count;
+    BREventAlarm *alarm = clock->alarms[index];
+
+    while (2 * index + 1 < count) {
+        size_t child = 2 * index + 1;
+        if (child + 1 < count && alarmIsBefore (clock->alarms[child + 1], clock->alarms[child]))
+            child += 1;
+        if (!alarmIsBefore (clock->alarms[child], alarm)) break;
+        alarmClockHeapSet (clock, index, clock->alarms[child]);
+        index = child;
+    }
+    alarmClockHeapSet (clock, index, alarm);
+}
 
-    for (; index > 0; index--) {
-        // If alarm.expiration is not less than 'alarm at index-1', then insert alarm at index
-        if (-1 != timespecCompare(&alarm.expiration, &clock->alarms[index - 1].expiration))
-            break;
+static void
+alarmClockInsertAlarm (BREventAlarmClock clock,
+                       BREventAlarm *alarm) {
+    alarm->sequence = clock->sequence++;
+    array_add (clock->alarms, alarm);
+    alarmClockHeapSiftUp (clock, array_count (clock->alarms) - 1);
+}
+
+static void
+alarmClockRemoveAlarm (BREventAlarmClock clock,
+                       BREventAlarm *alarm) {
+    size_t index = alarm->index;
+    size_t last  = array_count (clock->alarms) - 1;
+    assert (alarm == clock->alarms[index]);
+
+    if (index != last) {
+        // Move the last alarm into the hole; it may belong above or below the hole.
+        alarmClockHeapSet (clock, index, clock->alarms[last]);
+        array_rm_last (clock->alarms);
+        alarmClockHeapSiftDown (clock, index);
+        alarmClockHeapSiftUp   (clock, clock->alarms[index]->index);
     }
-    array_insert (clock->alarms, index, alarm);
+    else array_rm_last (clock->alarms);
+}
+
+static BREventAlarm *
+alarmClockLookupAlarm (BREventAlarmClock clock,
+                       BREventAlarmId identifier) {
+    BREventAlarm key = { .identifier = identifier };
+    return BRSetGet (clock->alarmsById, &key);
 }
 
 static void *
@@ -251,42 +363,49 @@ alarmClockThread (BREventAlarmClock clock) {
     clock->threadQuit = 0;
 
     while (!clock->threadQuit) {
+        struct timespec now = getTime();
+
+        // If the next alarm has expired...
+        if (array_count(clock->alarms) > 0 &&
+            1 != timespecCompare(&clock->alarms[0]->expiration, &now)) {
+            BREventAlarm *alarm   = clock->alarms[0];
+            BREventAlarm  expired = *alarm;
+
+            // ... remove it from the clock's alarms; if periodic, update the expiration and
+            // reinsert, otherwise it is done.
+            alarmClockRemoveAlarm (clock, alarm);
+            if (alarmIsPeriodic(alarm)) {
+                alarmPeriodUpdate(alarm);
+                alarmClockInsertAlarm(clock, alarm);
+            }
+            else {
+                BRSetRemove (clock->alarmsById, alarm);
+                alarmRelease (alarm);
+            }
+
+            // Expire the alarm - invokes the callback, without holding `lock` so that adding and
+            // removing alarms is not delayed by a callback.  See alarmClockRemAlarm().
+            clock->expiring = expired.identifier;
+            pthread_mutex_unlock(&clock->lock);
+
+            alarmExpire(&expired, clock);
+
+            pthread_mutex_lock(&clock->lock);
+            clock->expiring = ALARM_ID_NONE;
+            pthread_cond_broadcast(&clock->condExpired);
+
+            // Check for another expired alarm, or clock->threadQuit, before waiting.
+            continue;
+        }
+
         // Set the next timeout - based on an existing alarm or 'forever in the future'
         clock->timeout = (array_count(clock->alarms) > 0
-                          ? clock->alarms[0].expiration
+                          ? clock->alarms[0]->expiration
                           : (struct timespec) { .tv_sec = LONG_MAX, .tv_nsec = 0 });
 
-        switch (pthread_cond_timedwait (&clock->cond, &clock->lock, &clock->timeout)) {
-            case ETIMEDOUT: {
-                // Check if alarm was removed while we slept...
-                if (0 == array_count(clock->alarms) ||
-                    0 != timespecCompare(&clock->alarms[0].expiration, &clock->timeout)) {
-                    // ... ignore the timeout, its alarm is for the birds now
-                    break;
-                }
-
-                // If we timed-out, then get the alarm that has expired...
-                BREventAlarm alarm = clock->alarms[0];
-                // ... and remove it from the clock's alarms (for now; if periodic, add it back)
-                array_rm (clock->alarms, 0);
-
-                // Expire the alarm - invokes the callback.
-                alarmExpire(&alarm, clock);
-
-                // If periodic, update the alarm expiration and reinsert
-                if (alarmIsPeriodic(&alarm)) {
-                    alarmPeriodUpdate(&alarm);
-                    alarmClockInsertAlarm(clock, alarm);
-                }
-
-                break;
-            }
-
-            default:
-                // Update clock->timeout (above, presumably an alarm was added) and wait again.
-                // Or clock->threadQuit is set.
-                break;
-        }
+        // Wait for the timeout; or for a signal that clock->alarms was modified, presumably an
+        // alarm was added or removed, or that clock->threadQuit is set.
+        pthread_cond_timedwait (&clock->cond, &clock->lock, &clock->timeout);
     }
 
     // Requires as `cond_wait` takes its mutex when signalled.
@@ -335,6 +454,9 @@ static void
 alarmClockAssertRecovery (BREventAlarmClock clock) {
     alarmClockStop(clock);
     pthread_mutex_lock(&clock->lockOnStartStop);
+    for (size_t index = 0; index < array_count (clock->alarms); index++)
+        alarmRelease (clock->alarms[index]);
+    BRSetClear (clock->alarmsById);
     array_clear(clock->alarms);
     pthread_mutex_unlock(&clock->lockOnStartStop);
 }
@@ -346,7 +468,9 @@ alarmClockAddAlarmPeriodic (BREventAlarmClock clock,
                             struct timespec period) {
     pthread_mutex_lock(&clock->lock);
     BREventAlarmId identifier = ++clock->identifier;
-    alarmClockInsertAlarm(clock, alarmCreatePeriodic(context, callback, getTime(), period, identifier));
+    BREventAlarm *alarm = alarmCreatePeriodic(context, callback, getTime(), period, identifier);
+    BRSetAdd (clock->alarmsById, alarm);
+    alarmClockInsertAlarm(clock, alarm);
     // Having modified `alarms` we need to compute a new 'next expiration'
     pthread_cond_signal(&clock->cond);
     pthread_mutex_unlock(&clock->lock);
@@ -360,7 +484,9 @@ alarmClockAddAlarm (BREventAlarmClock clock,
                     struct timespec expiration) {
     pthread_mutex_lock(&clock->lock);
     BREventAlarmId identifier = ++clock->identifier;
-    alarmClockInsertAlarm(clock, alarmCreate(context, callback, expiration, identifier));
+    BREventAlarm *alarm = alarmCreate(context, callback, expiration, identifier);
+    BRSetAdd (clock->alarmsById, alarm);
+    alarmClockInsertAlarm(clock, alarm);
     // Having modified `alarms` we need to compute a new 'next expiration'
     pthread_cond_signal(&clock->cond);
     pthread_mutex_unlock(&clock->lock);
@@ -371,11 +497,19 @@ extern void
 alarmClockRemAlarm (BREventAlarmClock clock,
                     BREventAlarmId identifier) {
     pthread_mutex_lock(&clock->lock);
-    for (size_t index = 0; index < array_count (clock->alarms); index++)
-        if (identifier == clock->alarms[index].identifier) {
-            array_rm(clock->alarms, index);
-            break;
-        }
+    BREventAlarm *alarm = alarmClockLookupAlarm (clock, identifier);
+    if (NULL != alarm) {
+        alarmClockRemoveAlarm (clock, alarm);
+        BRSetRemove (clock->alarmsById, alarm);
+        alarmRelease (alarm);
+    }
+
+    // If the alarm's callback is in progress, wait for it to complete so that, once we return,
+    // the callback won't be invoked (and its context can be released).  Unless, of course, we
+    // are being called from that callback.
+    while (identifier == clock->expiring && !pthread_equal (pthread_self(), clock->thread))
+        pthread_cond_wait (&clock->condExpired, &clock->lock);
+
     // Having modified `alarms` we need to compute a new 'next expiration'
     pthread_cond_signal(&clock->cond);
     pthread_mutex_unlock(&clock->lock);
@@ -384,14 +518,8 @@ alarmClockRemAlarm (BREventAlarmClock clock,
 extern int
 alarmClockHasAlarm (BREventAlarmClock clock,
                     BREventAlarmId identifier) {
-    int hasAlarm = 0;
-
     pthread_mutex_lock(&clock->lock);
-    for (int index = 0; index < array_count (clock->alarms); index++)
-        if (identifier == clock->alarms[index].identifier) {
-            hasAlarm = 1;
-            break;
-        }
+    int hasAlarm = (NULL != alarmClockLookupAlarm (clock, identifier));
     pthread_mutex_unlock(&clock->lock);
 
     return hasAlarm;
@@ -62,6 +62,15 @@ alarmClockAddAlarm  (BREventAlarmClock clock,
                      BREventAlarmCallback callback,
                      struct timespec expiration);
 
+/**
+ * Remove the alarm `identifier` from `clock`.  Alarm callbacks are invoked on the clock's thread
+ * but without holding the clock's lock; if the alarm's callback is in progress, this waits for
+ * it to complete.  Thus, on return, the callback will not be invoked again and its context may
+ * be released.  (Callable from the callback itself, in which case there is no wait.)
+ *
+ * @param clock the clock
+ * @param identifier the alarm id
+ */
 extern void
 alarmClockRemAlarm (BREventAlarmClock clock,
                     BREventAlarmId identifier);
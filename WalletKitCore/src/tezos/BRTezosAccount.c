@@ -87,23 +87,65 @@ tezosAccountSignData (BRTezosAccount account,
     uint8_t watermark[] = { 0x03 };
     size_t watermarkSize = sizeof(watermark);
     
-    BRCryptoData watermarkedData = cryptoDataNew(data.size + watermarkSize);
-    
-    memcpy(watermarkedData.bytes, watermark, watermarkSize);
-    memcpy(&watermarkedData.bytes[watermarkSize], data.bytes, data.size);
-    
+    // hash the watermark and data in place rather than concatenating them
     uint8_t hash[32];
-    blake2b(hash, sizeof(hash), NULL, 0, watermarkedData.bytes, watermarkedData.size);
+    blake2b_ctx ctx;
+    blake2b_init(&ctx, sizeof(hash), NULL, 0);
+    blake2b_update(&ctx, watermark, watermarkSize);
+    blake2b_update(&ctx, data.bytes, data.size);
+    blake2b_final(&ctx, hash);
     
     BRCryptoData signature = cryptoDataNew(64);
     ed25519_sign(signature.bytes, hash, sizeof(hash), publicKey.pubKey, privateKeyBytes);
     
     mem_clean(privateKeyBytes, 64);
-    cryptoDataFree(watermarkedData);
     
     return signature;
 }
 
+extern int
+tezosAccountVerifySignatures (const BRCryptoData *data,
+                              const BRCryptoData *signatures,
+                              const uint8_t **publicKeys,
+                              size_t count,
+                              int *valid) {
+    if (0 == count) return 1;
+
+    uint8_t watermark[] = { 0x03 };
+
+    uint8_t (*hashes)[32] = calloc (count, sizeof (hashes[0]));
+    const uint8_t **messages = calloc (count, sizeof (uint8_t *));
+    const uint8_t **signatureBytes = calloc (count, sizeof (uint8_t *));
+    size_t *messageSizes = calloc (count, sizeof (size_t));
+
+    for (size_t index = 0; index < count; index++) {
+        // A signature of the wrong size can't be valid; an all-zero one never verifies.
+        static const uint8_t invalidSignature[64] = { 0 };
+
+        blake2b_ctx ctx;
+        blake2b_init(&ctx, sizeof(hashes[index]), NULL, 0);
+        blake2b_update(&ctx, watermark, sizeof(watermark));
+        blake2b_update(&ctx, data[index].bytes, data[index].size);
+        blake2b_final(&ctx, hashes[index]);
+
+        messages[index]       = hashes[index];
+        messageSizes[index]   = sizeof(hashes[index]);
+        signatureBytes[index] = (64 == signatures[index].size ? signatures[index].bytes : invalidSignature);
+    }
+
+    int allValid = ed25519_verify_batch (signatureBytes, messages, messageSizes, publicKeys, count, valid);
+
+    for (size_t index = 0; index < count; index++)
+        if (64 != signatures[index].size) { valid[index] = 0; allValid = 0; }
+
+    free (messageSizes);
+    free (signatureBytes);
+    free (messages);
+    free (hashes);
+
+    return allValid;
+}
+
 // MARK: - Accessors
 
 extern BRKey
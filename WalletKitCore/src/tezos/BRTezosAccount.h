@@ -70,6 +70,28 @@ tezosAccountSignData (BRTezosAccount account,
                       BRCryptoData data,
                       UInt512 seed);
 
+/**
+ * Verify signatures made by `tezosAccountSignData`.  The signatures are checked together as
+ * one ed25519 batch; if the batch fails each one is checked on its own.
+ *
+ * Nothing in WalletKitCore calls this: operations arrive from the BlockSet API already decoded,
+ * without signatures, and the library only signs its own.  It is for hosts that hold signed data.
+ *
+ * @param data - the signed messages
+ * @param signatures - the 64 byte signatures
+ * @param publicKeys - the 32 byte signer public keys
+ * @param count - the number of signatures
+ * @param valid - filled with 1 or 0 for each signature
+ *
+ * @return 1 if every signature is valid, 0 otherwise
+ */
+extern int
+tezosAccountVerifySignatures (const BRCryptoData *data,
+                              const BRCryptoData *signatures,
+                              const uint8_t **publicKeys,
+                              size_t count,
+                              int *valid);
+
 /**
  * Get the public key for this Tezos account
  *
@@ -19,155 +19,290 @@
 #include <assert.h>
 
 
-static BRCryptoData
-encodeAddress (BRTezosAddress address) {
-    // address bytes with 3-byte TZx prefix replaced with a 1-byte prefix
-    
+// An implicit (TZx) address is encoded with its 3-byte prefix replaced by a 1-byte tag.
+#define TEZOS_ENCODED_ADDRESS_BYTES     (TEZOS_ADDRESS_BYTES - 2)
+
+// The encoded public key is a 1-byte curve tag followed by the key.
+#define TEZOS_ENCODED_PUBLIC_KEY_BYTES  (1 + TEZOS_PUBLIC_KEY_SIZE)
+
+// The branch is the block hash without its 2-byte prefix.
+#define TEZOS_BRANCH_PREFIX_BYTES       (2)
+#define TEZOS_ENCODED_BRANCH_BYTES      (TEZOS_HASH_BYTES - TEZOS_BRANCH_PREFIX_BYTES)
+
+// MARK: - Field Encoding
+//
+// Each `encodeXInto` writes its field at `bytes` and returns the number of bytes written; the
+// matching size is known up front (either constant or from `encodeZarithSize`) so that an entire
+// operation list can be sized first and then written into one buffer.
+
+static size_t
+encodeAddressInto (BRTezosAddress address, uint8_t *bytes) {
     assert (address);
     assert (tezosAddressIsImplicit (address));
     
-    size_t len = tezosAddressGetRawSize (address);
-    uint8_t bytes[len];
-    tezosAddressGetRawBytes (address, bytes, len);
+    uint8_t raw[TEZOS_ADDRESS_BYTES];
+    tezosAddressGetRawBytes (address, raw, sizeof (raw));
     
     uint8_t prefix;
     
-    if (0 == memcmp(bytes, TZ1_PREFIX, sizeof(TZ1_PREFIX)))
+    if (0 == memcmp(raw, TZ1_PREFIX, sizeof(TZ1_PREFIX)))
         prefix = 0x00;
-    else if (0 == memcmp(bytes, TZ2_PREFIX, sizeof(TZ2_PREFIX)))
+    else if (0 == memcmp(raw, TZ2_PREFIX, sizeof(TZ2_PREFIX)))
         prefix = 0x01;
-    else if (0 == memcmp(bytes, TZ3_PREFIX, sizeof(TZ1_PREFIX)))
+    else if (0 == memcmp(raw, TZ3_PREFIX, sizeof(TZ1_PREFIX)))
         prefix = 0x02;
     else
         assert(0);
     
-    uint8_t encoded[len-2];
-    memcpy(&encoded[0], &prefix, 1);
-    memcpy(&encoded[1], &bytes[3], len-3);
+    bytes[0] = prefix;
+    memcpy(&bytes[1], &raw[3], TEZOS_ADDRESS_BYTES - 3);
     
-    return cryptoDataCopy (encoded, sizeof(encoded));
+    return TEZOS_ENCODED_ADDRESS_BYTES;
 }
 
-static BRCryptoData
-encodePublicKey (uint8_t * pubKey) {
-    uint8_t prefix = 0x0; // ed25519
-    BRCryptoData encoded = cryptoDataNew(TEZOS_PUBLIC_KEY_SIZE + 1);
-    memcpy(encoded.bytes, &prefix, 1);
-    memcpy(&encoded.bytes[1], pubKey, TEZOS_PUBLIC_KEY_SIZE);
-    return encoded;
+static size_t
+encodePublicKeyInto (const uint8_t * pubKey, uint8_t *bytes) {
+    bytes[0] = 0x0; // ed25519
+    memcpy(&bytes[1], pubKey, TEZOS_PUBLIC_KEY_SIZE);
+    return TEZOS_ENCODED_PUBLIC_KEY_BYTES;
 }
 
-extern BRCryptoData
-encodeZarith (int64_t value) {
+static size_t
+encodeZarithSize (int64_t value) {
     assert (value >= 0);
-    uint8_t result[32] = {0};
-    size_t resultSize = 0;
+    
+    size_t size = 1;
+    for (uint64_t input = (uint64_t)value; input >= 0x80; input >>= 7) size++;
+    return size;
+}
+
+static size_t
+encodeZarithInto (int64_t value, uint8_t *bytes) {
+    assert (value >= 0);
+    size_t size = 0;
     
     uint64_t input = (uint64_t)value;
     while (input >= 0x80) {
-        result[resultSize++] = (uint8_t)((input & 0xff) | 0x80);
+        bytes[size++] = (uint8_t)((input & 0xff) | 0x80);
         input >>= 7;
     }
-    result[resultSize++] = (uint8_t)input;
+    bytes[size++] = (uint8_t)input;
     
-    return cryptoDataCopy(&result[0], resultSize);
+    return size;
 }
 
-static BRCryptoData
-encodeBool (bool value) {
-    BRCryptoData encoded = cryptoDataNew(1);
-    encoded.bytes[0] = value ? 0xff : 0x00;
+extern BRCryptoData
+encodeZarith (int64_t value) {
+    BRCryptoData encoded = cryptoDataNew (encodeZarithSize (value));
+    encodeZarithInto (value, encoded.bytes);
     return encoded;
 }
 
-static BRCryptoData
-encodeOperationKind (BRTezosOperationKind kind) {
-    uint8_t bytes[1] = { kind };
-    return cryptoDataCopy (bytes, 1);
+static size_t
+encodeBoolInto (bool value, uint8_t *bytes) {
+    bytes[0] = value ? 0xff : 0x00;
+    return 1;
 }
 
-static BRCryptoData
-encodeBranch (BRTezosHash blockHash) {
+static size_t
+encodeOperationKindInto (BRTezosOperationKind kind, uint8_t *bytes) {
+    bytes[0] = (uint8_t) kind;
+    return 1;
+}
+
+static size_t
+encodeBranchInto (BRTezosHash blockHash, uint8_t *bytes) {
     // omit prefix
-    size_t numPrefixBytes = 2;
-    size_t branchSize = sizeof(blockHash.bytes) - numPrefixBytes;
-    
-    BRCryptoData branchData = cryptoDataNew(branchSize);
-    memcpy(branchData.bytes, &blockHash.bytes[numPrefixBytes], branchSize);
-    
-    return branchData;
+    memcpy(bytes, &blockHash.bytes[TEZOS_BRANCH_PREFIX_BYTES], TEZOS_ENCODED_BRANCH_BYTES);
+    return TEZOS_ENCODED_BRANCH_BYTES;
 }
 
-extern BRCryptoData
-tezosSerializeTransaction (BRTezosTransaction tx) {
+// MARK: - Operation Encoding
+
+typedef struct {
+    BRTezosOperationData opData;
+    BRTezosAddress source;
+    BRTezosUnitMutez fee;
+    int64_t counter;
+    int64_t gasLimit;
+    int64_t storageLimit;
+} BRTezosOperationFields;
+
+static BRTezosOperationFields
+tezosOperationFieldsCreate (BRTezosTransaction tx) {
     assert (tx);
     
-    BRTezosOperationData opData = tezosTransactionGetOperationData(tx);
-    
-    BRTezosAddress source = tezosTransactionGetSource(tx);
     BRTezosFeeBasis feeBasis = tezosTransactionGetFeeBasis(tx);
     assert(FEE_BASIS_ESTIMATE == feeBasis.type);
     
-    size_t maxFields = 9;
-    BRCryptoData fields[maxFields];
-    size_t numFields = 0;
-    fields[numFields++] = encodeOperationKind(opData.kind);
-    fields[numFields++] = encodeAddress(source);
-    fields[numFields++] = encodeZarith(tezosTransactionGetFee(tx));
-    fields[numFields++] = encodeZarith(tezosTransactionGetCounter(tx));
-    fields[numFields++] = encodeZarith(feeBasis.u.estimate.gasLimit);
-    fields[numFields++] = encodeZarith(feeBasis.u.estimate.storageLimit);
-    
-    if (TEZOS_OP_TRANSACTION == opData.kind) {
-        fields[numFields++] = encodeZarith(opData.u.transaction.amount);
+    return (BRTezosOperationFields) {
+        tezosTransactionGetOperationData(tx),
+        tezosTransactionGetSource(tx),
+        tezosTransactionGetFee(tx),
+        tezosTransactionGetCounter(tx),
+        feeBasis.u.estimate.gasLimit,
+        feeBasis.u.estimate.storageLimit
+    };
+}
+
+static void
+tezosOperationFieldsRelease (BRTezosOperationFields *fields) {
+    tezosAddressFree (fields->source);
+    tezosTransactionFreeOperationData (fields->opData);
+}
+
+static size_t
+tezosOperationFieldsSize (const BRTezosOperationFields *fields) {
+    size_t size = (1 // kind
+                   + TEZOS_ENCODED_ADDRESS_BYTES
+                   + encodeZarithSize (fields->fee)
+                   + encodeZarithSize (fields->counter)
+                   + encodeZarithSize (fields->gasLimit)
+                   + encodeZarithSize (fields->storageLimit));
+    
+    switch (fields->opData.kind) {
+        case TEZOS_OP_TRANSACTION:
+            return size + encodeZarithSize (fields->opData.u.transaction.amount) + 1 + TEZOS_ENCODED_ADDRESS_BYTES + 1;
+        case TEZOS_OP_DELEGATION:
+            return size + 1 + (NULL != fields->opData.u.delegation.target ? TEZOS_ENCODED_ADDRESS_BYTES : 0);
+        case TEZOS_OP_REVEAL:
+            return size + TEZOS_ENCODED_PUBLIC_KEY_BYTES;
+        default:
+            // unsupported
+            assert(0);
+            return size;
+    }
+}
+
+static size_t
+tezosOperationFieldsWrite (const BRTezosOperationFields *fields, uint8_t *bytes) {
+    const BRTezosOperationData *opData = &fields->opData;
+    size_t offset = 0;
+    
+    offset += encodeOperationKindInto (opData->kind,         &bytes[offset]);
+    offset += encodeAddressInto       (fields->source,       &bytes[offset]);
+    offset += encodeZarithInto        (fields->fee,          &bytes[offset]);
+    offset += encodeZarithInto        (fields->counter,      &bytes[offset]);
+    offset += encodeZarithInto        (fields->gasLimit,     &bytes[offset]);
+    offset += encodeZarithInto        (fields->storageLimit, &bytes[offset]);
+    
+    if (TEZOS_OP_TRANSACTION == opData->kind) {
+        offset += encodeZarithInto (opData->u.transaction.amount, &bytes[offset]);
         //TODO:XTZ support sending to KT addresses
-        fields[numFields++] = encodeBool(false); // is originated (KT) address
-        fields[numFields++] = encodeAddress(opData.u.transaction.target);
-        fields[numFields++] = encodeBool(false); // contract execution params (0x0 for no params)
-    } else if (TEZOS_OP_DELEGATION == opData.kind) {
-        if (NULL != opData.u.delegation.target) {
-            fields[numFields++] = encodeBool(true); // set delegate
-            fields[numFields++] = encodeAddress(opData.u.delegation.target);
+        offset += encodeBoolInto (false, &bytes[offset]); // is originated (KT) address
+        offset += encodeAddressInto (opData->u.transaction.target, &bytes[offset]);
+        offset += encodeBoolInto (false, &bytes[offset]); // contract execution params (0x0 for no params)
+    } else if (TEZOS_OP_DELEGATION == opData->kind) {
+        if (NULL != opData->u.delegation.target) {
+            offset += encodeBoolInto (true, &bytes[offset]); // set delegate
+            offset += encodeAddressInto (opData->u.delegation.target, &bytes[offset]);
         } else {
-            fields[numFields++] = encodeBool(false); // remove delegate
+            offset += encodeBoolInto (false, &bytes[offset]); // remove delegate
         }
-    } else if (TEZOS_OP_REVEAL == opData.kind) {
-        fields[numFields++] = encodePublicKey(opData.u.reveal.publicKey);
+    } else if (TEZOS_OP_REVEAL == opData->kind) {
+        offset += encodePublicKeyInto (opData->u.reveal.publicKey, &bytes[offset]);
     } else {
         // unsupported
         assert(0);
     }
     
-    BRCryptoData serialized = cryptoDataConcat(fields, numFields);
+    return offset;
+}
+
+// MARK: - Serialization
+
+extern size_t
+tezosSerializeTransactionInto (BRTezosTransaction tx,
+                               uint8_t *bytes,
+                               size_t bytesCount) {
+    BRTezosOperationFields fields = tezosOperationFieldsCreate (tx);
     
-    tezosAddressFree (source);
-    tezosTransactionFreeOperationData(opData);
-    for (int i=0; i < numFields; i++) {
-        cryptoDataFree(fields[i]);
+    size_t size = tezosOperationFieldsSize (&fields);
+    if (NULL != bytes && size <= bytesCount) {
+        size_t written = tezosOperationFieldsWrite (&fields, bytes);
+        assert (written == size); (void) written;
     }
     
-    return serialized;
+    tezosOperationFieldsRelease (&fields);
+    return size;
 }
 
 extern BRCryptoData
-tezosSerializeOperationList (BRTezosTransaction * tx, size_t txCount, BRTezosHash blockHash) {
-    
-    BRCryptoData fields[txCount + 1];
-    size_t numFields = 0;
+tezosSerializeTransaction (BRTezosTransaction tx) {
+    BRTezosOperationFields fields = tezosOperationFieldsCreate (tx);
     
-    // operation list = branch + [reveal op bytes] + transaction/delegation op bytes
+    BRCryptoData serialized = cryptoDataNew (tezosOperationFieldsSize (&fields));
+    size_t written = tezosOperationFieldsWrite (&fields, serialized.bytes);
+    assert (written == serialized.size); (void) written;
     
-    fields[numFields++] = encodeBranch(blockHash);
+    tezosOperationFieldsRelease (&fields);
+    return serialized;
+}
+
+///
+/// Size the operation list (branch + [reveal op bytes] + transaction/delegation op bytes), then
+/// write it at `bytes` if `bytesCount` can hold it.  Returns the size of the operation list.
+///
+static size_t
+tezosSerializeOperationListFields (const BRTezosOperationFields *fields,
+                                   size_t fieldsCount,
+                                   BRTezosHash blockHash,
+                                   uint8_t *bytes,
+                                   size_t bytesCount) {
+    size_t size = TEZOS_ENCODED_BRANCH_BYTES;
+    for (size_t i = 0; i < fieldsCount; i++)
+        size += tezosOperationFieldsSize (&fields[i]);
     
-    for (int i=0; i < txCount; i++) {
-        fields[numFields++] = tezosSerializeTransaction(tx[i]);
+    if (NULL != bytes && size <= bytesCount) {
+        size_t offset = encodeBranchInto (blockHash, bytes);
+        for (size_t i = 0; i < fieldsCount; i++)
+            offset += tezosOperationFieldsWrite (&fields[i], &bytes[offset]);
+        assert (offset == size);
     }
     
-    BRCryptoData serialized = cryptoDataConcat(fields, numFields);
+    return size;
+}
+
+extern size_t
+tezosSerializeOperationListInto (BRTezosTransaction * tx,
+                                 size_t txCount,
+                                 BRTezosHash blockHash,
+                                 uint8_t *bytes,
+                                 size_t bytesCount) {
+    BRTezosOperationFields fields[txCount > 0 ? txCount : 1];
+    for (size_t i = 0; i < txCount; i++)
+        fields[i] = tezosOperationFieldsCreate (tx[i]);
     
-    for (int i=0; i < numFields; i++) {
-        cryptoDataFree(fields[i]);
-    }
+    size_t size = tezosSerializeOperationListFields (fields, txCount, blockHash, bytes, bytesCount);
+    
+    for (size_t i = 0; i < txCount; i++)
+        tezosOperationFieldsRelease (&fields[i]);
+    
+    return size;
+}
+
+extern BRCryptoData
+tezosSerializeOperationListWithReserve (BRTezosTransaction * tx,
+                                        size_t txCount,
+                                        BRTezosHash blockHash,
+                                        size_t reserveCount) {
+    BRTezosOperationFields fields[txCount > 0 ? txCount : 1];
+    for (size_t i = 0; i < txCount; i++)
+        fields[i] = tezosOperationFieldsCreate (tx[i]);
+    
+    size_t size = tezosSerializeOperationListFields (fields, txCount, blockHash, NULL, 0);
+    
+    // cryptoDataNew zero-fills, so the reserved tail starts out as zeros
+    BRCryptoData serialized = cryptoDataNew (size + reserveCount);
+    tezosSerializeOperationListFields (fields, txCount, blockHash, serialized.bytes, serialized.size);
+    
+    for (size_t i = 0; i < txCount; i++)
+        tezosOperationFieldsRelease (&fields[i]);
     
     return serialized;
 }
+
+extern BRCryptoData
+tezosSerializeOperationList (BRTezosTransaction * tx, size_t txCount, BRTezosHash blockHash) {
+    return tezosSerializeOperationListWithReserve (tx, txCount, blockHash, 0);
+}
@@ -26,9 +26,39 @@ encodeZarith (int64_t value);
 extern BRCryptoData
 tezosSerializeTransaction (BRTezosTransaction tx);
 
+/**
+ * Serialize `tx` into the caller's `bytes`.  Returns the serialized size; the bytes are written
+ * only if `bytesCount` is at least that size (pass NULL/0 to query the size).
+ */
+extern size_t
+tezosSerializeTransactionInto (BRTezosTransaction tx,
+                               uint8_t *bytes,
+                               size_t bytesCount);
+
 extern BRCryptoData
 tezosSerializeOperationList (BRTezosTransaction * tx, size_t txCount, BRTezosHash blockHash);
 
+/**
+ * Serialize the operation list (branch followed by each of `tx`) into the caller's `bytes`.
+ * Returns the serialized size; the bytes are written only if `bytesCount` is at least that size.
+ */
+extern size_t
+tezosSerializeOperationListInto (BRTezosTransaction * tx,
+                                 size_t txCount,
+                                 BRTezosHash blockHash,
+                                 uint8_t *bytes,
+                                 size_t bytesCount);
+
+/**
+ * Serialize the operation list into a single allocation with `reserveCount` zeroed bytes after
+ * the forged operations - room for the signature.  The forged size is `result.size - reserveCount`.
+ */
+extern BRCryptoData
+tezosSerializeOperationListWithReserve (BRTezosTransaction * tx,
+                                        size_t txCount,
+                                        BRTezosHash blockHash,
+                                        size_t reserveCount);
+
 
 #ifdef __cplusplus
 }
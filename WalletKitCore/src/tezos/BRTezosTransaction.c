@@ -21,6 +21,17 @@
 
 #define TEZOS_SIGNATURE_BYTES 64
 
+// The inputs, beyond the transaction's immutable fields, that determine the forged operation list.
+typedef struct {
+    BRTezosHash branch;
+    bool withReveal;
+    uint8_t revealPublicKey[TEZOS_PUBLIC_KEY_SIZE];
+    int64_t counter;
+    BRTezosUnitMutez fee;
+    int64_t gasLimit;
+    int64_t storageLimit;
+} BRTezosForgeInputs;
+
 struct BRTezosTransactionRecord {
     
     BRTezosHash hash;
@@ -35,7 +46,12 @@ struct BRTezosTransactionRecord {
     const char * protocol; // protocol name
     const char * branch; // hash of head block
     
+    // The forged operation list followed by its signature.  The forged part is reused, with only
+    // the signature replaced, until one of `forgeInputs` changes; `hash` covers the current bytes
+    // when `hashIsCurrent`.
     BRCryptoData signedBytes;
+    BRTezosForgeInputs forgeInputs;
+    bool hashIsCurrent;
 };
 
 struct BRTezosSignatureRecord {
@@ -142,29 +158,94 @@ createTransactionHash(BRTezosTransaction tx) {
     memcpy(&(tx->hash.bytes[sizeof(prefix)]), hash, sizeof(hash));
 }
 
-static BRCryptoData
-tezosTransactionSerialize (BRTezosTransaction transaction,
-                           BRTezosAccount account,
-                           BRTezosHash lastBlockHash,
-                           bool needsReveal) {
+static BRTezosForgeInputs
+tezosTransactionGetForgeInputs (BRTezosTransaction transaction,
+                                BRTezosAccount account,
+                                BRTezosHash lastBlockHash,
+                                bool needsReveal) {
+    BRTezosForgeInputs inputs;
+    memset (&inputs, 0, sizeof(inputs));
+    
+    inputs.branch = lastBlockHash;
+    inputs.withReveal = needsReveal;
+    if (needsReveal) {
+        BRKey publicKey = tezosAccountGetPublicKey(account);
+        memcpy (inputs.revealPublicKey, publicKey.pubKey, TEZOS_PUBLIC_KEY_SIZE);
+    }
+    inputs.counter = transaction->counter;
+    inputs.fee = tezosTransactionGetFee (transaction);
+    inputs.gasLimit = transaction->feeBasis.u.estimate.gasLimit;
+    inputs.storageLimit = transaction->feeBasis.u.estimate.storageLimit;
+    
+    return inputs;
+}
+
+static bool
+tezosForgeInputsEqual (const BRTezosForgeInputs *i1, const BRTezosForgeInputs *i2) {
+    return (0 == memcmp (i1->branch.bytes, i2->branch.bytes, sizeof(i1->branch.bytes)) &&
+            i1->withReveal == i2->withReveal &&
+            0 == memcmp (i1->revealPublicKey, i2->revealPublicKey, sizeof(i1->revealPublicKey)) &&
+            i1->counter == i2->counter &&
+            i1->fee == i2->fee &&
+            i1->gasLimit == i2->gasLimit &&
+            i1->storageLimit == i2->storageLimit);
+}
+
+///
+/// Ensure `signedBytes` holds the forged operation list, followed by room for the signature, and
+/// return the forged size.  The operation list is only re-forged if its inputs have changed.
+///
+static size_t
+tezosTransactionForge (BRTezosTransaction transaction,
+                       BRTezosAccount account,
+                       BRTezosHash lastBlockHash,
+                       bool needsReveal) {
+    BRTezosForgeInputs inputs = tezosTransactionGetForgeInputs (transaction, account, lastBlockHash, needsReveal);
+    
+    bool reuse = (transaction->signedBytes.size > 0 &&
+                  tezosForgeInputsEqual (&inputs, &transaction->forgeInputs));
+    
     BRTezosTransaction opList[2];
     size_t opCount = 0;
     
     // add a reveal operation to the operation list if needed
     if (needsReveal) {
-        BRKey publicKey = tezosAccountGetPublicKey(account);
-        BRTezosTransaction reveal = tezosTransactionCreateReveal(transaction->source,
-                                                                 publicKey.pubKey,
-                                                                 transaction->feeBasis,
-                                                                 transaction->counter);
+        if (!reuse) {
+            opList[opCount++] = tezosTransactionCreateReveal(transaction->source,
+                                                             inputs.revealPublicKey,
+                                                             transaction->feeBasis,
+                                                             transaction->counter);
+        }
         transaction->counter += 1;
+    }
+    
+    if (!reuse) {
+        opList[opCount++] = transaction;
+        
+        cryptoDataFree (transaction->signedBytes);
+        transaction->signedBytes = tezosSerializeOperationListWithReserve (opList, opCount, lastBlockHash, TEZOS_SIGNATURE_BYTES);
+        transaction->forgeInputs = inputs;
+        transaction->hashIsCurrent = false;
         
-        opList[opCount++] = reveal;
+        if (needsReveal) tezosTransactionFree (opList[0]);
     }
     
-    opList[opCount++] = transaction;
+    return transaction->signedBytes.size - TEZOS_SIGNATURE_BYTES;
+}
+
+static void
+tezosTransactionSetSignature (BRTezosTransaction transaction,
+                              size_t forgedSize,
+                              const uint8_t *signature) {
+    uint8_t *signatureBytes = &transaction->signedBytes.bytes[forgedSize];
+    
+    if (!transaction->hashIsCurrent || 0 != memcmp (signatureBytes, signature, TEZOS_SIGNATURE_BYTES)) {
+        memcpy (signatureBytes, signature, TEZOS_SIGNATURE_BYTES);
+        createTransactionHash (transaction);
+        transaction->hashIsCurrent = true;
+    }
     
-    return tezosSerializeOperationList(opList, opCount, lastBlockHash);
+    transaction->feeBasis.u.estimate.sizeInBytes = transaction->signedBytes.size;
 }
 
 extern size_t
@@ -175,21 +256,10 @@ tezosTransactionSerializeForFeeEstimation (BRTezosTransaction transaction,
     assert (transaction);
     assert (account);
     
-    cryptoDataFree(transaction->signedBytes);
-    
-    BRCryptoData unsignedBytes = tezosTransactionSerialize(transaction, account, lastBlockHash, needsReveal);
-    BRCryptoData signature = cryptoDataNew(TEZOS_SIGNATURE_BYTES); // empty signature
+    size_t forgedSize = tezosTransactionForge (transaction, account, lastBlockHash, needsReveal);
     
-    BRCryptoData serializedBytes = cryptoDataNew(unsignedBytes.size + signature.size);
-    memcpy(serializedBytes.bytes, unsignedBytes.bytes, unsignedBytes.size);
-    memcpy(&serializedBytes.bytes[unsignedBytes.size], signature.bytes, signature.size);
-    
-    transaction->signedBytes = serializedBytes;
-    transaction->feeBasis.u.estimate.sizeInBytes = serializedBytes.size;
-    
-    if (transaction->signedBytes.size > 0) {
-        createTransactionHash(transaction);
-    }
+    uint8_t signature[TEZOS_SIGNATURE_BYTES] = { 0 }; // empty signature
+    tezosTransactionSetSignature (transaction, forgedSize, signature);
     
     return transaction->signedBytes.size;
 }
@@ -203,23 +273,14 @@ tezosTransactionSerializeAndSign (BRTezosTransaction transaction,
     assert (transaction);
     assert (account);
     
-    cryptoDataFree(transaction->signedBytes);
-    
-    BRCryptoData unsignedBytes = tezosTransactionSerialize (transaction, account, lastBlockHash, needsReveal);
+    size_t forgedSize = tezosTransactionForge (transaction, account, lastBlockHash, needsReveal);
     
+    BRCryptoData unsignedBytes = { transaction->signedBytes.bytes, forgedSize };
     BRCryptoData signature = tezosAccountSignData(account, unsignedBytes, seed);
     assert(TEZOS_SIGNATURE_BYTES == signature.size);
     
-    BRCryptoData signedBytes = cryptoDataNew(unsignedBytes.size + signature.size);
-    memcpy(signedBytes.bytes, unsignedBytes.bytes, unsignedBytes.size);
-    memcpy(&signedBytes.bytes[unsignedBytes.size], signature.bytes, signature.size);
-    
-    transaction->signedBytes = signedBytes;
-    transaction->feeBasis.u.estimate.sizeInBytes = signedBytes.size;
-    
-    if (transaction->signedBytes.size > 0) {
-        createTransactionHash(transaction);
-    }
+    tezosTransactionSetSignature (transaction, forgedSize, signature.bytes);
+    cryptoDataFree (signature);
     
     return transaction->signedBytes.size;
 }
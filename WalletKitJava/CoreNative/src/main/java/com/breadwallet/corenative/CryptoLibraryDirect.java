@@ -406,6 +406,7 @@ public final class CryptoLibraryDirect {
 
     // crypto/BRCryptoListener.h
     public static native Pointer cryptoListenerCreate (Pointer context, Callback systemCB, Callback networkCB, Callback managerCB, Callback walletCB, Callback transferCB);
+    public static native void cryptoListenerSetCoalescing (Pointer listener, int windowInMilliseconds, SizeT batchLimit, Callback batchCB);
 
     // crypto/BRCryptoSystem.h
     public static native Pointer cryptoSystemCreate(BRCryptoClient.ByValue client,
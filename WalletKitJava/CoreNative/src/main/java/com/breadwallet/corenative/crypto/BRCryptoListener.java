@@ -9,6 +9,7 @@ package com.breadwallet.corenative.crypto;
 
 import com.breadwallet.corenative.CryptoLibraryDirect;
 import com.breadwallet.corenative.utility.Cookie;
+import com.breadwallet.corenative.utility.SizeT;
 import com.sun.jna.Callback;
 import com.sun.jna.Pointer;
 import com.sun.jna.PointerType;
@@ -51,6 +52,12 @@ public class BRCryptoListener extends PointerType {
                       BRCryptoTransferEvent.ByValue event);
     }
 
+    public interface BRCryptoListenerBatchEvent extends Callback {
+        void callback(Pointer context,
+                      int begin,
+                      SizeT eventsCount);
+    }
+
     //
     // Client Interface
     //
@@ -139,6 +146,21 @@ public class BRCryptoListener extends PointerType {
         }
     }
 
+    public interface BatchEventCallback extends BRCryptoListenerBatchEvent {
+        void handle(Cookie context,
+                    boolean begin,
+                    long eventsCount);
+
+        @Override
+        default void callback(Pointer context,
+                              int begin,
+                              SizeT eventsCount) {
+            handle(new Cookie(context),
+                    BRCryptoBoolean.CRYPTO_TRUE == begin,
+                    eventsCount.longValue());
+        }
+    }
+
     //
     // Listener Pointer
     //
@@ -166,4 +188,14 @@ public class BRCryptoListener extends PointerType {
                         walletEventCallback,
                         transferEventCallback));
     }
+
+    public void setCoalescing(int windowInMilliseconds,
+                              long batchLimit,
+                              BatchEventCallback batchEventCallback) {
+        CryptoLibraryDirect.cryptoListenerSetCoalescing(
+                this.getPointer(),
+                windowInMilliseconds,
+                new SizeT(batchLimit),
+                batchEventCallback);
+    }
 }
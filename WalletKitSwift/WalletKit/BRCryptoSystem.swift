@@ -184,12 +184,21 @@ public final class System {
     ///   - listenerQueue: The queue to use when performing listen event handler callbacks.  If a
     ///       queue is not specficied (default to `nil`), then one will be provided.
     ///
+    ///   - listenerCoalescingWindowInMilliseconds: If non-zero, events are held for up to this
+    ///       window, or until `listenerCoalescingBatchLimit` are held, with superseded events
+    ///       merged, and then handled as a batch.  See `SystemListener.handleEventBatch`.  The
+    ///       default of 0 handles every event individually.
+    ///
+    ///   - listenerCoalescingBatchLimit: The most events held in a batch.
+    ///
     internal init (client: SystemClient,
                    listener: SystemListener,
                    account: Account,
                    onMainnet: Bool,
                    path: String,
-                   listenerQueue: DispatchQueue? = nil) {
+                   listenerQueue: DispatchQueue? = nil,
+                   listenerCoalescingWindowInMilliseconds: UInt32 = 0,
+                   listenerCoalescingBatchLimit: Int = 0) {
 
         let basePath = path.hasSuffix("/") ? String(path.dropLast()) : path
         let uids     = account.fileSystemIdentifier
@@ -209,8 +218,14 @@ public final class System {
         // `cryptoListener` will have their context (which is based on `self.index`)
         self.index = System.systemIndexIncrement;
 
+        let cryptoListener = self.cryptoListener
+        cryptoListenerSetCoalescing (cryptoListener,
+                                     listenerCoalescingWindowInMilliseconds,
+                                     listenerCoalescingBatchLimit,
+                                     System.cryptoListenerBatchCallback)
+
         self.core = cryptoSystemCreate (self.cryptoClient,
-                                        self.cryptoListener,
+                                        cryptoListener,
                                         account.core,
                                         basePath,
                                         onMainnet ? CRYPTO_TRUE : CRYPTO_FALSE)
@@ -230,13 +245,17 @@ public final class System {
                                account: Account,
                                onMainnet: Bool,
                                path: String,
-                               listenerQueue: DispatchQueue? = nil) -> System {
+                               listenerQueue: DispatchQueue? = nil,
+                               listenerCoalescingWindowInMilliseconds: UInt32 = 0,
+                               listenerCoalescingBatchLimit: Int = 0) -> System {
         return System (client: client,
                        listener: listener,
                        account: account,
                        onMainnet: onMainnet,
                        path: path,
-                       listenerQueue: listenerQueue)
+                       listenerQueue: listenerQueue,
+                       listenerCoalescingWindowInMilliseconds: listenerCoalescingWindowInMilliseconds,
+                       listenerCoalescingBatchLimit: listenerCoalescingBatchLimit)
     }
 
     static func ensurePath (_ path: String) -> Bool {
@@ -1179,6 +1198,25 @@ public protocol SystemListener : /* class, */ WalletManagerListener, WalletListe
     ///
     func handleSystemEvent (system: System,
                             event: SystemEvent)
+
+    ///
+    /// Handle the boundaries of a batch of coalesced events.  Only invoked for a System created
+    /// with a non-zero `listenerCoalescingWindowInMilliseconds`.
+    ///
+    /// - Parameters:
+    ///   - system: the system
+    ///   - begin: true before the batch's events are handled; false after
+    ///   - eventsCount: the number of events in the batch
+    ///
+    func handleEventBatch (system: System,
+                           begin: Bool,
+                           eventsCount: Int)
+}
+
+extension SystemListener {
+    public func handleEventBatch (system: System,
+                                  begin: Bool,
+                                  eventsCount: Int) {}
 }
 
 // MARK: - System Callback Coordinator
@@ -1252,6 +1290,18 @@ internal final class SystemCallbackCoordinator {
 // MARK: - Crypto Listener
 
 extension System {
+    internal static let cryptoListenerBatchCallback: BRCryptoListenerBatchCallback = {
+        (context, begin, eventsCount) in
+        precondition (nil != context)
+
+        guard let system = System.systemExtract(context)
+        else { print ("SYS: Event: Batch: Missed (sys)"); return }
+
+        system.listener?.handleEventBatch (system: system,
+                                           begin: CRYPTO_TRUE == begin,
+                                           eventsCount: eventsCount)
+    }
+
     internal var cryptoListener: BRCryptoListener {
         // These methods are invoked direclty on a BWM, EWM, or GWM thread.
         return cryptoListenerCreate(